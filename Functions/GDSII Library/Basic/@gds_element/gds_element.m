@@ -38,7 +38,9 @@ function gelm = gds_element(etype, varargin);
 %             Boundary element:
 %             -----------------
 %                xy :    a cell array of N x 2 matrices containing the vertices
-%                        of a one or more closed polygons. 
+%                        of a one or more closed polygons. Polygons with
+%                        more than 8191 vertices are split into several
+%                        polygons when they are written to a file.
 %                dtype : data type number 0 .. 255. Default is 0.
 %                        Forms a layer specification together with 
 %                        the layer.
@@ -48,6 +50,7 @@ function gelm = gds_element(etype, varargin);
 %             -------------
 %                xy :    a cell array of N x 2 matrices of vertex coordinates 
 %                        along the path describing one or more paths.
+%                        Paths can have at most 8191 vertices.
 %                dtype : data type number 0 .. 255. Default is 0.
 %                        Forms a layer specification together with 
 %                        the layer.
@@ -127,6 +130,18 @@ function gelm = gds_element(etype, varargin);
 %                 strans.angle   : rotation angle for structure in degrees.
 %                                  Default is 0.
 %
+%                 xy coordinates can also be int32 matrices in database
+%                 units instead of double matrices in user units. They
+%                 are written to files without conversion. Libraries
+%                 read with the 'dbu' option of read_gds_library have
+%                 elements with int32 coordinates. The methods
+%                 poly_bool, poly_boolops, poly_offset, poly_split,
+%                 poly_iscw, poly_cw, poly_box, and poly_path accept
+%                 elements with int32 coordinates and return int32
+%                 coordinates; poly_path needs defined units for the
+%                 path width.
+%                 poly_text does not accept int32 coordinates.
+%
 
 % Initial version, Ulf Griesmann, NIST, June 2011
 
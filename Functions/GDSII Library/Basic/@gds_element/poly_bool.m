@@ -10,7 +10,10 @@ function [bo] = poly_bool(ba, bb, op, varargin);
 %             before calls to 'poly_bool' either by creating the 
 %             library object or with a call to 'gdsii_units'.
 %             This is necessary because the boolean operations
-%             are performed on the database grid.
+%             are performed on the database grid. Elements with
+%             int32 coordinates in database units (see the 'dbu' 
+%             option of read_gds_library) need no units; the 
+%             output element then also has int32 coordinates.
 %
 % ba :    input boundary element. If ba is a compound element
 %         (i.e. contains more than one polygon) the boolean set
@@ -26,7 +29,27 @@ function [bo] = poly_bool(ba, bb, op, varargin);
 %           'notb' -  set difference; points that are in ba and 
 %                     not in bb.
 % varargin :  property - value pairs that modify the properties of
-%             the output boundary element. 
+%             the output boundary element. The following pairs 
+%             control the computation and are not element properties:
+%               'tiles', nt   -  divide the bounding box of the input
+%                                polygons into nt x nt tiles that are
+%                                clipped separately and in parallel
+%                                (default is 1, no tiles). Edges that
+%                                cross tile borders can move by up to
+%                                one database unit.
+%               'threads', n  -  number of threads for tiled operations
+%                                (default is the number of processors).
+%               'holes', hm   -  'keyhole' or 'cutline': holes in the
+%                                result are connected to the polygons
+%                                that contain them by a pair of 
+%                                coincident edges. A keyhole line 
+%                                runs to a vertex and adds 2 vertices
+%                                per hole; a cut line runs horizontally
+%                                to the nearest edge, which keeps 
+%                                Manhattan polygons Manhattan, and adds
+%                                3 vertices. By default, the function
+%                                exits with an error when a hole is 
+%                                created.
 % bo :    output boundary element, the result of the boolean set
 %         operation. Can contain more than one polygon. By default,
 %         the output polygon is on the same layer as ba and has the 
@@ -39,10 +62,15 @@ function [bo] = poly_bool(ba, bb, op, varargin);
 %          two elements 'square' and 'circle'. The output element
 %          is on layer 10.
 %
+%          out = poly_bool(chip, fill, 'notb', 'tiles',8);
+%
+%          subtracts the polygons of 'fill' from those of 'chip'
+%          in 8 x 8 tiles with all processors.
+%
 % NOTES: 
 % 1) Some operations can result in complex polygons containing holes.
-% Since these are difficult to convert into simple polygons the
-% function currently exits with an error when the output polygons are
+% GDS II boundaries cannot have holes. Unless the 'holes' option is 
+% used, the function exits with an error when the output polygons are
 % not all simple.
 %
 % 2) This function can use either the polygon clipper library by 
@@ -66,7 +94,13 @@ if ~strcmp(get_etype(ba.data.internal), 'boundary') || ...
 end
 
 % units must be defined
-if isempty(gdsii_uunit) 
+if isa(ba.data.xy{1}, 'int32') ~= isa(bb.data.xy{1}, 'int32')
+   error('gds_element.poly_bool :  input elements must both have int32 or double coordinates');
+end
+
+if isa(ba.data.xy{1}, 'int32')
+   duf = 1;                % already in database units
+elseif isempty(gdsii_uunit) 
    fprintf('%s', '\n  +-------------------- WARNING -----------------------+\n');
    fprintf('%s', '  | Units are not defined; setting uunit/dbunit = 1.   |\n'); 
    fprintf('%s', '  | Define units by creating the library object or     |\n'); 
@@ -77,8 +111,29 @@ else
    duf = gdsii_uunit;      % conversion factor to db units
 end
 
+% options that are not element properties
+ntiles = 1;
+nthreads = 0;
+hm = [];
+k = 1;
+while k < length(varargin)
+   if ischar(varargin{k}) && any(strcmpi(varargin{k}, {'tiles','threads','holes'}))
+      switch lower(varargin{k})
+         case 'tiles'
+            ntiles = varargin{k+1};
+         case 'threads'
+            nthreads = varargin{k+1};
+         case 'holes'
+            hm = varargin{k+1};
+      end
+      varargin(k:k+1) = [];
+   else
+      k = k + 2;
+   end
+end
+
 % apply boolean set operation
-[xyo, hf] = poly_boolmex(ba.data.xy, bb.data.xy, op, duf);
+[xyo, hf] = poly_boolmex(ba.data.xy, bb.data.xy, op, duf, ntiles, nthreads, hm);
 if any(hf)
    error('gds_element.poly_bool :  a polygon with a hole was created.');
 end
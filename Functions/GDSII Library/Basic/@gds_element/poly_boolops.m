@@ -0,0 +1,116 @@
+function [bo] = poly_boolops(ba, bb, ops, varargin);
+%function [bo] = poly_boolops(ba, bb, ops, varargin);
+%
+% poly_boolops - method for several boolean set operations
+%                on the same two boundary elements.
+%
+%             bo = poly_boolops(ba, bb, ops)
+%
+%             The polygons of both elements are converted to the
+%             database grid and added to a clipper context (see
+%             poly_clipmex.cpp) only once, and all operations are
+%             executed on the same context. This is faster than
+%             several calls to poly_bool with the same elements,
+%             e.g. when both the intersection and the difference
+%             of two large elements are needed. Units must be
+%             defined as for poly_bool.
+%
+% ba :    input boundary element (may be a compound element)
+% bb :    2nd input boundary element (may be a compound element)
+% ops :   cell array with the operations applied to the inputs:
+%         'and', 'or', 'xor', or 'notb' (see poly_bool). A single
+%         operation can be passed as a string.
+% varargin :  property - value pairs that modify the properties of
+%             all output boundary elements. The pair 'holes', hm
+%             controls the computation as in poly_bool; tiled
+%             operations are not supported.
+% bo :    cell array with one output boundary element for each
+%         operation. By default, the output polygons are on the
+%         same layer as ba and have the same data type.
+%
+% Example:
+%          bo = poly_boolops(metal, window, {'and','notb'});
+%
+%          returns the parts of 'metal' inside and outside of
+%          'window' in bo{1} and bo{2}.
+%
+% NOTE:
+% A clipper context is only released when it is destroyed. This
+% function destroys it with an onCleanup object, which also releases
+% the context when an error is raised. Code that calls poly_clipmex
+% directly should do the same.
+
+% Initial version, clipper contexts
+
+% global variables
+global gdsii_uunit;
+
+% check arguments
+if nargin < 3
+   error('gds_element.poly_boolops :  expecting at least 3 input arguments');
+end
+if ischar(ops)
+   ops = {ops};
+end
+
+% only works with boundary elements
+if ~strcmp(get_etype(ba.data.internal), 'boundary') || ...
+   ~strcmp(get_etype(bb.data.internal), 'boundary')
+   error('gds_element.poly_boolops :  input elements must be boundary elements');
+end
+
+% units must be defined
+if isa(ba.data.xy{1}, 'int32') ~= isa(bb.data.xy{1}, 'int32')
+   error('gds_element.poly_boolops :  input elements must both have int32 or double coordinates');
+end
+
+if isa(ba.data.xy{1}, 'int32')
+   duf = 1;                % already in database units
+elseif isempty(gdsii_uunit)
+   fprintf('%s', '\n  +-------------------- WARNING -----------------------+\n');
+   fprintf('%s', '  | Units are not defined; setting uunit/dbunit = 1.   |\n');
+   fprintf('%s', '  | Define units by creating the library object or     |\n');
+   fprintf('%s', '  | by calling gdsii_units.                            |\n');
+   fprintf('%s', '  +----------------------------------------------------+\n\n');
+   duf = 1;
+else
+   duf = gdsii_uunit;      % conversion factor to db units
+end
+
+% options that are not element properties
+hm = [];
+k = 1;
+while k < length(varargin)
+   if ischar(varargin{k}) && strcmpi(varargin{k}, 'holes')
+      hm = varargin{k+1};
+      varargin(k:k+1) = [];
+   else
+      k = k + 2;
+   end
+end
+
+% the context is destroyed when the function returns or fails
+h = poly_clipmex('create', duf);
+guard = onCleanup(@() poly_clipmex('destroy', h));
+poly_clipmex('add', h, ba.data.xy, 'subject');
+poly_clipmex('add', h, bb.data.xy, 'clip');
+
+% apply the boolean set operations
+bo = cell(1, numel(ops));
+for k = 1:numel(ops)
+
+   [xyo, hf] = poly_clipmex('execute', h, ops{k}, hm);
+   if any(hf)
+      error('gds_element.poly_boolops :  a polygon with a hole was created.');
+   end
+
+   % create a boundary element for the output polygons
+   bo{k} = ba;
+   bo{k}.data.xy = xyo;
+   if ~isempty(varargin)
+      bo{k}.data.internal = set_element_data(bo{k}.data.internal, varargin);
+   end
+
+end
+
+return
@@ -0,0 +1,119 @@
+function [bo] = poly_offset(ba, d, varargin);
+%function [bo] = poly_offset(ba, d, varargin);
+%
+% poly_offset - method for growing or shrinking boundary 
+%               elements.
+%
+%             bo = poly_offset(ba, d)
+%          
+%             IMPORTANT: user and database units must be defined
+%             before calls to 'poly_offset' either by creating the 
+%             library object or with a call to 'gdsii_units'.
+%             The offset is computed on the database grid. Elements 
+%             with int32 coordinates in database units need no units;
+%             d is then in database units and the output element 
+%             also has int32 coordinates.
+%
+% ba :    input boundary element. All polygons of a compound element
+%         are offset together; polygons that overlap after the 
+%         offset are merged.
+% d :     offset distance in user units. The polygons grow when 
+%         d > 0 and shrink when d < 0.
+% varargin :  property - value pairs that modify the properties of
+%             the output boundary element. The following pairs 
+%             control the offset and are not element properties:
+%               'join', jt    -  shape of convex corners: 'miter'
+%                                (default), 'square', or 'round'.
+%               'arctol', at  -  maximum deviation of round corners
+%                                from true arcs in database units
+%                                (default is 0.25).
+%               'miterlim', m -  corners of miter joins that would
+%                                extend more than m*d from the 
+%                                polygon are squared off (default 
+%                                is 2).
+%               'holes', hm   -  'keyhole' or 'cutline': connect holes
+%                                to the polygons that contain them 
+%                                (see poly_bool). By default, the 
+%                                function exits with an error when a
+%                                hole is created.
+% bo :    output boundary element with the offset polygons. By 
+%         default, the output element is on the same layer as ba 
+%         and has the same data type.
+%
+% Example:
+%          clad = poly_offset(wg, 2, 'join','round', 'arctol',5, ...
+%                             'layer',2);
+%       
+%          returns a boundary element on layer 2 that extends 2 
+%          user units beyond the waveguide polygons in 'wg', with 
+%          rounded corners that deviate at most 5 database units 
+%          from true arcs.
+
+% Initial version, polygon offsets
+
+% global variables
+global gdsii_uunit;
+
+% check arguments
+if nargin < 2
+   error('gds_element.poly_offset :  expecting at least 2 input arguments');
+end
+
+% only works with boundary elements
+if ~strcmp(get_etype(ba.data.internal), 'boundary')
+   error('gds_element.poly_offset :  input element must be a boundary element');
+end
+
+if isa(ba.data.xy{1}, 'int32')
+   duf = 1;                % already in database units
+elseif isempty(gdsii_uunit) 
+   fprintf('%s', '\n  +-------------------- WARNING -----------------------+\n');
+   fprintf('%s', '  | Units are not defined; setting uunit/dbunit = 1.   |\n'); 
+   fprintf('%s', '  | Define units by creating the library object or     |\n'); 
+   fprintf('%s', '  | by calling gdsii_units.                            |\n'); 
+   fprintf('%s', '  +----------------------------------------------------+\n\n');
+   duf = 1;
+else
+   duf = gdsii_uunit;      % conversion factor to db units
+end
+
+% options that are not element properties
+jt = 'miter';
+at = [];
+ml = [];
+hm = [];
+k = 1;
+while k < length(varargin)
+   if ischar(varargin{k}) && any(strcmpi(varargin{k}, {'join','arctol','miterlim','holes'}))
+      switch lower(varargin{k})
+         case 'join'
+            jt = varargin{k+1};
+         case 'arctol'
+            at = varargin{k+1};
+         case 'miterlim'
+            ml = varargin{k+1};
+         case 'holes'
+            hm = varargin{k+1};
+      end
+      varargin(k:k+1) = [];
+   else
+      k = k + 2;
+   end
+end
+
+% offset the polygons
+[xyo, hf] = poly_offsetmex(ba.data.xy, d, duf, jt, at, ml, hm);
+if any(hf)
+   error('gds_element.poly_offset :  a polygon with a hole was created.');
+end
+
+% create a boundary element for the output polygons
+bo = ba;
+bo.data.xy = xyo;
+
+% add any property arguments
+if ~isempty(varargin)
+   bo.data.internal = set_element_data(bo.data.internal, varargin);
+end
+
+return
@@ -6,10 +6,19 @@ function belm = poly_path(pelm);
 % pelm :  input path element
 % belm :  output boundary element
 %
+% Paths with int32 coordinates in database units are converted
+% to boundaries with int32 coordinates. The path width is in user
+% units and user and database units must then be defined, either
+% by creating the library object or with a call to 'gdsii_units'.
+%
 
 % Initial version, Ulf Griesmann, December 2011
 % Convert paths with multiple path segments; Ulf Griesmann, August2012
 % Convert to new internal data structure; Ulf Griesmann, July 2013
+% Paths with int32 coordinates in database units
+
+% global variables
+global gdsii_uunit;
 
 % check if input is a path
 if ~strcmp(get_etype(pelm.data.internal), 'path')
@@ -44,9 +53,20 @@ if has_property(pelm.data.internal, 'ext')
    ext = get_element_data(pelm.data.internal, 'ext');
 end
 
+% int32 coordinates are converted to user units and back
+dbu = isa(pelm.data.xy{1}, 'int32');
+if dbu && isempty(gdsii_uunit)
+   error('gds_element.poly_path :  units must be defined for int32 coordinates.');
+end
+
 data.xy = cell(1,length(pelm.data.xy));
 for k=1:length(pelm.data.xy)
-   data.xy{k} = path_to_boundary(pelm.data.xy{k}, ptype, width, ext);
+   if dbu
+      bxy = path_to_boundary(double(pelm.data.xy{k}) / gdsii_uunit, ptype, width, ext);
+      data.xy{k} = int32(round(bxy * gdsii_uunit));
+   else
+      data.xy{k} = path_to_boundary(pelm.data.xy{k}, ptype, width, ext);
+   end
 end
 
 % create new element
@@ -0,0 +1,80 @@
+function [bo] = poly_split(bi, mmax, varargin);
+%function [bo] = poly_split(bi, mmax, varargin);
+%
+% poly_split - method for splitting the polygons of a boundary
+%              element that have too many vertices for a GDS II
+%              XY record.
+%
+%             bo = poly_split(bi, mmax)
+%
+%             IMPORTANT: user and database units must be defined
+%             before calls to 'poly_split' either by creating the
+%             library object or with a call to 'gdsii_units'.
+%             Polygons are split on the database grid. Elements
+%             with int32 coordinates in database units need no
+%             units.
+%
+% bi :    input boundary element.
+% mmax :  (Optional) maximum number of vertices of a polygon,
+%         including the closing vertex. Default is 8191, the
+%         largest number of vertices of a GDS II boundary.
+% varargin :  property - value pairs that modify the properties of
+%             the output boundary element.
+% bo :    output boundary element. Polygons with at most mmax
+%         vertices are copied unchanged, larger polygons are
+%         replaced by closed pieces that cover the same area. The
+%         polygons are cut at horizontal and vertical lines; the
+%         pieces share the vertices on the cut lines. Edges that
+%         cross a cut line can move by up to half a database
+%         unit where they are cut.
+%
+% Example:
+%          ring = poly_split(ring, 4000);
+%
+%          splits all polygons of the boundary element 'ring' with
+%          more than 4000 vertices.
+%
+% NOTE:
+% gds_write_element and gds_write_library split polygons with more
+% than 8191 vertices when they are written. poly_split is useful
+% when the pieces are needed before, e.g. for a vertex limit that
+% is smaller than the GDS II limit.
+
+% Initial version, polygon splitting
+
+% global variables
+global gdsii_uunit;
+
+% check arguments
+if nargin < 2 || isempty(mmax)
+   mmax = 8191;
+end
+
+% only works with boundary elements
+if ~strcmp(get_etype(bi.data.internal), 'boundary')
+   error('gds_element.poly_split :  input element must be a boundary element');
+end
+
+if isa(bi.data.xy{1}, 'int32')
+   duf = 1;                % already in database units
+elseif isempty(gdsii_uunit)
+   fprintf('%s', '\n  +-------------------- WARNING -----------------------+\n');
+   fprintf('%s', '  | Units are not defined; setting uunit/dbunit = 1.   |\n');
+   fprintf('%s', '  | Define units by creating the library object or     |\n');
+   fprintf('%s', '  | by calling gdsii_units.                            |\n');
+   fprintf('%s', '  +----------------------------------------------------+\n\n');
+   duf = 1;
+else
+   duf = gdsii_uunit;      % conversion factor to db units
+end
+
+% split the polygons
+bo = bi;
+bo.data.xy = poly_splitmex(bi.data.xy, mmax, duf);
+
+% add any property arguments
+if ~isempty(varargin)
+   bo.data.internal = set_element_data(bo.data.internal, varargin);
+end
+
+return
@@ -51,6 +51,11 @@ data.internal = set_element_data(data.internal, plist);
 [tchars, twidth] = gdsii_ptext(telm.data.text, [0,0], height, 0, 1);
 
 % determine origin depending on justification
+% the text polygons are created in user units
+if isa(telm.data.xy, 'int32')
+   error('gds_element.poly_text :  text elements with int32 coordinates are not supported.');
+end
+
 XY = telm.data.xy;  % text location
 switch get_element_data(telm.data.internal, 'horj')
  case 1
@@ -4,7 +4,8 @@
  * 
  * [cw] = poly_iscw(pa);
  *
- * pa :  cell array of polygons (nx2 matrices)
+ * pa :  cell array of polygons (nx2 matrices), double in user
+ *       units or int32 in database units
  * cw :  1xn logical vector of orientations
  *
  * Ulf Griesmann, NIST, November 2012
@@ -12,6 +13,7 @@
 
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
 #include "mex.h"
 
 
@@ -29,9 +31,11 @@ mexFunction(int nlhs, mxArray *plhs[],
 {
    mxArray *par;               /* pointer to array structure */
    double *pda;                /* polynom data */
+   double *pdc = NULL;         /* int32 polygon converted to double */
+   int32_t *pia;
    mxLogical *pout;            /* pointer to output data */
-   int ma;
-   int k, Na;
+   int ma, mc = 0;
+   int k, j, Na;
 
    /* check argument pa */
    if ( !mxIsCell(prhs[0]) ) {
@@ -55,12 +59,31 @@ mexFunction(int nlhs, mxArray *plhs[],
 
       /* get the next polygon from the cell array */ 
       par = mxGetCell(prhs[0], k); /* ptr to mxArray */
-      pda = mxGetData(par);        /* ptr to a data */     
+      if (par == NULL || mxGetN(par) != 2) {
+         mexErrMsgTxt("poly_iscwmex :  polygons must be nx2 matrices.");
+      }
       ma  = mxGetM(par);           /* rows = vertex number */
+      if ( mxIsDouble(par) ) {
+         pda = mxGetData(par);     /* ptr to a data */
+      }
+      else if ( mxIsInt32(par) ) {
+         if (ma > mc) {
+            mc = ma;
+            pdc = (double *)mxRealloc(pdc, 2*mc*sizeof(double));
+         }
+         pia = (int32_t *)mxGetData(par);
+         for (j=0; j<2*ma; j++)
+            pdc[j] = pia[j];
+         pda = pdc;
+      }
+      else {
+         mexErrMsgTxt("poly_iscwmex :  polygons must be double or int32 matrices.");
+      }
 
       /* calculate orientation */
       pout[k] = (mxLogical)clock_wise(pda, ma);
    }
+   mxFree(pdc);
 }
 
 
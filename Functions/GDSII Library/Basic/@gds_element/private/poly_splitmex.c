@@ -0,0 +1,233 @@
+/*
+ * A mex function to split polygons with too many vertices
+ * for the GDS II toolbox
+ *
+ * [pc] = poly_splitmex(pa, mmax, ud);
+ *
+ * pa :    cell array of polygons (nx2 matrices). Polygons in
+ *         user units are double, polygons in database units
+ *         are int32.
+ * mmax :  maximum number of vertices of a polygon, including
+ *         the closing vertex.
+ * ud :    conversion factor user units --> database units. Not
+ *         used for int32 polygons.
+ * pc :    cell array with the polygons of pa that have at most
+ *         mmax vertices, unchanged, and the closed pieces of the
+ *         polygons that have more vertices, in the class of the
+ *         input polygons.
+ *
+ * The polygons are split on the database grid with the function
+ * used by gds_write_element (see gdsio/polysplit.h). Pieces share
+ * the vertices on the cut lines exactly.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mex.h"
+#include "polysplit.h"
+
+
+/*-- local prototypes -----------------------------------------*/
+
+static int32_t *
+polygon_to_dbu(const mxArray *par, double ud, int *pm);
+
+static mxArray *
+piece_to_mx(const int32_t *xy, int m, int dbu, double ud);
+
+static int
+closed_in_dbu(const mxArray *par, double ud);
+
+
+/*-------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+	    int nrhs, const mxArray *prhs[])
+{
+   mxArray *par;               /* pointer to array structure */
+   mxArray **pout;             /* output polygons */
+   poly_pieces pp;
+   int32_t *xy;
+   double ud = 1.0;
+   size_t Na, Nout, mout, k, off;
+   int mmax, m, j, dbu;
+
+   /* check arguments */
+   if (nrhs < 2) {
+      mexErrMsgTxt("poly_splitmex :  at least 2 input arguments expected.");
+   }
+   if ( !mxIsCell(prhs[0]) ) {
+      mexErrMsgTxt("poly_splitmex :  argument must be a cell array.");
+   }
+   mmax = (int)mxGetScalar(prhs[1]);
+   if (mmax < 5) {
+      mexErrMsgTxt("poly_splitmex :  mmax must be at least 5.");
+   }
+   if (nrhs > 2 && !mxIsEmpty(prhs[2]))
+      ud = mxGetScalar(prhs[2]);
+   Na = mxGetNumberOfElements(prhs[0]);
+
+   /* output polygons, grown as pieces are added */
+   mout = Na + 1;
+   Nout = 0;
+   pout = (mxArray **)mxMalloc(mout*sizeof(mxArray *));
+
+   for (k=0; k<Na; k++) {
+
+      /* get the next polygon from the cell array */
+      par = mxGetCell(prhs[0], k);
+      if (par == NULL || mxGetN(par) != 2 || mxGetM(par) < 3) {
+	 mexErrMsgTxt("poly_splitmex :  polygons must be nx2 matrices with n >= 3.");
+      }
+      dbu = mxIsInt32(par);
+      if (!dbu && !mxIsDouble(par)) {
+	 mexErrMsgTxt("poly_splitmex :  polygons must be double or int32 matrices.");
+      }
+
+      /* polygons that fit are not changed; a closing vertex is
+	 added when the polygon is written */
+      m = (int)mxGetM(par) + !closed_in_dbu(par, ud);
+      if (m <= mmax) {
+	 if (Nout == mout) {
+	    mout *= 2;
+	    pout = (mxArray **)mxRealloc(pout, mout*sizeof(mxArray *));
+	 }
+	 pout[Nout++] = mxDuplicateArray(par);
+	 continue;
+      }
+
+      /* split the polygon */
+      xy = polygon_to_dbu(par, ud, &m);
+      init_pieces(&pp);
+      if ( split_polygon(xy, m, mmax, &pp) ) {
+	 free_pieces(&pp);
+	 mxFree(xy);
+	 mexErrMsgTxt("poly_splitmex :  failed to split polygon.");
+      }
+      mxFree(xy);
+
+      /* copy the pieces */
+      if (Nout + pp.np > mout) {
+	 mout = 2*(Nout + pp.np);
+	 pout = (mxArray **)mxRealloc(pout, mout*sizeof(mxArray *));
+      }
+      for (off=0, j=0; j<pp.np; j++) {
+	 pout[Nout++] = piece_to_mx(pp.xy + off, pp.len[j], dbu, ud);
+	 off += 2*pp.len[j];
+      }
+      free_pieces(&pp);
+   }
+
+   /* return the polygons */
+   plhs[0] = mxCreateCellMatrix(1, Nout);
+   for (k=0; k<Nout; k++)
+      mxSetCell(plhs[0], k, pout[k]);
+   mxFree(pout);
+}
+
+
+/*-------------------------------------------------------------*/
+
+/*
+ * returns the vertices of polygon par in database units as (x,y)
+ * pairs and their number in *pm. A closing vertex is added when
+ * the polygon is not closed.
+ */
+static int32_t *
+polygon_to_dbu(const mxArray *par, double ud, int *pm)
+{
+   int32_t *xy, *pi;
+   double *pd;
+   int k, m;
+
+   m = mxGetM(par);
+   xy = (int32_t *)mxMalloc(2*(m+1)*sizeof(int32_t));
+
+   if ( mxIsInt32(par) ) {
+      pi = (int32_t *)mxGetData(par);
+      for (k=0; k<m; k++) {
+	 xy[2*k] = pi[k];
+	 xy[2*k+1] = pi[m+k];
+      }
+   }
+   else {
+      pd = mxGetPr(par);
+      for (k=0; k<m; k++) {
+	 xy[2*k] = (int32_t)floor(ud*pd[k] + 0.5);
+	 xy[2*k+1] = (int32_t)floor(ud*pd[m+k] + 0.5);
+      }
+   }
+
+   /* close the polygon */
+   if (xy[0] != xy[2*m-2] || xy[1] != xy[2*m-1]) {
+      xy[2*m] = xy[0];
+      xy[2*m+1] = xy[1];
+      m++;
+   }
+
+   *pm = m;
+   return xy;
+}
+
+
+/*-------------------------------------------------------------*/
+
+/*
+ * returns a piece with m vertices as an m x 2 matrix, in database
+ * units (int32) or in user units (double)
+ */
+static mxArray *
+piece_to_mx(const int32_t *xy, int m, int dbu, double ud)
+{
+   mxArray *pa;
+   int32_t *pi;
+   double *pd;
+   int k;
+
+   if (dbu) {
+      pa = mxCreateNumericMatrix(m, 2, mxINT32_CLASS, mxREAL);
+      pi = (int32_t *)mxGetData(pa);
+      for (k=0; k<m; k++) {
+	 pi[k] = xy[2*k];
+	 pi[m+k] = xy[2*k+1];
+      }
+   }
+   else {
+      pa = mxCreateDoubleMatrix(m, 2, mxREAL);
+      pd = mxGetPr(pa);
+      for (k=0; k<m; k++) {
+	 pd[k] = xy[2*k] / ud;
+	 pd[m+k] = xy[2*k+1] / ud;
+      }
+   }
+
+   return pa;
+}
+
+
+/*-------------------------------------------------------------*/
+
+/*
+ * returns 1 when the first and the last vertex of polygon par are
+ * equal in database units
+ */
+static int
+closed_in_dbu(const mxArray *par, double ud)
+{
+   int32_t *pi;
+   double *pd;
+   int m;
+
+   m = mxGetM(par);
+   if ( mxIsInt32(par) ) {
+      pi = (int32_t *)mxGetData(par);
+      return pi[0] == pi[m-1] && pi[m] == pi[2*m-1];
+   }
+   else {
+      pd = mxGetPr(par);
+      return floor(ud*pd[0] + 0.5) == floor(ud*pd[m-1] + 0.5) &&
+	     floor(ud*pd[m] + 0.5) == floor(ud*pd[2*m-1] + 0.5);
+   }
+}
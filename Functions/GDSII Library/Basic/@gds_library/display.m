@@ -11,8 +11,10 @@ fprintf('lname         :  %s\n', glib.lname);
 fprintf('Database unit :  %g m\n', glib.dbunit);
 fprintf('User unit     :  %g m\n', glib.uunit);
 fprintf('Structures    :  %d\n', glib.numst);
+N = stnames(glib);
+ne = stnumel(glib);
 for k = 1:glib.numst
-   fprintf('%6d ... %s (%d)\n', k, sname(glib.st{k}), numel(glib.st{k}));
+   fprintf('%6d ... %s (%d)\n', k, N{k}, ne(k));
 end
 fprintf('\n');
 return
@@ -30,6 +30,7 @@ glib.numst = 0;     % number of structures
 glib.st = {};       % cell array of structures
 glib.uunit = 1e-6;  % default user unit
 glib.dbunit = 1e-9; % default database unit
+glib.lazy = [];     % structure index of lazy libraries (see read_gds_library)
 
 % add the structures to the library
 while length(varargin) > 0
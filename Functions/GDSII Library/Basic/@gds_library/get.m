@@ -9,13 +9,14 @@ function s = get(glib, p);
 switch nargin
   
  case 1
-    s = glib.st;
+    s = getst(glib);
    
  case 2  % get a specific property or structure
     if ischar(p)
        s = glib.(p);
     elseif isnumeric(p)
-       s = glib.st{p};
+       s = getst(glib, p);
+       s = s{1};
     else
       error('gds_library.get :  property must be a string or numeric.');
    end
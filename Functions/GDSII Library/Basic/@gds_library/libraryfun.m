@@ -11,6 +11,15 @@ function [cout] = libraryfun(glib, func);
 
 % initial version, Ulf Griesmann, November 2011
 
-cout = cellfun(func, glib.st, 'UniformOutput',0);
+if isempty(glib.lazy)
+   cout = cellfun(func, glib.st, 'UniformOutput',0);
+else
+   % read the structures of lazy libraries one at a time
+   cout = cell(1, length(glib.st));
+   for k = 1:length(glib.st)
+      S = getst(glib, k);
+      cout{k} = func(S{1});
+   end
+end
 
 return
@@ -10,6 +10,6 @@ function nume = numel(glib);
 % Ulf Griesmann, NIST, September 2013
 
 % sum element numbers for each structure
-nume = sum(cellfun(@(s)numel(s), glib.st));
+nume = sum(stnumel(glib));
 
 return
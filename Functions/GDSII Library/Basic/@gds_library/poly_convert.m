@@ -17,6 +17,6 @@ function [cstruc] = poly_convert(glib);
 
 % create output library
 olib = glib;
-olib.st = cellfun(@poly_convert, glib.st, 'UniformOutput',0);
+olib.st = cellfun(@poly_convert, getst(glib), 'UniformOutput',0);
 
 return
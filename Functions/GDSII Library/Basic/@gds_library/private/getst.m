@@ -0,0 +1,29 @@
+function S = getst(glib, idx);
+%function S = getst(glib, idx);
+%
+% getst :  returns structures of a library as a cell array of
+%          gds_structure objects. Structures of lazy libraries
+%          that were not read yet are read from the library file.
+%
+% glib :  a gds_library object
+% idx :   (Optional) indices of the structures. Default is all.
+% S :     cell array with gds_structure objects
+%
+
+% Initial version, lazy libraries
+
+if nargin < 2
+   S = glib.st;
+else
+   S = glib.st(idx);
+end
+
+% structures of lazy libraries are stored as indices into the file
+if ~isempty(glib.lazy)
+   P = cellfun(@isnumeric, S);
+   if any(P)
+      S(P) = lazy_read(glib.lazy, [S{P}]);
+   end
+end
+
+return
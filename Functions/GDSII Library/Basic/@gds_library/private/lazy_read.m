@@ -0,0 +1,92 @@
+function S = lazy_read(lz, ind);
+%function S = lazy_read(lz, ind);
+%
+% lazy_read :  returns structures of a lazy library. Structures are
+%              read from the library file, or loaded from the layout
+%              cache file when lz.cache is set, on first access and are
+%              kept in a cache that is shared by all copies of the
+%              library. When lz.maxres is finite, the least recently
+%              used structures are removed from the cache.
+%
+% lz :   lazy library data (see read_gds_library)
+% ind :  indices of the structures in the library file
+% S :    cell array with gds_structure objects
+%
+
+% Initial version, lazy libraries
+
+persistent cache tick;
+
+if isempty(cache)
+   cache = struct('fname',{}, 'mtime',{}, 'st',{}, 'used',{});
+   tick = 0;
+end
+
+% find the cache of the library file; structures with coordinates
+% in database units are cached separately
+dbu = isfield(lz, 'dbu') && lz.dbu;
+key = lz.fname;
+if dbu
+   key = [key, ' (dbu)'];
+end
+c = find(strcmp(key, {cache.fname}), 1);
+if isempty(c)
+   c = length(cache) + 1;
+   cache(c).fname = key;
+end
+if ~isequal(cache(c).mtime, lz.mtime)  % new or modified file
+   cache(c).mtime = lz.mtime;
+   cache(c).st = cell(1, length(lz.offset));
+   cache(c).used = zeros(1, length(lz.offset));
+end
+
+% read structures that are not in the cache
+miss = unique(ind(cellfun(@isempty, cache(c).st(ind))));
+if ~isempty(miss)
+   finfo = dir(lz.fname);
+   if isempty(finfo) || finfo.bytes ~= lz.fsize || finfo.datenum ~= lz.mtime
+      error('gds_library :  library file %s was modified or removed.', lz.fname);
+   end
+   if isfield(lz, 'cache') && lz.cache
+      cache(c).st(miss) = cache_read(lz, miss);
+   else
+      gf = gds_open(lz.fname, 'rbm');
+      for k = miss
+         cache(c).st{k} = gds_read_struct(gf, lz.uunit, lz.dbunit, lz.offset(k), dbu);
+      end
+      gds_close(gf);
+   end
+end
+
+tick = tick + 1;
+cache(c).used(ind) = tick;
+S = cache(c).st(ind);
+
+% remove least recently used structures
+if isfinite(lz.maxres)
+   res = find(~cellfun(@isempty, cache(c).st));
+   if length(res) > lz.maxres
+      [us, ui] = sort(cache(c).used(res));
+      cache(c).st(res(ui(1:end-lz.maxres))) = {[]};
+   end
+end
+
+return
+
+
+function S = cache_read(lz, ind)
+%
+% loads structures from a layout cache file with a single call
+%
+slist = gds_cache_read(lz.fname, lz.offset(ind) + 1);
+S = cell(1, length(slist));
+for k = 1:length(slist)
+   elist = cellfun(@(x)gds_element([],x), slist(k).el, 'UniformOutput',0);
+   if isempty(elist)
+      elist = {};
+   end
+   S{k} = gds_structure(slist(k).sname, elist);
+   S{k} = set(S{k}, 'cdate',slist(k).cdate, 'mdate',slist(k).mdate);
+end
+
+return
@@ -0,0 +1,33 @@
+function [A,N] = libadj(glib);
+%function [A,N] = libadj(glib);
+%
+% libadj :  returns the adjacency matrix and the structure names
+%           of a library (see adjmatrix). The references of lazy 
+%           library structures that were not read yet are taken 
+%           from the structure index of the library file.
+%
+% glib :  a gds_library object
+% A :     adjacency matrix
+% N :     cell array with structure names
+%
+
+% Initial version, lazy libraries
+
+if isempty(glib.lazy)
+   [A,N] = adjmatrix(glib.st);
+   return
+end
+
+N = stnames(glib);
+A = sparse(length(N),length(N));
+
+for k = 1:length(N)
+   if isnumeric(glib.st{k})
+      R = glib.lazy.refs{glib.st{k}};
+   else
+      R = find_ref(glib.st{k});
+   end
+   A(k,:) = ismember(N,R);
+end
+
+return
@@ -0,0 +1,27 @@
+function N = stnames(glib);
+%function N = stnames(glib);
+%
+% stnames :  returns the names of all structures in a library
+%            without reading structures of lazy libraries.
+%
+% glib :  a gds_library object
+% N :     cell array with structure names
+%
+
+% Initial version, lazy libraries
+
+if isempty(glib.lazy)
+   N = cellfun(@sname, glib.st, 'UniformOutput',0);
+   return
+end
+
+N = cell(1, length(glib.st));
+for k = 1:length(glib.st)
+   if isnumeric(glib.st{k})
+      N{k} = glib.lazy.names{glib.st{k}};
+   else
+      N{k} = sname(glib.st{k});
+   end
+end
+
+return
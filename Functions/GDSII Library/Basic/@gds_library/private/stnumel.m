@@ -0,0 +1,23 @@
+function ne = stnumel(glib);
+%function ne = stnumel(glib);
+%
+% stnumel :  returns the number of elements in each structure 
+%            of a library without reading structures of lazy 
+%            libraries.
+%
+% glib :  a gds_library object
+% ne :    vector with the number of elements of each structure
+%
+
+% Initial version, lazy libraries
+
+ne = zeros(1, length(glib.st));
+for k = 1:length(glib.st)
+   if isnumeric(glib.st{k})
+      ne(k) = glib.lazy.numel(glib.st{k});
+   else
+      ne(k) = numel(glib.st{k});
+   end
+end
+
+return
@@ -12,22 +12,23 @@ function [olib] = srename(ilib, osname, nsname)
 % initial version, December 2012, Ulf Griesmann
 
 olib = ilib;
+olib.st = getst(ilib);
 
 % find the structure that needs to be replaced
 sidx =  1;
-while sidx <= length(ilib.st)  
-   if strcmp(osname, sname(ilib.st{sidx}))
+while sidx <= length(olib.st)  
+   if strcmp(osname, sname(olib.st{sidx}))
       break
    end
    sidx = sidx + 1;
 end
 
 % rename the structure
-olib.st{sidx} = rename(ilib.st{sidx}, nsname);
+olib.st{sidx} = rename(olib.st{sidx}, nsname);
 
 % rename all references to the renamed structure
 for k = setdiff(1:length(olib.st), sidx)
-   olib.st{k} = refrename(ilib.st{k}, osname, nsname);
+   olib.st{k} = refrename(olib.st{k}, osname, nsname);
 end
 
 return
@@ -26,13 +26,12 @@ switch ins.type
     end
     
  case '.'
-    for k = 1:length(glib.st)
-       if strcmp(ins.subs, glib.st{k}.sname)
-          glib.st{k} = val;   
-          break
-       end
+    k = find(strcmp(ins.subs, stnames(glib)), 1);
+    if ~isempty(k)
+       glib.st{k} = val;
+       return
     end
-    
+
     % structure was not found if we get here ...
     error(sprintf('gds_library.susasgn :  structure >>> %s <<< not found', ins.subs));
     
@@ -17,20 +17,21 @@ switch ins.type
     idx = ins.subs{:};
 
     if ischar(idx) && idx == ':'
-       gstrs = glib.st(1:end);
+       gstrs = getst(glib);
     elseif length(idx) == 1      % return one structure
-       gstrs = glib.st{idx};
+       gstrs = getst(glib, idx);
+       gstrs = gstrs{1};
     else
-       gstrs = glib.st(idx);
+       gstrs = getst(glib, idx);
     end
        
  case '.'                        % look up structure name
     
-    for k = 1:length(glib.st)
-       if strcmp(ins.subs, get(glib.st{k}, 'sname')) 
-          gstrs = glib.st{k};
-          return 
-       end
+    k = find(strcmp(ins.subs, stnames(glib)), 1);
+    if ~isempty(k)
+       gstrs = getst(glib, k);
+       gstrs = gstrs{1};
+       return 
     end 
 
     error(sprintf('gds_library.subsref :  structure >> %s << not found', ins.subs));   
@@ -15,7 +15,7 @@ function [si] = subtree(glib, sname);
 subtree_ind = [];
 
 % compute adjacency matrix of input library
-[A,N] = adjmatrix(glib.st);
+[A,N] = libadj(glib);
 
 % find index of structure 'sname'
 stri = find(ismember(N,{sname}) > 0);
@@ -11,7 +11,7 @@ function [ts] = topstruct(glib);
 % Initial version, Ulf Griesmann, December 2011
 
 % calculate the adjacency matrix of the structure tree
-[A,N] = adjmatrix(glib.st);
+[A,N] = libadj(glib);
 
 % find top level structure name(s)
 naml = N(find(sum(A)==0));
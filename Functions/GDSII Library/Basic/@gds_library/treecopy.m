@@ -15,7 +15,7 @@ function struc = treecopy(glib, sname);
 subtree_ind = [];
 
 % compute adjacency matrix of input library
-[A,N] = adjmatrix(glib.st);
+[A,N] = libadj(glib);
 
 % find index of structure 'sname'
 si = find( ismember(N,{sname}) > 0);
@@ -26,7 +26,7 @@ end
 % find the indices of all children
 find_children(A, si);
 
-struc = glib.st(unique(subtree_ind));
+struc = getst(glib, unique(subtree_ind));
 
    function find_children(A, pai);
       %
@@ -11,7 +11,7 @@ function treeview(glib);
 % initial version, Ulf Griesmann, NIST, December 2011
 
 % calculate the adjacency matrix of the structure tree
-[A,N] = adjmatrix(glib.st);
+[A,N] = libadj(glib);
 
 % find top level structure(s) - they have no parents
 pai = find(sum(A)==0);  % top parent index (or indices)
@@ -0,0 +1,38 @@
+function write_gds_cache(glib, cname);
+%function write_gds_cache(glib, cname);
+% 
+% write_gds_cache :
+%     writes a GDS library object to a layout cache file. A
+%     cache file stores the structures of the library in the
+%     tables used by the library reader, from which individual 
+%     structures can be loaded quickly with read_gds_cache. Cache
+%     files depend on the platform and are meant as a fast
+%     replacement for library objects saved in MAT files; use
+%     write_gds_library to exchange layouts.
+%
+% glib  :     a gds_library object
+% cname :     name of the cache file, e.g. 'chip_gds.gdc'
+%
+
+% Initial version, layout cache
+
+% check argument number
+if nargin < 2 
+   error('missing file name argument.');
+end
+
+% check if all structure names are unique
+N = stnames(glib); % structure names
+if length(N) ~= length(unique(N))
+   error('write_gds_cache :  structure names are not unique.');
+end
+
+% element data of all structures
+S = cellfun(@(x)struct('sname',sname(x), ...
+                       'cdate',get(x,'cdate'), 'mdate',get(x,'mdate'), ...
+                       'el',{cellfun(@get,get(x),'UniformOutput',0)}), ...
+            getst(glib), 'UniformOutput',0);
+
+gds_cache_write(cname, S, glib.uunit, glib.dbunit, glib.lname);
+
+return
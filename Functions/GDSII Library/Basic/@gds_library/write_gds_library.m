@@ -7,6 +7,24 @@ function write_gds_library(glib, fname, varargin);
 % glib  :     a gds_library object
 % fname :     GDS file name. When the file name has the extension .cgds 
 %             a compound GDS file is created instead of a standard GDS file.
+%             When the file name ends with .gz or .zst, e.g. 'chip.gds.zst',
+%             the file is compressed with gzip or Zstandard while it is
+%             written. When the file name has the extension .oas, the
+%             library is written in the OASIS format. Shapes of equal size
+%             and structure references are combined into OASIS repetitions.
+%             NODE elements and the reference libraries and fonts of the
+%             library are not stored in OASIS files. A warning is
+%             displayed when any of the following was not stored:
+%               - NODE elements
+%               - ELFLAGS and PLEX records of elements
+%               - presentation, path type, width, and strans of texts
+%               - the absolute width flag of paths (negative width)
+%               - round path ends, which become square ends extended
+%                 by half the width
+%               - odd path widths, which are widened by one unit
+%               - absolute magnification and angle flags of references
+%               - corners of array references whose pitch is not a whole
+%                 number of database units, which move to the nearest grid
 % varargin :  optional argument/value pairs 
 %
 %             verbose : when == 1, print out information about the
@@ -19,6 +37,12 @@ function write_gds_library(glib, fname, varargin);
 %                 element. They are not compatible with other software for
 %                 processing GDS II layout files.  Default is 0.
 %
+%             threads : number of threads used to create the records of
+%                 the GDS file. The records are always written in the
+%                 order of the structures in the library. Compressed
+%                 files are written by one thread. Default is 0, which
+%                 uses all processors.
+%
 
 % Ulf Griesmann, NIST, November 2011
 
@@ -31,6 +55,7 @@ end
 % defaults
 verbose = 1;
 compound = 0;
+threads = 0;
 
 % process varargin
 if ~isempty(varargin)
@@ -42,19 +67,23 @@ if ~isempty(varargin)
             verbose = valu;
          case 'compound'
             compound = valu;
+         case 'threads'
+            threads = valu;
          otherwise
             error(sprintf('unknown property --> %s\n', prop));
       end
    end
 end
 
-% extension selects compound flag
-if strcmp(fname(end-4:end),'.cgds')
+% extension selects compound flag (ignoring a compression extension)
+bname = regexprep(fname, '\.(gz|zst)$', '');
+if length(bname) > 4 && strcmp(bname(end-4:end),'.cgds')
    compound = 1;
 end
+oasis = length(bname) > 3 && strcmp(bname(end-3:end),'.oas');
 
 % check if all structure names are unique
-N = cellfun(@(x)sname(x), glib.st, 'UniformOutput',0); % structure names
+N = stnames(glib); % structure names
 if length(N) ~= length(unique(N))
    error('write_gds_library :  structure names are not unique.');
 end
@@ -87,11 +116,33 @@ t_start = now();
 gf = gds_initialize(fname, glib.uunit, glib.dbunit, ...
                     glib.lname, glib.reflibs, glib.fonts);
 
-% write all structures in library to file
-cellfun(@(x)write_structure(x,gf,glib.uunit,glib.dbunit,compound), glib.st);
+% write all structures in library to file with one call
+if isempty(glib.lazy)
+   S = cellfun(@(x)struct_data(x, oasis), glib.st, 'UniformOutput',0);
+   if oasis
+      oasis_write_library(gf, S, glib.uunit/glib.dbunit);
+   else
+      gds_write_library(gf, S, glib.uunit/glib.dbunit, compound, threads);
+   end
+else
+   % write lazy libraries one structure at a time
+   for k = 1:length(glib.st)
+      x = getst(glib, k);
+      S = {struct_data(x{1}, oasis)};
+      if oasis
+         oasis_write_library(gf, S, glib.uunit/glib.dbunit);
+      else
+         gds_write_library(gf, S, glib.uunit/glib.dbunit, compound, threads);
+      end
+   end
+end
 
 % close file
-gds_endlib(gf);
+if oasis
+   oasis_endlib(gf);
+else
+   gds_endlib(gf);
+end
 gds_close(gf);
 
 % end time
@@ -101,3 +152,21 @@ if verbose == 1
 end
 
 return
+
+
+function S = struct_data(gs, oasis)
+%
+% returns the data of a structure for the library writers. The
+% element store of a structure is passed to the GDS writer without
+% creating gds_element objects.
+%
+store = get(gs, 'store');
+if isempty(store) || oasis
+   S = struct('sname',sname(gs), ...
+              'el',{cellfun(@get,get(gs),'UniformOutput',0)}, ...
+              'store',[]);
+else
+   S = struct('sname',sname(gs), 'el',{{}}, 'store',store);
+end
+
+return
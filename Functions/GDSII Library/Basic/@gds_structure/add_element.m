@@ -12,7 +12,7 @@ function [ostruc] = add_element(istruc, gelm);
 % Initial version, Ulf Griesmann, December 2011
 
 % copy input to output
-ostruc = istruc;
+ostruc = unstore(istruc);
 
 % and add the new element
 if isa(gelm, 'gds_element');
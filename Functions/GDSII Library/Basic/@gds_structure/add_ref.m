@@ -18,7 +18,7 @@ function [ostruc] = add_ref(istruc, struc, varargin);
 % Initial version, Ulf Griesmann, December 2011
 
 % copy input to output
-ostruc = istruc;
+ostruc = unstore(istruc);
 
 % get the structure name
 if ischar(struc)
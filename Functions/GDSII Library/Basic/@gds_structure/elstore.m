@@ -0,0 +1,56 @@
+function store = elstore(gstruc, uu_to_dbu);
+%function store = elstore(gstruc, uu_to_dbu);
+%
+% elstore :  returns the elements of a structure as an element 
+%            store. An element store keeps all elements in a few 
+%            arrays: element kinds, layers, data types, and the
+%            vertices of all elements in database units (see 
+%            gdsstore.h for the fields). Operations on all elements
+%            of a structure, e.g. selecting the elements on a layer,
+%            can use the arrays directly. Stores read with 
+%            read_gds_library(..., 'store',2) also keep the records of
+%            the elements, which are copied when the structure is 
+%            written. Records that disagree with the kind, layer,
+%            dtype, vtx, or prop arrays are not copied; set 
+%            st.dirty(k) = 1 when other data of element k, e.g. 
+%            eldata, text, or pval, are modified.
+%
+% gstruc :     a gds_structure object
+% uu_to_dbu :  (Optional) conversion factor user units --> database
+%              units. Only needed for structures that are not already
+%              stored in an element store. Default is the factor of the
+%              current library (global variable gdsii_uunit, see
+%              gdsii_units); when no units are defined, a warning is
+%              displayed and a factor of 1 is used.
+% store :      element store with the elements of the structure
+%
+% Example:
+%            glib = read_gds_library('chip.gds', 'store',1);
+%            st = elstore(glib{1});
+%            nl = sum(st.layer == 10);  % number of elements on layer 10
+%
+
+% Initial version, element stores
+
+% global variables
+global gdsii_uunit;
+
+if ~isempty(gstruc.store)
+   store = gstruc.store;
+else
+   if nargin < 2 || isempty(uu_to_dbu)
+      if isempty(gdsii_uunit)
+         fprintf('%s', '\n  +-------------------- WARNING -----------------------+\n');
+         fprintf('%s', '  | Units are not defined; setting uunit/dbunit = 1.   |\n');
+         fprintf('%s', '  | Define units by creating the library object or     |\n');
+         fprintf('%s', '  | by calling gdsii_units.                            |\n');
+         fprintf('%s', '  +----------------------------------------------------+\n\n');
+         uu_to_dbu = 1;
+      else
+         uu_to_dbu = gdsii_uunit;
+      end
+   end
+   store = gds_store_pack(cellfun(@get, gstruc.el, 'UniformOutput',0), uu_to_dbu);
+end
+
+return
@@ -31,6 +31,7 @@ if nargin < 2
 end
 
 % return all elements with desired property
+gstruct = unstore(gstruct);
 gelms = gstruct.el( cellfun(ffunc, gstruct.el) ~= 0 );
   
 return  
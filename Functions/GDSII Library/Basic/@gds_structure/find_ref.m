@@ -10,6 +10,7 @@ function rnam = find_ref(gstruct);
 
 % Ulf Griesmann, NIST, November 2011
 
+gstruct = unstore(gstruct);
 rnam = {};
 for k=1:length(gstruct.el)
    if is_ref(gstruct.el{k}) && ~ismember(gstruct.el{k}.sname, rnam)
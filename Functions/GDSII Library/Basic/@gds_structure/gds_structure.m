@@ -8,6 +8,8 @@ function gstruc = gds_structure(sname, varargin);
 % gstruc :    the structure object returned by the constructor
 % varargin :  (Optional) EITHER one or more elements that become
 %             part of the structure OR a cell array with elements
+%             OR an element store (see elstore) with the elements
+%             of the structure
 %
 
 % Ulf Griesmann, NIST, June 2011
@@ -20,6 +22,7 @@ if ~ischar(sname), error('gds_structure :  first argument is not a string'); end
 gstruc.sname = sname; % structure name
 gstruc.numel = 0;     % number of elements
 gstruc.el = {};       % cell array of elements
+gstruc.store = [];    % element store, replaces el when not empty
 
 % structure dates
 gstruc.cdate = datevec(now);              % creation date
@@ -40,6 +43,17 @@ while length(varargin) > 0
       gstruc.el = [gstruc.el, el];
       gstruc.numel = gstruc.numel + length(el);
       
+   elseif isstruct(el) && isfield(el, 'kind')  % element store
+      if gstruc.numel == 0 && length(varargin) == 1
+         gstruc.store = el;
+         gstruc.numel = length(el.kind);
+      else
+         el = cellfun(@(x)gds_element([],x), gds_store_unpack(el), ...
+                      'UniformOutput',0);
+         gstruc.el = [gstruc.el, el];
+         gstruc.numel = gstruc.numel + length(el);
+      end
+      
    else
       error('gds_structure :  argument(s) must be GDS element(s) or structure(s).');
    end
@@ -8,19 +8,30 @@ function s = get(gstruc, p);
 %                      structure
 % get(gstruc, k)       returns the k-th element in the structure
 % get(gstruc)          returns a cell array with all elements
+% get(gstruc, 'store') returns the element store of the structure,
+%                      or [] when the elements are gds_element objects
 %
 switch nargin
     
   case 1
+     gstruc = unstore(gstruc);
      s = gstruc.el;
    
   case 2  % get a specific property
    
      if ischar(p)
+        if strcmp(p, 'el')
+           gstruc = unstore(gstruc);
+        end
         s = gstruc.(p);
      
      elseif isnumeric(p)
-        s = gstruc.el{p};
+        if ~isempty(gstruc.store)
+           el = gds_store_unpack(gstruc.store, p);
+           s = gds_element([], el{1});
+        else
+           s = gstruc.el{p};
+        end
 
      else
         error('gds_structure.get :  argument must be string or index.');
@@ -21,6 +21,7 @@ function [cstruc] = poly_convert(gstruc);
 % Initial version, Ulf Griesmann, December 2011
 
 % copy structure
+gstruc = unstore(gstruc);
 cstruc = gstruc;
 m = 1;
 
@@ -0,0 +1,37 @@
+function [ostruc] = poly_split(istruc, mmax);
+%function [ostruc] = poly_split(istruc, mmax);
+%
+% splits the polygons of all boundary elements in
+% a structure that have more than mmax vertices.
+%
+% istruc :   input gds_structure object
+% mmax :     (Optional) maximum number of vertices of a
+%            polygon, including the closing vertex.
+%            Default is 8191.
+% ostruc :   output gds_structure object
+%
+% Example:
+%        gstruc = poly_split(gstruc, 4000);
+%
+% splits all polygons in gstruc with more than 4000
+% vertices (see gds_element/poly_split).
+%
+% NOTE:
+% The output structure has the same name as the input
+% structure !
+
+% Initial version, polygon splitting
+
+if nargin < 2, mmax = []; end
+
+% copy structure
+ostruc = unstore(istruc);
+
+% split the boundary elements
+for k = 1:length(ostruc.el)
+   if is_etype(ostruc.el{k}, 'boundary')
+      ostruc.el{k} = poly_split(ostruc.el{k}, mmax);
+   end
+end
+
+return
@@ -0,0 +1,23 @@
+function gstruc = unstore(gstruc);
+%function gstruc = unstore(gstruc);
+%
+% unstore :  replaces the element store of a structure with
+%            gds_element objects. Structures without an element
+%            store are returned unchanged.
+%
+% gstruc :  a gds_structure object
+%
+
+% Initial version, element stores
+
+if ~isempty(gstruc.store)
+   el = cellfun(@(x)gds_element([],x), gds_store_unpack(gstruc.store), ...
+                'UniformOutput',0);
+   if isempty(el)
+      el = {};
+   end
+   gstruc.el = el;
+   gstruc.store = [];
+end
+
+return
@@ -11,7 +11,7 @@ function [ostruc] = refrename(istruc, osname, nsname)
 
 % initial version, December 2012, Ulf Griesmann
 
-ostruc = istruc;
+ostruc = unstore(istruc);
 
 % look for reference elements
 for k = 1:length(ostruc.el)
@@ -11,6 +11,7 @@ function [cout] = structfun(gstruc, func);
 
 % initial version, Ulf Griesmann, November 2011
 
+gstruc = unstore(gstruc);
 cout = cellfun(func, gstruc.el, 'UniformOutput',0);
 
 return
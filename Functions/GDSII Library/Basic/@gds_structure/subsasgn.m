@@ -15,6 +15,7 @@ switch ins.type
   
  case '()'
     idx = ins.subs{:};
+    gstruc = unstore(gstruc);
     gstruc.el{idx} = val;
     gstruc.numel = gstruc.numel + 1;
 
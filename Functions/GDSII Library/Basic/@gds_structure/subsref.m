@@ -17,6 +17,14 @@ switch ins.type
  case '()'
     
     idx = ins.subs{:};
+    if ~isempty(gstruct.store)
+       if length(idx) == 1 && ~ischar(idx)
+          el = gds_store_unpack(gstruct.store, idx);
+          gelp = gds_element([], el{1});  % unpack one element
+          return
+       end
+       gstruct = unstore(gstruct);
+    end
     if ischar(idx) && idx == ':'
        gelp = gstruct.el(1:end);
     elseif length(idx) == 1 
@@ -15,13 +15,17 @@ function write_structure(gstruc, gf, uunit, dbunit, compound);
 % Ulf Griesmann, NIST, November 2011
 % modified for new low-level I/O, Ulf Griesmann, January 2013
 
-% write a structure header
-gds_beginstruct(gf, gstruc.sname, gstruc.cdate);
+% compound elements are off by default
+if nargin < 5, compound = 0; end
 
-% write all elements in the structure
-cellfun(@(x)write_element(x,gf,uunit,dbunit,compound), gstruc.el);
-
-% write an end structure record
-gds_endstruct(gf);
+% write the structure and all its elements with one call
+S.sname = gstruc.sname;
+if isempty(gstruc.store)
+   S.el = cellfun(@get, gstruc.el, 'UniformOutput',0);
+else
+   S.el = {};
+end
+S.store = gstruc.store;    % used instead of el when not empty
+gds_write_library(gf, {S}, uunit/dbunit, compound);
 
 return
@@ -18,6 +18,7 @@
 % poly_text     - method to convert text to boundary element
 % poly_path     - method to convert path to boundary element
 % poly_bool     - method for Boolean set algebra with boundary elements
+% poly_boolops  - method for several Boolean operations on the same elements
 %
 % NOTE: 
 % Element properties can be read and set using field name indexing
@@ -62,6 +63,8 @@
 %                    in a library.
 % libraryfun       - iterator method for the gds_library class
 % write_gds_library- method to write a gds_library object to a file
+% write_gds_cache  - method to write a gds_library object to a
+%                    layout cache file (see read_gds_cache)
 %
 % NOTE:
 % - Structures in a library can be addressed using array indexing.
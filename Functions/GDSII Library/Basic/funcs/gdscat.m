@@ -62,7 +62,7 @@ write_structure(T, of, uunit, dbunit);
 for k = 1:length(inpfil)
 
     % open input file
-    fi = gds_open(inpfil(k).name, 'rb');
+    fi = gds_open(inpfil(k).name, 'rbm');
     
     % read library header
     ldata = gds_libdata(fi);
@@ -4,6 +4,8 @@ function gdspeek(gdsfil, bel)
 % gdspeek :  peek at the contents of a GDS II library file without 
 %            loading the file into memory. Displays structure
 %            names and, if desired, element content of the file.
+%            The file is scanned with gds_layer_stats; no element
+%            objects are created.
 %
 % gdsfil :  name of a GDS II library file
 % bel :     (Optional) if ~= 0, statistical information regarding
@@ -20,7 +22,7 @@ if isempty(bel), bel = 0; end
 
 
 % open input file
-gf = gds_open(gdsfil, 'rb'); % the 'b' is for Windows
+gf = gds_open(gdsfil, 'rbm'); % 'b' for Windows, 'm' maps the file
     
 % read library header
 ldata = gds_libdata(gf);
@@ -29,87 +31,59 @@ fprintf('Creation date : %d-%d-%d, %02d:%02d:%02d\n', ldata.cdate);
 fprintf('User unit     : %g m\n', ldata.uunit);
 fprintf('Database unit : %g m\n\n', ldata.dbunit);
 
-% read all structures and copy to output file
-nst = 0;
-while 1
-
-    [rlen, rtype] = gds_record_info(gf);
-
-    switch rtype
-
-    case 1024 % ENDLIB
-       break
-
-    case 1282 % BGNSTR - beginning of structure
-       S = gds_read_struct(gf, ldata.uunit, ldata.dbunit);
-       nst = nst + 1;
-       fprintf('%d ... %s (%d) ', nst, sname(S), numel(S));
-       if bel
-           inspect_elements(S);
-       else
-           fprintf('\n');
-       end
+% element statistics of all structures
+try
+   st = gds_layer_stats(gf, ldata.dbunit/ldata.uunit);
+catch err
+   gds_close(gf); % something is wrong - get out
+   rethrow(err);
+end
 
-    otherwise
-       gds_close(gf); % something is wrong - get out
-       error('invalid GDS file - ENDLIB or BGNSTR expected.');
- 
-    end % switch
+% close input file
+gds_close(gf);
 
-end % while
+for k = 1:length(st)
+   fprintf('%d ... %s (%d) ', k, st(k).sname, st(k).numel);
+   if bel
+      inspect_elements(st(k));
+   else
+      fprintf('\n');
+   end
+end
 
 fprintf('\n');
 
-% close input file
-gds_close(gf);
-
 return
 
 
-function inspect_elements(gstruc)
+function inspect_elements(ss)
 %
-% inspects all the elements in gds_structure S and prints 
-% a statistical summary
+% prints a statistical summary of the elements in a structure
+% from the statistics returned by gds_layer_stats
 
-% initialize variables for accounting
-numl = 256; % max number of layers
-for k=1:numl
-   S(k) = struct('boundary',0, 'path',0, 'box',0, 'node',0, 'text',0);
-end
-L = zeros(1,numl);
-
-% iterate over all elements in structure S
-nref = 0;
-for m = 1:numel(gstruc)
-    if is_ref(gstruc(m))    % sref and aref have no layer information
-        nref = nref + 1;
-    else
-        E = gstruc(m);
-        numl = E.layer + 1;  % gds layer numbers start with 0
-        L(numl) = L(numl) + 1; 
-        S(numl).(etype(E)) = S(numl).(etype(E)) + 1;
-    end
-end
+% element counts per layer, summed over data types
+L = unique(ss.layer)';
 
 %display
-for k = find(L>0)
-    fprintf('|L%d> ', k-1); % layers start with 0
-    if S(k).boundary
-        fprintf('Bnd:%d ', S(k).boundary);
+for k = L
+    C = sum(ss.count(ss.layer == k,:), 1);
+    fprintf('|L%d> ', k);
+    if C(1)
+        fprintf('Bnd:%d ', C(1));
     end
-    if S(k).path
-        fprintf('Pth:%d ', S(k).path);
+    if C(2)
+        fprintf('Pth:%d ', C(2));
     end
-    if S(k).box
-        fprintf('Box:%d ', S(k).box);
+    if C(3)
+        fprintf('Box:%d ', C(3));
     end
-    if S(k).node
-        fprintf('Nde:%d ', S(k).node);
+    if C(4)
+        fprintf('Nde:%d ', C(4));
     end
-    if S(k).text
-        fprintf('Txt:%d ', S(k).text);
+    if C(5)
+        fprintf('Txt:%d ', C(5));
     end 
 end
-fprintf('|%d Ref\n', nref);
+fprintf('|%d Ref\n', ss.sref + ss.aref);
 
 return
@@ -3,30 +3,81 @@ function [S] = layerinfo(glib);
 %
 % layerinfo :  displays information about the
 %              distribution of elements on layers
-%              in a gds_library object.
+%              in a gds_library object or a GDS II file.
 %
-% glib :  a gds_library object
+% glib :  a gds_library object or the name of a GDS II file. 
+%         The elements of GDS II files, and of lazy libraries
+%         read from GDS II files, are counted with a scan of the
+%         file records (see gds_layer_stats) without creating
+%         element objects.
 % S :     (Optional) structure array with number of element 
 %         per layer.
 %         S(k).(etype) contains the number of elements of 
-%         type 'etype' on layer k. E.g.: S(10).boundary
+%         type 'etype' on layer k-1. E.g.: S(11).boundary
+%         S has one entry for each layer up to the highest
+%         layer with elements.
 %         When the output argument is omitted, the layer
 %         information is printed on the screen.
 %
 
 % initial version, Ulf Griesmann, NIST, November 16, 2012
 
+etypes = {'boundary', 'path', 'box', 'node', 'text'};
+
 % check argument
-if ~isa(glib, 'gds_library')
-   error('layerinfo :  argument must be a gds_library object.');
+if ischar(glib)
+   C = file_counts(glib);
+elseif isa(glib, 'gds_library')
+   lz = get(glib, 'lazy');
+   if ~isempty(lz) && ~(isfield(lz, 'cache') && lz.cache) && ...
+      all(cellfun(@isnumeric, get(glib, 'st'))) && file_current(lz)
+      C = file_counts(lz.fname);
+   else
+      C = library_counts(glib, etypes);
+   end
+else
+   error('layerinfo :  argument must be a gds_library object or a file name.');
 end
 
-% initialize variables for accounting
-numl = 256; % max number of layers
-for k=1:numl
-   S(k) = struct('boundary',0, 'path',0, 'box',0, 'node',0, 'text',0);
+% C(k,t) is the number of elements of type t on layer k-1
+L = sum(C, 2)';
+if nargout
+   S = cell2struct(num2cell(C), etypes, 2)';
 end
-L = zeros(1,numl);
+
+%display
+if ~nargout
+   fprintf('\n');
+   for k = find(L>0)
+      fprintf('L %-3d ->  ', k-1); % layers start with 0
+      if C(k,1)
+         fprintf('%8d Bnd ', C(k,1));
+      end
+      if C(k,2)
+         fprintf('%8d Pth ', C(k,2));
+      end
+      if C(k,3)
+         fprintf('%8d Box ', C(k,3));
+      end
+      if C(k,4)
+         fprintf('%8d Nde ', C(k,4));
+      end
+      if C(k,5)
+         fprintf('%8d Txt ', C(k,5));
+      end 
+      fprintf('\n');
+   end
+   fprintf('\n');
+end
+
+return
+
+
+function C = library_counts(glib, etypes)
+%
+% counts the elements of the structures in a library
+%
+C = zeros(0,5);
 
 % iterate over all structures
 for k=1:numst(glib)
@@ -39,35 +90,46 @@ for k=1:numst(glib)
       E = st(m);
       if ~is_ref(E)           % sref and aref have no layer information
          numl = E.layer + 1;  % gds layer numbers start with 0
-         L(numl) = L(numl) + 1; 
-         S(numl).(etype(E)) = S(numl).(etype(E)) + 1;
+         t = find(strcmp(etype(E), etypes));
+         if numl > size(C,1)
+            C(numl,5) = 0;
+         end
+         C(numl,t) = C(numl,t) + 1;
       end
    end
 end
 
-%display
-if ~nargout
-   fprintf('\n');
-   for k = find(L>0)
-      fprintf('L %-3d ->  ', k-1); % layers start with 0
-      if S(k).boundary
-         fprintf('%8d Bnd ', S(k).boundary);
-      end
-      if S(k).path
-         fprintf('%8d Pth ', S(k).path);
-      end
-      if S(k).box
-         fprintf('%8d Box ', S(k).box);
-      end
-      if S(k).node
-         fprintf('%8d Nde ', S(k).node);
-      end
-      if S(k).text
-         fprintf('%8d Txt ', S(k).text);
-      end 
-      fprintf('\n');
-   end
-   fprintf('\n');
+return
+
+
+function C = file_counts(fname)
+%
+% counts the elements in a GDS II file with a scan of the records
+%
+gf = gds_open(fname, 'rbm');
+ldata = gds_libdata(gf);
+st = gds_layer_stats(gf, ldata.dbunit/ldata.uunit);
+gds_close(gf);
+
+layer = vertcat(st.layer);
+count = vertcat(st.count);
+if isempty(layer)
+   C = zeros(0,5);
+   return
+end
+C = zeros(max(layer) + 1, 5);
+for t = 1:5
+   C(:,t) = accumarray(layer + 1, count(:,t), [size(C,1), 1]);
 end
 
 return
+
+
+function cur = file_current(lz)
+%
+% true when the file of a lazy library was not modified
+%
+finfo = dir(lz.fname);
+cur = ~isempty(finfo) && finfo.bytes == lz.fsize && finfo.datenum == lz.mtime;
+
+return
@@ -5,12 +5,16 @@
  * byte reordering functions in C.
  *
  * Ulf Griesmann, August 2013
+ *
+ * The array functions use SSSE3 or AVX2 byte shuffles when the
+ * compiler targets a processor that has them (e.g. with -march=native).
  */
 
 #ifndef _BYTESWAP
 #define _BYTESWAP
 
 #include <stdint.h>
+#include <math.h>
 
 /* GNU C has inline */
 #if defined __GNUC__
@@ -19,6 +23,17 @@
    #define INLINE
 #endif
 
+/* vector extensions */
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+   #if defined __SSSE3__
+      #include <immintrin.h>
+      #define BSWAP_SSSE3
+   #endif
+   #if defined __AVX2__
+      #define BSWAP_AVX2
+   #endif
+#endif
+
 
 /*-----------------------------------------------------------------*/
 
@@ -38,8 +53,21 @@ byte_reverse(uint16_t *s) {
 static INLINE void 
 byte_reverse_n(uint16_t *s, int n) {
 #if __BYTE_ORDER == __LITTLE_ENDIAN
-   register int k;
-   for (k=0; k<n; k++) {
+   register int k = 0;
+#if defined BSWAP_AVX2
+   const __m256i sh256 = _mm256_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14,
+					   1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+   for (; k+16<=n; k+=16)
+      _mm256_storeu_si256((__m256i *)(s+k), 
+	 _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i *)(s+k)), sh256));
+#endif
+#if defined BSWAP_SSSE3
+   const __m128i sh128 = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+   for (; k+8<=n; k+=8)
+      _mm_storeu_si128((__m128i *)(s+k), 
+	 _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)(s+k)), sh128));
+#endif
+   for (; k<n; k++) {
       s[k] =  ( ( s[k] & 0x00ffU ) <<  8 ) | 
               ( ( s[k] & 0xff00U ) >>  8 );
    }
@@ -73,10 +101,23 @@ byte_reverse32(int32_t *i) {
 static INLINE void 
 byte_reverse32_n(int32_t *i, int n) {
 #if __BYTE_ORDER == __LITTLE_ENDIAN
-   register int k;
+   register int k = 0;
    register int32_t x;
 
-   for (k=0; k<n; k++) {
+#if defined BSWAP_AVX2
+   const __m256i sh256 = _mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,
+					   3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+   for (; k+8<=n; k+=8)
+      _mm256_storeu_si256((__m256i *)(i+k), 
+	 _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i *)(i+k)), sh256));
+#endif
+#if defined BSWAP_SSSE3
+   const __m128i sh128 = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+   for (; k+4<=n; k+=4)
+      _mm_storeu_si128((__m128i *)(i+k), 
+	 _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)(i+k)), sh128));
+#endif
+   for (; k<n; k++) {
       x = i[k];
       x = ( ( x & 0x000000ffU ) << 24 ) | 
 	  ( ( x & 0x0000ff00U ) <<  8 ) | 
@@ -128,4 +169,149 @@ host_to_be64(uint64_t u) {
 
 /*-----------------------------------------------------------------*/
 
+static INLINE int32_t
+load_be32(const uint8_t *p) {
+   return (int32_t)( ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | 
+		     ((uint32_t)p[2] <<  8) |  (uint32_t)p[3] );
+}
+
+static INLINE void
+store_be32(uint8_t *p, int32_t i) {
+   p[0] = (uint32_t)i >> 24;
+   p[1] = (uint32_t)i >> 16;
+   p[2] = (uint32_t)i >>  8;
+   p[3] = (uint32_t)i;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * Converts m coordinate pairs (x,y) stored as big endian 32-bit
+ * integers, as they are in XY records, to scaled doubles. The 
+ * x and y coordinates are stored in separate arrays, e.g. in 
+ * the two columns of a m x 2 matrix.
+ */
+static INLINE void
+be32_xy_to_double(const uint8_t *src, double *x, double *y, int m, double sf) {
+   int k = 0;
+
+#if defined BSWAP_AVX2
+   const __m256i sh256 = _mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,
+					   3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+   const __m256i perm = _mm256_setr_epi32(0,2,4,6,1,3,5,7);
+   const __m256d vsf = _mm256_set1_pd(sf);
+   __m256i v;
+
+   for (; k+4<=m; k+=4) {
+      v = _mm256_loadu_si256((const __m256i *)(src + 8*k));
+      v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, sh256), perm);
+      _mm256_storeu_pd(x+k, 
+	 _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), vsf));
+      _mm256_storeu_pd(y+k, 
+	 _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), vsf));
+   }
+#endif
+#if defined BSWAP_SSSE3
+   /* swap bytes and separate x0,x1 from y0,y1 with one shuffle */
+   const __m128i shxy = _mm_setr_epi8(3,2,1,0,11,10,9,8,7,6,5,4,15,14,13,12);
+   const __m128d vsf2 = _mm_set1_pd(sf);
+   __m128i w;
+
+   for (; k+2<=m; k+=2) {
+      w = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 8*k)), shxy);
+      _mm_storeu_pd(x+k, _mm_mul_pd(_mm_cvtepi32_pd(w), vsf2));
+      _mm_storeu_pd(y+k, _mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(w, w)), vsf2));
+   }
+#endif
+   for (; k<m; k++) {
+      x[k] = (double)load_be32(src + 8*k)     * sf;
+      y[k] = (double)load_be32(src + 8*k + 4) * sf;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * The inverse of be32_xy_to_double: scales m coordinates in 
+ * separate x and y arrays, rounds them to the nearest integer, 
+ * and stores them as big endian (x,y) pairs of 32-bit integers.
+ */
+static INLINE void
+double_xy_to_be32(const double *x, const double *y, uint8_t *dst, int m, double sf) {
+   int k = 0;
+
+#if defined BSWAP_AVX2
+   const __m128i sh128a = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+   const __m256d vsf = _mm256_set1_pd(sf);
+   const __m256d half = _mm256_set1_pd(0.5);
+   __m128i xi, yi;
+
+   for (; k+4<=m; k+=4) {
+      xi = _mm256_cvttpd_epi32(_mm256_floor_pd(
+	      _mm256_add_pd(half, _mm256_mul_pd(_mm256_loadu_pd(x+k), vsf))));
+      yi = _mm256_cvttpd_epi32(_mm256_floor_pd(
+	      _mm256_add_pd(half, _mm256_mul_pd(_mm256_loadu_pd(y+k), vsf))));
+      _mm_storeu_si128((__m128i *)(dst + 8*k), 
+		       _mm_shuffle_epi8(_mm_unpacklo_epi32(xi, yi), sh128a));
+      _mm_storeu_si128((__m128i *)(dst + 8*k + 16), 
+		       _mm_shuffle_epi8(_mm_unpackhi_epi32(xi, yi), sh128a));
+   }
+#endif
+#if defined BSWAP_SSSE3 && defined __SSE4_1__
+   const __m128i sh128b = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+   const __m128d vsf2 = _mm_set1_pd(sf);
+   const __m128d half2 = _mm_set1_pd(0.5);
+   __m128i xw, yw;
+
+   for (; k+2<=m; k+=2) {
+      xw = _mm_cvttpd_epi32(_mm_floor_pd(
+	      _mm_add_pd(half2, _mm_mul_pd(_mm_loadu_pd(x+k), vsf2))));
+      yw = _mm_cvttpd_epi32(_mm_floor_pd(
+	      _mm_add_pd(half2, _mm_mul_pd(_mm_loadu_pd(y+k), vsf2))));
+      _mm_storeu_si128((__m128i *)(dst + 8*k), 
+		       _mm_shuffle_epi8(_mm_unpacklo_epi32(xw, yw), sh128b));
+   }
+#endif
+   for (; k<m; k++) {
+      store_be32(dst + 8*k,     (int32_t)floor(0.5 + x[k] * sf));
+      store_be32(dst + 8*k + 4, (int32_t)floor(0.5 + y[k] * sf));
+   }
+}
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * Like be32_xy_to_double, but without conversion to user units.
+ * Used for coordinates that are kept in database units.
+ */
+static INLINE void
+be32_xy_to_int32(const uint8_t *src, int32_t *x, int32_t *y, int m) {
+   int k;
+
+   for (k=0; k<m; k++) {
+      x[k] = load_be32(src + 8*k);
+      y[k] = load_be32(src + 8*k + 4);
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * The inverse of be32_xy_to_int32
+ */
+static INLINE void
+int32_xy_to_be32(const int32_t *x, const int32_t *y, uint8_t *dst, int m) {
+   int k;
+
+   for (k=0; k<m; k++) {
+      store_be32(dst + 8*k,     x[k]);
+      store_be32(dst + 8*k + 4, y[k]);
+   }
+}
+
+/*-----------------------------------------------------------------*/
+
 #endif /* _BYTESWAP */
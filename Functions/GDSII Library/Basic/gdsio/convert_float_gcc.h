@@ -17,6 +17,7 @@
 #ifndef _CONVERT_FLOAT
 #define _CONVERT_FLOAT
 
+#include <string.h>
 #include "mex.h"
 #include "byteswap.h"
 
@@ -26,14 +27,15 @@
 static INLINE double 
 excess64_to_ieee754(uint64_t *b)
 { 
-   int count = 0;
-   uint64_t fraction;
+   uint64_t fraction, bits, nz;
    uint16_t exp_ieee;
    int8_t exp_ex64;
+   int shift;
+   double d;
 
 
    /* Fraction takes binary content of last seven bytes */
-   fraction = be64_to_host(*b) & 0xffffffffffffff;
+   fraction = be64_to_host(*b) & 0xffffffffffffffULL;
 
    /* Exponent is last seven bits of first byte decremented with 64 */
    exp_ex64 = (*((int8_t *)b) & 0x7f) - 64;
@@ -41,35 +43,29 @@ excess64_to_ieee754(uint64_t *b)
    /* Convert exponent from Calma's GDSII (base16) to IEEE754 (base2) */
    exp_ieee = 1023+(((uint16_t) exp_ex64) << 2);
 
-   /* Find leading '1' of significand,... but stop after 56 times,
-      as left shift inserts zeros (prevent loop lock). */
-   while (((fraction & 0x100000000000000) == 0) && count <= 56) {
-      fraction <<= 1;
-      exp_ieee-=1;
-      count++;
-   }
-   /* When 57 times left shifted, fraction was filled
-      with zero's, so to represent absolute zero in IEEE754
-      set exponent also to lowest value */
-   if (count >= 57)
-      exp_ieee = 0;
+   /* Shift the leading '1' of the significand to bit 56. The number
+      of leading zeros replaces a loop over all bit positions. A zero
+      fraction is handled by the mask nz below. */
+   nz = (fraction != 0);
+   shift = __builtin_clzll(fraction | 1) - 7;
+   fraction <<= shift;
+   exp_ieee -= shift;
  
-   /* and suppress leading '1' (implicitly present in IEEE754) */
-   fraction &= 0xFFFFFFFFFFFFFF;
-
-   /* Shift 4-bits to the right, as IEEE754 has
-      only 52 instead of 56 bits significand */
-   fraction >>= 4;
+   /* suppress leading '1' (implicitly present in IEEE754) and
+      shift 4-bits to the right, as IEEE754 has only 52 instead 
+      of 56 bits significand */
+   fraction = (fraction & 0xffffffffffffffULL) >> 4;
 
-   /* do binary OR operation with fraction and move
-      exponent to correct position for IEEE754 */
-   fraction |= (( (uint64_t) exp_ieee) << 52);
+   /* combine fraction and exponent; absolute zero has a zero 
+      exponent in IEEE754 */
+   bits = (fraction | ((uint64_t)exp_ieee << 52)) & (0 - nz);
 
    /* Don't forget to logically OR sign bit too */
-   if( *((int8_t *)b) & 0x80 ) fraction |= 0x8000000000000000;
+   bits |= (uint64_t)(*((uint8_t *)b) & 0x80) << 56;
 
    /* Re-interpret created bit pattern as double */
-   return *( (double *)(&fraction) );
+   memcpy(&d, &bits, sizeof(double));
+   return d;
 }
 
 
@@ -82,43 +78,37 @@ ieee754_to_excess64(double d, uint64_t *b)
    uint16_t exp_ieee;
    uint64_t fraction;
    uint64_t d_bits;
-   int i;
 
 
    /* Interpret double as an 64 bit unsigned integer */
-   d_bits = *( (uint64_t *)&d );
+   memcpy(&d_bits, &d, sizeof(double));
 
    /* Fraction takes binary content of last 52 bits, while
       adding implicitly removed leading '1' (IEEE754) */
-   fraction = (d_bits & 0xfffffffffffff) | 0x10000000000000;
+   fraction = (d_bits & 0xfffffffffffffULL) | 0x10000000000000ULL;
 
    /* Take 2nd till 12th bit, and right shift them 52 positions,
       as representation of the exponent */
-   exp_ieee = (uint16_t)((d_bits & 0x7ff0000000000000) >> 52);
+   exp_ieee = (uint16_t)((d_bits & 0x7ff0000000000000ULL) >> 52);
 
    /* Verify if IEEE754 exponent exceeds Calma format range, return error */
-   if ( (exp_ieee > 1275) || (exp_ieee < 767) ) {
-     mexErrMsgTxt("ieee754_to_excess64 :  floating point number cannot be represented in excess-64 format.");
-   } 
-   else {
-      /* Convert power of 2 to power of 16, remainder absorbed by fraction
-         as ieee-1023 is default, add 4 (changing from 52 to 56 bit size of
-         the fraction) and adding 4 times 64, the new offset of base 16.*/
-      exp_ex64 = exp_ieee - 1023 + 4 + 4*64;
-      for(i=1; i<3;i++) {
-	 /* As factors 2^1, 2^2 and 2^3 do not fit in 2^4, shift fraction
-	    accordingly, if needed. */
-	 if(exp_ex64 & 0x1)
-	    fraction <<= i;
-	 exp_ex64 >>= 1; /* Looped twice, exp is divided by four */
-      }
-   }
+   if ( (exp_ieee > 1274) || (exp_ieee < 767) )
+      mexErrMsgTxt("ieee754_to_excess64 :  floating point number cannot be represented in excess-64 format.");
+
+   /* Convert power of 2 to power of 16, remainder absorbed by fraction
+      as ieee-1023 is default, add 4 (changing from 52 to 56 bit size of
+      the fraction) and adding 4 times 64, the new offset of base 16.
+      Factors 2^1, 2^2 and 2^3 do not fit in 2^4 and shift the fraction. */
+   exp_ex64 = exp_ieee - 1023 + 4 + 4*64;
+   fraction <<= (exp_ex64 & 0x3);
+   exp_ex64 >>= 2;
 
    /* Write result to memory: binary OR function of sign, exponent and fraction */
-   *b = host_to_be64( (d_bits & 0x8000000000000000) | 
+   *b = host_to_be64( (d_bits & 0x8000000000000000ULL) | 
                       ((uint64_t)exp_ex64 << 56) | fraction );
 }
 
+
 /*-----------------------------------------------------------------*/
 
 #endif /* _CONVERT_FLOAT */
@@ -5,6 +5,8 @@
  * These functions are in the Public Domain.
  */
 
+#include "mex.h"
+
 /*-----------------------------------------------------------------*/
 
 /* find mantissa and exponent of a real number
@@ -40,7 +42,7 @@ float_parts(double anum, double *M)
    mn = frexp(anum, &ex);         /* anum = mn * 2^ex, normalized */
    ex16 = 0.25 * ex;              /* scale to base 16 */
    E = ceil(ex16);                /* integer fraction is exponent */
-   *M = mn * pow(16.0, ex16 - E); /* base 16 mantissa */
+   *M = ldexp(mn, ex - 4*E);      /* base 16 mantissa, exact */
 
    /* normalize the representation such that 1/16 <= M < 1 */
    while (*M >= 1) {
@@ -81,7 +83,7 @@ excess64_to_ieee754(uint64_t *b)
    }
    mantissa = (double)imantissa / 72057594037927936.0;  /* divide by 2^56 */
 
-   rnum = mantissa * pow(16, (float)exponent);
+   rnum = ldexp(mantissa, 4*exponent);  /* exact scaling by 16^exponent */
    if(sign)
       rnum *= -1;
 
@@ -108,6 +110,8 @@ ieee754_to_excess64(double d, uint64_t *b)
    /* convert to excess-64 representation */
    /* originally used on IBM mainframes */
    exponent += 64;  
+   if (exponent < 0 || exponent > 127)
+      mexErrMsgTxt("ieee754_to_excess64 :  floating point number cannot be represented in excess-64 format.");
    if (mantissa < 0.0) {
       exponent |= 0x80;   /* set the sign bit */
       mantissa *= -1;     /* and make mantissa positive */
@@ -37,9 +37,10 @@ mexFunction(int nlhs, mxArray *plhs[],
 	    int nrhs, const mxArray *prhs[])
 {
    mxArray *pd;           /* pointers to matrix objects*/
-   FILE *fob;             /* file object pointer */
+   gdsfile_t *fob;             /* file object pointer */
    date_t cdate, mdate;   /* dates */
    double *uunit, *dbunit;
+   double units[2];
    char name[NLEN];      /* library name */
    int len, k, nrl, nfn;
 
@@ -130,10 +131,10 @@ mexFunction(int nlhs, mxArray *plhs[],
       mexErrMsgTxt("failed to write UNITS record.");
    uunit  = mxGetData(prhs[UUNIT_ARG]);
    dbunit = mxGetData(prhs[DBUNIT_ARG]);
-   if ( write_real8(fob, dbunit[0]/uunit[0]) )
-      mexErrMsgTxt("failed to write dbunit/uunit.");
-   if ( write_real8(fob, dbunit[0]) )
-      mexErrMsgTxt("failed to write dbunit.");
+   units[0] = dbunit[0]/uunit[0];
+   units[1] = dbunit[0];
+   if ( write_real8_n(fob, units, 2) )
+      mexErrMsgTxt("failed to write UNITS record.");
 }
 
 /*-----------------------------------------------------------------*/
@@ -26,7 +26,7 @@ void
 mexFunction(int nlhs, mxArray *plhs[], 
 	    int nrhs, const mxArray *prhs[])
 {
-   FILE *fob;          /* file object pointer */
+   gdsfile_t *fob;          /* file object pointer */
    date_t cdate;       /* creation date */
    date_t mdate;       /* modification date */
    char sname[NLEN];   /* structure name */
@@ -0,0 +1,124 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Loads data from a layout cache file written by gds_cache_write.
+ * The file is memory mapped when possible; the tables in the file
+ * are used without copying, and element data are only created for 
+ * the requested structures.
+ *
+ * [ldata, cidx] = gds_cache_read(cname);
+ * slist = gds_cache_read(cname, ind);
+ *
+ * Input
+ * cname :  name of the cache file
+ * ind :    (Optional) vector with indices of structures in the 
+ *          cache file.
+ *
+ * Output:
+ * ldata :  a structure with the library data, with the same fields
+ *          as returned by gds_libdata. Only lname, uunit, and
+ *          dbunit are stored in the cache; the dates are the
+ *          current date.
+ * cidx :   (Optional) a 1 x N structure array with the fields
+ *          sname, offset, length, numel, and refs, as returned by
+ *          gds_struct_index. offset is the zero-based index of
+ *          the structure in the cache file and length is 1.
+ * slist :  a 1 x M structure array with fields sname, cdate, 
+ *          mdate, and el for the structures in ind, as returned
+ *          by gds_read_library.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsio.h"
+#include "gdsread.h"
+#include "gdscache.h"
+#include "mexfuncs.h"
+
+#define FNAME_LEN  1024
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   const char *fields[] = {"lname", "libver", "cdate", "mdate",
+			   "uunit", "dbunit", "reflibs", "fonts", "generations"};
+   char cname[FNAME_LEN];
+   gdsfile_t *gf;
+   cache_info ci;
+   lib_tables lt, sel;
+   double *pd;
+   size_t k, n, nind;
+   date_t dv;
+   uint16_t word = 7;
+   void *buf;
+
+   /* check argument number */
+   if (nrhs < 1 || nrhs > 2) {
+      mexErrMsgTxt("gds_cache_read :  1 or 2 input arguments expected.");
+   }
+
+   /* open and map the cache */
+   if ( mxGetString(prhs[0], cname, FNAME_LEN) )
+      mexErrMsgTxt("gds_cache_read :  failed to access file name argument.");
+   gf = gdsfile_open(cname, "rbm");
+   if (gf == NULL) {
+      mexPrintf("gds_cache_read: file >> %s <<\n", cname);
+      mexErrMsgTxt("gds_cache_read :  could not open cache file.");
+   }
+   buf = map_cache(gf, &lt, &ci);
+
+   if (nrhs == 1) {
+
+      /* library data and index */
+      plhs[0] = mxCreateStructMatrix(1, 1, 9, fields); 
+      struct_set_string(plhs[0], 0, ci.lname);
+      struct_set_word(plhs[0], 1, &word, 1);
+      now(dv);
+      struct_set_word(plhs[0], 2, dv, 6);
+      struct_set_word(plhs[0], 3, dv, 6);
+      struct_set_float(plhs[0], 4, ci.uunit);
+      struct_set_float(plhs[0], 5, ci.dbunit);
+
+      if (nlhs > 1)
+	 plhs[1] = index_to_mx(&lt);
+   }
+   else {
+
+      /* selected structures in a table of their own */
+      nind = mxGetNumberOfElements(prhs[1]);
+      if ( nind && !mxIsDouble(prhs[1]) ) {
+	 gdsfile_close(gf);
+	 mexErrMsgTxt("gds_cache_read :  structure indices must be double.");
+      }
+      pd = nind ? mxGetPr(prhs[1]) : NULL;
+      sel = lt;
+      sel.st = mxMalloc((nind ? nind : 1) * sizeof(st_rec));
+      sel.nst = nind;
+      for (k=0; k<nind; k++) {
+	 n = (size_t)pd[k];
+	 if (pd[k] < 1 || n > lt.nst) {
+	    gdsfile_close(gf);
+	    mexErrMsgTxt("gds_cache_read :  structure index out of range.");
+	 }
+	 check_cache_structure(&lt, n-1);
+	 sel.st[k] = lt.st[n-1];
+	 sel.st[k].cont = 0;
+      }
+      plhs[0] = structures_to_mx(&sel, 1);
+      mxFree(sel.st);
+   }
+
+   if (buf != NULL)
+      mxFree(buf);
+   gdsfile_close(gf);
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,71 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Writes a list of structures to a layout cache file, from which
+ * individual structures can be loaded quickly with gds_cache_read.
+ * Coordinates are stored in database units.
+ *
+ * gds_cache_write(cname, slist, uunit, dbunit, lname);
+ *
+ * Input
+ * cname :     name of the cache file
+ * slist :     a cell array of structures with fields
+ *               sname : structure name
+ *               cdate : (Optional) creation date
+ *               mdate : (Optional) modification date
+ *               el    : cell array with element data structures
+ *                       as stored in gds_element objects
+ * uunit :     user unit in m
+ * dbunit :    database unit in m
+ * lname :     library name
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsio.h"
+#include "gdsread.h"
+#include "gdscache.h"
+#include "mexfuncs.h"
+
+#define FNAME_LEN  1024
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   char cname[FNAME_LEN];
+   cache_info ci;
+   lib_tables lt;
+
+   /* check argument number */
+   if (nrhs != 5) {
+      mexErrMsgTxt("gds_cache_write :  5 input arguments expected.");
+   }
+
+   /* arguments */
+   if ( mxGetString(prhs[0], cname, FNAME_LEN) )
+      mexErrMsgTxt("gds_cache_write :  failed to access file name argument.");
+   ci.uunit = mxGetScalar(prhs[2]);
+   ci.dbunit = mxGetScalar(prhs[3]);
+   if (ci.uunit <= 0.0 || ci.dbunit <= 0.0)
+      mexErrMsgTxt("gds_cache_write :  units must be > 0.");
+   memset(ci.lname, 0, sizeof(ci.lname));
+   if ( mxIsChar(prhs[4]) )
+      mxGetString(prhs[4], ci.lname, sizeof(ci.lname));
+
+   /* collect the tables and write them */
+   init_tables(&lt, ci.dbunit / ci.uunit);
+   if ( !mxIsEmpty(prhs[1]) )
+      tables_from_mx(prhs[1], ci.uunit / ci.dbunit, &lt);
+   write_cache(cname, &lt, &ci);
+   free_tables(&lt);
+}
+
+/*-----------------------------------------------------------------*/
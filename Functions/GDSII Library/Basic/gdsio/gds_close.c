@@ -22,7 +22,8 @@ void
 mexFunction(int nlhs, mxArray *plhs[], 
 	    int nrhs, const mxArray *prhs[])
 {
-   FILE *fob;                  /* file object pointer */
+   gdsfile_t *fob;             /* file object pointer */
+   int ahead;
 
    /* check argument number */
    if (nrhs != 1) {
@@ -33,8 +34,13 @@ mexFunction(int nlhs, mxArray *plhs[],
    fob = get_file_ptr((mxArray *)prhs[0]);
 
    /* close file */
-   if ( fclose(fob) )
+   ahead = fob->ra != NULL;
+   if ( gdsfile_close(fob) )
       mexErrMsgTxt("gds_close :  failed to close file.");
+
+   /* gds_open can be unloaded when its last read-ahead thread ended */
+   if (ahead)
+      mexCallMATLAB(0, NULL, 0, NULL, "gds_open");
 }
 
 /*-----------------------------------------------------------------*/
@@ -22,7 +22,7 @@ void
 mexFunction(int nlhs, mxArray *plhs[], 
 	    int nrhs, const mxArray *prhs[])
 {
-   FILE *fob;                  /* file object pointer */
+   gdsfile_t *fob;                  /* file object pointer */
 
    /* check argument number */
    if (nrhs != 1) {
@@ -0,0 +1,244 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Compares the bit-level conversion functions for GCC in
+ * convert_float_gcc.h with reference functions that normalize the
+ * excess-64 fraction one bit at a time, as the functions did before
+ * they used __builtin_clzll. The results must be bit-identical. The
+ * encoder in convert_float_generic.h is compared too; its decoder
+ * rounds fractions with more than 53 bits instead of truncating them
+ * and is not compared. This function is only built by makemex-debug.
+ *
+ * [nd, ne] = gds_float_check(ntail);
+ *
+ * Input
+ * ntail :  (Optional) number of fractions tested for each exponent
+ *          and position of the leading fraction bit. Default is 256.
+ *
+ * Output
+ * nd :     number of excess-64 reals that are decoded differently
+ * ne :     number of doubles that are encoded differently by any of
+ *          the encoders, or that do not survive a round trip through
+ *          excess-64 format
+ *
+ * Decoding is tested for all 256 values of the first byte (sign and
+ * exponent), combined with all 57 positions of the leading fraction
+ * bit (including a zero fraction), which covers every normalization
+ * shift of the decoder. Encoding is tested for both signs and
+ * all IEEE 754 exponents that can be represented in excess-64 format,
+ * and each result is decoded again. For each case, the first fraction
+ * has no bits and the second all bits set below the leading bit; the
+ * other fractions are pseudo-random. Doubles outside of the excess-64
+ * range are not tested because both encoders raise an error.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "mex.h"
+
+#if !defined __GNUC__
+   #error "gds_float_check requires GCC."
+#endif
+
+#include "byteswap.h"
+
+#define excess64_to_ieee754 gcc_excess64_to_ieee754
+#define ieee754_to_excess64 gcc_ieee754_to_excess64
+#include "convert_float_gcc.h"
+#undef excess64_to_ieee754
+#undef ieee754_to_excess64
+
+#define excess64_to_ieee754 gen_excess64_to_ieee754
+#define ieee754_to_excess64 gen_ieee754_to_excess64
+#include "convert_float_generic.h"
+#undef excess64_to_ieee754
+#undef ieee754_to_excess64
+
+/* range of IEEE 754 exponents that fit the excess-64 format */
+#define EXP_MIN  767
+#define EXP_MAX  1274
+
+
+/*-- local prototypes -----------------------------------------*/
+
+static double ref_excess64_to_ieee754(uint64_t *b);
+static void ref_ieee754_to_excess64(double d, uint64_t *b);
+static uint64_t next_random(uint64_t *state);
+static uint64_t double_bits(double d);
+static uint64_t fraction(int k, int p, uint64_t *state);
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+	    int nrhs, const mxArray *prhs[])
+{
+   uint64_t state = 88172645463325252ULL;
+   uint64_t host, raw, a, b, c, dbits;
+   double d, ndec = 0, nenc = 0;
+   int ntail = 256;
+   int b0, p, e, s, k;
+
+   if (nrhs > 0 && !mxIsEmpty(prhs[0]))
+      ntail = (int)mxGetScalar(prhs[0]);
+   if (ntail < 2)
+      ntail = 2;
+
+   /* decoding: sign and exponent byte x leading bit x fractions */
+   for (b0=0; b0<256; b0++) {
+      for (p=-1; p<56; p++) {
+	 for (k=0; k<ntail; k++) {
+	    host = ((uint64_t)b0 << 56) | fraction(k, p, &state);
+	    raw = host_to_be64(host);
+	    a = b = raw;
+	    if (double_bits(gcc_excess64_to_ieee754(&a)) !=
+		double_bits(ref_excess64_to_ieee754(&b)))
+	       ndec += 1;
+	    if (p < 0)
+	       break;  /* only one zero fraction */
+	 }
+      }
+   }
+
+   /* encoding: sign x representable exponent x fractions */
+   for (e=EXP_MIN; e<=EXP_MAX; e++) {
+      for (s=0; s<2; s++) {
+	 for (k=0; k<ntail; k++) {
+	    dbits = ((uint64_t)s << 63) | ((uint64_t)e << 52) |
+		    (fraction(k, 52, &state) & 0xfffffffffffffULL);
+	    memcpy(&d, &dbits, sizeof(double));
+	    gcc_ieee754_to_excess64(d, &a);
+	    ref_ieee754_to_excess64(d, &b);
+	    gen_ieee754_to_excess64(d, &c);
+	    if (a != b || a != c || double_bits(gcc_excess64_to_ieee754(&a)) != dbits)
+	       nenc += 1;
+	 }
+      }
+   }
+
+   mexPrintf("gds_float_check :  %.0f decoding and %.0f encoding differences.\n",
+	     ndec, nenc);
+
+   plhs[0] = mxCreateDoubleScalar(ndec);
+   if (nlhs > 1)
+      plhs[1] = mxCreateDoubleScalar(nenc);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* reference decoder: shifts the leading fraction bit to bit 56 */
+static double
+ref_excess64_to_ieee754(uint64_t *b)
+{
+   int count = 0;
+   uint64_t fraction;
+   uint16_t exp_ieee;
+   int8_t exp_ex64;
+   double d;
+
+   fraction = be64_to_host(*b) & 0xffffffffffffffULL;
+   exp_ex64 = (*((int8_t *)b) & 0x7f) - 64;
+   exp_ieee = 1023+(((uint16_t) exp_ex64) << 2);
+
+   while (((fraction & 0x100000000000000ULL) == 0) && count <= 56) {
+      fraction <<= 1;
+      exp_ieee -= 1;
+      count++;
+   }
+   if (count >= 57)
+      exp_ieee = 0;
+
+   fraction &= 0xffffffffffffffULL;
+   fraction >>= 4;
+   fraction |= ((uint64_t)exp_ieee << 52);
+   if ( *((int8_t *)b) & 0x80 )
+      fraction |= 0x8000000000000000ULL;
+
+   memcpy(&d, &fraction, sizeof(double));
+   return d;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* reference encoder: shifts the fraction one bit at a time */
+static void
+ref_ieee754_to_excess64(double d, uint64_t *b)
+{
+   uint16_t exp_ex64;
+   uint16_t exp_ieee;
+   uint64_t fraction;
+   uint64_t d_bits;
+   int i;
+
+   memcpy(&d_bits, &d, sizeof(double));
+   fraction = (d_bits & 0xfffffffffffffULL) | 0x10000000000000ULL;
+   exp_ieee = (uint16_t)((d_bits & 0x7ff0000000000000ULL) >> 52);
+
+   exp_ex64 = exp_ieee - 1023 + 4 + 4*64;
+   for (i=1; i<3; i++) {
+      if (exp_ex64 & 0x1)
+	 fraction <<= i;
+      exp_ex64 >>= 1;
+   }
+
+   *b = host_to_be64( (d_bits & 0x8000000000000000ULL) |
+		      ((uint64_t)exp_ex64 << 56) | fraction );
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* xorshift generator for fractions */
+static uint64_t
+next_random(uint64_t *state)
+{
+   *state ^= *state << 13;
+   *state ^= *state >> 7;
+   *state ^= *state << 17;
+   return *state;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static uint64_t
+double_bits(double d)
+{
+   uint64_t u;
+
+   memcpy(&u, &d, sizeof(double));
+   return u;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * fraction k with the leading bit at position p (zero when p < 0):
+ * k = 0 has no other bits, k = 1 all bits below p, and the others
+ * random bits below p. The encoding test uses p = 52, the implicit
+ * leading bit of IEEE 754, and masks it.
+ */
+static uint64_t
+fraction(int k, int p, uint64_t *state)
+{
+   uint64_t lead, below;
+
+   if (p < 0)
+      return 0;
+
+   lead = (uint64_t)1 << p;
+   below = lead - 1;
+   if (k == 0)
+      return lead;
+   else if (k == 1)
+      return lead | below;
+   else
+      return lead | (next_random(state) & below);
+}
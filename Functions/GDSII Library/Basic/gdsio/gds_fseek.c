@@ -0,0 +1,49 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Sets the position of the file pointer of a file that was
+ * opened for reading.
+ * 
+ * gds_fseek(gf, fpos);
+ *
+ * Input
+ * gf :    a file handle returned by gds_open.
+ * fpos :  the new file position, e.g. as returned by gds_ftell
+ * 
+ */
+
+#include <stdio.h>
+#include "gdsio.h"
+#include "mex.h"
+#include "mexfuncs.h"
+
+/*-----------------------------------------------------------------*/
+
+void 
+mexFunction(int nlhs, mxArray *plhs[], 
+	    int nrhs, const mxArray *prhs[])
+{
+   gdsfile_t *fob;    /* file object pointer */
+   double *pd;
+
+   /* 
+    * check argument number 
+    */
+   if (nrhs != 2)
+      mexErrMsgTxt("expected 2 input arguments.");
+   
+   /* 
+    * get file handle argument 
+    */
+   fob = get_file_ptr((mxArray *)prhs[0]);
+
+   /*
+    * set file position
+    */
+   pd = mxGetData(prhs[1]);
+   if ( gdsfile_seek(fob, (long)pd[0]) )
+      mexErrMsgTxt("failed to set file position.");
+}
+
+/*-----------------------------------------------------------------*/
@@ -24,7 +24,7 @@ void
 mexFunction(int nlhs, mxArray *plhs[], 
 	    int nrhs, const mxArray *prhs[])
 {
-   FILE *fob;         /* file object pointer */
+   gdsfile_t *fob;    /* file object pointer */
    long int pos;
    double *pd;
 
@@ -44,7 +44,7 @@ mexFunction(int nlhs, mxArray *plhs[],
     */
    plhs[0] = mxCreateDoubleMatrix(1,1, mxREAL);
    pd = mxGetData(plhs[0]);
-   pos = ftell(fob);
+   pos = gdsfile_tell(fob);
    if (pos < 0)
       mexErrMsgTxt("failed to obtain file position with ftell().");
    *pd = pos;
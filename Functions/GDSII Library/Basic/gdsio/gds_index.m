@@ -0,0 +1,71 @@
+function [gidx] = gds_index(gdsname, update)
+%function [gidx] = gds_index(gdsname, update)
+%
+% gds_index :
+%        returns an index of the structures in a GDS II file with
+%        the file position, length, and referenced structures of 
+%        each structure. The index is stored in a small sidecar 
+%        file (gdsname + '.sidx') and is only recreated when the
+%        size or modification time of the GDS II file changes.
+%
+% gdsname :  name of a GDS II file
+% update :   (Optional) when > 0, the index is always recreated.
+%            Default is 0.
+% gidx :     a structure with the fields
+%               fname  : name of the GDS II file
+%               fsize  : file size in bytes
+%               mtime  : modification time (datenum)
+%               lname  : library name
+%               uunit  : user unit
+%               dbunit : database unit
+%               st     : structure array with index entries
+%                        (see gds_struct_index)
+%
+
+% Initial version, structure index
+
+% check arguments
+if nargin < 2, update = []; end
+if isempty(update), update = 0; end
+
+% file information
+finfo = dir(gdsname);
+if isempty(finfo)
+   error('gds_index :  file %s does not exist.', gdsname);
+end
+iname = [gdsname, '.sidx'];
+
+% return the stored index when it is current
+if ~update && gds_file_exists(iname)
+   try
+      S = load(iname, '-mat');
+      gidx = S.gidx;
+      if gidx.fsize == finfo.bytes && gidx.mtime == finfo.datenum && ...
+         isfield(gidx.st, 'numel')
+         gidx.fname = gdsname;
+         return
+      end
+   catch
+      % unreadable index - create a new one
+   end
+end
+
+% scan the GDS II file
+gf = gds_open(gdsname, 'rbm');
+ldata = gds_libdata(gf);
+gidx.fname = gdsname;
+gidx.fsize = finfo.bytes;
+gidx.mtime = finfo.datenum;
+gidx.lname = ldata.lname;
+gidx.uunit = ldata.uunit;
+gidx.dbunit = ldata.dbunit;
+gidx.st = gds_struct_index(gf);
+gds_close(gf);
+
+% store the index; a read-only directory is not an error
+try
+   save(iname, 'gidx', '-mat');
+catch
+end
+
+return
@@ -9,6 +9,10 @@ function [gf] = gds_initialize(fname, uunit, dbunit, lname, reflibs, fonts);
 %           name already exists, the existing file will be renamed,
 %           unless the file name begins with a '!'. If the file
 %           name begins with '!' an existing file will be overwritten.
+%           When the file name has the extension .oas (optionally
+%           followed by .gz or .zst), an OASIS file is created; its
+%           contents must be written with oasis_write_library and
+%           oasis_endlib.
 % uunit   : (Optional) user unit in meters. Default is 1^-6 (1 um)
 % dbunit  : (Optional) database unit in meters. Default is 10^-9 (1 nm)
 % lname   : (Optional) library name which is stored in the file header. By
@@ -81,7 +85,12 @@ end
 % open the library file
 gf = gds_open(fname, 'wb'); % the 'b' is for Windows
 
-% write the HEADER record (format version 7 permits 8192 polygon vertices)
-gds_beginlib(gf, uunit, dbunit, lname, reflibs, fonts);
+% write the library header
+if ~isempty(regexp(fname, '\.oas(\.gz|\.zst)?$', 'once'))
+   oasis_beginlib(gf, uunit, dbunit, lname); % no reflibs and fonts in OASIS
+else
+   % HEADER record (format version 7 permits 8192 polygon vertices)
+   gds_beginlib(gf, uunit, dbunit, lname, reflibs, fonts);
+end
 
 return
@@ -0,0 +1,81 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Returns the statistics of the read-ahead thread of a GDS II file
+ * that was opened with the read-ahead flag, e.g. with mode 'rba'.
+ * The statistics show how well reading the file overlaps with 
+ * decoding the records: when the overlap is close to 1, the decoder
+ * rarely waited for data and reading the file is CPU-bound; when it
+ * is close to 0, the decoder waited for the storage.
+ *
+ * st = gds_io_stats(gf);
+ *
+ * Input
+ * gf :    a file handle returned by gds_open.
+ *
+ * Output:
+ * st :    a structure with the fields
+ *           st.bytes      : bytes delivered to the decoder
+ *           st.elapsed    : seconds since the file was opened
+ *           st.io_time    : seconds spent reading the file
+ *           st.wait_time  : seconds the decoder waited for data
+ *           st.throughput : bytes / elapsed in MB/s
+ *           st.overlap    : fraction of the reading time that was
+ *                           hidden behind decoding, 
+ *                           1 - wait_time / io_time
+ *         An empty matrix is returned when the file is not read
+ *         by a read-ahead thread.
+ */
+
+#include <stdio.h>
+#include "gdsio.h"
+#include "gdsahead.h"
+#include "mex.h"
+#include "mexfuncs.h"
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   gdsfile_t *gf;
+   ahead_stats st;
+   double ovl;
+   const char *fields[] = {"bytes", "elapsed", "io_time", "wait_time",
+                           "throughput", "overlap"};
+
+   /* check argument number */
+   if (nrhs != 1) {
+      mexErrMsgTxt("gds_io_stats :  1 input argument expected.");
+   }
+
+   /* get file handle argument */
+   gf = get_file_ptr((mxArray *)prhs[0]);
+   if (gf->ra == NULL) {
+      plhs[0] = mxCreateDoubleMatrix(0,0, mxREAL);
+      return;
+   }
+
+   /* return the statistics */
+   gdsahead_stats(gf, &st);
+   ovl = 1.0;
+   if (st.io_time > 0) {
+      ovl = 1.0 - st.wait_time / st.io_time;
+      if (ovl < 0)
+	 ovl = 0;
+   }
+
+   plhs[0] = mxCreateStructMatrix(1,1, 6, fields);
+   mxSetFieldByNumber(plhs[0], 0, 0, mxCreateDoubleScalar(st.bytes));
+   mxSetFieldByNumber(plhs[0], 0, 1, mxCreateDoubleScalar(st.elapsed));
+   mxSetFieldByNumber(plhs[0], 0, 2, mxCreateDoubleScalar(st.io_time));
+   mxSetFieldByNumber(plhs[0], 0, 3, mxCreateDoubleScalar(st.wait_time));
+   mxSetFieldByNumber(plhs[0], 0, 4, 
+		      mxCreateDoubleScalar(st.elapsed > 0 ? 1e-6*st.bytes/st.elapsed : 0));
+   mxSetFieldByNumber(plhs[0], 0, 5, mxCreateDoubleScalar(ovl));
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,82 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Returns statistics of the elements in all structures of a GDS II
+ * library file, by layer and data type, from a scan of the records.
+ * No element data are created, which makes the function much faster
+ * than reading the library. The file must be positioned after the 
+ * library header, i.e. after calling gds_libdata.
+ *
+ * st = gds_layer_stats(gf, dbu_to_uu, nthreads);
+ *
+ * Input
+ * gf :        a file handle returned by gds_open.
+ * dbu_to_uu : conversion factor database units --> user units
+ * nthreads :  (Optional) number of threads used to scan the 
+ *             structures of a memory mapped file. Default is 0,
+ *             which uses all processors.
+ *
+ * Output:
+ * st :  a 1 x N structure array with one entry per structure
+ *          st(k).sname    : structure name
+ *          st(k).offset   : file position of the BGNSTR record
+ *          st(k).length   : number of bytes up to and including
+ *                           the ENDSTR record
+ *          st(k).numel    : number of elements in the structure
+ *          st(k).sref     : number of sref elements
+ *          st(k).aref     : number of aref elements
+ *        and with one row for each of L layer / data type pairs
+ *        with elements in the structure, sorted by layer:
+ *          st(k).layer    : L x 1 layer numbers
+ *          st(k).dtype    : L x 1 data types; text types, box
+ *                           types, and node types are counted
+ *                           as data types
+ *          st(k).count    : L x 5 matrix with the number of 
+ *                           boundary, path, box, node, and text
+ *                           elements
+ *          st(k).vertices : L x 1 number of vertices
+ *          st(k).bbox     : L x 4 matrix with the bounding boxes
+ *                           [xmin, ymin, xmax, ymax] of the 
+ *                           vertices in user units
+ *          st(k).bytes    : L x 1 number of bytes of the element
+ *                           records
+ */
+
+#include <stdio.h>
+#include "gdsio.h"
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsstats.h"
+#include "mexfuncs.h"
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   gdsfile_t *gf;
+   struct_stat *ps;
+   size_t nst;
+   int nthreads = 0;
+
+   /* check argument number */
+   if (nrhs < 2) {
+      mexErrMsgTxt("gds_layer_stats :  at least 2 input arguments expected.");
+   }
+
+   /* get arguments */
+   gf = get_file_ptr((mxArray *)prhs[0]);
+   if (nrhs > 2 && !mxIsEmpty(prhs[2]))
+      nthreads = (int)mxGetScalar(prhs[2]);
+
+   /* scan the file */
+   ps = library_stats(gf, nthreads, &nst);
+   plhs[0] = stats_to_mx(ps, nst, mxGetScalar(prhs[1]));
+   free_stats(ps, nst);
+}
+
+/*-----------------------------------------------------------------*/
@@ -38,10 +38,10 @@ mexFunction(int nlhs, mxArray *plhs[],
 	    int nrhs, const mxArray *prhs[])
 {
    mxArray *ca;           /* pointer to cell array */
-   FILE *fob;             /* file object pointer */
+   gdsfile_t *fob;             /* file object pointer */
    date_t cdate;          /* creation date */
    date_t mdate;          /* modification date */
-   double uunit, dbunit;
+   double units[2];            /* uunit, dbunit */
    char lname[NLEN];      /* library name */
    char name[TLEN];       /* various file names */
    int recn = 0;          /* record number */
@@ -103,12 +103,10 @@ mexFunction(int nlhs, mxArray *plhs[],
       switch(rtype) {
 	
          case UNITS:
-	    if ( read_real8(fob, &uunit) )
-	       mexErrMsgTxt("gds_libdata :  failed to read UUNIT.");
-	    if ( read_real8(fob, &dbunit) )
-	       mexErrMsgTxt("gds_libdata :  failed to read DBUNIT.");
-	    struct_set_float(plhs[0], 4, dbunit / uunit); /* actual user unit */
-	    struct_set_float(plhs[0], 5, dbunit);
+	    if ( read_real8_n(fob, units, 2) )
+	       mexErrMsgTxt("gds_libdata :  failed to read UNITS.");
+	    struct_set_float(plhs[0], 4, units[1] / units[0]); /* actual user unit */
+	    struct_set_float(plhs[0], 5, units[1]);
 	    return;  /* last record in header */
 
          case REFLIBS:
@@ -6,28 +6,52 @@
  * Opens a GDS II library file for reading or writing.
  * 
  * [gf,size] = gds_open(name, mode);
+ * gds_open();
  *
  * Input:
  * name :  string with file name.
  * mode :  string specifying the open mode, either 'rb' or 'wb'. 
+ *         When 'm' is appended to a read mode, e.g. 'rbm', the file
+ *         is mapped into memory on platforms that support it and
+ *         records are decoded directly from the mapped pages.
+ *         When 'a' is appended to a read mode, e.g. 'rba', a file
+ *         that is not mapped is read ahead in large blocks by a 
+ *         background thread while the records are decoded (see
+ *         gds_io_stats).
+ *         Files with the extension .gz (gzip) or .zst (Zstandard)
+ *         are decompressed while reading and compressed while 
+ *         writing; they are never mapped.
+ *
+ * Without arguments, gds_open releases the lock that keeps it in
+ * memory while read-ahead threads exist, unless such threads remain.
+ * gds_close calls it after closing a file that was read ahead.
  *
  * Output:
- * gf :    a file handle (actually a FILE *, stored in a 4 byte 
- *         or 8 byte integer variable, depending on architecture).
+ * gf :    a file handle (actually a pointer to a gds file object,
+ *         stored in a 4 byte or 8 byte integer variable, depending 
+ *         on architecture).
  * size :  the file size in bytes; it is returned only when a file
- *         is opened for reading.
+ *         is opened for reading. For compressed files it is the size
+ *         of the uncompressed data when the file records it and 0
+ *         otherwise. gzip files record it modulo 4 GB, so the size
+ *         of a gzip file with more data can be too small.
  * 
  * NOTE:
  * This function bypasses the Octave (MATLAB) file i/o functions. It is
- * directly based on the fread/fwrite function of the C standard library.
+ * directly based on the fread/fwrite function of the C standard library
+ * or on memory mapping. Compressed files are handled by zlib and the
+ * Zstandard library when the function is compiled with HAVE_ZLIB and
+ * HAVE_ZSTD, respectively.
  */
 
 #include <stdio.h>
 #include "gdsio.h"
+#include "gdszip.h"
+#include "gdsahead.h"
 #include "mex.h"
 
 #define FNAME_LEN   256
-#define MODE_LEN    4
+#define MODE_LEN    8
 
 
 /*-----------------------------------------------------------------*/
@@ -36,14 +60,22 @@ void
 mexFunction(int nlhs, mxArray *plhs[], 
 	    int nrhs, const mxArray *prhs[])
 {
-   FILE *fob;                  /* file object pointer */
-   FILE **pfob;                /* pointer to fob */
+   gdsfile_t *fob;             /* file object pointer */
+   gdsfile_t **pfob;           /* pointer to fob */
    double *pd;
-   long int fsize;
    char fname[FNAME_LEN];      /* file name */
    char mode[MODE_LEN];        /* string with polygon operation */
 
 
+   /*
+    * release the lock when the last read-ahead file was closed
+    */
+   if (nrhs == 0) {
+      if (mexIsLocked() && !gdsahead_active())
+	 mexUnlock();
+      return;
+   }
+
    /* 
     * check argument number 
     */
@@ -64,44 +96,50 @@ mexFunction(int nlhs, mxArray *plhs[],
    if ( (mode[0] != 'r') && (mode[0] != 'w') )
       mexErrMsgTxt("mode must be either r or w.");
 
+   /* 
+    * compressed files need zlib or zstd
+    */
+   if ( !gdszip_supported(gdszip_codec(fname)) )
+      mexErrMsgTxt("compressed GDS II files (.gz, .zst) are not supported by this build.");
+
    /* 
     * open the file 
     */
-   fob = fopen(fname, mode);
+   fob = gdsfile_open(fname, mode);
    if (fob == NULL) {
       mexPrintf("gds_open: file >> %s <<\n", fname);
       mexErrMsgTxt("could not open file.");
    }
 
+   /*
+    * the read-ahead thread runs code of this MEX file, which
+    * must not be unloaded while the thread exists
+    */
+   if (fob->ra && !mexIsLocked())
+      mexLock();
+
    /* 
     * return the file pointer 
     */
-   if ( sizeof(FILE *) == 4 ) { 
+   if ( sizeof(gdsfile_t *) == 4 ) { 
       plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT32_CLASS, mxREAL);
    }
-   else if ( sizeof(FILE *) == 8 ) {
+   else if ( sizeof(gdsfile_t *) == 8 ) {
       plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
    }
    else
       mexErrMsgTxt("pointer size is neither 4 nor 8 bytes.");
 
-   pfob  = (FILE **)mxGetData(plhs[0]);
+   pfob  = (gdsfile_t **)mxGetData(plhs[0]);
    *pfob = fob;
 
    /* 
     * also return file size if opened for reading 
     */
    if (mode[0] == 'r') {
-      if (fseek(fob, 0L, SEEK_END) < 0)
-	 mexErrMsgTxt("fseek to end of file failed.");
-      fsize = ftell(fob);
-      if (fsize < 0)
-	 mexErrMsgTxt("failed to obtain file position with ftell().");
-      if (fseek(fob, 0L, SEEK_SET) < 0)
-	 mexErrMsgTxt("fseek to beginning of file failed.");
       plhs[1] = mxCreateDoubleMatrix(1,1, mxREAL);
       pd = mxGetData(plhs[1]);
-      *pd = fsize;
+      *pd = fob->size;
    }
 }
 
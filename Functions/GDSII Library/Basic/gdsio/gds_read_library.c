@@ -0,0 +1,151 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Reads all structures and elements of a GDS II library file
+ * with a single call. The file must be positioned after the
+ * library header, i.e. after calling gds_libdata. All records
+ * are decoded before any MATLAB data are created, which avoids
+ * one MEX call per element and the growing of cell arrays.
+ *
+ * [slist, epos] = gds_read_library(gf, dbu_to_uu, single, nthreads, store, intxy);
+ *
+ * Input
+ * gf :        a file handle returned by gds_open.
+ * dbu_to_uu : conversion factor database units --> user units
+ * single :    (Optional) when ~= 0, only the structure following a
+ *             BGNSTR record header that was already read with
+ *             gds_record_info is returned. Default is 0.
+ * nthreads :  (Optional) number of threads used to decode the
+ *             structures of a memory mapped file. Default is 0, 
+ *             which uses all processors. Large structures are
+ *             divided between threads at element boundaries. The
+ *             structures and elements are returned in file order 
+ *             for any number of threads.
+ * store :     (Optional) when ~= 0, the elements of each structure
+ *             are returned in an element store (see gdsstore.h)
+ *             in the field store instead of the field el. When
+ *             store > 1 and the file is memory mapped, the stores
+ *             also keep the records of the elements, which are
+ *             copied to the output file when the elements were not
+ *             modified. Default is 0.
+ * intxy :     (Optional) when ~= 0, the xy matrices of the elements
+ *             are int32 matrices in database units instead of
+ *             double matrices in user units. Default is 0.
+ *
+ * Output:
+ * slist :  a 1 x N structure array with one entry per structure
+ *            slist(k).sname : structure name
+ *            slist(k).cdate : creation date
+ *            slist(k).mdate : modification date
+ *            slist(k).el    : cell array with element data, as
+ *                             returned by gds_read_element
+ *            slist(k).store : element store, when store ~= 0
+ * epos :   (Optional) 1 x N vector with the file position after
+ *          the ENDSTR record of each structure.
+ */
+
+#include <stdio.h>
+#include "gdsio.h"
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsread.h"
+#include "gdsstore.h"
+#include "mexfuncs.h"
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   gdsfile_t *gf;
+   double *pd;
+   lib_tables lt, *plt;
+   size_t k, n;
+   int single = 0;
+   int nthreads = 0;
+   int store = 0;
+   int intxy = 0;
+   int nlt, t;
+
+   /* check argument number */
+   if (nrhs < 2) {
+      mexErrMsgTxt("gds_read_library :  at least 2 input arguments expected.");
+   }
+
+   /* get file handle argument */
+   gf = get_file_ptr((mxArray *)prhs[0]);
+
+   /* get unit conversion factor: database units --> user units */
+   pd = mxGetData(prhs[1]);
+   init_tables(&lt, pd[0]);
+
+   /* read only one structure ? */
+   if (nrhs > 2 && !mxIsEmpty(prhs[2])) {
+      pd = mxGetData(prhs[2]);
+      single = (int)pd[0];
+   }
+
+   /* number of threads */
+   if (nrhs > 3 && !mxIsEmpty(prhs[3])) {
+      pd = mxGetData(prhs[3]);
+      nthreads = (int)pd[0];
+   }
+
+   /* return element stores ? */
+   if (nrhs > 4 && !mxIsEmpty(prhs[4])) {
+      pd = mxGetData(prhs[4]);
+      store = (int)pd[0];
+   }
+
+   /* coordinates in database units ? */
+   if (nrhs > 5 && !mxIsEmpty(prhs[5])) {
+      pd = mxGetData(prhs[5]);
+      intxy = (int)pd[0];
+   }
+
+   /* keep the element records for the stores ? */
+   if (store > 1)
+      lt.raw = gf->map;
+
+   /* decode all structures, then create MATLAB data */
+   plt = decode_library_mt(gf, lt.dbu_to_uu, nthreads, single, store > 1, &nlt);
+   if (plt == NULL) {
+      if (single)
+	 decode_structure(gf, &lt);
+      else
+	 decode_library(gf, &lt);
+      plt = &lt;
+      nlt = 1;
+   }
+   for (t=0; t<nlt; t++)
+      plt[t].intxy = intxy;
+   if (store)
+      plhs[0] = structures_to_store(plt, nlt);
+   else
+      plhs[0] = structures_to_mx(plt, nlt);
+
+   /* optionally return structure end positions */
+   if (nlhs > 1) {
+      plhs[1] = mxCreateDoubleMatrix(1, mxGetN(plhs[0]), mxREAL);
+      pd = mxGetData(plhs[1]);
+      for (n=0, t=0; t<nlt; t++) {
+	 for (k=0; k<plt[t].nst; k++) {
+	    if (plt[t].st[k].cont)
+	       pd[n-1] = plt[t].st[k].epos; /* split structure */
+	    else
+	       pd[n++] = plt[t].st[k].epos;
+	 }
+      }
+   }
+
+   if (plt == &lt)
+      free_tables(&lt);
+   else
+      free_tables_mt(plt, nlt);
+}
+
+/*-----------------------------------------------------------------*/
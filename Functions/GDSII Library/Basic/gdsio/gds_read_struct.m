@@ -1,37 +1,45 @@
-function [gst] = gds_read_struct(gf, uunit, dbunit)
+function [gst] = gds_read_struct(gf, uunit, dbunit, offset, dbu)
 %
 % read all elements contained in a structure and return 
 % a gds_structure object 
 %
+% gf :      file handle returned by gds_open
+% uunit :   user unit
+% dbunit :  database unit
+% offset :  (Optional) file position of the BGNSTR record of the
+%           structure, e.g. from a structure index created with
+%           gds_index. When omitted, the BGNSTR record header must 
+%           have been read with gds_record_info.
+% dbu :     (Optional) when > 0, the xy coordinates are int32 matrices
+%           in database units (see read_gds_library). Default is 0.
+%
 
 % renamed 'gdsii_read_struct' --> gds_read_struct' and rewritten
 % for the new C-based low level I/O. U. Griesmann, Jan. 2013
+% the structure is now decoded with a single call of gds_read_library 
+% instead of one gds_read_element call per element.
 
-% read structure header data
-[sname, cdate, mdate] = gds_structdata(gf);
-
-% read all elements belonging to it
-elist = {};
-while 1
-  
-   % read next record header (ignore record length) 
-   rtype = gds_record_info(gf);
-   
-   % ENDSTR - reached end of structure
-   if (rtype == 1792)
-      break
+% seek to the structure
+if nargin > 3 && ~isempty(offset)
+   gds_fseek(gf, offset);
+   if gds_record_info(gf) ~= 1282 % BGNSTR
+      error('gds_read_struct :  no structure at file position %d.', offset);
    end
-  
-   % if not, read element data
-   data = gds_read_element(gf, rtype, dbunit/uunit);
-   
-   % create element object and add to cell array
-   elist{end+1} = gds_element([], data);
-  
+end
+
+% read structure header data and all elements belonging to it
+if nargin < 5 || isempty(dbu), dbu = 0; end
+
+sdata = gds_read_library(gf, dbunit/uunit, 1, 0, 0, dbu);
+
+% create element objects
+elist = cellfun(@(x)gds_element([],x), sdata.el, 'UniformOutput',0);
+if isempty(elist)
+   elist = {};
 end
 
 % create a new GDS structure
-gst = gds_structure(sname, elist);
-gst = set(gst, 'cdate',cdate, 'mdate',mdate);
+gst = gds_structure(sdata.sname, elist);
+gst = set(gst, 'cdate',sdata.cdate, 'mdate',sdata.mdate);
 
 return
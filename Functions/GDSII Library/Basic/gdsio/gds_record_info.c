@@ -25,7 +25,7 @@ mexFunction(int nlhs, mxArray *plhs[],
 	    int nrhs, const mxArray *prhs[])
 {
    double *pda;              /* pointer to data*/
-   FILE *fob;                /* file object pointer */
+   gdsfile_t *fob;                /* file object pointer */
    uint16_t rtype, rlen;
 
 
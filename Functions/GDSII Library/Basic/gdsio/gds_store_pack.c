@@ -0,0 +1,67 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Creates an element store (see gdsstore.h) from the data of a 
+ * list of elements. Coordinates are stored in database units.
+ *
+ * store = gds_store_pack(el, uu_to_dbu);
+ *
+ * Input
+ * el :        cell array with element data structures as stored
+ *             in gds_element objects
+ * uu_to_dbu : conversion factor user units --> database units
+ *
+ * Output:
+ * store :     an element store with the elements
+ */
+
+#include <stdio.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsread.h"
+#include "gdscache.h"
+#include "gdsstore.h"
+#include "mexfuncs.h"
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   mxArray *slist, *ps;
+   lib_tables lt, *plt;
+   st_rec *pst;
+   double uu_to_dbu;
+   const char *fields[] = {"sname", "el"};
+
+   /* check argument number */
+   if (nrhs != 2) {
+      mexErrMsgTxt("gds_store_pack :  2 input arguments expected.");
+   }
+   if ( !mxIsEmpty(prhs[0]) && !mxIsCell(prhs[0]) )
+      mexErrMsgTxt("gds_store_pack :  elements must be in a cell array.");
+   uu_to_dbu = mxGetScalar(prhs[1]);
+
+   /* decode the elements as one structure */
+   ps = mxCreateStructMatrix(1, 1, 2, fields);
+   mxSetFieldByNumber(ps, 0, 0, mxCreateString("store"));
+   mxSetFieldByNumber(ps, 0, 1, (mxArray *)prhs[0]);
+   slist = mxCreateCellMatrix(1, 1);
+   mxSetCell(slist, 0, ps);
+
+   init_tables(&lt, 1.0 / uu_to_dbu);
+   tables_from_mx(slist, uu_to_dbu, &lt);
+   mxSetFieldByNumber(ps, 0, 1, NULL);  /* input is not destroyed */
+   mxDestroyArray(slist);
+
+   plt = &lt;
+   pst = &lt.st[0];
+   plhs[0] = tables_to_store(&plt, &pst, 1);
+   free_tables(&lt);
+}
+
+/*-----------------------------------------------------------------*/
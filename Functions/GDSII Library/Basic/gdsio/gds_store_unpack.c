@@ -0,0 +1,72 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Returns the data of elements in an element store (see gdsstore.h)
+ * as element data structures, which are stored in gds_element
+ * objects.
+ *
+ * el = gds_store_unpack(store, ind);
+ *
+ * Input
+ * store :     an element store
+ * ind :       (Optional) vector with indices of elements in the
+ *             store. Default is all elements.
+ *
+ * Output:
+ * el :        1 x N cell array with element data structures
+ */
+
+#include <stdio.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsread.h"
+#include "gdsstore.h"
+#include "mexfuncs.h"
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   store_view sv;
+   lib_tables lt;
+   size_t *ind = NULL;
+   size_t k, nind;
+   double *pd;
+
+   /* check argument number */
+   if (nrhs < 1 || nrhs > 2) {
+      mexErrMsgTxt("gds_store_unpack :  1 or 2 input arguments expected.");
+   }
+   get_store_view(prhs[0], &sv);
+
+   /* element indices */
+   nind = sv.nel;
+   if (nrhs > 1) {
+      nind = mxGetNumberOfElements(prhs[1]);
+      if ( nind && !mxIsDouble(prhs[1]) )
+	 mexErrMsgTxt("gds_store_unpack :  element indices must be double.");
+      pd = nind ? mxGetPr(prhs[1]) : NULL;
+      ind = (size_t *)mxMalloc((nind ? nind : 1) * sizeof(size_t));
+      for (k=0; k<nind; k++) {
+	 if (pd[k] < 1 || pd[k] > sv.nel)
+	    mexErrMsgTxt("gds_store_unpack :  element index out of range.");
+	 ind[k] = (size_t)pd[k] - 1;
+      }
+   }
+
+   init_tables(&lt, sv.dbu_to_uu);
+   store_to_tables(&sv, ind, nind, &lt);
+   mxFree(ind);
+
+   plhs[0] = mxCreateCellMatrix(1, nind);
+   for (k=0; k<nind; k++)
+      mxSetCell(plhs[0], k, element_to_mx(&lt, k));
+   free_tables(&lt);
+}
+
+/*-----------------------------------------------------------------*/
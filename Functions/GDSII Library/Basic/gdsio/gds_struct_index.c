@@ -0,0 +1,61 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Scans the structures of a GDS II library file without decoding 
+ * their elements and returns the location of each structure in 
+ * the file and the names of the structures it references. The
+ * file must be positioned after the library header, i.e. after
+ * calling gds_libdata.
+ *
+ * sidx = gds_struct_index(gf);
+ *
+ * Input
+ * gf :    a file handle returned by gds_open.
+ *
+ * Output:
+ * sidx :  a 1 x N structure array with one entry per structure
+ *            sidx(k).sname  : structure name
+ *            sidx(k).offset : file position of the BGNSTR record
+ *            sidx(k).length : number of bytes up to and including
+ *                             the ENDSTR record
+ *            sidx(k).numel  : number of elements in the structure
+ *            sidx(k).refs   : cell array with the names of the
+ *                             structures referenced by sref or 
+ *                             aref elements
+ */
+
+#include <stdio.h>
+#include "gdsio.h"
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsread.h"
+#include "mexfuncs.h"
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   gdsfile_t *gf;
+   lib_tables lt;
+
+   /* check argument number */
+   if (nrhs != 1) {
+      mexErrMsgTxt("gds_struct_index :  1 input argument expected.");
+   }
+
+   /* get file handle argument */
+   gf = get_file_ptr((mxArray *)prhs[0]);
+
+   /* scan the file */
+   init_tables(&lt, 1.0);
+   scan_library(gf, &lt);
+   plhs[0] = index_to_mx(&lt);
+   free_tables(&lt);
+}
+
+/*-----------------------------------------------------------------*/
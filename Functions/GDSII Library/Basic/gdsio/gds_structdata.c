@@ -30,7 +30,7 @@ void
 mexFunction(int nlhs, mxArray *plhs[], 
 	    int nrhs, const mxArray *prhs[])
 {
-   FILE *fob;          /* file object pointer */
+   gdsfile_t *fob;          /* file object pointer */
    double *pd;         /* pointer to data */
    date_t cdate;       /* creation date */
    date_t mdate;       /* modification date */
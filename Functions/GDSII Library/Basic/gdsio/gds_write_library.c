@@ -0,0 +1,72 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Writes a list of structures to a GDS II library file with a
+ * single call. Records are collected in the output buffer of the 
+ * file object and written to the file in large blocks. The records
+ * of large libraries are created by several threads and written
+ * in the order of the structure list.
+ *
+ * gds_write_library(gf, slist, uu_to_dbu, compound, nthreads);
+ *
+ * Input
+ * gf :        a file handle returned by gds_open
+ * slist :     a cell array of structures with fields
+ *               sname : structure name
+ *               el    : cell array with element data structures
+ *                       as stored in gds_element objects
+ * uu_to_dbu : conversion factor user units --> database units
+ * compound :  controls creation of compound elements.
+ * nthreads :  (Optional) number of threads used to create the
+ *             records. Default is 0 (all processors).
+ */
+
+#include <stdio.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsio.h"
+#include "gdswrite.h"
+#include "mexfuncs.h"
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   gdsfile_t *fob;
+   double *pd;
+   double uu_to_dbu;
+   int compound;
+   int nthreads = 0;
+
+   /* check argument number */
+   if (nrhs < 4) {
+      mexErrMsgTxt("gds_write_library :  at least 4 input arguments expected.");
+   }
+   
+   /* get file handle argument */
+   fob = get_file_ptr((mxArray *)prhs[0]);
+
+   /* get unit conversion factor user units --> database units */
+   pd = (double *)mxGetData(prhs[2]);
+   uu_to_dbu = pd[0];
+
+   /* compound element flag */
+   pd = (double *)mxGetData(prhs[3]);
+   compound = (int)pd[0];
+
+   /* number of threads */
+   if (nrhs > 4 && !mxIsEmpty(prhs[4]))
+      nthreads = (int)mxGetScalar(prhs[4]);
+
+   /* write all structures */
+   if ( mxIsEmpty(prhs[1]) )
+      return;
+   write_library_data(fob, prhs[1], uu_to_dbu, compound, nthreads);
+}
+
+/*-----------------------------------------------------------------*/
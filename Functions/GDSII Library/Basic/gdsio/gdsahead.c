@@ -0,0 +1,422 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Read-ahead streams for GDS II files. See gdsahead.h.
+ *
+ * The stream owns two blocks. The background thread reads the file
+ * into a block that is not in use by the decoder and then moves on
+ * to the other block; the decoder copies records from its current
+ * block and hands the block back to the thread when it is used up.
+ * Only the thread calls fread and fseek on the stdio stream. A seek
+ * outside of the blocks in memory discards both blocks and restarts
+ * the thread at the new position; blocks that were being read when 
+ * the seek was requested are recognized by their generation number
+ * and dropped.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "gdsahead.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+   #define HAVE_THREADS
+   #include <pthread.h>
+   #include <time.h>
+#endif
+
+#define AHEAD_BLOCK  4194304     /* 4 MB blocks */
+
+
+#ifdef HAVE_THREADS
+
+/* read-ahead threads of this module that have not ended */
+static int nactive = 0;
+static pthread_mutex_t active_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+/*-- Types --------------------------------------------------------*/
+
+struct gds_ahead {
+   pthread_t thr;
+   pthread_mutex_t mtx;
+   pthread_cond_t cnd;   /* signals changes of the block states */
+   uint8_t *blk[2];      /* data blocks */
+   size_t len[2];        /* bytes in blocks */
+   long off[2];          /* file positions of blocks */
+   int full[2];          /* block contains data for the decoder */
+   int fill;             /* block the thread reads next */
+   long fpos;            /* file position of the next block */
+   long tpos;            /* position of the stdio stream */
+   unsigned gen;         /* incremented by each discarding seek */
+   int eof, err, stop;
+
+   /* owned by the decoder */
+   int cur;              /* current block */
+   int have;             /* the current block is full */
+   size_t rpos;          /* read position in current block */
+   long pos;             /* file position */
+
+   /* statistics */
+   double bytes;
+   double io_time;
+   double wait_time;
+   double t_start;
+};
+
+
+/*-----------------------------------------------------------------*/
+
+static double
+seconds(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * body of the read-ahead thread
+ */
+static void*
+read_blocks(void *arg)
+{
+   gdsfile_t *gf = (gdsfile_t *)arg;
+   struct gds_ahead *ra = gf->ra;
+   unsigned gen;
+   long pos;
+   size_t n;
+   double t0, dt;
+   int b, ioerr;
+
+   pthread_mutex_lock(&ra->mtx);
+   while ( !ra->stop ) {
+
+      /* wait for an empty block */
+      if (ra->eof || ra->err || ra->full[ra->fill]) {
+	 pthread_cond_wait(&ra->cnd, &ra->mtx);
+	 continue;
+      }
+      b = ra->fill;
+      pos = ra->fpos;
+      gen = ra->gen;
+      pthread_mutex_unlock(&ra->mtx);
+
+      /* read the block without holding the lock */
+      t0 = seconds();
+      ioerr = 0;
+      n = 0;
+      if (pos != ra->tpos && fseek(gf->fob, pos, SEEK_SET))
+	 ioerr = 1;
+      else {
+	 n = fread(ra->blk[b], sizeof(uint8_t), AHEAD_BLOCK, gf->fob);
+	 if (n < AHEAD_BLOCK && ferror(gf->fob))
+	    ioerr = 1;
+	 ra->tpos = pos + n;
+      }
+      dt = seconds() - t0;
+
+      pthread_mutex_lock(&ra->mtx);
+      ra->io_time += dt;
+      if (gen != ra->gen)
+	 continue;  /* a seek made the block obsolete */
+      ra->len[b] = n;
+      ra->off[b] = pos;
+      ra->full[b] = 1;
+      ra->fpos = pos + n;
+      ra->fill = 1 - b;
+      if (ioerr)
+	 ra->err = 1;
+      else if (n < AHEAD_BLOCK)
+	 ra->eof = 1;
+      pthread_cond_broadcast(&ra->cnd);
+   }
+   pthread_mutex_unlock(&ra->mtx);
+
+   pthread_mutex_lock(&active_mtx);
+   nactive -= 1;
+   pthread_mutex_unlock(&active_mtx);
+
+   return NULL;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * return the current block to the thread and wait for the next one.
+ * Returns 0 when the next block is available, -1 at the end of the
+ * file or on error.
+ */
+static int
+next_block(struct gds_ahead *ra)
+{
+   double t0;
+
+   pthread_mutex_lock(&ra->mtx);
+   if (ra->have) {
+      ra->full[ra->cur] = 0;
+      ra->cur = 1 - ra->cur;
+      ra->have = 0;
+      pthread_cond_broadcast(&ra->cnd);
+   }
+   if ( !ra->full[ra->cur] && !ra->eof && !ra->err ) {
+      t0 = seconds();
+      while ( !ra->full[ra->cur] && !ra->eof && !ra->err )
+	 pthread_cond_wait(&ra->cnd, &ra->mtx);
+      ra->wait_time += seconds() - t0;
+   }
+   ra->have = ra->full[ra->cur];
+   pthread_mutex_unlock(&ra->mtx);
+
+   ra->rpos = 0;
+   return ra->have ? 0 : -1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+int
+gdsahead_open(gdsfile_t *gf)
+{
+   struct gds_ahead *ra;
+   long pos;
+
+   pos = ftell(gf->fob);
+   if (pos < 0)
+      return -1;
+
+   ra = (struct gds_ahead *)calloc(1, sizeof(struct gds_ahead));
+   if (ra == NULL)
+      return -1;
+   ra->blk[0] = (uint8_t *)malloc(AHEAD_BLOCK);
+   ra->blk[1] = (uint8_t *)malloc(AHEAD_BLOCK);
+   if (ra->blk[0] == NULL || ra->blk[1] == NULL)
+      goto fail;
+   ra->fpos = ra->tpos = ra->pos = pos;
+   ra->t_start = seconds();
+
+   if ( pthread_mutex_init(&ra->mtx, NULL) )
+      goto fail;
+   if ( pthread_cond_init(&ra->cnd, NULL) ) {
+      pthread_mutex_destroy(&ra->mtx);
+      goto fail;
+   }
+
+   gf->ra = ra;
+   pthread_mutex_lock(&active_mtx);
+   if ( pthread_create(&ra->thr, NULL, read_blocks, gf) ) {
+      pthread_mutex_unlock(&active_mtx);
+      gf->ra = NULL;
+      pthread_cond_destroy(&ra->cnd);
+      pthread_mutex_destroy(&ra->mtx);
+      goto fail;
+   }
+   nactive += 1;
+   pthread_mutex_unlock(&active_mtx);
+
+   return 0;
+
+ fail:
+   free(ra->blk[0]);
+   free(ra->blk[1]);
+   free(ra);
+   return -1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+gdsahead_close(gdsfile_t *gf)
+{
+   struct gds_ahead *ra = gf->ra;
+
+   pthread_mutex_lock(&ra->mtx);
+   ra->stop = 1;
+   pthread_cond_broadcast(&ra->cnd);
+   pthread_mutex_unlock(&ra->mtx);
+   pthread_join(ra->thr, NULL);
+
+   pthread_cond_destroy(&ra->cnd);
+   pthread_mutex_destroy(&ra->mtx);
+   free(ra->blk[0]);
+   free(ra->blk[1]);
+   free(ra);
+   gf->ra = NULL;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+int
+gdsahead_active(void)
+{
+   int n;
+
+   pthread_mutex_lock(&active_mtx);
+   n = nactive;
+   pthread_mutex_unlock(&active_mtx);
+
+   return n;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+size_t
+gdsahead_read(gdsfile_t *gf, void *buf, size_t nb)
+{
+   struct gds_ahead *ra = gf->ra;
+   uint8_t *pb = (uint8_t *)buf;
+   size_t n, nr = 0;
+
+   while (nr < nb) {
+      if ( !ra->have || ra->rpos == ra->len[ra->cur] ) {
+	 if ( next_block(ra) )
+	    break;
+	 continue;
+      }
+      n = ra->len[ra->cur] - ra->rpos;
+      if (n > nb - nr)
+	 n = nb - nr;
+      memcpy(pb + nr, ra->blk[ra->cur] + ra->rpos, n);
+      ra->rpos += n;
+      nr += n;
+   }
+
+   ra->pos += nr;
+   ra->bytes += nr;
+   return nr;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+long
+gdsahead_tell(gdsfile_t *gf)
+{
+   return gf->ra->pos;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+int
+gdsahead_seek(gdsfile_t *gf, long pos)
+{
+   struct gds_ahead *ra = gf->ra;
+   int c, nxt;
+
+   if (pos < 0 || (size_t)pos > gf->size)
+      return -1;
+
+   /* position in the current block */
+   c = ra->cur;
+   if (ra->have && pos >= ra->off[c] && pos <= ra->off[c] + (long)ra->len[c]) {
+      ra->rpos = pos - ra->off[c];
+      ra->pos = pos;
+      return 0;
+   }
+
+   pthread_mutex_lock(&ra->mtx);
+
+   /* position in the next block */
+   nxt = ra->have ? 1 - c : c;
+   if (ra->full[nxt] && pos >= ra->off[nxt] && 
+       pos <= ra->off[nxt] + (long)ra->len[nxt]) {
+      if (ra->have) {
+	 ra->full[c] = 0;
+	 ra->cur = nxt;
+	 pthread_cond_broadcast(&ra->cnd);
+      }
+      ra->have = 1;
+      ra->rpos = pos - ra->off[nxt];
+      ra->pos = pos;
+      pthread_mutex_unlock(&ra->mtx);
+      return 0;
+   }
+
+   /* discard both blocks and restart the thread */
+   ra->gen++;
+   ra->full[0] = ra->full[1] = 0;
+   ra->fill = ra->cur;
+   ra->fpos = pos;
+   ra->eof = ra->err = 0;
+   ra->have = 0;
+   ra->rpos = 0;
+   ra->pos = pos;
+   pthread_cond_broadcast(&ra->cnd);
+   pthread_mutex_unlock(&ra->mtx);
+
+   return 0;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+gdsahead_stats(gdsfile_t *gf, ahead_stats *st)
+{
+   struct gds_ahead *ra = gf->ra;
+
+   pthread_mutex_lock(&ra->mtx);
+   st->bytes = ra->bytes;
+   st->elapsed = seconds() - ra->t_start;
+   st->io_time = ra->io_time;
+   st->wait_time = ra->wait_time;
+   pthread_mutex_unlock(&ra->mtx);
+}
+
+
+#else  /* no threads */
+
+/*-----------------------------------------------------------------*/
+
+int
+gdsahead_open(gdsfile_t *gf)
+{
+   return -1;
+}
+
+void
+gdsahead_close(gdsfile_t *gf)
+{
+}
+
+int
+gdsahead_active(void)
+{
+   return 0;
+}
+
+size_t
+gdsahead_read(gdsfile_t *gf, void *buf, size_t nb)
+{
+   return 0;
+}
+
+long
+gdsahead_tell(gdsfile_t *gf)
+{
+   return -1;
+}
+
+int
+gdsahead_seek(gdsfile_t *gf, long pos)
+{
+   return -1;
+}
+
+void
+gdsahead_stats(gdsfile_t *gf, ahead_stats *st)
+{
+   memset(st, 0, sizeof(ahead_stats));
+}
+
+#endif /* HAVE_THREADS */
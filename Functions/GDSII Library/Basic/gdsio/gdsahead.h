@@ -0,0 +1,78 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Read-ahead streams for GDS II files that are read with stdio.
+ * A background thread reads the file in large blocks into two 
+ * buffers: while the records in one buffer are decoded, the next
+ * block is read into the other buffer. The stream records how long
+ * the thread spent reading and how long the decoder waited for
+ * data, which shows whether reading a file is limited by the
+ * storage (I/O-bound) or by decoding (CPU-bound). Read-ahead
+ * streams need POSIX threads; on other platforms gdsahead_open
+ * fails and the file is read without read-ahead.
+ */
+
+#ifndef _GDSAHEAD_H
+#define _GDSAHEAD_H
+
+#include "gdsio.h"
+
+
+/*-- Types --------------------------------------------------------*/
+
+/*
+ * read-ahead statistics
+ */
+typedef struct {
+   double bytes;        /* bytes delivered to the decoder */
+   double elapsed;      /* seconds since the file was opened */
+   double io_time;      /* seconds the thread spent reading */
+   double wait_time;    /* seconds the decoder waited for data */
+} ahead_stats;
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * start a read-ahead thread for the stdio stream of a file opened
+ * for reading. Returns 0 on success and -1 on failure; the file 
+ * is then read directly from the stream.
+ */
+int gdsahead_open(gdsfile_t *gf);
+
+/*
+ * stop the read-ahead thread and release the buffers. The stdio
+ * stream must be closed by the caller.
+ */
+void gdsahead_close(gdsfile_t *gf);
+
+/*
+ * return the number of read-ahead threads started by the calling
+ * MEX function that have not ended. The threads run code of that 
+ * MEX function, which must not be unloaded while they exist.
+ */
+int gdsahead_active(void);
+
+/*
+ * copy up to nb bytes into buf. Returns the number of bytes
+ * copied, which is less than nb at the end of the file or on error.
+ */
+size_t gdsahead_read(gdsfile_t *gf, void *buf, size_t nb);
+
+/*
+ * return the read position
+ */
+long gdsahead_tell(gdsfile_t *gf);
+
+/*
+ * set the read position. Returns 0 on success and -1 on failure.
+ */
+int gdsahead_seek(gdsfile_t *gf, long pos);
+
+/*
+ * return the statistics of the read-ahead stream
+ */
+void gdsahead_stats(gdsfile_t *gf, ahead_stats *st);
+
+#endif /* _GDSAHEAD_H */
@@ -0,0 +1,538 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Functions for writing and loading layout cache files. A cache
+ * file consists of a fixed size header followed by the tables of
+ * the GDS II reader, each aligned to 8 bytes:
+ *
+ *   header | st_rec[] | el_rec[] | xy_rec[] | prop_rec[] |
+ *   int32_t vertices[] | char strings[] | long refs[]
+ *
+ * The header records the sizes of the table records and the byte
+ * order of the writing host; cache files are not portable between
+ * platforms with different ABIs and are rejected there. They can
+ * always be recreated from the layout file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsio.h"
+#include "gdsread.h"
+#include "gdscache.h"
+#include "mexfuncs.h"
+#include "byteswap.h"
+
+#define CACHE_MAGIC     "GDSCACHE"
+#define CACHE_VERSION   1
+#define CACHE_ENDIAN    0x01020304U
+
+/* table indices in the cache header */
+#define T_ST    0
+#define T_EL    1
+#define T_XY    2
+#define T_PROP  3
+#define T_VTX   4
+#define T_STR   5
+#define T_REF   6
+#define NTABLE  7
+
+/* tables are written in pieces of this size */
+#define WCHUNK  (1<<30)
+
+/* pieces of at least this size bypass the output buffer */
+#define WDIRECT 65536
+
+/* longest text string and property value */
+#define TXTLEN  512
+#define VLEN    128
+
+
+/*-- Local Types --------------------------------------------------*/
+
+typedef struct {
+   char magic[8];       /* CACHE_MAGIC */
+   uint32_t version;    /* CACHE_VERSION */
+   uint32_t endian;     /* CACHE_ENDIAN in host byte order */
+   uint32_t recsz[5];   /* sizes of st_rec, el_rec, xy_rec, prop_rec, long */
+   uint32_t pad;
+   double uunit;
+   double dbunit;
+   char lname[256];
+   uint64_t n[NTABLE];  /* number of table entries */
+   uint64_t off[NTABLE];/* file offsets of the tables */
+} cache_hdr;
+
+
+/*-- Local Functions ----------------------------------------------*/
+
+static void set_record_sizes(uint32_t *recsz);
+static void* grow(void *p, size_t *mcur, size_t need, size_t esz);
+static long add_string(lib_tables *lt, const char *s);
+static void add_xy(lib_tables *lt, el_rec *pe, const mxArray *pa, double uu_to_dbu);
+static void add_props(lib_tables *lt, el_rec *pe, const mxArray *pprop);
+static void add_refs(lib_tables *lt, st_rec *ps);
+static void get_date(const mxArray *ps, const char *field, date_t dv);
+static void write_bytes(gdsfile_t *gf, const void *p, size_t nb);
+
+
+/*-----------------------------------------------------------------*/
+
+void
+tables_from_mx(const mxArray *slist, double uu_to_dbu, lib_tables *lt)
+{
+   mxArray *ps, *pel, *pdata, *pa;
+   st_rec *pst;
+   el_rec *pe;
+   size_t k, n, nel;
+   char text[TXTLEN];
+
+   if ( !mxIsCell(slist) )
+      mexErrMsgTxt("gds_cache_write :  structure list must be a cell array.");
+
+   for (k=0; k<mxGetNumberOfElements(slist); k++) {
+
+      ps = mxGetCell(slist, k);
+      if (ps == NULL || !mxIsStruct(ps))
+	 mexErrMsgTxt("gds_cache_write :  structure list entries must be structures.");
+
+      lt->st = grow(lt->st, &lt->mst, lt->nst+1, sizeof(st_rec));
+      pst = &lt->st[lt->nst];
+      memset(pst, 0, sizeof(st_rec));
+
+      if ( !get_field_ptr(ps, "sname", &pa) )
+	 mexErrMsgTxt("gds_cache_write :  missing structure name.");
+      mxGetString(pa, pst->sname, sizeof(pst->sname));
+      get_date(ps, "cdate", pst->cdate);
+      get_date(ps, "mdate", pst->mdate);
+
+      /* elements */
+      pst->el = lt->nel;
+      nel = 0;
+      if ( get_field_ptr(ps, "el", &pel) ) {
+	 if ( !mxIsCell(pel) )
+	    mexErrMsgTxt("gds_cache_write :  elements must be in a cell array.");
+	 nel = mxGetNumberOfElements(pel);
+      }
+
+      for (n=0; n<nel; n++) {
+
+	 pdata = mxGetCell(pel, n);
+	 if ( pdata == NULL || !get_field_ptr(pdata, "internal", &pa) )
+	    mexErrMsgTxt("gds_cache_write :  missing internal element data.");
+
+	 lt->el = grow(lt->el, &lt->mel, lt->nel+1, sizeof(el_rec));
+	 pe = &lt->el[lt->nel];
+	 memset(pe, 0, sizeof(el_rec));
+	 memcpy(&pe->internal, mxGetData(pa), sizeof(element_t));
+	 pe->xy = lt->nxy;
+	 pe->prop = lt->nprop;
+	 pe->text = -1;
+
+	 if ( get_field_ptr(pdata, "xy", &pa) )
+	    add_xy(lt, pe, pa, uu_to_dbu);
+
+	 if ( get_field_ptr(pdata, "prop", &pa) )
+	    add_props(lt, pe, pa);
+
+	 if (pe->internal.kind == GDS_TEXT && get_field_ptr(pdata, "text", &pa)) {
+	    mxGetString(pa, text, TXTLEN);
+	    pe->text = add_string(lt, text);
+	 }
+
+	 lt->nel += 1;
+      }
+      pst = &lt->st[lt->nst];
+      pst->nel = nel;
+
+      /* the position in the cache replaces the file position */
+      pst->spos = lt->nst;
+      pst->epos = lt->nst + 1;
+
+      add_refs(lt, pst);
+      lt->nst += 1;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+write_cache(const char *fname, lib_tables *lt, const cache_info *ci)
+{
+   gdsfile_t *gf;
+   cache_hdr hdr;
+   const void *tab[NTABLE];
+   size_t esz[NTABLE];
+   uint64_t pos;
+   uint8_t zero[8];
+   size_t n;
+   int k;
+
+   memset(&hdr, 0, sizeof(cache_hdr));
+   memcpy(hdr.magic, CACHE_MAGIC, 8);
+   hdr.version = CACHE_VERSION;
+   hdr.endian = CACHE_ENDIAN;
+   set_record_sizes(hdr.recsz);
+   hdr.uunit = ci->uunit;
+   hdr.dbunit = ci->dbunit;
+   n = strlen(ci->lname);
+   if (n >= sizeof(hdr.lname))
+      n = sizeof(hdr.lname) - 1;
+   memcpy(hdr.lname, ci->lname, n);
+
+   tab[T_ST] = lt->st;     hdr.n[T_ST] = lt->nst;     esz[T_ST] = sizeof(st_rec);
+   tab[T_EL] = lt->el;     hdr.n[T_EL] = lt->nel;     esz[T_EL] = sizeof(el_rec);
+   tab[T_XY] = lt->xy;     hdr.n[T_XY] = lt->nxy;     esz[T_XY] = sizeof(xy_rec);
+   tab[T_PROP] = lt->prop; hdr.n[T_PROP] = lt->nprop; esz[T_PROP] = sizeof(prop_rec);
+   tab[T_VTX] = lt->vtx;   hdr.n[T_VTX] = lt->nvtx;   esz[T_VTX] = sizeof(int32_t);
+   tab[T_STR] = lt->str;   hdr.n[T_STR] = lt->nstr;   esz[T_STR] = sizeof(char);
+   tab[T_REF] = lt->ref;   hdr.n[T_REF] = lt->nref;   esz[T_REF] = sizeof(long);
+
+   /* table offsets */
+   pos = sizeof(cache_hdr);
+   for (k=0; k<NTABLE; k++) {
+      pos = (pos + 7) & ~(uint64_t)7;
+      hdr.off[k] = pos;
+      pos += hdr.n[k] * esz[k];
+   }
+
+   gf = gdsfile_open(fname, "wb");
+   if (gf == NULL)
+      mexErrMsgTxt("gds_cache_write :  could not open cache file.");
+
+   memset(zero, 0, sizeof(zero));
+   write_bytes(gf, &hdr, sizeof(cache_hdr));
+   pos = sizeof(cache_hdr);
+   for (k=0; k<NTABLE; k++) {
+      write_bytes(gf, zero, hdr.off[k] - pos);
+      write_bytes(gf, tab[k], hdr.n[k] * esz[k]);
+      pos = hdr.off[k] + hdr.n[k] * esz[k];
+   }
+
+   if ( gdsfile_close(gf) )
+      mexErrMsgTxt("gds_cache_write :  failed to write cache file.");
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void *
+map_cache(gdsfile_t *gf, lib_tables *lt, cache_info *ci)
+{
+   cache_hdr hdr;
+   uint32_t recsz[5];
+   uint8_t *base, *buf = NULL;
+   size_t esz[NTABLE];
+   size_t k;
+
+   /* header */
+   if (gf->size < sizeof(cache_hdr))
+      mexErrMsgTxt("gds_cache_read :  not a layout cache file.");
+   if (gf->map)
+      memcpy(&hdr, gf->map, sizeof(cache_hdr));
+   else if (gdsfile_read(gf, &hdr, sizeof(cache_hdr)) != sizeof(cache_hdr))
+      mexErrMsgTxt("gds_cache_read :  failed to read cache file header.");
+
+   if ( memcmp(hdr.magic, CACHE_MAGIC, 8) )
+      mexErrMsgTxt("gds_cache_read :  not a layout cache file.");
+   if (hdr.version != CACHE_VERSION)
+      mexErrMsgTxt("gds_cache_read :  unsupported cache file version.");
+   set_record_sizes(recsz);
+   if (hdr.endian != CACHE_ENDIAN || memcmp(recsz, hdr.recsz, sizeof(recsz)))
+      mexErrMsgTxt("gds_cache_read :  cache file was written on an incompatible platform.");
+
+   esz[T_ST] = sizeof(st_rec);
+   esz[T_EL] = sizeof(el_rec);
+   esz[T_XY] = sizeof(xy_rec);
+   esz[T_PROP] = sizeof(prop_rec);
+   esz[T_VTX] = sizeof(int32_t);
+   esz[T_STR] = sizeof(char);
+   esz[T_REF] = sizeof(long);
+   for (k=0; k<NTABLE; k++) {
+      if (hdr.off[k] > gf->size || hdr.off[k] % 8 ||
+	  hdr.n[k] > (gf->size - hdr.off[k]) / esz[k])
+	 mexErrMsgTxt("gds_cache_read :  cache file is truncated or corrupt.");
+   }
+
+   /* tables in the mapped file or in a buffer */
+   if (gf->map)
+      base = gf->map;
+   else {
+      buf = mxMalloc(gf->size);
+      memcpy(buf, &hdr, sizeof(cache_hdr));
+      if (gdsfile_read(gf, buf + sizeof(cache_hdr), gf->size - sizeof(cache_hdr)) !=
+	  gf->size - sizeof(cache_hdr))
+	 mexErrMsgTxt("gds_cache_read :  failed to read cache file.");
+      base = buf;
+   }
+
+   init_tables(lt, hdr.dbunit / hdr.uunit);
+   lt->st   = (st_rec *)(base + hdr.off[T_ST]);     lt->nst   = hdr.n[T_ST];
+   lt->el   = (el_rec *)(base + hdr.off[T_EL]);     lt->nel   = hdr.n[T_EL];
+   lt->xy   = (xy_rec *)(base + hdr.off[T_XY]);     lt->nxy   = hdr.n[T_XY];
+   lt->prop = (prop_rec *)(base + hdr.off[T_PROP]); lt->nprop = hdr.n[T_PROP];
+   lt->vtx  = (int32_t *)(base + hdr.off[T_VTX]);   lt->nvtx  = hdr.n[T_VTX];
+   lt->str  = (char *)(base + hdr.off[T_STR]);      lt->nstr  = hdr.n[T_STR];
+   lt->ref  = (long *)(base + hdr.off[T_REF]);      lt->nref  = hdr.n[T_REF];
+
+   /* references into the tables must stay inside the tables */
+   for (k=0; k<lt->nst; k++) {
+      if (lt->st[k].el + lt->st[k].nel > lt->nel || lt->st[k].nel > lt->nel ||
+	  lt->st[k].nref < 0 || lt->st[k].ref + lt->st[k].nref > lt->nref)
+	 mexErrMsgTxt("gds_cache_read :  cache file is corrupt.");
+      if ( memchr(lt->st[k].sname, '\0', sizeof(lt->st[k].sname)) == NULL )
+	 mexErrMsgTxt("gds_cache_read :  cache file is corrupt.");
+   }
+   if (lt->nstr && lt->str[lt->nstr-1] != '\0')
+      mexErrMsgTxt("gds_cache_read :  cache file is corrupt.");
+   for (k=0; k<lt->nref; k++) {
+      if (lt->ref[k] < 0 || lt->ref[k] >= (long)lt->nstr)
+	 mexErrMsgTxt("gds_cache_read :  cache file is corrupt.");
+   }
+
+   strncpy(ci->lname, hdr.lname, sizeof(ci->lname)-1);
+   ci->lname[sizeof(ci->lname)-1] = '\0';
+   ci->uunit = hdr.uunit;
+   ci->dbunit = hdr.dbunit;
+
+   return buf;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+check_cache_structure(lib_tables *lt, size_t k)
+{
+   st_rec *ps;
+   el_rec *pe;
+   xy_rec *pxy;
+   size_t n;
+   int j;
+
+   ps = &lt->st[k];
+   for (n=ps->el; n<ps->el+ps->nel; n++) {
+      pe = &lt->el[n];
+      if (pe->nxy < 0 || pe->xy > lt->nxy || (size_t)pe->nxy > lt->nxy - pe->xy ||
+	  pe->nslot < 0 || pe->prop > lt->nprop || (size_t)pe->nslot > lt->nprop - pe->prop ||
+	  pe->text >= (long)lt->nstr)
+	 mexErrMsgTxt("gds_cache_read :  cache file is corrupt.");
+      if ((pe->internal.kind == GDS_SREF || pe->internal.kind == GDS_AREF) &&
+	  memchr(pe->internal.sname, '\0', sizeof(pe->internal.sname)) == NULL)
+	 mexErrMsgTxt("gds_cache_read :  cache file is corrupt.");
+      for (j=0; j<pe->nxy; j++) {
+	 pxy = &lt->xy[pe->xy + j];
+	 if (pxy->m < 0 || pxy->off > lt->nvtx || 2*(size_t)pxy->m > lt->nvtx - pxy->off)
+	    mexErrMsgTxt("gds_cache_read :  cache file is corrupt.");
+      }
+      for (j=0; j<pe->nslot; j++) {
+	 if (lt->prop[pe->prop + j].name >= (long)lt->nstr)
+	    mexErrMsgTxt("gds_cache_read :  cache file is corrupt.");
+      }
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+set_record_sizes(uint32_t *recsz)
+{
+   recsz[0] = sizeof(st_rec);
+   recsz[1] = sizeof(el_rec);
+   recsz[2] = sizeof(xy_rec);
+   recsz[3] = sizeof(prop_rec);
+   recsz[4] = sizeof(long);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void*
+grow(void *p, size_t *mcur, size_t need, size_t esz)
+{
+   size_t m;
+
+   if (need <= *mcur)
+      return p;
+
+   m = *mcur < 64 ? 64 : *mcur;
+   while (m < need)
+      m *= 2;
+   *mcur = m;
+
+   return mxRealloc(p, m*esz);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static long
+add_string(lib_tables *lt, const char *s)
+{
+   size_t n;
+   long off;
+
+   n = strlen(s);
+   lt->str = grow(lt->str, &lt->mstr, lt->nstr+n+1, sizeof(char));
+   off = lt->nstr;
+   memcpy(lt->str + off, s, n+1);
+   lt->nstr += n+1;
+
+   return off;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * boundaries and paths have a cell array with one matrix per
+ * XY record; all other elements have a single matrix.
+ */
+static void
+add_xy(lib_tables *lt, el_rec *pe, const mxArray *pa, double uu_to_dbu)
+{
+   const mxArray *pm;
+   const int32_t *pi;
+   xy_rec *pxy;
+   size_t k, n;
+   int m;
+
+   n = mxIsCell(pa) ? mxGetNumberOfElements(pa) : 1;
+
+   for (k=0; k<n; k++) {
+      pm = mxIsCell(pa) ? mxGetCell(pa, k) : pa;
+      if (pm == NULL || mxIsEmpty(pm))
+	 continue;
+      if ( !(mxIsDouble(pm) || mxIsInt32(pm)) || mxGetN(pm) != 2 )
+	 mexErrMsgTxt("gds_cache_write :  xy must be an n x 2 matrix.");
+      m = mxGetM(pm);
+
+      lt->vtx = grow(lt->vtx, &lt->mvtx, lt->nvtx + 2*m, sizeof(int32_t));
+      if ( mxIsInt32(pm) ) {   /* already in database units */
+	 pi = (const int32_t *)mxGetData(pm);
+	 int32_xy_to_be32(pi, pi+m, (uint8_t *)(lt->vtx + lt->nvtx), m);
+      }
+      else
+	 double_xy_to_be32(mxGetPr(pm), mxGetPr(pm)+m, (uint8_t *)(lt->vtx + lt->nvtx),
+			   m, uu_to_dbu);
+
+      lt->xy = grow(lt->xy, &lt->mxy, lt->nxy+1, sizeof(xy_rec));
+      pxy = &lt->xy[lt->nxy++];
+      pxy->off = lt->nvtx;
+      pxy->m = m;
+      lt->nvtx += 2*m;
+      pe->nxy += 1;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+add_props(lib_tables *lt, el_rec *pe, const mxArray *pprop)
+{
+   mxArray *pa;
+   prop_rec *pp;
+   size_t k;
+   char value[VLEN];
+
+   if ( !mxIsStruct(pprop) )
+      return;
+
+   for (k=0; k<mxGetNumberOfElements(pprop); k++) {
+      lt->prop = grow(lt->prop, &lt->mprop, lt->nprop+1, sizeof(prop_rec));
+      pp = &lt->prop[lt->nprop++];
+      pa = mxGetField(pprop, k, "attr");
+      pp->attr = (pa != NULL && !mxIsEmpty(pa)) ? (int16_t)mxGetScalar(pa) : 0;
+      pa = mxGetField(pprop, k, "name");
+      if (pa != NULL && mxIsChar(pa)) {
+	 mxGetString(pa, value, VLEN);
+	 pp->name = add_string(lt, value);
+	 pe->nval += 1;
+      }
+      else
+	 pp->name = -1;
+      pe->nslot += 1;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* records the distinct names of the structures referenced in ps */
+static void
+add_refs(lib_tables *lt, st_rec *ps)
+{
+   el_rec *pe;
+   size_t k;
+   int n;
+
+   ps->ref = lt->nref;
+   for (k=ps->el; k<ps->el+ps->nel; k++) {
+      pe = &lt->el[k];
+      if (pe->internal.kind != GDS_SREF && pe->internal.kind != GDS_AREF)
+	 continue;
+      for (n=0; n<ps->nref; n++) {
+	 if ( !strcmp(lt->str + lt->ref[ps->ref + n], pe->internal.sname) )
+	    break;
+      }
+      if (n < ps->nref)
+	 continue;
+      lt->ref = grow(lt->ref, &lt->mref, lt->nref+1, sizeof(long));
+      lt->ref[lt->nref++] = add_string(lt, pe->internal.sname);
+      ps->nref += 1;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* structure dates; missing dates are set to the current date */
+static void
+get_date(const mxArray *ps, const char *field, date_t dv)
+{
+   mxArray *pa;
+   double *pd;
+   int k;
+
+   if ( get_field_ptr((mxArray *)ps, (char *)field, &pa) &&
+	mxIsDouble(pa) && mxGetNumberOfElements(pa) == 6 ) {
+      pd = mxGetPr(pa);
+      for (k=0; k<6; k++)
+	 dv[k] = (uint16_t)pd[k];
+   }
+   else
+      now(dv);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* large tables are written directly, not through the output buffer */
+static void
+write_bytes(gdsfile_t *gf, const void *p, size_t nb)
+{
+   size_t n;
+   err_id err;
+
+   while (nb) {
+      n = nb > WCHUNK ? WCHUNK : nb;
+      if (n >= WDIRECT)
+	 err = gdsfile_write(gf, p, n);
+      else
+	 err = write_string(gf, (char *)p, (int)n);
+      if (err)
+	 mexErrMsgTxt("gds_cache_write :  failed to write cache file.");
+      p = (const uint8_t *)p + n;
+      nb -= n;
+   }
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,64 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Layout cache files. A cache file stores the decoding tables of
+ * the GDS II reader (gdsread.h): the structure table, the element
+ * table, the XY record table, the property table, one contiguous
+ * vertex pool, and the string pool. The tables are stored in the
+ * byte order of the host and are used directly from the memory
+ * mapped file, which makes loading a cache almost free; MATLAB data
+ * are only created for the structures that are requested.
+ */
+
+#ifndef _GDSCACHE_H
+#define _GDSCACHE_H
+
+#include "mex.h"
+#include "gdsio.h"
+#include "gdsread.h"
+
+
+/*-- Types --------------------------------------------------------*/
+
+/*
+ * library data stored in a cache file
+ */
+typedef struct {
+   char lname[256];     /* library name */
+   double uunit;        /* user unit in m */
+   double dbunit;       /* database unit in m */
+} cache_info;
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * append the structures in slist to the tables lt. slist is a cell
+ * array of structures with fields sname, el (cell array with element
+ * data structures), and optionally cdate and mdate. Coordinates are
+ * converted to database units with the factor uu_to_dbu.
+ */
+void tables_from_mx(const mxArray *slist, double uu_to_dbu, lib_tables *lt);
+
+/*
+ * write the tables lt and the library data ci to a cache file
+ */
+void write_cache(const char *fname, lib_tables *lt, const cache_info *ci);
+
+/*
+ * set up the tables lt for the cache file gf, which was opened for
+ * reading. When the file is memory mapped, the tables point into the
+ * mapped file; otherwise the file is read into a buffer, which is 
+ * returned and must be released with mxFree after the tables were 
+ * used. The tables must not be released with free_tables.
+ */
+void * map_cache(gdsfile_t *gf, lib_tables *lt, cache_info *ci);
+
+/*
+ * check that the elements of structure k in mapped tables refer
+ * only to data inside the tables. Raises an error otherwise.
+ */
+void check_cache_structure(lib_tables *lt, size_t k);
+
+#endif /* _GDSCACHE_H */
@@ -9,6 +9,21 @@
 #include <time.h>
 #include <math.h>
 #include "gdsio.h"
+#include "gdszip.h"
+#include "gdsahead.h"
+
+/* memory mapped files */
+#if defined(__unix__) || defined(__APPLE__)
+   #define HAVE_MMAP
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <fcntl.h>
+   #include <unistd.h>
+#endif
+
+/* output buffer size */
+#define OBUF_INIT   65536       /* initial size */
+#define OBUF_FLUSH  4194304     /* flush when exceeding 4 MB */
 
 /* GNU C has inline */
 #if defined __GNUC__
@@ -56,18 +71,390 @@ now(date_t dv)
 }
 
 
+/*-- File objects -------------------------------------------------*/
+
+#ifdef HAVE_MMAP
+/*
+ * map a file into memory. Returns 0 on success and -1 when
+ * the file cannot be mapped.
+ */
+static int
+map_file(gdsfile_t *gf, const char *fname)
+{
+   struct stat st;
+   void *p;
+   int fd;
+
+   fd = open(fname, O_RDONLY);
+   if (fd < 0)
+      return -1;
+
+   if (fstat(fd, &st) < 0 || st.st_size == 0) {
+      close(fd);
+      return -1;
+   }
+
+   p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);  /* the mapping remains valid */
+   if (p == MAP_FAILED)
+      return -1;
+   madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+   gf->map  = (uint8_t *)p;
+   gf->pos  = gf->map;
+   gf->end  = gf->map + st.st_size;
+   gf->size = st.st_size;
+
+   return 0;
+}
+#endif
+
+
+/*-----------------------------------------------------------------*/
+
+gdsfile_t *
+gdsfile_open(const char *fname, const char *mode)
+{
+   gdsfile_t *gf;
+   char fmode[4];
+   long fsize;
+   int k, n, mapped, ahead;
+   zip_codec codec;
+
+
+   /* separate the map and read-ahead flags from the stdio mode */
+   for (k=n=mapped=ahead=0; mode[k] && n<3; k++) {
+      if (mode[k] == 'm')
+	 mapped = 1;
+      else if (mode[k] == 'a')
+	 ahead = 1;
+      else
+	 fmode[n++] = mode[k];
+   }
+   fmode[n] = '\0';
+
+   /* persistent across MEX calls */
+   gf = (gdsfile_t *)calloc(1, sizeof(gdsfile_t));
+   if (gf == NULL)
+      return NULL;
+
+   /* compressed stream */
+   codec = gdszip_codec(fname);
+   if (codec != ZIP_NONE) {
+      if ( gdszip_open(gf, fname, codec, fmode[0] != 'r') ) {
+	 free(gf);
+	 return NULL;
+      }
+      return gf;
+   }
+
+#ifdef HAVE_MMAP
+   if (mapped && fmode[0] == 'r') {
+      if ( !map_file(gf, fname) )
+	 return gf;
+   }
+#endif
+
+   /* stdio stream */
+   gf->fob = fopen(fname, fmode);
+   if (gf->fob == NULL) {
+      free(gf);
+      return NULL;
+   }
+
+   /* file size */
+   if (fmode[0] == 'r') {
+      if (fseek(gf->fob, 0L, SEEK_END) < 0 || 
+	  (fsize = ftell(gf->fob)) < 0 ||
+	  fseek(gf->fob, 0L, SEEK_SET) < 0) {
+	 fclose(gf->fob);
+	 free(gf);
+	 return NULL;
+      }
+      gf->size = fsize;
+
+      /* the file is read directly when no thread can be started */
+      if (ahead)
+	 gdsahead_open(gf);
+   }
+
+   return gf;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+gdsfile_t *
+gdsfile_mem(void)
+{
+   return (gdsfile_t *)calloc(1, sizeof(gdsfile_t));
+}
+
+
+/*-----------------------------------------------------------------*/
+
+err_id
+gdsfile_close(gdsfile_t *gf)
+{
+   err_id ret;
+
+   ret = gdsfile_flush(gf);
+   if (gf->zs) {
+      if ( gdszip_close(gf) )
+	 ret = WRITE_OPEN_CLOSE;
+   }
+
+#ifdef HAVE_MMAP
+   if (gf->map) {
+      if ( munmap(gf->map, gf->size) )
+	 ret = READ_OPEN_CLOSE;
+   }
+#endif
+   if (gf->ra)
+      gdsahead_close(gf);
+   if (gf->fob) {
+      if ( fclose(gf->fob) )
+	 ret = WRITE_OPEN_CLOSE;
+   }
+   free(gf->obuf);
+   free(gf->xybuf);
+   free(gf);
+
+   return ret;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+long
+gdsfile_tell(gdsfile_t *gf)
+{
+   long pos;
+
+   if (gf->map)
+      return (long)(gf->pos - gf->map);
+
+   if (gf->zs)
+      pos = gdszip_tell(gf);
+   else if (gf->ra)
+      pos = gdsahead_tell(gf);
+   else
+      pos = ftell(gf->fob);
+   if (pos < 0)
+      return pos;
+   return pos + gf->nob;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+err_id
+gdsfile_seek(gdsfile_t *gf, long pos)
+{
+   if (gf->map) {
+      if (pos < 0 || (size_t)pos > gf->size)
+	 return READ_OPEN_CLOSE;
+      gf->pos = gf->map + pos;
+      return A_OK;
+   }
+
+   if (gf->zs) {
+      if ( gdszip_seek(gf, pos) )
+	 return READ_OPEN_CLOSE;
+      return A_OK;
+   }
+
+   if (gf->ra) {
+      if ( gdsahead_seek(gf, pos) )
+	 return READ_OPEN_CLOSE;
+      return A_OK;
+   }
+
+   if ( fseek(gf->fob, pos, SEEK_SET) )
+      return READ_OPEN_CLOSE;
+
+   return A_OK;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+size_t
+gdsfile_read(gdsfile_t *gf, void *buf, size_t nb)
+{
+   size_t n;
+
+   if (gf->map) {
+      n = (size_t)(gf->end - gf->pos);
+      if (n > nb)
+	 n = nb;
+      memcpy(buf, gf->pos, n);
+      gf->pos += n;
+      return n;
+   }
+
+   if (gf->zs)
+      return gdszip_read(gf, buf, nb);
+
+   if (gf->ra)
+      return gdsahead_read(gf, buf, nb);
+
+   return fread(buf, sizeof(uint8_t), nb, gf->fob);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+int32_t *
+gdsfile_xybuf(gdsfile_t *gf, size_t n)
+{
+   int32_t *p;
+
+   if (n > gf->mxy) {
+      p = (int32_t *)realloc(gf->xybuf, n*sizeof(int32_t));
+      if (p == NULL)
+	 return NULL;
+      gf->xybuf = p;
+      gf->mxy = n;
+   }
+
+   return gf->xybuf;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+err_id
+gdsfile_flush(gdsfile_t *gf)
+{
+   if (gf->nob == 0)
+      return A_OK;
+
+   /* memory file objects keep their records */
+   if (gf->fob == NULL && gf->zs == NULL)
+      return A_OK;
+
+   if (gf->zs) {
+      if ( gdszip_write(gf, gf->obuf, gf->nob) )
+	 return WRITE_OPEN_CLOSE;
+   }
+   else if (fwrite(gf->obuf, sizeof(uint8_t), gf->nob, gf->fob) != gf->nob)
+      return WRITE_OPEN_CLOSE;
+   gf->nob = 0;
+
+   return A_OK;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * copy nb bytes from the file to a buffer. Returns 1 on
+ * success and 0 when the end of the file was reached.
+ */
+static INLINE int
+get_bytes(gdsfile_t *gf, void *buf, size_t nb)
+{
+   if (gf->map) {
+      if ((size_t)(gf->end - gf->pos) < nb)
+	 return 0;
+      memcpy(buf, gf->pos, nb);
+      gf->pos += nb;
+      return 1;
+   }
+   else if (gf->zs)
+      return gdszip_read(gf, buf, nb) == nb;
+   else if (gf->ra)
+      return gdsahead_read(gf, buf, nb) == nb;
+   else
+      return fread(buf, sizeof(uint8_t), nb, gf->fob) == nb;
+}
+
+
+/*
+ * append nb bytes to the output buffer. The buffer grows until
+ * it exceeds OBUF_FLUSH bytes, then it is written to the file. 
+ * Returns 1 on success and 0 on failure.
+ */
+static int
+put_bytes(gdsfile_t *gf, const void *buf, size_t nb)
+{
+   uint8_t *p;
+   size_t m;
+
+   if (gf->nob + nb > gf->mob) {
+
+      /* write out a full buffer */
+      if (gf->nob >= OBUF_FLUSH) {
+	 if ( gdsfile_flush(gf) )
+	    return 0;
+      }
+
+      /* grow the buffer */
+      if (gf->nob + nb > gf->mob) {
+	 m = gf->mob ? gf->mob : OBUF_INIT;
+	 while (m < gf->nob + nb)
+	    m *= 2;
+	 p = (uint8_t *)realloc(gf->obuf, m);
+	 if (p == NULL)
+	    return 0;
+	 gf->obuf = p;
+	 gf->mob = m;
+      }
+   }
+
+   memcpy(gf->obuf + gf->nob, buf, nb);
+   gf->nob += nb;
+
+   return 1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+err_id
+gdsfile_write(gdsfile_t *gf, const void *buf, size_t nb)
+{
+   if (gf->fob == NULL && gf->zs == NULL)
+      return put_bytes(gf, buf, nb) ? A_OK : WRITE_OPEN_CLOSE;
+
+   if ( gdsfile_flush(gf) )
+      return WRITE_OPEN_CLOSE;
+
+   if (gf->zs) {
+      if ( gdszip_write(gf, buf, nb) )
+	 return WRITE_OPEN_CLOSE;
+   }
+   else if (fwrite(buf, sizeof(uint8_t), nb, gf->fob) != nb)
+      return WRITE_OPEN_CLOSE;
+
+   return A_OK;
+}
+
+
 /*--------------------------------------------------------------
  * Read a record header consisting of record length and record
  * type. The number of data bytes remaining in the record is returned.
  */
 err_id
-read_record_hdr(FILE* fob, uint16_t *rtype, uint16_t *rlen) 
+read_record_hdr(gdsfile_t *gf, uint16_t *rtype, uint16_t *rlen) 
 {
    uint16_t hdr[2];
-   int nr;
+   uint8_t *p;
+
+   /* decode directly from mapped file */
+   if (gf->map) {
+      if (gf->end - gf->pos < 4)
+	 return READ_REC_HEADER;
+      p = gf->pos;
+      *rtype = (p[2] << 8) | p[3];
+      *rlen  = ((p[0] << 8) | p[1]) - 2*sizeof(uint16_t);
+      gf->pos += 4;
+      return A_OK;
+   }
 
-   nr = fread(hdr, sizeof(uint16_t), 2, fob);
-   if (nr != 2) return READ_REC_HEADER;
+   if ( !get_bytes(gf, hdr, 2*sizeof(uint16_t)) ) 
+      return READ_REC_HEADER;
    byte_reverse_n(hdr, 2);
 
    *rtype = hdr[1];
@@ -83,17 +470,16 @@ read_record_hdr(FILE* fob, uint16_t *rtype, uint16_t *rlen)
  * write a GDS II record header
  */
 err_id 
-write_record_hdr(FILE* fob, uint16_t rtype, uint16_t rlen)
+write_record_hdr(gdsfile_t *gf, uint16_t rtype, uint16_t rlen)
 {
    uint16_t hdr[2];
-   int nw;
 
    hdr[0] = rlen + 2*sizeof(uint16_t);
    hdr[1] = rtype;
    byte_reverse_n(hdr, 2);
 
-   nw = fwrite(hdr, sizeof(uint16_t), 2, fob);
-   if (nw != 2) return WRITE_REC_HEADER;
+   if ( !put_bytes(gf, hdr, 2*sizeof(uint16_t)) )
+      return WRITE_REC_HEADER;
 
    return A_OK;
 }
@@ -101,12 +487,9 @@ write_record_hdr(FILE* fob, uint16_t rtype, uint16_t rlen)
 /*-----------------------------------------------------------------*/
  
 err_id 
-read_word_n(FILE *fob, uint16_t *data, int n)
+read_word_n(gdsfile_t *gf, uint16_t *data, int n)
 {
-   int nr;
-
-   nr = fread(data, sizeof(uint16_t), n, fob);
-   if (nr != n)
+   if ( !get_bytes(gf, data, n*sizeof(uint16_t)) )
       return READ_WORD;
 
    byte_reverse_n(data, n);
@@ -118,13 +501,10 @@ read_word_n(FILE *fob, uint16_t *data, int n)
 /*-----------------------------------------------------------------*/
  
 err_id 
-write_word_n(FILE *fob, uint16_t *data, int n)
+write_word_n(gdsfile_t *gf, uint16_t *data, int n)
 {
-   int nw;
-
    byte_reverse_n(data, n);
-   nw = fwrite(data, sizeof(uint16_t), n, fob);
-   if (nw != n)
+   if ( !put_bytes(gf, data, n*sizeof(uint16_t)) )
       return WRITE_WORD;
 
    return A_OK;
@@ -135,12 +515,20 @@ write_word_n(FILE *fob, uint16_t *data, int n)
 
 
 err_id 
-read_word(FILE *fob, uint16_t *data)
+read_word(gdsfile_t *gf, uint16_t *data)
 {
-   int nr;
+   uint8_t *p;
+
+   if (gf->map) {
+      if (gf->end - gf->pos < 2)
+	 return READ_WORD;
+      p = gf->pos;
+      *data = (p[0] << 8) | p[1];
+      gf->pos += 2;
+      return A_OK;
+   }
 
-   nr = fread(data, sizeof(uint16_t), 1, fob);
-   if (nr != 1)
+   if ( !get_bytes(gf, data, sizeof(uint16_t)) )
       return READ_WORD;
 
    byte_reverse(data);
@@ -152,13 +540,10 @@ read_word(FILE *fob, uint16_t *data)
 /*-----------------------------------------------------------------*/
 
 err_id 
-write_word(FILE *fob, uint16_t data)
+write_word(gdsfile_t *gf, uint16_t data)
 {
-   int nw;
-
    byte_reverse(&data);
-   nw = fwrite(&data, sizeof(uint16_t), 1, fob);
-   if (nw != 1)
+   if ( !put_bytes(gf, &data, sizeof(uint16_t)) )
       return WRITE_WORD;
 
    return A_OK;
@@ -168,12 +553,21 @@ write_word(FILE *fob, uint16_t data)
 /*-----------------------------------------------------------------*/
 
 err_id 
-read_int(FILE *fob, int32_t *data)
+read_int(gdsfile_t *gf, int32_t *data)
 {
-   int nr;
+   uint8_t *p;
+
+   if (gf->map) {
+      if (gf->end - gf->pos < 4)
+	 return READ_INT;
+      p = gf->pos;
+      *data = (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | 
+			((uint32_t)p[2] << 8) | (uint32_t)p[3]);
+      gf->pos += 4;
+      return A_OK;
+   }
 
-   nr = fread(data, sizeof(int32_t), 1, fob);
-   if (nr != 1)
+   if ( !get_bytes(gf, data, sizeof(int32_t)) )
       return READ_INT;
 
    byte_reverse32(data);
@@ -185,13 +579,10 @@ read_int(FILE *fob, int32_t *data)
 /*-----------------------------------------------------------------*/
  
 err_id 
-write_int(FILE *fob, int32_t data)
+write_int(gdsfile_t *gf, int32_t data)
 {
-   int nw;
-
    byte_reverse32(&data);
-   nw = fwrite(&data, sizeof(int32_t), 1, fob);
-   if (nw != 1)
+   if ( !put_bytes(gf, &data, sizeof(int32_t)) )
       return WRITE_INT;
 
    return A_OK;
@@ -201,12 +592,9 @@ write_int(FILE *fob, int32_t data)
 /*-----------------------------------------------------------------*/
 
 err_id 
-read_int_n(FILE *fob, int32_t *data, int n)
+read_int_n(gdsfile_t *gf, int32_t *data, int n)
 {
-   int nr;
-
-   nr = fread(data, sizeof(int32_t), n, fob);
-   if (nr != n)
+   if ( !get_bytes(gf, data, n*sizeof(int32_t)) )
       return READ_INT;
 
    byte_reverse32_n(data, n);
@@ -218,13 +606,10 @@ read_int_n(FILE *fob, int32_t *data, int n)
 /*-----------------------------------------------------------------*/
 
 err_id 
-write_int_n(FILE *fob, int32_t *data, int n)
+write_int_n(gdsfile_t *gf, int32_t *data, int n)
 {
-   int nw;
-
    byte_reverse32_n(data, n);
-   nw = fwrite(data, sizeof(int32_t), n, fob);
-   if (nw != n)
+   if ( !put_bytes(gf, data, n*sizeof(int32_t)) )
       return WRITE_INT;
 
    return A_OK;
@@ -234,12 +619,45 @@ write_int_n(FILE *fob, int32_t *data, int n)
 /*-----------------------------------------------------------------*/
 
 err_id 
-read_string(FILE *fob, char *str, int nchar)
+read_int_be_n(gdsfile_t *gf, int32_t *data, int n)
 {
-   int nr;
+   if ( !get_bytes(gf, data, n*sizeof(int32_t)) )
+      return READ_INT;
 
-   nr = fread(str, sizeof(char), nchar, fob);
-   if (nr != nchar)
+   return A_OK;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+err_id 
+write_int_be_n(gdsfile_t *gf, int32_t *data, int n)
+{
+   if ( !put_bytes(gf, data, n*sizeof(int32_t)) )
+      return WRITE_INT;
+
+   return A_OK;
+} 
+ 
+
+/*-----------------------------------------------------------------*/
+
+err_id 
+write_records(gdsfile_t *gf, const void *data, size_t nb)
+{
+   if ( !put_bytes(gf, data, nb) )
+      return WRITE_CHAR;
+
+   return A_OK;
+} 
+
+
+/*-----------------------------------------------------------------*/
+
+err_id 
+read_string(gdsfile_t *gf, char *str, int nchar)
+{
+   if ( !get_bytes(gf, str, nchar) )
       return READ_CHAR;
    
    if (str[nchar] != '\0')
@@ -252,12 +670,9 @@ read_string(FILE *fob, char *str, int nchar)
 /*-----------------------------------------------------------------*/
  
 err_id 
-write_string(FILE *fob, char *str, int nchar)
+write_string(gdsfile_t *gf, char *str, int nchar)
 {
-   int nw;
-
-   nw = fwrite(str, sizeof(char), nchar, fob);
-   if (nw != nchar)
+   if ( !put_bytes(gf, str, nchar) )
       return WRITE_CHAR;
 
    return A_OK;
@@ -267,16 +682,29 @@ write_string(FILE *fob, char *str, int nchar)
 /*--------------------------------------------------------------*/
 
 err_id
-read_ignore(FILE *fob, int numb)
+read_ignore(gdsfile_t *gf, int numb)
 {
-   char *p;
-   int nr;
+   /* skipping is pointer arithmetic in mapped files */
+   if (gf->map) {
+      if (gf->end - gf->pos < numb)
+	 return READ_CHAR;
+      gf->pos += numb;
+      return A_OK;
+   }
 
-   p = malloc(numb);
-   nr = fread(p, sizeof(uint8_t), numb, fob);
-   free(p);
+   if (gf->zs) {
+      if ( gdszip_seek(gf, gdszip_tell(gf) + numb) )
+	 return READ_CHAR;
+      return A_OK;
+   }
 
-   if (nr != numb)
+   if (gf->ra) {
+      if ( gdsahead_seek(gf, gdsahead_tell(gf) + numb) )
+	 return READ_CHAR;
+      return A_OK;
+   }
+
+   if ( fseek(gf->fob, numb, SEEK_CUR) )
       return READ_CHAR; 
    else
       return A_OK;
@@ -286,14 +714,12 @@ read_ignore(FILE *fob, int numb)
 /*-----------------------------------------------------------------*/
 
 err_id
-read_real8(FILE *fob, double *rnum) 
+read_real8(gdsfile_t *gf, double *rnum) 
 {
-   int nr;
    uint64_t e64num;
 
    /* read bytes */
-   nr = fread(&e64num, sizeof(uint64_t), 1, fob);
-   if (nr != 1)
+   if ( !get_bytes(gf, &e64num, sizeof(uint64_t)) )
       return READ_FLOAT;
 
    *rnum = excess64_to_ieee754(&e64num);
@@ -305,18 +731,58 @@ read_real8(FILE *fob, double *rnum)
 /*--------------------------------------------------------------*/
 
 err_id
-write_real8(FILE *fob, double rnum) 
+write_real8(gdsfile_t *gf, double rnum) 
 {
-   int nw;
    uint64_t e64num;
 
    ieee754_to_excess64(rnum, &e64num);
-   nw = fwrite(&e64num, sizeof(uint64_t), 1, fob);
-   if (nw != 1)
+   if ( !put_bytes(gf, &e64num, sizeof(uint64_t)) )
       return WRITE_FLOAT;
 
    return A_OK;
 }
 
-/*-----------------------------------------------------------------*/
+/*--------------------------------------------------------------*/
+
+err_id
+read_real8_n(gdsfile_t *gf, double *rnum, int n) 
+{
+   uint64_t e64num;
+   int k;
+
+   /* read all numbers, then convert them in place */
+   if ( !get_bytes(gf, rnum, n*sizeof(uint64_t)) )
+      return READ_FLOAT;
+
+   for (k=0; k<n; k++) {
+      memcpy(&e64num, &rnum[k], sizeof(uint64_t));
+      rnum[k] = excess64_to_ieee754(&e64num);
+   }
+
+   return A_OK;
+}
 
+
+/*--------------------------------------------------------------*/
+
+err_id
+write_real8_n(gdsfile_t *gf, double *rnum, int n) 
+{
+   uint64_t e64num[32];
+   int k, nb;
+
+   /* convert in blocks of 32 numbers */
+   while (n > 0) {
+      nb = n < 32 ? n : 32;
+      for (k=0; k<nb; k++)
+	 ieee754_to_excess64(rnum[k], &e64num[k]);
+      if ( !put_bytes(gf, e64num, nb*sizeof(uint64_t)) )
+	 return WRITE_FLOAT;
+      rnum += nb;
+      n -= nb;
+   }
+
+   return A_OK;
+}
+
+/*-----------------------------------------------------------------*/
@@ -13,6 +13,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 #include "gdstypes.h"
 
 
@@ -25,10 +26,94 @@ typedef enum {A_OK = 0,
 	      WRITE_INT, WRITE_WORD, WRITE_CHAR} err_id;
 
 
+struct gds_zstream;
+struct gds_ahead;
+
+/*
+ * GDS II file object. Files opened for reading can be memory mapped;
+ * records are then decoded directly from the mapped file and the 
+ * stdio stream is not used. Records written to a file are collected
+ * in an output buffer that is written to the stream in large blocks.
+ * Compressed files (see gdszip.h) are read and written through a
+ * compressed stream and are never mapped. Files that are read with
+ * stdio can be read by a read-ahead thread (see gdsahead.h). Memory
+ * file objects have neither a stream nor a mapping; records written
+ * to them remain in the output buffer.
+ */
+typedef struct {
+   FILE *fob;         /* stdio stream; NULL when the file is mapped */
+   struct gds_zstream *zs;  /* compressed stream or NULL */
+   struct gds_ahead *ra;    /* read-ahead stream or NULL */
+   uint8_t *map;      /* start of memory mapped file or NULL */
+   uint8_t *pos;      /* read position in mapped file */
+   uint8_t *end;      /* end of mapped file */
+   size_t size;       /* file size when opened for reading */
+   uint8_t *obuf;     /* output buffer */
+   size_t nob, mob;   /* bytes in output buffer, buffer size */
+   int32_t *xybuf;    /* coordinate scratch buffer of the writer */
+   size_t mxy;        /* size of coordinate buffer */
+} gdsfile_t;
+
+
 /* ------------------------------------------------------------------
  *  Function prototypes
  */
 
+/*
+ * open a GDS II file. mode is "r" or "w", optionally followed by "b".
+ * When mode also contains "m", a file opened for reading is 
+ * memory mapped if the platform supports it. When mode contains "a",
+ * a file opened for reading that is not mapped is read ahead by a
+ * background thread. Files with the extension
+ * .gz or .zst are decompressed while reading and compressed while
+ * writing. Returns NULL on error.
+ */
+gdsfile_t * gdsfile_open(const char *fname, const char *mode);
+
+/*
+ * create a memory file object for writing records into the output
+ * buffer. Returns NULL on error.
+ */
+gdsfile_t * gdsfile_mem(void);
+
+/*
+ * close a GDS II file and release the file object
+ */
+err_id gdsfile_close(gdsfile_t *gf);
+
+/*
+ * return the current file position or -1 on error
+ */
+long gdsfile_tell(gdsfile_t *gf);
+
+/*
+ * set the file position of a file opened for reading
+ */
+err_id gdsfile_seek(gdsfile_t *gf, long pos);
+
+/*
+ * read up to nb bytes from the current file position. Returns
+ * the number of bytes read, which is less than nb at the end of
+ * the file.
+ */
+size_t gdsfile_read(gdsfile_t *gf, void *buf, size_t nb);
+
+/*
+ * write nb bytes after the contents of the output buffer
+ */
+err_id gdsfile_write(gdsfile_t *gf, const void *buf, size_t nb);
+
+/*
+ * write the contents of the output buffer to the file
+ */
+err_id gdsfile_flush(gdsfile_t *gf);
+
+/*
+ * return a scratch buffer for at least n coordinates owned by the 
+ * file object. Returns NULL when the buffer cannot be allocated.
+ */
+int32_t * gdsfile_xybuf(gdsfile_t *gf, size_t n);
+
 /*
  * return the current date and time
  */
@@ -38,82 +123,110 @@ void now(date_t dv);
  * read a GDS II record header. The function returns the number
  * of data bytes in the record that remain to be read. 
  */
-err_id read_record_hdr(FILE *fob, uint16_t *rtype, uint16_t *rlen); 
+err_id read_record_hdr(gdsfile_t *gf, uint16_t *rtype, uint16_t *rlen); 
 
 /* 
  * write a GDS II record header. The number of data bytes in the record
  * must be in rh.rlen (not including the record header). 
  */
-err_id write_record_hdr(FILE *fob, uint16_t rtype, uint16_t rlen); 
+err_id write_record_hdr(gdsfile_t *gf, uint16_t rtype, uint16_t rlen); 
 
 /*
  * read n 16-bit words from a GDS II file
  */
-err_id read_word_n(FILE *fob, uint16_t *data, int n); 
+err_id read_word_n(gdsfile_t *gf, uint16_t *data, int n); 
 
 /*
  * write n 16-bit words to a GDS II file
  * NOTE: the byte order in data is not preserved !
  */
-err_id write_word_n(FILE *fob, uint16_t *data, int n); 
+err_id write_word_n(gdsfile_t *gf, uint16_t *data, int n); 
 
 /*
  * read a 16-bit word from a GDS II file
  */
-err_id read_word(FILE *fob, uint16_t *data); 
+err_id read_word(gdsfile_t *gf, uint16_t *data); 
 
 /*
  * write a 16-bit word to a GDS II file
  * NOTE: the byte order in data is not preserved !
  */
-err_id write_word(FILE *fob, uint16_t data); 
+err_id write_word(gdsfile_t *gf, uint16_t data); 
 
 /*
  * read a 32-bit integer from a GDS II file
  */
-err_id read_int(FILE *fob, int32_t *data); 
+err_id read_int(gdsfile_t *gf, int32_t *data); 
 
 /*
  * write a 32-bit integer to a GDS II file
  * NOTE: the byte order in data is not preserved !
  */
-err_id write_int(FILE *fob, int32_t data); 
+err_id write_int(gdsfile_t *gf, int32_t data); 
 
 /*
  * read n 32-bit integers from a GDS II file
  */
-err_id read_int_n(FILE *fob, int32_t *data, int n); 
+err_id read_int_n(gdsfile_t *gf, int32_t *data, int n); 
 
 /*
  * write n 32-bit integers to a GDS II file
  * NOTE: the byte order in data is not preserved !
  */
-err_id write_int_n(FILE *fob, int32_t *data, int n); 
+err_id write_int_n(gdsfile_t *gf, int32_t *data, int n); 
+
+/*
+ * read n 32-bit integers from a GDS II file without changing 
+ * their byte order, i.e. they remain big endian.
+ */
+err_id read_int_be_n(gdsfile_t *gf, int32_t *data, int n); 
+
+/*
+ * write n 32-bit integers that are already in big endian byte
+ * order to a GDS II file.
+ */
+err_id write_int_be_n(gdsfile_t *gf, int32_t *data, int n); 
+
+/*
+ * write nb bytes of complete records, e.g. records copied from
+ * another GDS II file, to a GDS II file
+ */
+err_id write_records(gdsfile_t *gf, const void *data, size_t nb); 
 
 /*
  * read a character string from a GDS II file
  */
-err_id read_string(FILE *fob, char *str, int nchar); 
+err_id read_string(gdsfile_t *gf, char *str, int nchar); 
 
 /*
  * write a character string to a GDS II file
  */
-err_id write_string(FILE *fob, char *str, int nchar); 
+err_id write_string(gdsfile_t *gf, char *str, int nchar); 
 
 /* 
  * read an excess-64 encoded 8-byte floating point number 
  */
-err_id read_real8(FILE *fob, double *rnum); 
+err_id read_real8(gdsfile_t *gf, double *rnum); 
 
 /* 
  * write an excess-64 encoded 8-byte floating point number 
  */
-err_id write_real8(FILE *fob, double rnum); 
+err_id write_real8(gdsfile_t *gf, double rnum); 
+
+/* 
+ * read n excess-64 encoded 8-byte floating point numbers
+ */
+err_id read_real8_n(gdsfile_t *gf, double *rnum, int n); 
+
+/* 
+ * write n excess-64 encoded 8-byte floating point numbers
+ */
+err_id write_real8_n(gdsfile_t *gf, double *rnum, int n); 
 
 /*
  * read and discard a specified number of bytes
  */
-err_id read_ignore(FILE *fob, int numb);
+err_id read_ignore(gdsfile_t *gf, int numb);
 
 /*-----------------------------------------------------------------*/
 
@@ -0,0 +1,1308 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Decodes GDS II structures and elements into compact tables and
+ * converts the tables into the mxArray data used by the gds_element
+ * and gds_structure classes. The element data created here are
+ * identical to the data returned by the original element readers
+ * in gds_read_element.c, from which the decoding functions were
+ * derived.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "gdsio.h"
+#include "gdsread.h"
+#include "mexfuncs.h"
+#include "eldata.h"
+#include "byteswap.h"
+#include "gdsthreads.h"
+
+/* minimum distance of element boundaries at which structures are split */
+#define SPLIT_BYTES  262144
+
+
+/*-- Local Types --------------------------------------------------*/
+
+/*
+ * error context of a decoding thread, which is attached to the
+ * tables the thread decodes into. Errors cannot be raised with
+ * mexErrMsgTxt outside the MATLAB thread; they are returned to the 
+ * thread function with longjmp instead.
+ */
+typedef struct decode_ctx {
+   jmp_buf jmp;
+   char msg[256];
+} decode_ctx;
+
+/*
+ * a file position at which the file can be divided into ranges:
+ * the beginning of a structure, the beginning of an element in a
+ * large structure, or the end of the structure data.
+ */
+typedef struct {
+   long pos;            /* file position of the record */
+   int inside;          /* position is inside a structure */
+} cut_t;
+
+/*
+ * a range of the file decoded by one thread. A range can begin and
+ * end inside of structures, which are then split between ranges.
+ */
+typedef struct {
+   gdsfile_t gf;        /* view of the mapped file */
+   lib_tables lt;       /* decoded structures */
+   int inside;          /* range begins inside a structure */
+   int failed;          /* decoding error */
+   char msg[256];       /* error message */
+} chunk_t;
+
+
+/*-- Local Functions ----------------------------------------------*/
+
+static void decode_error(lib_tables *lt, const char *msg);
+static void decode_struct(gdsfile_t *gf, lib_tables *lt, int partial);
+static void decode_elements(gdsfile_t *gf, lib_tables *lt, st_rec *ps, int partial);
+static void* grow(lib_tables *lt, void *p, size_t *mcur, size_t need, size_t esz);
+static int record_allowed(element_kind kind, uint16_t rtype);
+static void read_sname(gdsfile_t *gf, lib_tables *lt, char *sname, int nmax, int rlen);
+static long read_text_string(gdsfile_t *gf, lib_tables *lt, int rlen);
+static void read_xy_record(gdsfile_t *gf, lib_tables *lt, el_rec *pe, int rlen);
+static void read_propattr(gdsfile_t *gf, lib_tables *lt, el_rec *pe);
+static void read_propvalue(gdsfile_t *gf, lib_tables *lt, el_rec *pe, int rlen);
+static uint16_t read_elflags(gdsfile_t *gf, lib_tables *lt);
+static int32_t read_plex(gdsfile_t *gf, lib_tables *lt);
+static uint16_t read_layer(gdsfile_t *gf, lib_tables *lt);
+static uint16_t read_type(gdsfile_t *gf, lib_tables *lt);
+static int32_t read_extn(gdsfile_t *gf, lib_tables *lt);
+static int32_t read_width(gdsfile_t *gf, lib_tables *lt);
+static void read_colrow(gdsfile_t *gf, lib_tables *lt, uint16_t *row, uint16_t *col);
+static mxArray* xy_to_mx(lib_tables *lt, xy_rec *pxy);
+static mxArray* sref_xy_to_mx(lib_tables *lt, el_rec *pe);
+static mxArray* props_to_mx(lib_tables *lt, el_rec *pe);
+static void decode_chunk(void *arg, int k);
+static cut_t* find_cuts(gdsfile_t *gf, int single, size_t *ncut);
+
+
+/*-- Data ---------------------------------------------------------*/
+
+/* element names for error messages, indexed by element_kind */
+static const char *elname[] = {"", "boundary", "path", "box", "node",
+                               "text", "sref", "aref"};
+static const char *ELNAME[] = {"", "BOUNDARY", "PATH", "BOX", "NODE",
+                               "TEXT", "SREF", "AREF"};
+
+
+/*-----------------------------------------------------------------*/
+
+void
+init_tables(lib_tables *lt, double dbu_to_uu)
+{
+   memset(lt, '\0', sizeof(lib_tables));
+   lt->dbu_to_uu = dbu_to_uu;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+free_tables(lib_tables *lt)
+{
+   if (lt->sysmem) {
+      free(lt->st);
+      free(lt->el);
+      free(lt->xy);
+      free(lt->prop);
+      free(lt->vtx);
+      free(lt->str);
+      free(lt->ref);
+      free(lt->rpos);
+   }
+   else {
+      mxFree(lt->st);
+      mxFree(lt->el);
+      mxFree(lt->xy);
+      mxFree(lt->prop);
+      mxFree(lt->vtx);
+      mxFree(lt->str);
+      mxFree(lt->ref);
+      mxFree(lt->rpos);
+   }
+   memset(lt, '\0', sizeof(lib_tables));
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+free_tables_mt(lib_tables *plt, int nlt)
+{
+   int k;
+
+   for (k=0; k<nlt; k++)
+      free_tables(&plt[k]);
+   mxFree(plt);
+}
+
+
+/*-- Decoding -----------------------------------------------------*/
+
+void
+decode_library(gdsfile_t *gf, lib_tables *lt)
+{
+   uint16_t rtype, rlen;
+
+   while (1) {
+
+      if ( read_record_hdr(gf, &rtype, &rlen) )
+	 decode_error(lt, "gds_read_library :  could not read record header.");
+
+      switch (rtype) {
+
+         case ENDLIB:
+	    return;
+
+         case BGNSTR:
+	    decode_structure(gf, lt);
+	    break;
+
+         default:
+	    decode_error(lt, "gds_read_library :  invalid GDS file - ENDLIB or BGNSTR expected.");
+      }
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+decode_structure(gdsfile_t *gf, lib_tables *lt)
+{
+   decode_struct(gf, lt, 0);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * decode a structure beginning after the BGNSTR record header.
+ * When partial is set, decoding stops at the end of the file view,
+ * which then ends at an element inside the structure.
+ */
+static void
+decode_struct(gdsfile_t *gf, lib_tables *lt, int partial)
+{
+   st_rec *ps;
+   uint16_t rtype, rlen;
+
+   lt->st = grow(lt, lt->st, &lt->mst, lt->nst+1, sizeof(st_rec));
+   ps = &lt->st[lt->nst];
+   memset(ps, '\0', sizeof(st_rec));
+   ps->spos = gdsfile_tell(gf) - 2*sizeof(uint16_t);
+
+   /* read dates */
+   if ( read_word_n(gf, ps->cdate, 6) )
+      decode_error(lt, "gds_read_library :  failed to read structure cdate.");
+   if ( read_word_n(gf, ps->mdate, 6) )
+      decode_error(lt, "gds_read_library :  failed to read structure mdate.");
+
+   /* STRNAME record */
+   if ( read_record_hdr(gf, &rtype, &rlen) )
+      decode_error(lt, "gds_read_library :  failed to read STRNAME record.");
+   if (rtype != STRNAME)
+      decode_error(lt, "gds_read_library :  invalid STRNAME record.");
+   read_sname(gf, lt, ps->sname, sizeof(ps->sname), rlen);
+
+   decode_elements(gf, lt, ps, partial);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * decode elements up to the ENDSTR record of structure ps,
+ * or up to the end of the file view when partial is set.
+ */
+static void
+decode_elements(gdsfile_t *gf, lib_tables *lt, st_rec *ps, int partial)
+{
+   uint16_t rtype, rlen;
+
+   ps->el = lt->nel;
+   while (1) {
+
+      if (partial && gf->pos == gf->end)
+	 break;
+
+      if ( read_record_hdr(gf, &rtype, &rlen) )
+	 decode_error(lt, "gds_read_library :  could not read record header.");
+
+      if (rtype == ENDSTR) {
+	 ps->epos = gdsfile_tell(gf);
+	 break;
+      }
+
+      decode_element(gf, lt, rtype);
+   }
+   ps->nel = lt->nel - ps->el;
+
+   lt->nst += 1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+lib_tables*
+decode_library_mt(gdsfile_t *gf, double dbu_to_uu, int nthreads, 
+                  int single, int raw, int *nlt)
+{
+   lib_tables *plt;
+   chunk_t *pc;
+   uint8_t *start;
+   cut_t *cut;
+   long total;
+   size_t ncut, k, j;
+   int nchunk, c;
+   char msg[256];
+
+   if (gf->map == NULL)
+      return NULL;
+
+   nthreads = pool_threads(nthreads);
+   if (nthreads < 2)
+      return NULL;
+
+   /* find structures and element boundaries in large structures */
+   start = gf->pos;
+   cut = find_cuts(gf, single, &ncut);
+   if (cut == NULL || ncut < 3) {
+      gf->pos = start;
+      mxFree(cut);
+      return NULL;
+   }
+
+   /* divide the file into ranges of similar size */
+   nchunk = nthreads * TASKS_PER_THREAD;
+   if ((size_t)nchunk > ncut - 1)
+      nchunk = ncut - 1;
+   pc = (chunk_t *)mxCalloc(nchunk, sizeof(chunk_t));
+   total = cut[ncut-1].pos - cut[0].pos;
+   for (c=0, k=0; k<ncut-1; c++) {
+      j = k + 1;
+      while (j < ncut-1 && 
+	     cut[j].pos - cut[0].pos <= (double)total * (c+1) / nchunk)
+	 j++;
+      pc[c].gf = *gf;
+      pc[c].gf.pos = gf->map + cut[k].pos;
+      pc[c].gf.end = gf->map + cut[j].pos;
+      pc[c].inside = cut[k].inside;
+      init_tables(&pc[c].lt, dbu_to_uu);
+      pc[c].lt.sysmem = 1;
+      if (raw)
+	 pc[c].lt.raw = gf->map;
+      k = j;
+   }
+   nchunk = c;
+   mxFree(cut);
+
+   /* decode the ranges */
+   run_tasks(decode_chunk, pc, nchunk, nthreads);
+
+   /* collect the tables in file order */
+   plt = (lib_tables *)mxMalloc(nchunk * sizeof(lib_tables));
+   for (c=0; c<nchunk; c++)
+      plt[c] = pc[c].lt;
+
+   /* report the first error in the file */
+   for (c=0; c<nchunk; c++) {
+      if (pc[c].failed) {
+	 strcpy(msg, pc[c].msg);
+	 mxFree(pc);
+	 free_tables_mt(plt, nchunk);
+	 mexErrMsgTxt(msg);
+      }
+   }
+   mxFree(pc);
+
+   *nlt = nchunk;
+   return plt;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+scan_library(gdsfile_t *gf, lib_tables *lt)
+{
+   st_rec *ps = NULL;
+   uint16_t rtype, rlen;
+   long off;
+   size_t k;
+
+   while (1) {
+
+      if ( read_record_hdr(gf, &rtype, &rlen) )
+	 decode_error(lt, "gds_struct_index :  could not read record header.");
+
+      switch (rtype) {
+
+         case ENDLIB:
+	    if (ps != NULL)
+	       decode_error(lt, "gds_struct_index :  ENDSTR record missing.");
+	    return;
+
+         case BGNSTR:
+	    lt->st = grow(lt, lt->st, &lt->mst, lt->nst+1, sizeof(st_rec));
+	    ps = &lt->st[lt->nst];
+	    memset(ps, '\0', sizeof(st_rec));
+	    ps->spos = gdsfile_tell(gf) - 2*sizeof(uint16_t);
+	    ps->ref = lt->nref;
+	    read_ignore(gf, rlen);
+	    break;
+
+         case STRNAME:
+	    if (ps == NULL)
+	       decode_error(lt, "gds_struct_index :  STRNAME outside of structure.");
+	    read_sname(gf, lt, ps->sname, sizeof(ps->sname), rlen);
+	    break;
+
+         case SNAME:
+	    if (ps == NULL)
+	       decode_error(lt, "gds_struct_index :  SNAME outside of structure.");
+	    off = read_text_string(gf, lt, rlen);
+
+	    /* record each referenced structure only once */
+	    for (k=ps->ref; k<lt->nref; k++) {
+	       if ( !strcmp(lt->str + lt->ref[k], lt->str + off) )
+		  break;
+	    }
+	    if (k < lt->nref) {
+	       lt->nstr = off;  /* release the string */
+	       break;
+	    }
+	    lt->ref = grow(lt, lt->ref, &lt->mref, lt->nref+1, sizeof(long));
+	    lt->ref[lt->nref++] = off;
+	    ps->nref += 1;
+	    break;
+
+         case BOUNDARY:
+         case PATH:
+         case SREF:
+         case AREF:
+         case TEXT:
+         case NODE:
+         case BOX:
+	    if (ps == NULL)
+	       decode_error(lt, "gds_struct_index :  element outside of structure.");
+	    ps->nel += 1;
+	    read_ignore(gf, rlen);
+	    break;
+
+         case ENDSTR:
+	    if (ps == NULL)
+	       decode_error(lt, "gds_struct_index :  ENDSTR outside of structure.");
+	    ps->epos = gdsfile_tell(gf);
+	    lt->nst += 1;
+	    ps = NULL;
+	    break;
+
+         default:
+	    if ( read_ignore(gf, rlen) )
+	       decode_error(lt, "gds_struct_index :  unexpected end of file.");
+      }
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+decode_element(gdsfile_t *gf, lib_tables *lt, uint16_t rtype)
+{
+   el_rec *pe;
+   element_t *pi;
+   element_kind kind;
+   uint16_t rlen;
+   char errmsg[128];
+
+
+   switch (rtype) {
+      case BOUNDARY: kind = GDS_BOUNDARY; break;
+      case PATH:     kind = GDS_PATH;     break;
+      case SREF:     kind = GDS_SREF;     break;
+      case AREF:     kind = GDS_AREF;     break;
+      case TEXT:     kind = GDS_TEXT;     break;
+      case NODE:     kind = GDS_NODE;     break;
+      case BOX:      kind = GDS_BOX;      break;
+      default:
+         decode_error(lt, "gds_read_element :  unknown element type.");
+         return;
+   }
+
+   /* new element table entry */
+   lt->el = grow(lt, lt->el, &lt->mel, lt->nel+1, sizeof(el_rec));
+   pe = &lt->el[lt->nel];
+   pi = &pe->internal;
+   memset(pi, '\0', sizeof(element_t));
+   pi->kind = kind;
+   pe->xy = lt->nxy;
+   pe->nxy = 0;
+   pe->prop = lt->nprop;
+   pe->nslot = 0;
+   pe->nval = 0;
+   pe->text = -1;
+
+   /* the element begins with the record header that was read */
+   if (lt->raw != NULL) {
+      lt->rpos = grow(lt, lt->rpos, &lt->mrpos, 2*(lt->nel+1), sizeof(long));
+      lt->rpos[2*lt->nel] = gdsfile_tell(gf) - 2*sizeof(uint16_t);
+   }
+
+   /* read element properties */
+   while (1) {
+
+      if ( read_record_hdr(gf, &rtype, &rlen) ) {
+	 sprintf(errmsg, "gds_read_element (%s) :  could not read record header.",
+		 elname[kind]);
+	 decode_error(lt, errmsg);
+      }
+
+      if (rtype == ENDEL)
+	 break;
+
+      if ( !record_allowed(kind, rtype) ) {
+	 sprintf(errmsg, "%s :  found unknown element property (record id 0x%x).",
+		 ELNAME[kind], rtype);
+	 decode_error(lt, errmsg);
+      }
+
+      switch (rtype) {
+
+         case XY:
+	    read_xy_record(gf, lt, pe, rlen);
+	    break;
+
+         case LAYER:
+	    pi->layer = read_layer(gf, lt);
+	    break;
+
+         case DATATYPE:
+         case TEXTTYPE:
+         case NODETYPE:
+         case BOXTYPE:
+	    pi->dtype = read_type(gf, lt);
+	    break;
+
+         case PATHTYPE:
+	    pi->ptype = read_type(gf, lt);
+	    pi->has |= HAS_PTYPE;
+	    break;
+
+         case WIDTH:
+	    pi->width = lt->dbu_to_uu * (double)read_width(gf, lt);
+	    pi->has |= HAS_WIDTH;
+	    break;
+
+         case BGNEXTN:
+	    pi->bgnextn = lt->dbu_to_uu * read_extn(gf, lt);
+	    pi->has |= HAS_BGNEXTN;
+	    break;
+
+         case ENDEXTN:
+	    pi->endextn = lt->dbu_to_uu * read_extn(gf, lt);
+	    pi->has |= HAS_ENDEXTN;
+	    break;
+
+         case ELFLAGS:
+	    pi->elflags = read_elflags(gf, lt);
+	    pi->has |= HAS_ELFLAGS;
+	    break;
+
+         case PLEX:
+	    pi->plex = read_plex(gf, lt);
+	    pi->has |= HAS_PLEX;
+	    break;
+
+         case SNAME:
+	    read_sname(gf, lt, pi->sname, sizeof(pi->sname), rlen);
+	    break;
+
+         case COLROW:
+	    read_colrow(gf, lt, &pi->nrow, &pi->ncol);
+	    break;
+
+         case STRANS:
+	    if ( read_word(gf, &pi->strans.flags) ) {
+	       sprintf(errmsg, "gds_read_element (%s) :  could not read strans data.",
+		       elname[kind]);
+	       decode_error(lt, errmsg);
+	    }
+	    pi->has |= HAS_STRANS;
+	    break;
+
+         case MAG:
+	    if ( read_real8(gf, &pi->strans.mag) ) {
+	       sprintf(errmsg, "gds_read_element (%s) :  could not read magnification.",
+		       elname[kind]);
+	       decode_error(lt, errmsg);
+	    }
+	    pi->has |= HAS_MAG;
+	    break;
+
+         case ANGLE:
+	    if ( read_real8(gf, &pi->strans.angle) ) {
+	       sprintf(errmsg, "gds_read_element (%s) :  could not read angle.",
+		       elname[kind]);
+	       decode_error(lt, errmsg);
+	    }
+	    pi->has |= HAS_ANGLE;
+	    break;
+
+         case PRESENTATION:
+	    if ( read_word(gf, &pi->present) )
+	       decode_error(lt, "gds_read_element (text) :  could not read presentation data.");
+	    pi->has |= HAS_PRESTN;
+	    break;
+
+         case STRING:
+	    pe->text = read_text_string(gf, lt, rlen);
+	    break;
+
+         case PROPATTR:
+	    read_propattr(gf, lt, pe);
+	    break;
+
+         case PROPVALUE:
+	    read_propvalue(gf, lt, pe, rlen);
+	    break;
+      }
+   }
+
+   /* boundaries, paths, and srefs must have coordinates */
+   if ( !pe->nxy && (kind == GDS_BOUNDARY || kind == GDS_PATH || kind == GDS_SREF) ) {
+      sprintf(errmsg, "gds_read_element (%s) :  element has no XY record.",
+	      elname[kind]);
+      decode_error(lt, errmsg);
+   }
+
+   /* the element ends after the ENDEL record */
+   if (lt->raw != NULL)
+      lt->rpos[2*lt->nel+1] = gdsfile_tell(gf);
+
+   lt->nel += 1;
+}
+
+
+/*-- Conversion to mxArray ----------------------------------------*/
+
+mxArray*
+element_to_mx(lib_tables *lt, size_t k)
+{
+   mxArray *pstruct;
+   mxArray *pc;
+   el_rec *pe;
+   int n;
+   const char *fields[] = {"internal", "xy", "prop", "text"};
+
+   pe = &lt->el[k];
+
+   /* text elements have a text field */
+   if (pe->internal.kind == GDS_TEXT) {
+      pstruct = mxCreateStructMatrix(1,1, 4, fields);
+      if (pe->text >= 0)
+	 struct_set_string(pstruct, 3, lt->str + pe->text);
+   }
+   else
+      pstruct = mxCreateStructMatrix(1,1, 3, fields);
+
+   /* XY data */
+   switch (pe->internal.kind) {
+
+      case GDS_BOUNDARY:
+      case GDS_PATH:
+	 pc = mxCreateCellMatrix(1, pe->nxy);
+	 for (n=0; n<pe->nxy; n++)
+	    mxSetCell(pc, n, xy_to_mx(lt, &lt->xy[pe->xy + n]));
+	 mxSetFieldByNumber(pstruct, 0, 1, pc);
+	 break;
+
+      case GDS_SREF:
+	 mxSetFieldByNumber(pstruct, 0, 1, sref_xy_to_mx(lt, pe));
+	 break;
+
+      default: /* last XY record */
+	 if (pe->nxy)
+	    mxSetFieldByNumber(pstruct, 0, 1, xy_to_mx(lt, &lt->xy[pe->xy + pe->nxy - 1]));
+   }
+
+   /* set prop field */
+   if ( pe->nval )
+      mxSetFieldByNumber(pstruct, 0, 2, props_to_mx(lt, pe));
+   else
+      mxSetFieldByNumber(pstruct, 0, 2, empty_matrix());
+
+   /* store structure with internal element data */
+   mxSetFieldByNumber(pstruct, 0, 0, copy_element_to_array(&pe->internal));
+
+   return pstruct;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+mxArray*
+structures_to_mx(lib_tables *plt, int nlt)
+{
+   mxArray *pslist, *pc, *pa;
+   double *pd;
+   st_rec *ps, *pp;
+   size_t k, n, m, i, nst, nel;
+   int j, t, u, npart;
+   const char *fields[] = {"sname", "cdate", "mdate", "el"};
+
+   /* structures split between tables are counted once */
+   for (nst=0, t=0; t<nlt; t++) {
+      for (k=0; k<plt[t].nst; k++)
+	 nst += !plt[t].st[k].cont;
+   }
+   pslist = mxCreateStructMatrix(1, nst, 4, fields);
+
+   for (i=0, t=0; t<nlt; t++) {
+      for (k=0; k<plt[t].nst; k++) {
+
+	 ps = &plt[t].st[k];
+	 if (ps->cont)
+	    continue;
+
+	 mxSetFieldByNumber(pslist, i, 0, mxCreateString(ps->sname));
+
+	 pa = mxCreateDoubleMatrix(1, 6, mxREAL);
+	 pd = (double *)mxGetData(pa);
+	 for (j=0; j<6; j++)
+	    pd[j] = (double)ps->cdate[j];
+	 mxSetFieldByNumber(pslist, i, 1, pa);
+
+	 pa = mxCreateDoubleMatrix(1, 6, mxREAL);
+	 pd = (double *)mxGetData(pa);
+	 for (j=0; j<6; j++)
+	    pd[j] = (double)ps->mdate[j];
+	 mxSetFieldByNumber(pslist, i, 2, pa);
+
+	 /* the last structure of a table continues in the next tables */
+	 nel = ps->nel;
+	 npart = 1;
+	 if (k == plt[t].nst-1) {
+	    for (u=t+1; u<nlt && plt[u].nst && plt[u].st[0].cont; u++) {
+	       nel += plt[u].st[0].nel;
+	       npart++;
+	       if (plt[u].nst > 1)
+		  break;
+	    }
+	 }
+
+	 pc = mxCreateCellMatrix(1, nel);
+	 for (n=0, u=t; u<t+npart; u++) {
+	    pp = u == t ? ps : &plt[u].st[0];
+	    for (m=0; m<pp->nel; m++)
+	       mxSetCell(pc, n++, element_to_mx(&plt[u], pp->el + m));
+	 }
+	 mxSetFieldByNumber(pslist, i, 3, pc);
+	 i++;
+      }
+   }
+
+   return pslist;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+mxArray*
+index_to_mx(lib_tables *lt)
+{
+   mxArray *pidx, *pc, *pa;
+   st_rec *ps;
+   size_t k;
+   int n;
+   const char *fields[] = {"sname", "offset", "length", "numel", "refs"};
+
+   pidx = mxCreateStructMatrix(1, lt->nst, 5, fields);
+
+   for (k=0; k<lt->nst; k++) {
+
+      ps = &lt->st[k];
+      mxSetFieldByNumber(pidx, k, 0, mxCreateString(ps->sname));
+
+      pa = mxCreateDoubleMatrix(1,1, mxREAL);
+      *mxGetPr(pa) = ps->spos;
+      mxSetFieldByNumber(pidx, k, 1, pa);
+
+      pa = mxCreateDoubleMatrix(1,1, mxREAL);
+      *mxGetPr(pa) = ps->epos - ps->spos;
+      mxSetFieldByNumber(pidx, k, 2, pa);
+
+      pa = mxCreateDoubleMatrix(1,1, mxREAL);
+      *mxGetPr(pa) = ps->nel;
+      mxSetFieldByNumber(pidx, k, 3, pa);
+
+      pc = mxCreateCellMatrix(1, ps->nref);
+      for (n=0; n<ps->nref; n++)
+	 mxSetCell(pc, n, mxCreateString(lt->str + lt->ref[ps->ref + n]));
+      mxSetFieldByNumber(pidx, k, 4, pc);
+   }
+
+   return pidx;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* converts an XY record to an m x 2 matrix in user units, or
+   to an int32 matrix in database units */
+static mxArray*
+xy_to_mx(lib_tables *lt, xy_rec *pxy)
+{
+   mxArray *pa;
+   double *pd;
+   int32_t *pv, *pi;
+   int m;
+
+   m = pxy->m;
+   pv = lt->vtx + pxy->off;
+   if (lt->intxy) {
+      pa = mxCreateNumericMatrix(m,2, mxINT32_CLASS, mxREAL);
+      pi = mxGetData(pa);
+      be32_xy_to_int32((uint8_t *)pv, pi, pi+m, m);
+   }
+   else {
+      pa = mxCreateDoubleMatrix(m,2, mxREAL);
+      pd = mxGetData(pa);
+      be32_xy_to_double((uint8_t *)pv, pd, pd+m, m, lt->dbu_to_uu);
+   }
+
+   return pa;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * catenates the XY records of an sref element. Each record
+ * is stored as a block with the x coordinates followed by the
+ * y coordinates, as in the original sref reader.
+ */
+static mxArray*
+sref_xy_to_mx(lib_tables *lt, el_rec *pe)
+{
+   mxArray *pa;
+   double *pd;
+   int32_t *pv, *pi;
+   xy_rec *pxy;
+   int m,n,mtotal = 0;
+
+   for (n=0; n<pe->nxy; n++)
+      mtotal += lt->xy[pe->xy + n].m;
+
+   if (lt->intxy) {
+      pa = mxCreateNumericMatrix(mtotal,2, mxINT32_CLASS, mxREAL);
+      pi = mxGetData(pa);
+      for (n=0; n<pe->nxy; n++) {
+	 pxy = &lt->xy[pe->xy + n];
+	 m = pxy->m;
+	 pv = lt->vtx + pxy->off;
+	 be32_xy_to_int32((uint8_t *)pv, pi, pi+m, m);
+	 pi += 2*m;
+      }
+      return pa;
+   }
+
+   pa = mxCreateDoubleMatrix(mtotal,2, mxREAL);
+   pd = mxGetData(pa);
+   for (n=0; n<pe->nxy; n++) {
+      pxy = &lt->xy[pe->xy + n];
+      m = pxy->m;
+      pv = lt->vtx + pxy->off;
+      be32_xy_to_double((uint8_t *)pv, pd, pd+m, m, lt->dbu_to_uu);
+      pd += 2*m;
+   }
+
+   return pa;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static mxArray*
+props_to_mx(lib_tables *lt, el_rec *pe)
+{
+   mxArray *pprop, *pa;
+   prop_rec *pp;
+   double *pd;
+   int k;
+   const char *fields[] = {"attr","name"};
+
+   pprop = mxCreateStructMatrix(1,pe->nslot, 2, fields);
+   for (k=0; k<pe->nslot; k++) {
+      pp = &lt->prop[pe->prop + k];
+      pa = mxCreateDoubleMatrix(1,1,mxREAL);
+      pd = (double *)mxGetData(pa);
+      *pd = pp->attr;
+      mxSetFieldByNumber(pprop, k, 0, pa);
+      if (pp->name >= 0)
+	 mxSetFieldByNumber(pprop, k, 1, mxCreateString(lt->str + pp->name));
+   }
+
+   return pprop;
+}
+
+
+/*-- Record readers -----------------------------------------------*/
+
+static int
+record_allowed(element_kind kind, uint16_t rtype)
+{
+   switch (rtype) {
+
+      case XY:
+      case ELFLAGS:
+      case PLEX:
+      case PROPATTR:
+      case PROPVALUE:
+	 return 1;
+
+      case LAYER:
+	 return kind != GDS_SREF && kind != GDS_AREF;
+
+      case DATATYPE:
+	 return kind == GDS_BOUNDARY || kind == GDS_PATH;
+
+      case PATHTYPE:
+      case WIDTH:
+	 return kind == GDS_PATH || kind == GDS_TEXT;
+
+      case BGNEXTN:
+      case ENDEXTN:
+	 return kind == GDS_PATH;
+
+      case SNAME:
+      case STRANS:
+      case MAG:
+      case ANGLE:
+	 return kind == GDS_SREF || kind == GDS_AREF ||
+	       (kind == GDS_TEXT && rtype != SNAME);
+
+      case COLROW:
+	 return kind == GDS_AREF;
+
+      case TEXTTYPE:
+      case PRESENTATION:
+      case STRING:
+	 return kind == GDS_TEXT;
+
+      case NODETYPE:
+	 return kind == GDS_NODE;
+
+      case BOXTYPE:
+	 return kind == GDS_BOX;
+
+      default:
+	 return 0;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * task function for decode_library_mt: decodes range k
+ */
+static void
+decode_chunk(void *arg, int k)
+{
+   chunk_t *pc = (chunk_t *)arg + k;
+   decode_ctx ctx;
+   uint16_t rtype, rlen;
+
+   pc->lt.ctx = &ctx;
+   if ( setjmp(ctx.jmp) ) {
+      pc->failed = 1;
+      pc->lt.ctx = NULL;
+      strcpy(pc->msg, ctx.msg);
+      return;
+   }
+   if (pc->inside) {  /* continue the structure of the previous range */
+      pc->lt.st = grow(&pc->lt, pc->lt.st, &pc->lt.mst, 1, sizeof(st_rec));
+      memset(pc->lt.st, '\0', sizeof(st_rec));
+      pc->lt.st[0].cont = 1;
+      decode_elements(&pc->gf, &pc->lt, pc->lt.st, 1);
+   }
+   while (pc->gf.pos < pc->gf.end) {
+      read_record_hdr(&pc->gf, &rtype, &rlen); /* BGNSTR */
+      decode_struct(&pc->gf, &pc->lt, 1);
+   }
+   pc->lt.ctx = NULL;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * returns the positions at which the file can be divided into 
+ * ranges, using only the record headers: the BGNSTR records up to 
+ * the ENDLIB record, element records inside of structures at least
+ * SPLIT_BYTES apart, and the position of the ENDLIB record. When 
+ * single is set, the file is positioned after the BGNSTR record 
+ * header of a structure and only this structure is considered; the 
+ * last position is then the end of the structure. Returns NULL for 
+ * invalid files, which are left to the serial decoder for error 
+ * reporting.
+ */
+static cut_t*
+find_cuts(gdsfile_t *gf, int single, size_t *ncut)
+{
+   cut_t *cut = NULL;
+   size_t mcut = 0;
+   uint16_t rtype, rlen;
+   long pos, last = 0;
+   int instr = 0;
+
+   if (single) {
+      gf->pos -= 2*sizeof(uint16_t);  /* back to BGNSTR */
+      if (gf->pos < gf->map)
+	 return NULL;
+   }
+
+   *ncut = 0;
+   while (1) {
+
+      pos = gdsfile_tell(gf);
+      if ( read_record_hdr(gf, &rtype, &rlen) )
+	 break;
+
+      if (instr) {
+	 switch (rtype) {
+
+            case ENDSTR:
+	       instr = 0;
+	       break;
+
+            case BOUNDARY:
+            case PATH:
+            case SREF:
+            case AREF:
+            case TEXT:
+            case NODE:
+            case BOX:
+	       if (pos - last >= SPLIT_BYTES) {
+		  cut = grow(NULL, cut, &mcut, *ncut+1, sizeof(cut_t));
+		  cut[*ncut].pos = pos;
+		  cut[*ncut].inside = 1;
+		  *ncut += 1;
+		  last = pos;
+	       }
+	       break;
+	 }
+	 if ( read_ignore(gf, rlen) )
+	    break;
+	 if (single && !instr) {  /* end of the structure */
+	    cut = grow(NULL, cut, &mcut, *ncut+1, sizeof(cut_t));
+	    cut[*ncut].pos = gdsfile_tell(gf);
+	    cut[*ncut].inside = 0;
+	    *ncut += 1;
+	    return cut;
+	 }
+	 continue;
+      }
+
+      cut = grow(NULL, cut, &mcut, *ncut+1, sizeof(cut_t));
+      cut[*ncut].pos = pos;
+      cut[*ncut].inside = 0;
+      *ncut += 1;
+      last = pos;
+
+      switch (rtype) {
+
+         case ENDLIB:
+	    if (!single)
+	       return cut;
+	    mxFree(cut);
+	    return NULL;
+
+         case BGNSTR:
+	    instr = 1;
+	    break;
+
+         default:
+	    mxFree(cut);
+	    return NULL;
+      }
+
+      if ( read_ignore(gf, rlen) )
+	 break;
+   }
+
+   mxFree(cut);
+   return NULL;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void*
+grow(lib_tables *lt, void *p, size_t *mcur, size_t need, size_t esz)
+{
+   size_t m;
+
+   if (need <= *mcur)
+      return p;
+
+   m = *mcur < 64 ? 64 : *mcur;
+   while (m < need)
+      m *= 2;
+   *mcur = m;
+
+   /* decoding threads must not use the MATLAB memory manager */
+   if (lt != NULL && lt->sysmem) {
+      p = realloc(p, m*esz);
+      if (p == NULL)
+	 decode_error(lt, "gds_read_library :  out of memory.");
+      return p;
+   }
+
+   return mxRealloc(p, m*esz);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * raise an error in the MATLAB thread, or return to the 
+ * thread function of a decoding thread.
+ */
+static void
+decode_error(lib_tables *lt, const char *msg)
+{
+   if (lt != NULL && lt->ctx != NULL) {
+      strncpy(lt->ctx->msg, msg, sizeof(lt->ctx->msg)-1);
+      lt->ctx->msg[sizeof(lt->ctx->msg)-1] = '\0';
+      longjmp(lt->ctx->jmp, 1);
+   }
+   mexErrMsgTxt(msg);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * reads a name into a fixed size buffer, using the string pool
+ * as scratch space for names that are longer than the buffer.
+ */
+static void
+read_sname(gdsfile_t *gf, lib_tables *lt, char *sname, int nmax, int rlen)
+{
+   lt->str = grow(lt, lt->str, &lt->mstr, lt->nstr+rlen+1, sizeof(char));
+   if ( read_string(gf, lt->str + lt->nstr, rlen) )
+      decode_error(lt, "gds_read_element :  could not read structure name.");
+   if (rlen >= nmax)
+      rlen = nmax - 1;
+   memcpy(sname, lt->str + lt->nstr, rlen);
+   sname[rlen] = '\0';
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static long
+read_text_string(gdsfile_t *gf, lib_tables *lt, int rlen)
+{
+   long off;
+
+   lt->str = grow(lt, lt->str, &lt->mstr, lt->nstr+rlen+1, sizeof(char));
+   off = lt->nstr;
+   if ( read_string(gf, lt->str + off, rlen) )
+      decode_error(lt, "gds_read_element (text) :  could not read string.");
+   lt->nstr += rlen+1;
+
+   return off;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+read_xy_record(gdsfile_t *gf, lib_tables *lt, el_rec *pe, int rlen)
+{
+   xy_rec *pxy;
+   int n;
+
+   n = rlen / sizeof(int32_t);
+   lt->vtx = grow(lt, lt->vtx, &lt->mvtx, lt->nvtx+n, sizeof(int32_t));
+   if ( read_int_be_n(gf, lt->vtx + lt->nvtx, n) )
+      decode_error(lt, "gds_read_element :  could not read XY record.");
+
+   lt->xy = grow(lt, lt->xy, &lt->mxy, lt->nxy+1, sizeof(xy_rec));
+   pxy = &lt->xy[lt->nxy];
+   pxy->off = lt->nvtx;
+   pxy->m = n / 2;
+
+   lt->nvtx += n;
+   lt->nxy += 1;
+   pe->nxy += 1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * A PROPATTR record begins a new attribute / value pair. Like
+ * the original reader, an attribute without a value is replaced
+ * by the next attribute.
+ */
+static void
+read_propattr(gdsfile_t *gf, lib_tables *lt, el_rec *pe)
+{
+   prop_rec *pp;
+   int16_t attr;
+
+   if ( read_word(gf, (uint16_t *)&attr) )
+      decode_error(lt, "read_propattr :  read failed.");
+
+   if (pe->nslot == pe->nval) {
+      lt->prop = grow(lt, lt->prop, &lt->mprop, lt->nprop+1, sizeof(prop_rec));
+      lt->nprop += 1;
+      pe->nslot += 1;
+      lt->prop[pe->prop + pe->nval].name = -1;
+   }
+   pp = &lt->prop[pe->prop + pe->nval];
+   pp->attr = attr;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+read_propvalue(gdsfile_t *gf, lib_tables *lt, el_rec *pe, int rlen)
+{
+   long off;
+
+   if (pe->nval >= pe->nslot)
+      decode_error(lt, "read_propvalue :  PROPVALUE record without PROPATTR record.");
+
+   lt->str = grow(lt, lt->str, &lt->mstr, lt->nstr+rlen+1, sizeof(char));
+   off = lt->nstr;
+   if ( read_string(gf, lt->str + off, rlen) )
+      decode_error(lt, "read_propvalue :  read failed.");
+   lt->nstr += rlen+1;
+
+   lt->prop[pe->prop + pe->nval].name = off;
+   pe->nval += 1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static uint16_t
+read_elflags(gdsfile_t *gf, lib_tables *lt)
+{
+   uint16_t elflags;
+
+   if ( read_word(gf, &elflags) )
+      decode_error(lt, "read_elflags :  read failed.");
+
+   return elflags;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static int32_t
+read_plex(gdsfile_t *gf, lib_tables *lt)
+{
+   int32_t plex;
+
+   if ( read_int(gf, &plex) )
+      decode_error(lt, "read_plex :  read failed.");
+
+   if ( plex & (1<<23) ) {
+      plex = plex & ~(1<<23);
+      plex = -plex;
+   }
+
+   return plex;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static uint16_t
+read_layer(gdsfile_t *gf, lib_tables *lt)
+{
+   uint16_t layer;
+
+   if ( read_word(gf, &layer) )
+      decode_error(lt, "read_layer :  failed to read layer info.");
+
+   return layer;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static uint16_t
+read_type(gdsfile_t *gf, lib_tables *lt)
+{
+   uint16_t type;
+
+   if ( read_word(gf, &type) )
+      decode_error(lt, "read_type :  failed to read type info.");
+
+   return type;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static int32_t
+read_extn(gdsfile_t *gf, lib_tables *lt)
+{
+   int32_t ext;
+
+   if ( read_int(gf, &ext) )
+      decode_error(lt, "read_ext :  read failed.");
+
+   return ext;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static int32_t
+read_width(gdsfile_t *gf, lib_tables *lt)
+{
+   int32_t width;
+
+   if ( read_int(gf, &width) )
+      decode_error(lt, "read_width :  read failed.");
+
+   return width;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+read_colrow(gdsfile_t *gf, lib_tables *lt, uint16_t *row, uint16_t *col)
+{
+    uint16_t colrow[2];
+
+    if ( read_word_n(gf, colrow, 2) )
+       decode_error(lt, "read_colrow :  read failed.");
+
+    *row = colrow[1];
+    *col = colrow[0];
+}
+
+/*-----------------------------------------------------------------*/
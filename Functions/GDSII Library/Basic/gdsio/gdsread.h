@@ -0,0 +1,183 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Decodes GDS II structures and elements into compact tables and
+ * converts the tables into the mxArray data used by the gds_element
+ * and gds_structure classes. Decoding and conversion are separate
+ * steps, which makes it possible to read entire libraries without
+ * creating MATLAB data until all records have been parsed.
+ */
+
+#ifndef _GDSREAD_H
+#define _GDSREAD_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "mex.h"
+#include "gdstypes.h"
+#include "gdsio.h"
+
+
+/*-- Types --------------------------------------------------------*/
+
+struct decode_ctx;     /* error context of a decoding thread */
+
+/*
+ * one XY record; the coordinates are stored in database units
+ * in the vertex pool in the order in which they appear in the file.
+ * The byte order is not changed until the coordinates are converted.
+ */
+typedef struct {
+   size_t off;       /* index of first coordinate in vertex pool */
+   int m;            /* number of vertices */
+} xy_rec;
+
+/*
+ * one property attribute / value pair
+ */
+typedef struct {
+   int16_t attr;
+   long name;        /* offset of value in string pool, -1 if none */
+} prop_rec;
+
+/*
+ * element table entry
+ */
+typedef struct {
+   element_t internal;  /* data stored in the gds_element object */
+   size_t xy;           /* first XY record */
+   int nxy;             /* number of XY records */
+   size_t prop;         /* first property slot */
+   int nslot;           /* number of property slots */
+   int nval;            /* number of PROPVALUE records */
+   long text;           /* offset of text string, -1 if none */
+} el_rec;
+
+/*
+ * structure table entry
+ */
+typedef struct {
+   char sname[48];      /* structure name */
+   date_t cdate;        /* creation date */
+   date_t mdate;        /* modification date */
+   size_t el;           /* first element */
+   size_t nel;          /* number of elements */
+   long spos;           /* file position of BGNSTR record */
+   long epos;           /* file position after ENDSTR */
+   size_t ref;          /* first referenced structure name */
+   int nref;            /* number of referenced structures */
+   int cont;            /* continues the last structure of the
+                           previous table set (decode_library_mt) */
+} st_rec;
+
+/*
+ * decoded library data
+ */
+typedef struct {
+   double dbu_to_uu;    /* database unit --> user unit */
+   st_rec *st;          /* structure table */
+   size_t nst, mst;
+   el_rec *el;          /* element table */
+   size_t nel, mel;
+   xy_rec *xy;          /* XY record table */
+   size_t nxy, mxy;
+   prop_rec *prop;      /* property table */
+   size_t nprop, mprop;
+   int32_t *vtx;        /* vertex pool, big endian as in the file */
+   size_t nvtx, mvtx;
+   char *str;           /* string pool */
+   size_t nstr, mstr;
+   long *ref;           /* referenced structure names in string pool */
+   size_t nref, mref;
+   const uint8_t *raw;  /* mapped file when the element records are kept */
+   long *rpos;          /* element k has the records raw[rpos[2k]] up to,
+                           but not including, raw[rpos[2k+1]] */
+   size_t mrpos;
+   int sysmem;          /* tables use the C library memory manager */
+   int intxy;           /* XY matrices are int32 in database units */
+   struct decode_ctx *ctx; /* error context, NULL in the MATLAB thread */
+} lib_tables;
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * initialize and release decoding tables
+ */
+void init_tables(lib_tables *lt, double dbu_to_uu);
+void free_tables(lib_tables *lt);
+
+/*
+ * release the table sets returned by decode_library_mt
+ */
+void free_tables_mt(lib_tables *plt, int nlt);
+
+/*
+ * decode one element beginning after the element record header
+ * of type rtype and append it to the element table. When lt->raw
+ * is set, the file positions of the element records are recorded
+ * in lt->rpos.
+ */
+void decode_element(gdsfile_t *gf, lib_tables *lt, uint16_t rtype);
+
+/*
+ * decode one structure beginning after the BGNSTR record header
+ * and append it and its elements to the tables.
+ */
+void decode_structure(gdsfile_t *gf, lib_tables *lt);
+
+/*
+ * decode all structures up to and including the ENDLIB record.
+ * The file must be positioned after the library header.
+ */
+void decode_library(gdsfile_t *gf, lib_tables *lt);
+
+/*
+ * decode all structures up to and including the ENDLIB record 
+ * with up to nthreads threads (all processors when nthreads <= 0).
+ * When single is set, only the structure following a BGNSTR record 
+ * header is decoded. The structure boundaries, and element boundaries
+ * in large structures, are found with a scan of the record headers.
+ * Then ranges of the file are decoded concurrently into *nlt table
+ * sets, which contain the structures in file order. A structure that
+ * is split between ranges continues in the first entry of the next 
+ * table set, which is marked with 'cont'.
+ * When raw is set, the table sets keep the file positions of the
+ * element records (see lib_tables).
+ * Returns NULL when the file is not memory mapped, when threads 
+ * are not available, or when decoding in parallel is not useful; 
+ * the file position is then unchanged.
+ */
+lib_tables* decode_library_mt(gdsfile_t *gf, double dbu_to_uu, 
+                              int nthreads, int single, int raw, int *nlt);
+
+/*
+ * record the names, file positions, and referenced structures
+ * of all structures up to the ENDLIB record without decoding 
+ * elements. The file must be positioned after the library header.
+ */
+void scan_library(gdsfile_t *gf, lib_tables *lt);
+
+/*
+ * create the element data structure of element k, identical
+ * to the structure returned by gds_read_element.
+ */
+mxArray* element_to_mx(lib_tables *lt, size_t k);
+
+/*
+ * create a 1 x N structure array with fields sname, cdate, mdate,
+ * and el (a cell array with element data) for all structures
+ * in nlt table sets.
+ */
+mxArray* structures_to_mx(lib_tables *plt, int nlt);
+
+/*
+ * create a 1 x N structure array with fields sname, offset, length,
+ * numel, and refs (a cell array with names of referenced structures)
+ * from the data collected by scan_library.
+ */
+mxArray* index_to_mx(lib_tables *lt);
+
+#endif /* _GDSREAD_H */
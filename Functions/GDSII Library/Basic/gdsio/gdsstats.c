@@ -0,0 +1,596 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Element statistics of GDS II structures. The records of each
+ * structure are scanned in memory: directly in the mapped file, or
+ * in a buffer into which the structure was read when the file is
+ * not mapped. Only LAYER, type, XY, and the element and structure
+ * delimiting records are examined; all other records are skipped.
+ * Scanning threads use the C library memory manager.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsio.h"
+#include "gdsstats.h"
+#include "byteswap.h"
+#include "gdsthreads.h"
+
+/* indices of element counts in layer_stat */
+#define C_BOUNDARY   0
+#define C_PATH       1
+#define C_BOX        2
+#define C_NODE       3
+#define C_TEXT       4
+
+
+/*-- Local Types --------------------------------------------------*/
+
+/*
+ * a range of structures scanned by one thread
+ */
+typedef struct {
+   const uint8_t *map;  /* mapped file */
+   struct_stat *ss;     /* structures of the range */
+   size_t nss;
+} chunk_t;
+
+
+/*-- Local Functions ----------------------------------------------*/
+
+static const char* scan_structure(const uint8_t *p, const uint8_t *end, struct_stat *ss);
+static layer_stat* find_layer(struct_stat *ss, uint16_t layer, uint16_t dtype);
+static struct_stat* find_structures(gdsfile_t *gf, size_t *nst);
+static struct_stat* read_structures(gdsfile_t *gf, size_t *nst);
+static int compare_layers(const void *a, const void *b);
+static void* grow(void *p, size_t *mcur, size_t need, size_t esz);
+static void scan_chunk(void *arg, int k);
+
+
+/*-----------------------------------------------------------------*/
+
+static INLINE uint16_t
+load_be16(const uint8_t *p)
+{
+   return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+struct_stat*
+library_stats(gdsfile_t *gf, int nthreads, size_t *nst)
+{
+   struct_stat *ps;
+   const char *err;
+   size_t k, j;
+   chunk_t *pc;
+   long total;
+   int nchunk, c;
+
+   /* files that are not mapped are scanned one structure at a time */
+   if (gf->map == NULL)
+      return read_structures(gf, nst);
+
+   ps = find_structures(gf, nst);
+
+   nthreads = pool_threads(nthreads);
+   if (nthreads > 1 && *nst > 1) {
+
+      /* divide the structures into ranges of similar size */
+      nchunk = nthreads * TASKS_PER_THREAD;
+      if ((size_t)nchunk > *nst)
+	 nchunk = *nst;
+      pc = (chunk_t *)mxCalloc(nchunk, sizeof(chunk_t));
+      total = ps[*nst-1].epos - ps[0].spos;
+      for (c=0, k=0; k<*nst; c++) {
+	 j = k + 1;
+	 while (j < *nst &&
+		ps[j].spos - ps[0].spos < (double)total * (c+1) / nchunk)
+	    j++;
+	 pc[c].map = gf->map;
+	 pc[c].ss = ps + k;
+	 pc[c].nss = j - k;
+	 k = j;
+      }
+      nchunk = c;
+
+      /* scan the ranges */
+      run_tasks(scan_chunk, pc, nchunk, nthreads);
+      mxFree(pc);
+   }
+   else {
+      for (k=0; k<*nst; k++)
+	 ps[k].err = scan_structure(gf->map + ps[k].spos, gf->map + ps[k].epos, &ps[k]);
+   }
+
+   /* report the first error in the file */
+   for (k=0; k<*nst; k++) {
+      if (ps[k].err != NULL) {
+	 err = ps[k].err;
+	 free_stats(ps, *nst);
+	 mexErrMsgTxt(err);
+      }
+   }
+
+   return ps;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+free_stats(struct_stat *ps, size_t nst)
+{
+   size_t k;
+
+   for (k=0; k<nst; k++) {
+      free(ps[k].ls);
+      free(ps[k].slot);
+   }
+   free(ps);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+mxArray*
+stats_to_mx(struct_stat *ps, size_t nst, double dbu_to_uu)
+{
+   mxArray *pstat, *pc, *pv, *pb, *pn, *pl, *pd;
+   struct_stat *ss;
+   layer_stat *pls;
+   double *pr;
+   size_t k, n, nls;
+   int j;
+   const char *fields[] = {"sname", "offset", "length", "numel",
+			   "sref", "aref", "layer", "dtype", "count",
+			   "vertices", "bbox", "bytes"};
+
+   pstat = mxCreateStructMatrix(1, nst, 12, fields);
+
+   for (k=0; k<nst; k++) {
+
+      ss = &ps[k];
+      mxSetFieldByNumber(pstat, k, 0, mxCreateString(ss->sname));
+      mxSetFieldByNumber(pstat, k, 1, mxCreateDoubleScalar((double)ss->spos));
+      mxSetFieldByNumber(pstat, k, 2, mxCreateDoubleScalar((double)(ss->epos - ss->spos)));
+      mxSetFieldByNumber(pstat, k, 3, mxCreateDoubleScalar((double)ss->nel));
+      mxSetFieldByNumber(pstat, k, 4, mxCreateDoubleScalar((double)ss->nsref));
+      mxSetFieldByNumber(pstat, k, 5, mxCreateDoubleScalar((double)ss->naref));
+
+      /* one row per layer and data type */
+      nls = ss->nls;
+      if (nls > 1)
+	 qsort(ss->ls, nls, sizeof(layer_stat), compare_layers);
+      pl = mxCreateDoubleMatrix(nls, 1, mxREAL);
+      pd = mxCreateDoubleMatrix(nls, 1, mxREAL);
+      pc = mxCreateDoubleMatrix(nls, 5, mxREAL);
+      pv = mxCreateDoubleMatrix(nls, 1, mxREAL);
+      pb = mxCreateDoubleMatrix(nls, 4, mxREAL);
+      pn = mxCreateDoubleMatrix(nls, 1, mxREAL);
+      for (n=0; n<nls; n++) {
+	 pls = &ss->ls[n];
+	 mxGetPr(pl)[n] = pls->layer;
+	 mxGetPr(pd)[n] = pls->dtype;
+	 pr = mxGetPr(pc);
+	 for (j=0; j<5; j++)
+	    pr[n + j*nls] = (double)pls->count[j];
+	 mxGetPr(pv)[n] = (double)pls->nvtx;
+	 pr = mxGetPr(pb);
+	 for (j=0; j<4; j++)
+	    pr[n + j*nls] = pls->nvtx ? dbu_to_uu * pls->bbox[j] : mxGetNaN();
+	 mxGetPr(pn)[n] = (double)pls->bytes;
+      }
+      mxSetFieldByNumber(pstat, k, 6, pl);
+      mxSetFieldByNumber(pstat, k, 7, pd);
+      mxSetFieldByNumber(pstat, k, 8, pc);
+      mxSetFieldByNumber(pstat, k, 9, pv);
+      mxSetFieldByNumber(pstat, k, 10, pb);
+      mxSetFieldByNumber(pstat, k, 11, pn);
+   }
+
+   return pstat;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * scans the records of one structure from the BGNSTR record
+ * to the ENDSTR record. Returns an error message or NULL.
+ */
+static const char*
+scan_structure(const uint8_t *p, const uint8_t *end, struct_stat *ss)
+{
+   const uint8_t *el = NULL, *pxy;
+   layer_stat *pls;
+   uint16_t rtype, layer = 0, dtype = 0;
+   int32_t x, y, bbox[4] = {0, 0, 0, 0};
+   size_t rlen, nvtx = 0, m, k;
+   int kind = -1;
+
+   while (end - p >= 4) {
+
+      rlen = load_be16(p);
+      rtype = load_be16(p+2);
+      if (rlen < 4 || rlen > (size_t)(end - p))
+	 return "gds_layer_stats :  invalid record length.";
+
+      switch (rtype) {
+
+         case STRNAME:
+	    m = rlen - 4;
+	    if (m > sizeof(ss->sname) - 1)
+	       m = sizeof(ss->sname) - 1;
+	    memcpy(ss->sname, p+4, m);
+	    ss->sname[m] = '\0';
+	    break;
+
+         case BOUNDARY:
+         case PATH:
+         case BOX:
+         case NODE:
+         case TEXT:
+         case SREF:
+         case AREF:
+	    if (el != NULL)
+	       return "gds_layer_stats :  ENDEL record missing.";
+	    el = p;
+	    kind = rtype;
+	    layer = dtype = 0;
+	    nvtx = 0;
+	    bbox[0] = bbox[1] = INT32_MAX;
+	    bbox[2] = bbox[3] = INT32_MIN;
+	    ss->nel += 1;
+	    break;
+
+         case LAYER:
+	    if (rlen >= 6)
+	       layer = load_be16(p+4);
+	    break;
+
+         case DATATYPE:
+         case TEXTTYPE:
+         case BOXTYPE:
+         case NODETYPE:
+	    if (rlen >= 6)
+	       dtype = load_be16(p+4);
+	    break;
+
+         case XY:
+	    if (el == NULL || kind == SREF || kind == AREF)
+	       break;
+	    m = (rlen - 4) / 8;
+	    nvtx += m;
+	    for (pxy=p+4, k=0; k<m; k++, pxy+=8) {
+	       x = load_be32(pxy);
+	       y = load_be32(pxy + 4);
+	       if (x < bbox[0]) bbox[0] = x;
+	       if (y < bbox[1]) bbox[1] = y;
+	       if (x > bbox[2]) bbox[2] = x;
+	       if (y > bbox[3]) bbox[3] = y;
+	    }
+	    break;
+
+         case ENDEL:
+	    if (el == NULL)
+	       return "gds_layer_stats :  ENDEL outside of element.";
+	    if (kind == SREF)
+	       ss->nsref += 1;
+	    else if (kind == AREF)
+	       ss->naref += 1;
+	    else {
+	       pls = find_layer(ss, layer, dtype);
+	       if (pls == NULL)
+		  return "gds_layer_stats :  out of memory.";
+	       switch (kind) {
+	          case BOUNDARY: pls->count[C_BOUNDARY] += 1; break;
+	          case PATH:     pls->count[C_PATH] += 1; break;
+	          case BOX:      pls->count[C_BOX] += 1; break;
+	          case NODE:     pls->count[C_NODE] += 1; break;
+	          case TEXT:     pls->count[C_TEXT] += 1; break;
+	       }
+	       if (nvtx) {
+		  if (bbox[0] < pls->bbox[0]) pls->bbox[0] = bbox[0];
+		  if (bbox[1] < pls->bbox[1]) pls->bbox[1] = bbox[1];
+		  if (bbox[2] > pls->bbox[2]) pls->bbox[2] = bbox[2];
+		  if (bbox[3] > pls->bbox[3]) pls->bbox[3] = bbox[3];
+		  pls->nvtx += nvtx;
+	       }
+	       pls->bytes += (p + rlen) - el;
+	    }
+	    el = NULL;
+	    break;
+
+         case ENDSTR:
+	    if (el != NULL)
+	       return "gds_layer_stats :  ENDEL record missing.";
+	    return NULL;
+      }
+
+      p += rlen;
+   }
+
+   return "gds_layer_stats :  ENDSTR record missing.";
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * returns the statistics of a layer and data type, which are
+ * created when they do not exist yet. Layers are found with
+ * a hash table with open addressing.
+ */
+static layer_stat*
+find_layer(struct_stat *ss, uint16_t layer, uint16_t dtype)
+{
+   layer_stat *pls;
+   size_t h, k, m;
+   uint32_t key;
+   void *p;
+
+   key = ((uint32_t)layer << 16) | dtype;
+
+   if (ss->mslot) {
+      h = (key * 2654435761U) & (ss->mslot - 1);
+      while (ss->slot[h] >= 0) {
+	 pls = &ss->ls[ss->slot[h]];
+	 if (pls->layer == layer && pls->dtype == dtype)
+	    return pls;
+	 h = (h + 1) & (ss->mslot - 1);
+      }
+   }
+
+   /* new layer; keep the table at most half full */
+   if (2*(ss->nls + 1) > ss->mslot) {
+      m = ss->mslot ? 2*ss->mslot : 64;
+      free(ss->slot);
+      ss->slot = (int *)malloc(m * sizeof(int));
+      if (ss->slot == NULL) {
+	 ss->mslot = 0;
+	 return NULL;
+      }
+      ss->mslot = m;
+      for (h=0; h<m; h++)
+	 ss->slot[h] = -1;
+      for (k=0; k<ss->nls; k++) {
+	 h = ((((uint32_t)ss->ls[k].layer << 16) | ss->ls[k].dtype) * 2654435761U) & (m - 1);
+	 while (ss->slot[h] >= 0)
+	    h = (h + 1) & (m - 1);
+	 ss->slot[h] = k;
+      }
+   }
+
+   /* free slot of the new layer */
+   h = (key * 2654435761U) & (ss->mslot - 1);
+   while (ss->slot[h] >= 0)
+      h = (h + 1) & (ss->mslot - 1);
+
+   p = grow(ss->ls, &ss->mls, ss->nls+1, sizeof(layer_stat));
+   if (p == NULL)
+      return NULL;
+   ss->ls = (layer_stat *)p;
+   pls = &ss->ls[ss->nls];
+   memset(pls, '\0', sizeof(layer_stat));
+   pls->layer = layer;
+   pls->dtype = dtype;
+   pls->bbox[0] = pls->bbox[1] = INT32_MAX;
+   pls->bbox[2] = pls->bbox[3] = INT32_MIN;
+   ss->slot[h] = ss->nls++;
+
+   return pls;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * finds the structures in a mapped file with a scan of
+ * the record headers up to the ENDLIB record.
+ */
+static struct_stat*
+find_structures(gdsfile_t *gf, size_t *nst)
+{
+   struct_stat *ps = NULL;
+   size_t mst = 0;
+   uint16_t rtype, rlen;
+   int instr = 0;
+   void *p;
+
+   *nst = 0;
+   while (1) {
+
+      if ( read_record_hdr(gf, &rtype, &rlen) ) {
+	 free_stats(ps, *nst);
+	 mexErrMsgTxt("gds_layer_stats :  could not read record header.");
+      }
+
+      if (instr) {
+	 if (rtype == ENDSTR) {
+	    ps[*nst].epos = gdsfile_tell(gf) + rlen;
+	    *nst += 1;
+	    instr = 0;
+	 }
+      }
+      else {
+	 switch (rtype) {
+
+	    case ENDLIB:
+	       return ps;
+
+	    case BGNSTR:
+	       p = grow(ps, &mst, *nst+1, sizeof(struct_stat));
+	       if (p == NULL) {
+		  free_stats(ps, *nst);
+		  mexErrMsgTxt("gds_layer_stats :  out of memory.");
+	       }
+	       ps = (struct_stat *)p;
+	       memset(&ps[*nst], '\0', sizeof(struct_stat));
+	       ps[*nst].spos = gdsfile_tell(gf) - 2*sizeof(uint16_t);
+	       instr = 1;
+	       break;
+
+	    default:
+	       free_stats(ps, *nst);
+	       mexErrMsgTxt("gds_layer_stats :  BGNSTR or ENDLIB record expected.");
+	 }
+      }
+
+      if ( read_ignore(gf, rlen) ) {
+	 free_stats(ps, *nst);
+	 mexErrMsgTxt("gds_layer_stats :  unexpected end of file.");
+      }
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * reads the structures of a file that is not mapped into a
+ * buffer, one at a time, and scans them.
+ */
+static struct_stat*
+read_structures(gdsfile_t *gf, size_t *nst)
+{
+   struct_stat *ps = NULL;
+   uint8_t *buf = NULL;
+   size_t mst = 0, mbuf = 0, nbuf = 0;
+   const char *err = NULL;
+   uint16_t rtype, rlen;
+   int instr = 0;
+   void *p;
+
+   *nst = 0;
+   while (1) {
+
+      if ( read_record_hdr(gf, &rtype, &rlen) ) {
+	 err = "gds_layer_stats :  could not read record header.";
+	 break;
+      }
+
+      if (!instr) {
+	 if (rtype == ENDLIB)
+	    break;
+	 if (rtype != BGNSTR) {
+	    err = "gds_layer_stats :  BGNSTR or ENDLIB record expected.";
+	    break;
+	 }
+	 p = grow(ps, &mst, *nst+1, sizeof(struct_stat));
+	 if (p == NULL) {
+	    err = "gds_layer_stats :  out of memory.";
+	    break;
+	 }
+	 ps = (struct_stat *)p;
+	 memset(&ps[*nst], '\0', sizeof(struct_stat));
+	 ps[*nst].spos = gdsfile_tell(gf) - 2*sizeof(uint16_t);
+	 nbuf = 0;
+	 instr = 1;
+      }
+
+      /* copy the record to the buffer */
+      p = grow(buf, &mbuf, nbuf + rlen + 4, sizeof(uint8_t));
+      if (p == NULL) {
+	 err = "gds_layer_stats :  out of memory.";
+	 break;
+      }
+      buf = (uint8_t *)p;
+      buf[nbuf]   = (uint8_t)((rlen + 4) >> 8);
+      buf[nbuf+1] = (uint8_t)(rlen + 4);
+      buf[nbuf+2] = (uint8_t)(rtype >> 8);
+      buf[nbuf+3] = (uint8_t)rtype;
+      if (gdsfile_read(gf, buf + nbuf + 4, rlen) != rlen) {
+	 err = "gds_layer_stats :  unexpected end of file.";
+	 break;
+      }
+      nbuf += rlen + 4;
+
+      if (rtype == ENDSTR) {
+	 ps[*nst].epos = gdsfile_tell(gf);
+	 err = scan_structure(buf, buf + nbuf, &ps[*nst]);
+	 *nst += 1;
+	 if (err != NULL)
+	    break;
+	 instr = 0;
+      }
+   }
+
+   free(buf);
+   if (err != NULL) {
+      free_stats(ps, *nst);
+      mexErrMsgTxt(err);
+   }
+
+   return ps;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static int
+compare_layers(const void *a, const void *b)
+{
+   const layer_stat *pa = (const layer_stat *)a;
+   const layer_stat *pb = (const layer_stat *)b;
+
+   if (pa->layer != pb->layer)
+      return pa->layer < pb->layer ? -1 : 1;
+   if (pa->dtype != pb->dtype)
+      return pa->dtype < pb->dtype ? -1 : 1;
+   return 0;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * grows a table with the C library memory manager, which can be
+ * used by scanning threads. Returns NULL when out of memory; the
+ * table is then unchanged.
+ */
+static void*
+grow(void *p, size_t *mcur, size_t need, size_t esz)
+{
+   size_t m;
+   void *q;
+
+   if (need <= *mcur)
+      return p;
+
+   m = *mcur < 64 ? 64 : *mcur;
+   while (m < need)
+      m *= 2;
+
+   q = realloc(p, m*esz);
+   if (q != NULL)
+      *mcur = m;
+
+   return q;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * task function for library_stats: scans range k
+ */
+static void
+scan_chunk(void *arg, int k)
+{
+   chunk_t *pc = (chunk_t *)arg + k;
+   size_t n;
+
+   for (n=0; n<pc->nss; n++)
+      pc->ss[n].err = scan_structure(pc->map + pc->ss[n].spos,
+				     pc->map + pc->ss[n].epos, &pc->ss[n]);
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,77 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Collects statistics of the elements in GDS II structures from the
+ * raw records, without decoding elements into tables or creating
+ * MATLAB data: the number of elements of each type, the number of
+ * vertices, the bounding box, and the number of bytes for each
+ * layer and data type of a structure. The structures of memory
+ * mapped files are scanned by several threads.
+ */
+
+#ifndef _GDSSTATS_H
+#define _GDSSTATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mex.h"
+#include "gdsio.h"
+
+
+/*-- Types --------------------------------------------------------*/
+
+/*
+ * element statistics of one layer and data type in a structure.
+ * Text, box, and node types are counted as data types.
+ */
+typedef struct {
+   uint16_t layer;
+   uint16_t dtype;
+   size_t count[5];     /* boundary, path, box, node, text elements */
+   size_t nvtx;         /* vertices in XY records */
+   int32_t bbox[4];     /* xmin, ymin, xmax, ymax of the vertices (DBU) */
+   size_t bytes;        /* bytes of the element records */
+} layer_stat;
+
+/*
+ * statistics of one structure
+ */
+typedef struct {
+   char sname[48];      /* structure name */
+   long spos;           /* file position of BGNSTR record */
+   long epos;           /* file position after ENDSTR */
+   size_t nel;          /* number of elements */
+   size_t nsref;        /* number of sref elements */
+   size_t naref;        /* number of aref elements */
+   layer_stat *ls;      /* layer statistics */
+   size_t nls, mls;
+   int *slot;           /* hash table of layer statistics */
+   size_t mslot;
+   const char *err;     /* error message or NULL */
+} struct_stat;
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * scan all structures up to the ENDLIB record. The file must be
+ * positioned after the library header. Structures of memory mapped
+ * files are scanned with up to nthreads threads (all processors
+ * when nthreads <= 0). Returns the statistics of *nst structures
+ * in file order.
+ */
+struct_stat* library_stats(gdsfile_t *gf, int nthreads, size_t *nst);
+
+/*
+ * release the statistics returned by library_stats
+ */
+void free_stats(struct_stat *ps, size_t nst);
+
+/*
+ * create a 1 x N structure array with the statistics of nst
+ * structures; coordinates are converted to user units.
+ */
+mxArray* stats_to_mx(struct_stat *ps, size_t nst, double dbu_to_uu);
+
+#endif /* _GDSSTATS_H */
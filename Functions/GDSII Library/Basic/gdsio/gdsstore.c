@@ -0,0 +1,655 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Element stores (see gdsstore.h). Stores are created from the
+ * decoding tables of the GDS II reader and converted back to the
+ * tables when element data are needed, which makes it possible to
+ * use the conversion functions of the reader for both.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsread.h"
+#include "gdsstore.h"
+#include "mexfuncs.h"
+#include "byteswap.h"
+
+/* longest text string and property value */
+#define TXTLEN  512
+#define VLEN    128
+
+/* store fields */
+#define F_KIND    0
+#define F_LAYER   1
+#define F_DTYPE   2
+#define F_FLAGS   3
+#define F_XYREC   4
+#define F_XYOFF   5
+#define F_VTX     6
+#define F_EXT     7
+#define F_ELDATA  8
+#define F_TEXT    9
+#define F_PROP   10
+#define F_PATTR  11
+#define F_PVAL   12
+#define F_SCALE  13
+#define F_RAW    14
+#define F_RAWOFF 15
+#define F_DIRTY  16
+#define NFIELD   17
+
+static const char *store_fields[] = {"kind", "layer", "dtype", "flags",
+				     "xyrec", "xyoff", "vtx", "ext", "eldata",
+				     "text", "prop", "pattr", "pval", "dbu_to_uu",
+				     "raw", "rawoff", "dirty"};
+
+
+/*-- Local Functions ----------------------------------------------*/
+
+static int needs_ext(const element_t *pe);
+static void simple_element(element_kind kind, uint16_t layer, uint16_t dtype, element_t *pe);
+static const void* field_data(const mxArray *store, int f, mxClassID id, size_t n, const char *name);
+static void* grow(void *p, size_t *mcur, size_t need, size_t esz);
+static long add_string(lib_tables *lt, const char *s);
+static int raw_matches(const store_view *sv, size_t k, const uint8_t *raw, size_t nb);
+
+
+/*-----------------------------------------------------------------*/
+
+mxArray*
+tables_to_store(lib_tables **plt, st_rec **ps, int npart)
+{
+   mxArray *store, *pa[NFIELD];
+   lib_tables *lt;
+   el_rec *pe;
+   xy_rec *pxy;
+   prop_rec *pp;
+   uint8_t *kind;
+   uint16_t *layer, *dtype;
+   uint32_t *flags, *xyrec, *xyoff, *ext, *prop, *rawoff;
+   int16_t *pattr;
+   int32_t *vtx;
+   uint8_t *eldata, *raw;
+   const long *rp;
+   size_t nel, nrec, nvtx, next, nprop, nraw;
+   size_t k, m, i, r, e, p;
+   int u, n, keep;
+
+
+   /* count the elements, records, vertices, and record bytes */
+   nel = nrec = nvtx = next = nprop = nraw = 0;
+   keep = npart > 0;
+   for (u=0; u<npart; u++) {
+      lt = plt[u];
+      keep = keep && lt->raw != NULL;
+      for (m=0; m<ps[u]->nel; m++) {
+	 pe = &lt->el[ps[u]->el + m];
+	 nel += 1;
+	 nrec += pe->nxy;
+	 for (n=0; n<pe->nxy; n++)
+	    nvtx += lt->xy[pe->xy + n].m;
+	 next += needs_ext(&pe->internal);
+	 nprop += pe->nslot;
+	 if (lt->raw != NULL) {
+	    rp = lt->rpos + 2*(ps[u]->el + m);
+	    nraw += rp[1] - rp[0];
+	 }
+      }
+   }
+   if (nvtx > UINT32_MAX || nrec > UINT32_MAX || nprop > UINT32_MAX)
+      mexErrMsgTxt("gds_store :  structure is too large for an element store.");
+   if (nraw > UINT32_MAX)
+      keep = 0;   /* the elements are encoded when they are written */
+   if (!keep)
+      nraw = 0;
+
+   /* create the store */
+   pa[F_KIND] = mxCreateNumericMatrix(1, nel, mxUINT8_CLASS, mxREAL);
+   pa[F_LAYER] = mxCreateNumericMatrix(1, nel, mxUINT16_CLASS, mxREAL);
+   pa[F_DTYPE] = mxCreateNumericMatrix(1, nel, mxUINT16_CLASS, mxREAL);
+   pa[F_FLAGS] = mxCreateNumericMatrix(1, nel, mxUINT32_CLASS, mxREAL);
+   pa[F_XYREC] = mxCreateNumericMatrix(1, nel+1, mxUINT32_CLASS, mxREAL);
+   pa[F_XYOFF] = mxCreateNumericMatrix(1, nrec+1, mxUINT32_CLASS, mxREAL);
+   pa[F_VTX] = mxCreateNumericMatrix(2, nvtx, mxINT32_CLASS, mxREAL);
+   pa[F_EXT] = mxCreateNumericMatrix(1, nel, mxUINT32_CLASS, mxREAL);
+   pa[F_ELDATA] = mxCreateNumericMatrix(sizeof(element_t), next, mxUINT8_CLASS, mxREAL);
+   pa[F_TEXT] = mxCreateCellMatrix(1, next);
+   pa[F_PROP] = mxCreateNumericMatrix(1, nel+1, mxUINT32_CLASS, mxREAL);
+   pa[F_PATTR] = mxCreateNumericMatrix(1, nprop, mxINT16_CLASS, mxREAL);
+   pa[F_PVAL] = mxCreateCellMatrix(1, nprop);
+   pa[F_SCALE] = mxCreateDoubleScalar(npart ? plt[0]->dbu_to_uu : 1.0);
+   pa[F_RAW] = mxCreateNumericMatrix(1, nraw, mxUINT8_CLASS, mxREAL);
+   pa[F_RAWOFF] = mxCreateNumericMatrix(1, keep ? nel+1 : 0, mxUINT32_CLASS, mxREAL);
+   pa[F_DIRTY] = mxCreateNumericMatrix(1, keep ? nel : 0, mxUINT8_CLASS, mxREAL);
+
+   kind = (uint8_t *)mxGetData(pa[F_KIND]);
+   layer = (uint16_t *)mxGetData(pa[F_LAYER]);
+   dtype = (uint16_t *)mxGetData(pa[F_DTYPE]);
+   flags = (uint32_t *)mxGetData(pa[F_FLAGS]);
+   xyrec = (uint32_t *)mxGetData(pa[F_XYREC]);
+   xyoff = (uint32_t *)mxGetData(pa[F_XYOFF]);
+   vtx = (int32_t *)mxGetData(pa[F_VTX]);
+   ext = (uint32_t *)mxGetData(pa[F_EXT]);
+   eldata = (uint8_t *)mxGetData(pa[F_ELDATA]);
+   prop = (uint32_t *)mxGetData(pa[F_PROP]);
+   pattr = (int16_t *)mxGetData(pa[F_PATTR]);
+   raw = (uint8_t *)mxGetData(pa[F_RAW]);
+   rawoff = (uint32_t *)mxGetData(pa[F_RAWOFF]);
+
+   /* copy the elements */
+   k = r = e = p = 0;
+   xyrec[0] = xyoff[0] = prop[0] = 0;
+   for (u=0; u<npart; u++) {
+      lt = plt[u];
+      for (m=0; m<ps[u]->nel; m++, k++) {
+
+	 pe = &lt->el[ps[u]->el + m];
+	 kind[k] = pe->internal.kind;
+	 layer[k] = pe->internal.layer;
+	 dtype[k] = pe->internal.dtype;
+	 flags[k] = pe->internal.has;
+
+	 /* internal data */
+	 ext[k] = 0;
+	 if ( needs_ext(&pe->internal) ) {
+	    memcpy(eldata + e*sizeof(element_t), &pe->internal, sizeof(element_t));
+	    if (pe->internal.kind == GDS_TEXT && pe->text >= 0)
+	       mxSetCell(pa[F_TEXT], e, mxCreateString(lt->str + pe->text));
+	    ext[k] = ++e;
+	 }
+
+	 /* vertices in host byte order */
+	 for (n=0; n<pe->nxy; n++, r++) {
+	    pxy = &lt->xy[pe->xy + n];
+	    memcpy(vtx + 2*(size_t)xyoff[r], lt->vtx + pxy->off, 2*pxy->m*sizeof(int32_t));
+	    byte_reverse32_n(vtx + 2*(size_t)xyoff[r], 2*pxy->m);
+	    xyoff[r+1] = xyoff[r] + pxy->m;
+	 }
+	 xyrec[k+1] = r;
+
+	 /* properties */
+	 for (n=0; n<pe->nslot; n++, p++) {
+	    pp = &lt->prop[pe->prop + n];
+	    pattr[p] = pp->attr;
+	    if (pp->name >= 0)
+	       mxSetCell(pa[F_PVAL], p, mxCreateString(lt->str + pp->name));
+	 }
+	 prop[k+1] = p;
+
+	 /* records as they were read */
+	 if (keep) {
+	    rp = lt->rpos + 2*(ps[u]->el + m);
+	    memcpy(raw + rawoff[k], lt->raw + rp[0], rp[1] - rp[0]);
+	    rawoff[k+1] = rawoff[k] + (uint32_t)(rp[1] - rp[0]);
+	 }
+      }
+   }
+
+   store = mxCreateStructMatrix(1, 1, NFIELD, store_fields);
+   for (i=0; i<NFIELD; i++)
+      mxSetFieldByNumber(store, 0, i, pa[i]);
+
+   return store;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+mxArray*
+structures_to_store(lib_tables *plt, int nlt)
+{
+   mxArray *pslist, *pa;
+   lib_tables **ptab;
+   st_rec **ppart;
+   double *pd;
+   st_rec *ps;
+   size_t k, i, nst;
+   int j, t, u, npart;
+   const char *fields[] = {"sname", "cdate", "mdate", "store"};
+
+   /* structures split between tables are counted once */
+   for (nst=0, t=0; t<nlt; t++) {
+      for (k=0; k<plt[t].nst; k++)
+	 nst += !plt[t].st[k].cont;
+   }
+   pslist = mxCreateStructMatrix(1, nst, 4, fields);
+   ptab = (lib_tables **)mxMalloc((nlt ? nlt : 1) * sizeof(lib_tables *));
+   ppart = (st_rec **)mxMalloc((nlt ? nlt : 1) * sizeof(st_rec *));
+
+   for (i=0, t=0; t<nlt; t++) {
+      for (k=0; k<plt[t].nst; k++) {
+
+	 ps = &plt[t].st[k];
+	 if (ps->cont)
+	    continue;
+
+	 mxSetFieldByNumber(pslist, i, 0, mxCreateString(ps->sname));
+
+	 pa = mxCreateDoubleMatrix(1, 6, mxREAL);
+	 pd = (double *)mxGetData(pa);
+	 for (j=0; j<6; j++)
+	    pd[j] = (double)ps->cdate[j];
+	 mxSetFieldByNumber(pslist, i, 1, pa);
+
+	 pa = mxCreateDoubleMatrix(1, 6, mxREAL);
+	 pd = (double *)mxGetData(pa);
+	 for (j=0; j<6; j++)
+	    pd[j] = (double)ps->mdate[j];
+	 mxSetFieldByNumber(pslist, i, 2, pa);
+
+	 /* the last structure of a table continues in the next tables */
+	 ptab[0] = &plt[t];
+	 ppart[0] = ps;
+	 npart = 1;
+	 if (k == plt[t].nst-1) {
+	    for (u=t+1; u<nlt && plt[u].nst && plt[u].st[0].cont; u++) {
+	       ptab[npart] = &plt[u];
+	       ppart[npart] = &plt[u].st[0];
+	       npart++;
+	       if (plt[u].nst > 1)
+		  break;
+	    }
+	 }
+
+	 mxSetFieldByNumber(pslist, i, 3, tables_to_store(ptab, ppart, npart));
+	 i++;
+      }
+   }
+
+   mxFree(ptab);
+   mxFree(ppart);
+
+   return pslist;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+get_store_view(const mxArray *store, store_view *sv)
+{
+   const mxArray *pa;
+   size_t k, nel;
+
+
+   if ( !mxIsStruct(store) || mxGetNumberOfElements(store) != 1 )
+      mexErrMsgTxt("gds_store :  element store must be a scalar structure.");
+
+   /* the number of elements is the length of the kind array */
+   pa = mxGetField(store, 0, "kind");
+   if (pa == NULL)
+      mexErrMsgTxt("gds_store :  missing field kind in element store.");
+   nel = mxGetNumberOfElements(pa);
+   sv->nel = nel;
+
+   sv->kind = (const uint8_t *)field_data(store, F_KIND, mxUINT8_CLASS, nel, "kind");
+   sv->layer = (const uint16_t *)field_data(store, F_LAYER, mxUINT16_CLASS, nel, "layer");
+   sv->dtype = (const uint16_t *)field_data(store, F_DTYPE, mxUINT16_CLASS, nel, "dtype");
+   sv->flags = (const uint32_t *)field_data(store, F_FLAGS, mxUINT32_CLASS, nel, "flags");
+   sv->xyrec = (const uint32_t *)field_data(store, F_XYREC, mxUINT32_CLASS, nel+1, "xyrec");
+   sv->ext = (const uint32_t *)field_data(store, F_EXT, mxUINT32_CLASS, nel, "ext");
+   sv->prop = (const uint32_t *)field_data(store, F_PROP, mxUINT32_CLASS, nel+1, "prop");
+
+   /* sizes of the pools */
+   pa = mxGetField(store, 0, "xyoff");
+   if (pa == NULL || mxIsEmpty(pa))
+      mexErrMsgTxt("gds_store :  missing field xyoff in element store.");
+   sv->nrec = mxGetNumberOfElements(pa) - 1;
+   sv->xyoff = (const uint32_t *)field_data(store, F_XYOFF, mxUINT32_CLASS, sv->nrec+1, "xyoff");
+
+   pa = mxGetField(store, 0, "vtx");
+   if (pa == NULL || (!mxIsEmpty(pa) && mxGetM(pa) != 2))
+      mexErrMsgTxt("gds_store :  vtx must be a 2 x N matrix.");
+   sv->nvtx = mxGetNumberOfElements(pa) / 2;
+   sv->vtx = (const int32_t *)field_data(store, F_VTX, mxINT32_CLASS, 2*sv->nvtx, "vtx");
+
+   pa = mxGetField(store, 0, "eldata");
+   if (pa == NULL || (!mxIsEmpty(pa) && mxGetM(pa) != sizeof(element_t)))
+      mexErrMsgTxt("gds_store :  eldata has the wrong size.");
+   sv->next = mxIsEmpty(pa) ? 0 : mxGetN(pa);
+   sv->eldata = (const element_t *)field_data(store, F_ELDATA, mxUINT8_CLASS,
+					      sv->next*sizeof(element_t), "eldata");
+
+   pa = mxGetField(store, 0, "pattr");
+   if (pa == NULL)
+      mexErrMsgTxt("gds_store :  missing field pattr in element store.");
+   sv->nprop = mxGetNumberOfElements(pa);
+   sv->pattr = (const int16_t *)field_data(store, F_PATTR, mxINT16_CLASS, sv->nprop, "pattr");
+
+   sv->text = mxGetField(store, 0, "text");
+   if (sv->text == NULL || !mxIsCell(sv->text) || mxGetNumberOfElements(sv->text) != sv->next)
+      mexErrMsgTxt("gds_store :  text must be a cell array with one entry per eldata column.");
+   sv->pval = mxGetField(store, 0, "pval");
+   if (sv->pval == NULL || !mxIsCell(sv->pval) || mxGetNumberOfElements(sv->pval) != sv->nprop)
+      mexErrMsgTxt("gds_store :  pval must be a cell array with one entry per property.");
+
+   pa = mxGetField(store, 0, "dbu_to_uu");
+   if (pa == NULL || !mxIsDouble(pa) || mxIsEmpty(pa))
+      mexErrMsgTxt("gds_store :  missing field dbu_to_uu in element store.");
+   sv->dbu_to_uu = mxGetScalar(pa);
+
+   /* the records of the elements are optional */
+   sv->raw = NULL;
+   sv->rawoff = NULL;
+   sv->dirty = NULL;
+   pa = mxGetField(store, 0, "rawoff");
+   if (pa != NULL && !mxIsEmpty(pa)) {
+      sv->rawoff = (const uint32_t *)field_data(store, F_RAWOFF, mxUINT32_CLASS, nel+1, "rawoff");
+      pa = mxGetField(store, 0, "raw");
+      if (pa == NULL || !mxIsUint8(pa) || mxGetNumberOfElements(pa) < sv->rawoff[nel])
+	 mexErrMsgTxt("gds_store :  field raw of element store has the wrong class or size.");
+      sv->raw = (const uint8_t *)mxGetData(pa);
+      pa = mxGetField(store, 0, "dirty");
+      if (pa == NULL || mxGetNumberOfElements(pa) != nel || 
+	  (nel && !mxIsUint8(pa) && !mxIsLogical(pa)))
+	 mexErrMsgTxt("gds_store :  field dirty of element store has the wrong class or size.");
+      sv->dirty = (const uint8_t *)mxGetData(pa);
+      for (k=0; k<nel; k++) {
+	 if (sv->rawoff[k+1] < sv->rawoff[k])
+	    mexErrMsgTxt("gds_store :  offsets must not decrease.");
+      }
+   }
+
+   /* all offsets must be inside the pools */
+   if (sv->xyrec[0] != 0 || sv->xyoff[0] != 0 || sv->prop[0] != 0)
+      mexErrMsgTxt("gds_store :  offsets must begin with 0.");
+   for (k=0; k<nel; k++) {
+      if (sv->kind[k] < GDS_BOUNDARY || sv->kind[k] > GDS_AREF)
+	 mexErrMsgTxt("gds_store :  unknown element kind in element store.");
+      if (sv->xyrec[k+1] < sv->xyrec[k] || sv->prop[k+1] < sv->prop[k])
+	 mexErrMsgTxt("gds_store :  offsets must not decrease.");
+      if (sv->ext[k] > sv->next)
+	 mexErrMsgTxt("gds_store :  ext refers to a missing eldata column.");
+   }
+   if (sv->xyrec[nel] > sv->nrec || sv->prop[nel] > sv->nprop)
+      mexErrMsgTxt("gds_store :  offsets exceed the size of the store.");
+   for (k=0; k<sv->nrec; k++) {
+      if (sv->xyoff[k+1] < sv->xyoff[k])
+	 mexErrMsgTxt("gds_store :  offsets must not decrease.");
+   }
+   if (sv->xyoff[sv->nrec] > sv->nvtx)
+      mexErrMsgTxt("gds_store :  offsets exceed the size of the store.");
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+store_element(const store_view *sv, size_t k, element_t *pe)
+{
+   if ( sv->ext[k] )
+      memcpy(pe, &sv->eldata[sv->ext[k]-1], sizeof(element_t));
+   else
+      simple_element(sv->kind[k], 0, 0, pe);
+
+   /* the arrays of the store take precedence */
+   pe->kind = sv->kind[k];
+   pe->layer = sv->layer[k];
+   pe->dtype = sv->dtype[k];
+   pe->has = sv->flags[k];
+}
+
+
+/*-----------------------------------------------------------------*/
+
+const uint8_t*
+store_raw(const store_view *sv, size_t k, size_t *nb)
+{
+   const uint8_t *raw;
+
+   if (sv->raw == NULL || sv->dirty[k])
+      return NULL;
+
+   *nb = sv->rawoff[k+1] - sv->rawoff[k];
+   raw = sv->raw + sv->rawoff[k];
+   if ( !raw_matches(sv, k, raw, *nb) )
+      return NULL;
+
+   return raw;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * returns 1 when the records raw[0] .. raw[nb-1] of element k agree
+ * with the arrays of the store: element kind, layer, data type, the
+ * vertices of all XY records, and the number of properties. The
+ * records of elements whose arrays were modified without setting
+ * the dirty flag are then not copied.
+ */
+static int
+raw_matches(const store_view *sv, size_t k, const uint8_t *raw, size_t nb)
+{
+   static const uint16_t elrec[] = {0, BOUNDARY, PATH, BOX, NODE,
+				    TEXT, SREF, AREF};
+   const uint8_t *p, *end;
+   const int32_t *pv;
+   uint16_t rlen, rtype;
+   size_t r, nv, np, j;
+
+   if (nb < 4 || sv->kind[k] < GDS_BOUNDARY || sv->kind[k] > GDS_AREF)
+      return 0;
+   if ( ((raw[2] << 8) | raw[3]) != elrec[sv->kind[k]] )
+      return 0;
+
+   r = sv->xyrec[k];
+   np = 0;
+   end = raw + nb;
+   for (p=raw; p+4 <= end; p+=rlen) {
+
+      rlen = (p[0] << 8) | p[1];
+      rtype = (p[2] << 8) | p[3];
+      if (rlen < 4 || rlen > end - p)
+	 return 0;
+
+      switch (rtype) {
+
+         case LAYER:
+	    if (rlen < 6 || ((p[4] << 8) | p[5]) != sv->layer[k])
+	       return 0;
+	    break;
+
+         case DATATYPE:
+         case TEXTTYPE:
+         case NODETYPE:
+         case BOXTYPE:
+	    if (rlen < 6 || ((p[4] << 8) | p[5]) != sv->dtype[k])
+	       return 0;
+	    break;
+
+         case XY:
+	    if (r >= sv->xyrec[k+1])
+	       return 0;
+	    nv = sv->xyoff[r+1] - sv->xyoff[r];
+	    if ((size_t)(rlen - 4) != 8*nv)
+	       return 0;
+	    pv = sv->vtx + 2*(size_t)sv->xyoff[r];
+	    for (j=0; j<2*nv; j++) {
+	       if (load_be32(p + 4 + 4*j) != pv[j])
+		  return 0;
+	    }
+	    r += 1;
+	    break;
+
+         case PROPATTR:
+	    np += 1;
+	    break;
+      }
+   }
+
+   return r == sv->xyrec[k+1] && np == sv->prop[k+1] - sv->prop[k];
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+store_to_tables(const store_view *sv, const size_t *ind, size_t nind, lib_tables *lt)
+{
+   const mxArray *pa;
+   st_rec *ps;
+   el_rec *pe;
+   xy_rec *pxy;
+   prop_rec *pp;
+   size_t i, k, r, p, e;
+   char str[TXTLEN];
+
+
+   lt->st = grow(lt->st, &lt->mst, lt->nst+1, sizeof(st_rec));
+   ps = &lt->st[lt->nst];
+   memset(ps, 0, sizeof(st_rec));
+   ps->el = lt->nel;
+
+   for (i=0; i<nind; i++) {
+
+      k = ind ? ind[i] : i;
+
+      lt->el = grow(lt->el, &lt->mel, lt->nel+1, sizeof(el_rec));
+      pe = &lt->el[lt->nel++];
+      memset(pe, 0, sizeof(el_rec));
+      store_element(sv, k, &pe->internal);
+      pe->xy = lt->nxy;
+      pe->prop = lt->nprop;
+      pe->text = -1;
+
+      /* XY records in file byte order */
+      for (r=sv->xyrec[k]; r<sv->xyrec[k+1]; r++) {
+	 lt->xy = grow(lt->xy, &lt->mxy, lt->nxy+1, sizeof(xy_rec));
+	 pxy = &lt->xy[lt->nxy++];
+	 pxy->off = lt->nvtx;
+	 pxy->m = sv->xyoff[r+1] - sv->xyoff[r];
+	 lt->vtx = grow(lt->vtx, &lt->mvtx, lt->nvtx + 2*pxy->m, sizeof(int32_t));
+	 memcpy(lt->vtx + lt->nvtx, sv->vtx + 2*(size_t)sv->xyoff[r], 2*pxy->m*sizeof(int32_t));
+	 byte_reverse32_n(lt->vtx + lt->nvtx, 2*pxy->m);
+	 lt->nvtx += 2*pxy->m;
+	 pe->nxy += 1;
+      }
+
+      /* properties */
+      for (p=sv->prop[k]; p<sv->prop[k+1]; p++) {
+	 lt->prop = grow(lt->prop, &lt->mprop, lt->nprop+1, sizeof(prop_rec));
+	 pp = &lt->prop[lt->nprop++];
+	 pp->attr = sv->pattr[p];
+	 pp->name = -1;
+	 pa = mxGetCell(sv->pval, p);
+	 if (pa != NULL && mxIsChar(pa)) {
+	    mxGetString(pa, str, VLEN);
+	    pp->name = add_string(lt, str);
+	    pe->nval += 1;
+	 }
+	 pe->nslot += 1;
+      }
+
+      /* text string */
+      e = sv->ext[k];
+      if (pe->internal.kind == GDS_TEXT && e) {
+	 pa = mxGetCell(sv->text, e-1);
+	 if (pa != NULL && mxIsChar(pa)) {
+	    mxGetString(pa, str, TXTLEN);
+	    pe->text = add_string(lt, str);
+	 }
+      }
+   }
+
+   ps = &lt->st[lt->nst++];
+   ps->nel = nind;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * boundaries, boxes, and nodes without optional properties are
+ * described completely by the kind, layer, and type arrays
+ */
+static int
+needs_ext(const element_t *pe)
+{
+   element_t se;
+
+   simple_element(pe->kind, pe->layer, pe->dtype, &se);
+   if (pe->kind != GDS_BOUNDARY && pe->kind != GDS_BOX && pe->kind != GDS_NODE)
+      return 1;
+
+   return memcmp(pe, &se, sizeof(element_t)) != 0;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+simple_element(element_kind kind, uint16_t layer, uint16_t dtype, element_t *pe)
+{
+   memset(pe, 0, sizeof(element_t));
+   pe->kind = kind;
+   pe->layer = layer;
+   pe->dtype = dtype;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * returns the data of field f of an element store after checking
+ * the class and the number of elements of the field
+ */
+static const void*
+field_data(const mxArray *store, int f, mxClassID id, size_t n, const char *name)
+{
+   const mxArray *pa;
+   char msg[128];
+
+   pa = mxGetField(store, 0, store_fields[f]);
+   if (pa == NULL || mxGetNumberOfElements(pa) != n || (n && mxGetClassID(pa) != id)) {
+      sprintf(msg, "gds_store :  field %s of element store has the wrong class or size.", name);
+      mexErrMsgTxt(msg);
+   }
+
+   return mxGetData(pa);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void*
+grow(void *p, size_t *mcur, size_t need, size_t esz)
+{
+   size_t m;
+
+   if (need <= *mcur)
+      return p;
+   m = *mcur ? *mcur : 64;
+   while (m < need)
+      m *= 2;
+   p = mxRealloc(p, m*esz);
+   *mcur = m;
+
+   return p;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static long
+add_string(lib_tables *lt, const char *s)
+{
+   size_t n;
+   long off;
+
+   n = strlen(s);
+   lt->str = grow(lt->str, &lt->mstr, lt->nstr+n+1, sizeof(char));
+   off = lt->nstr;
+   memcpy(lt->str + off, s, n+1);
+   lt->nstr += n+1;
+
+   return off;
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,127 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Element stores. An element store holds all elements of a structure
+ * in a few MATLAB arrays instead of one gds_element object per
+ * element. It is a scalar structure with the fields
+ *
+ *   kind   : uint8  1 x N   element kinds (element_kind)
+ *   layer  : uint16 1 x N   layers
+ *   dtype  : uint16 1 x N   data, text, box, or node types
+ *   flags  : uint32 1 x N   optional properties (HAS_* flags)
+ *   xyrec  : uint32 1 x N+1 element k has the XY records
+ *                           xyrec(k)+1 .. xyrec(k+1)
+ *   xyoff  : uint32 1 x R+1 XY record r has the vertices
+ *                           xyoff(r)+1 .. xyoff(r+1)
+ *   vtx    : int32  2 x V   vertex pool in database units
+ *   ext    : uint32 1 x N   column of the element in eldata, 0 if none
+ *   eldata : uint8  S x E   internal data (element_t) of all elements
+ *                           that are not boundaries, boxes, or nodes
+ *                           without optional properties
+ *   text   : cell   1 x E   text strings of text elements
+ *   prop   : uint32 1 x N+1 element k has the properties
+ *                           prop(k)+1 .. prop(k+1)
+ *   pattr  : int16  1 x P   property attributes
+ *   pval   : cell   1 x P   property values
+ *   dbu_to_uu : conversion factor database units --> user units
+ *   raw    : uint8  1 x B   original records of the elements, or empty
+ *   rawoff : uint32 1 x N+1 element k has the records
+ *                           raw(rawoff(k)+1 .. rawoff(k+1))
+ *   dirty  : uint8  1 x N   elements whose arrays were modified
+ *
+ * The arrays can be used directly for operations on all elements of
+ * a structure, e.g. selecting the elements on a layer. Stores that
+ * were read from a GDS II file can keep the records of the elements
+ * as they were read. Elements that are not marked as dirty are then
+ * written by copying their records, unless the records disagree with
+ * the kind, layer, dtype, vtx, or prop arrays of the element. Code 
+ * that modifies other data of an element, e.g. eldata, text, or pval,
+ * must set its dirty flag.
+ */
+
+#ifndef _GDSSTORE_H
+#define _GDSSTORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mex.h"
+#include "gdstypes.h"
+#include "gdsread.h"
+
+
+/*-- Types --------------------------------------------------------*/
+
+/*
+ * pointers to the data of an element store. The data are not copied.
+ */
+typedef struct {
+   size_t nel;             /* number of elements */
+   size_t nrec;            /* number of XY records */
+   size_t nvtx;            /* number of vertices */
+   size_t next;            /* number of eldata columns */
+   size_t nprop;           /* number of properties */
+   const uint8_t *kind;
+   const uint16_t *layer;
+   const uint16_t *dtype;
+   const uint32_t *flags;
+   const uint32_t *xyrec;
+   const uint32_t *xyoff;
+   const int32_t *vtx;
+   const uint32_t *ext;
+   const element_t *eldata;
+   const mxArray *text;
+   const uint32_t *prop;
+   const int16_t *pattr;
+   const mxArray *pval;
+   double dbu_to_uu;
+   const uint8_t *raw;     /* NULL when the records were not kept */
+   const uint32_t *rawoff;
+   const uint8_t *dirty;
+} store_view;
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * create an element store with the elements of the structure
+ * parts ps[0] .. ps[npart-1] in the tables plt[0] .. plt[npart-1].
+ * The records of the elements are copied into the store when all
+ * tables kept them (see lib_tables).
+ */
+mxArray* tables_to_store(lib_tables **plt, st_rec **ps, int npart);
+
+/*
+ * create a 1 x N structure array with fields sname, cdate, mdate,
+ * and store (an element store) for all structures in nlt table
+ * sets, like structures_to_mx.
+ */
+mxArray* structures_to_store(lib_tables *plt, int nlt);
+
+/*
+ * check an element store and return pointers to its data in sv.
+ * Raises an error when the store is not valid.
+ */
+void get_store_view(const mxArray *store, store_view *sv);
+
+/*
+ * return the internal data of element k of an element store
+ */
+void store_element(const store_view *sv, size_t k, element_t *pe);
+
+/*
+ * return the original records of element k of an element store
+ * and their length in *nb, or NULL when the records were not kept,
+ * the element is dirty, or the records disagree with the arrays.
+ */
+const uint8_t* store_raw(const store_view *sv, size_t k, size_t *nb);
+
+/*
+ * copy the elements ind[0] .. ind[nind-1] of an element store into
+ * the tables lt as the elements of one structure; the first nind
+ * elements are copied when ind is NULL. The tables must be
+ * initialized.
+ */
+void store_to_tables(const store_view *sv, const size_t *ind, size_t nind, lib_tables *lt);
+
+#endif /* _GDSSTORE_H */
@@ -0,0 +1,122 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Worker pool for independent tasks. See gdsthreads.h.
+ */
+
+#include <stdlib.h>
+#include "gdsthreads.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+   #define HAVE_THREADS
+   #include <pthread.h>
+   #include <unistd.h>
+#endif
+
+
+#ifdef HAVE_THREADS
+
+/*-- Types --------------------------------------------------------*/
+
+/*
+ * the task list shared by the threads of a pool
+ */
+typedef struct {
+   task_fn fn;
+   void *arg;
+   int ntask;
+   int next;             /* next task to be done */
+   pthread_mutex_t mtx;
+} pool_t;
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * body of a pool thread: takes the next task until none is left
+ */
+static void*
+do_tasks(void *arg)
+{
+   pool_t *pp = (pool_t *)arg;
+   int k;
+
+   while (1) {
+      pthread_mutex_lock(&pp->mtx);
+      k = pp->next++;
+      pthread_mutex_unlock(&pp->mtx);
+      if (k >= pp->ntask)
+	 break;
+      pp->fn(pp->arg, k);
+   }
+
+   return NULL;
+}
+
+#endif
+
+
+/*-----------------------------------------------------------------*/
+
+int
+pool_threads(int nthreads)
+{
+#ifdef HAVE_THREADS
+   if (nthreads <= 0)
+      nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+   nthreads = 1;
+#endif
+   if (nthreads < 1)
+      nthreads = 1;
+
+   return nthreads;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+run_tasks(task_fn fn, void *arg, int ntask, int nthreads)
+{
+#ifdef HAVE_THREADS
+   pool_t pool;
+   pthread_t *pt;
+   int t, nt;
+#endif
+   int k;
+
+   nthreads = pool_threads(nthreads);
+   if (nthreads > ntask)
+      nthreads = ntask;
+
+#ifdef HAVE_THREADS
+   if (nthreads > 1) {
+      pt = (pthread_t *)malloc(nthreads * sizeof(pthread_t));
+      if (pt != NULL && !pthread_mutex_init(&pool.mtx, NULL)) {
+	 pool.fn = fn;
+	 pool.arg = arg;
+	 pool.ntask = ntask;
+	 pool.next = 0;
+
+	 /* the calling thread is the first thread of the pool */
+	 for (nt=1; nt<nthreads; nt++) {
+	    if ( pthread_create(&pt[nt], NULL, do_tasks, &pool) )
+	       break;
+	 }
+	 do_tasks(&pool);
+	 for (t=1; t<nt; t++)
+	    pthread_join(pt[t], NULL);
+
+	 pthread_mutex_destroy(&pool.mtx);
+	 free(pt);
+	 return;
+      }
+      free(pt);
+   }
+#endif
+
+   for (k=0; k<ntask; k++)
+      fn(arg, k);
+}
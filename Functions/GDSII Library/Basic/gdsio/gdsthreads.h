@@ -0,0 +1,48 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * A simple worker pool for functions that divide their work into
+ * independent tasks, e.g. ranges of a file or tiles of a layout.
+ * The tasks are handed out in increasing order to the calling
+ * thread and to a number of worker threads; the calling thread
+ * works on tasks too, which keeps it busy while it waits for the
+ * workers. Task functions must not call the MEX API because they
+ * can run on any thread. On platforms without POSIX threads, all
+ * tasks are run by the calling thread.
+ */
+
+#ifndef _GDSTHREADS_H
+#define _GDSTHREADS_H
+
+/* number of tasks per thread for a balanced load */
+#define TASKS_PER_THREAD  4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * a task function; k is the index of the task
+ */
+typedef void (*task_fn)(void *arg, int k);
+
+/*
+ * returns the number of threads to use: nthreads when nthreads > 0
+ * and the number of processors otherwise, but at least 1.
+ */
+int pool_threads(int nthreads);
+
+/*
+ * calls fn(arg, k) for k = 0 .. ntask-1 on at most nthreads threads,
+ * including the calling thread (see pool_threads for nthreads <= 0),
+ * and returns when all tasks are done. When fewer threads can be
+ * created, the remaining threads do all tasks.
+ */
+void run_tasks(task_fn fn, void *arg, int ntask, int nthreads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GDSTHREADS_H */
@@ -0,0 +1,1799 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Functions for writing GDS II elements and structures. Records
+ * are collected in the output buffer of the gds file object.
+ *
+ * Writing is done in two steps: the element data are first collected
+ * from the MATLAB arrays into tables, which is the only step that
+ * uses the MEX API, and the records are then created from the tables.
+ * The second step does not call MEX functions and can run in any
+ * thread; write_library_data uses it to create the records of a
+ * library with several threads. Structures can also be given as
+ * element stores (gdsstore.h), whose arrays are used directly, and
+ * int32 XY matrices in database units are written without conversion.
+ * Unmodified elements of stores that kept the records of a GDS II
+ * file are written by copying the records.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsio.h"
+#include "mexfuncs.h"
+#include "gdswrite.h"
+#include "gdsstore.h"
+#include "polysplit.h"
+#include "byteswap.h"
+#include "gdsthreads.h"
+
+#define VLEN         128
+#define SLEN         40
+#define TXTLEN       512
+#define MAXVERTEXNUM 8191
+
+/* smallest and largest range written by a thread (estimated bytes) */
+#define MIN_CHUNK    262144
+#define MAX_CHUNK    4194304
+
+#ifdef __GNUC__
+   #define RESTRICT __restrict
+   #define INLINE __inline__
+#else
+   #define RESTRICT
+   #define INLINE
+#endif
+
+
+/*-- Local Types --------------------------------------------------*/
+
+/*
+ * an XY matrix of an element. The coordinates remain in the
+ * MATLAB array until the element is written.
+ */
+typedef struct {
+   const double *pd;    /* m x n matrix in user units, or */
+   const int32_t *pc;   /* m x n int32 matrix in database units, or */
+   const int32_t *pi;   /* m vertices of an element store */
+   double fs;           /* database unit of the store in user units */
+   int same;            /* store and file have the same database unit */
+   int m, n;
+} wxy_rec;
+
+/*
+ * a property attribute / value pair
+ */
+typedef struct {
+   int16_t attr;
+   size_t value;        /* offset of value in string pool */
+} wprop_rec;
+
+/*
+ * an element to be written
+ */
+typedef struct {
+   const element_t *pe; /* internal data of the gds_element object */
+   int isv;             /* element store, when pe is NULL */
+   size_t sk;           /* index of the element in the store */
+   const uint8_t *raw;  /* records of an unmodified element, or NULL */
+   size_t nraw;         /* length of the records */
+   size_t xy;           /* first XY matrix */
+   int nxy;             /* number of XY matrices */
+   size_t prop;         /* first property */
+   int nprop;           /* number of properties */
+   size_t text;         /* offset of text string */
+} wel_rec;
+
+/*
+ * a structure to be written
+ */
+typedef struct {
+   char sname[SLEN];
+   int slen;            /* length of STRNAME record data */
+   date_t cdate;
+   date_t mdate;
+   size_t el;           /* first element */
+   size_t nel;          /* number of elements */
+} wst_rec;
+
+/*
+ * structures and elements collected from the MATLAB data
+ */
+typedef struct {
+   double uu_to_dbu;
+   int compound;
+   wst_rec *st;         /* structure table */
+   size_t nst, mst;
+   wel_rec *el;         /* element table */
+   size_t nel, mel;
+   wxy_rec *xy;         /* XY matrices */
+   size_t nxy, mxy;
+   wprop_rec *prop;     /* properties */
+   size_t nprop, mprop;
+   char *str;           /* string pool */
+   size_t nstr, mstr;
+   store_view *sv;      /* element stores */
+   size_t nsv, msv;
+} write_tables;
+
+/*
+ * the records from position (s0,k0) up to position (s1,k1), where
+ * (s,k) is element k of structure s, written by one thread
+ */
+typedef struct {
+   size_t s0, k0;
+   size_t s1, k1;
+   gdsfile_t *mf;       /* memory file with the records */
+   const char *err;     /* error message or NULL */
+} chunk_t;
+
+/*
+ * task argument: a batch of chunks that are written at the same time
+ */
+typedef struct {
+   write_tables *wt;
+   chunk_t *chunk;
+} batch_t;
+
+
+/*-- Local Functions ----------------------------------------------*/
+
+static void init_write_tables(write_tables *wt, double uu_to_dbu, int compound);
+static void free_write_tables(write_tables *wt);
+static void* grow(void *p, size_t *mcur, size_t need, size_t esz);
+static size_t add_string(write_tables *wt, const char *s);
+static void add_matrix(write_tables *wt, wel_rec *pw, const mxArray *pa);
+static void add_store_matrix(write_tables *wt, wel_rec *pw, const store_view *sv,
+			     size_t r0, size_t r1);
+static void collect_element(write_tables *wt, mxArray *data);
+static void collect_store(write_tables *wt, const mxArray *store);
+static void collect_structure(write_tables *wt, mxArray *sdata);
+static void check_element(write_tables *wt, wel_rec *pw, const element_t *pe);
+static void check_sname(const element_t *pe, const char *kind);
+static void check_strans(const element_t *pe, const char *kind);
+static int real8_ok(double r);
+static const char* write_range(gdsfile_t *fob, write_tables *wt,
+			       size_t s0, size_t k0, size_t s1, size_t k1);
+static const char* write_element(gdsfile_t *fob, write_tables *wt, wel_rec *pw);
+static const char* write_boundary(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static const char* write_compound_boundary(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static const char* write_path(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static const char* write_compound_path(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static const char* write_sref(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static const char* write_compound_sref(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static const char* write_aref(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static const char* write_text(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static const char* write_node(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static const char* write_box(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe);
+static void write_property(gdsfile_t *fob, write_tables *wt, wel_rec *pw);
+static void write_strans(gdsfile_t *fob, const element_t *pe);
+static int32_t * xy_buffer(gdsfile_t *fob, int m);
+static int32_t * boundary_xy(gdsfile_t *fob, wxy_rec *pxy, double uu_to_dbu, int *m);
+static int split_boundary(int32_t *xybuf, int m, poly_pieces *pp);
+static INLINE void scale_trans(const wxy_rec *pxy, int k0, int32_t * RESTRICT xy, int m, double sfact);
+static void sref_block(const wxy_rec *pxy, int k0, int32_t *xy, int m, double sfact);
+static void write_chunk(void *arg, int k);
+
+static const char *err_xybuf = "gds_write_element :  failed to allocate coordinate buffer.";
+
+
+/*-----------------------------------------------------------------*/
+
+void
+write_element_data(gdsfile_t *fob, mxArray *data, double uu_to_dbu, int compound)
+{
+   write_tables wt;
+   const char *err;
+
+   init_write_tables(&wt, uu_to_dbu, compound);
+   collect_element(&wt, data);
+   err = write_element(fob, &wt, &wt.el[0]);
+   free_write_tables(&wt);
+   if (err != NULL)
+      mexErrMsgTxt(err);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+write_structure_data(gdsfile_t *fob, mxArray *sdata, double uu_to_dbu, int compound)
+{
+   write_tables wt;
+   const char *err;
+
+   init_write_tables(&wt, uu_to_dbu, compound);
+   collect_structure(&wt, sdata);
+   err = write_range(fob, &wt, 0, 0, wt.nst, 0);
+   free_write_tables(&wt);
+   if (err != NULL)
+      mexErrMsgTxt(err);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+write_library_data(gdsfile_t *fob, const mxArray *slist, double uu_to_dbu,
+		   int compound, int nthreads)
+{
+   write_tables wt;
+   const char *err = NULL;
+   size_t k, nst;
+   chunk_t *pc;
+   batch_t bt;
+   wel_rec *pe;
+   double total, target, acc;
+   size_t s, mch;
+   int nchunk, nbatch, nb, c, b, j;
+
+   if ( !mxIsCell(slist) )
+      mexErrMsgTxt("gds_write_library :  structure list must be a cell array.");
+   nst = mxGetNumberOfElements(slist);
+
+   nthreads = pool_threads(nthreads);
+
+   /*
+    * compressed streams are written serially because the frames
+    * of a compressed file depend on the sequence of writes
+    */
+   if (nthreads > 1 && fob->zs == NULL) {
+
+      /* collect all structures in the MATLAB thread */
+      init_write_tables(&wt, uu_to_dbu, compound);
+      for (k=0; k<nst; k++)
+	 collect_structure(&wt, mxGetCell(slist, k));
+
+      /* estimate the size of the records */
+      total = 0;
+      for (k=0; k<wt.nel; k++) {
+	 pe = &wt.el[k];
+	 total += 64 + 16*pe->nprop + pe->nraw;
+	 for (j=0; j<pe->nxy; j++)
+	    total += 8 * (double)wt.xy[pe->xy+j].m;
+      }
+
+      if (total >= 2*MIN_CHUNK) {
+
+	 /*
+	  * divide the library into ranges of similar size. The ranges
+	  * are written in batches, and the records of a batch are
+	  * written to the file before the next batch is created, which
+	  * limits the memory for records to about nbatch*MAX_CHUNK.
+	  */
+	 nbatch = nthreads * TASKS_PER_THREAD;
+	 target = total / nbatch;
+	 if (target < MIN_CHUNK)
+	    target = MIN_CHUNK;
+	 if (target > MAX_CHUNK)
+	    target = MAX_CHUNK;
+	 mch = nbatch + 1;
+	 pc = (chunk_t *)mxCalloc(mch, sizeof(chunk_t));
+	 nchunk = 0;
+	 acc = 0;
+	 for (s=0; s<wt.nst; s++) {
+	    for (k=0; k<wt.st[s].nel; k++) {
+	       if (acc >= target) {
+		  pc = (chunk_t *)grow(pc, &mch, nchunk+2, sizeof(chunk_t));
+		  pc[nchunk].s1 = s;
+		  pc[nchunk].k1 = k;
+		  nchunk += 1;
+		  pc[nchunk].s0 = s;
+		  pc[nchunk].k0 = k;
+		  acc = 0;
+	       }
+	       pe = &wt.el[wt.st[s].el + k];
+	       acc += 64 + 16*pe->nprop + pe->nraw;
+	       for (j=0; j<pe->nxy; j++)
+		  acc += 8 * (double)wt.xy[pe->xy+j].m;
+	    }
+	 }
+	 pc[nchunk].s1 = wt.nst;
+	 pc[nchunk].k1 = 0;
+	 nchunk += 1;
+
+	 /* write the ranges into memory and then to the file, in order */
+	 bt.wt = &wt;
+	 for (b=0; b<nchunk && err==NULL; b+=nbatch) {
+	    nb = nchunk - b;
+	    if (nb > nbatch)
+	       nb = nbatch;
+	    bt.chunk = pc + b;
+	    run_tasks(write_chunk, &bt, nb, nthreads);
+
+	    for (c=b; c<b+nb; c++) {
+	       if (err == NULL) {
+		  if (pc[c].err != NULL)
+		     err = pc[c].err;
+		  else if ( gdsfile_write(fob, pc[c].mf->obuf, pc[c].mf->nob) )
+		     err = "gds_write_library :  failed to write to file.";
+	       }
+	       if (pc[c].mf != NULL) {
+		  gdsfile_close(pc[c].mf);
+		  pc[c].mf = NULL;
+	       }
+	    }
+	 }
+	 mxFree(pc);
+      }
+      else
+	 err = write_range(fob, &wt, 0, 0, wt.nst, 0);
+
+      free_write_tables(&wt);
+      if (err != NULL)
+	 mexErrMsgTxt(err);
+      return;
+   }
+
+   /* write one structure at a time */
+   init_write_tables(&wt, uu_to_dbu, compound);
+   for (k=0; k<nst && err==NULL; k++) {
+      wt.nst = wt.nel = wt.nxy = wt.nprop = wt.nstr = wt.nsv = 0;
+      collect_structure(&wt, mxGetCell(slist, k));
+      err = write_range(fob, &wt, 0, 0, wt.nst, 0);
+   }
+   free_write_tables(&wt);
+   if (err != NULL)
+      mexErrMsgTxt(err);
+}
+
+
+/*-- Collecting element data --------------------------------------*/
+
+static void
+init_write_tables(write_tables *wt, double uu_to_dbu, int compound)
+{
+   memset(wt, 0, sizeof(write_tables));
+   wt->uu_to_dbu = uu_to_dbu;
+   wt->compound = compound;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+free_write_tables(write_tables *wt)
+{
+   mxFree(wt->st);
+   mxFree(wt->el);
+   mxFree(wt->xy);
+   mxFree(wt->prop);
+   mxFree(wt->str);
+   mxFree(wt->sv);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void*
+grow(void *p, size_t *mcur, size_t need, size_t esz)
+{
+   size_t m;
+
+   if (need <= *mcur)
+      return p;
+   m = *mcur ? *mcur : 64;
+   while (m < need)
+      m *= 2;
+   p = mxRealloc(p, m*esz);
+   *mcur = m;
+
+   return p;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static size_t
+add_string(write_tables *wt, const char *s)
+{
+   size_t n, off;
+
+   n = strlen(s);
+   wt->str = (char *)grow(wt->str, &wt->mstr, wt->nstr+n+1, sizeof(char));
+   off = wt->nstr;
+   memcpy(wt->str + off, s, n+1);
+   wt->nstr += n+1;
+
+   return off;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+add_matrix(write_tables *wt, wel_rec *pw, const mxArray *pa)
+{
+   wxy_rec *pxy;
+
+   wt->xy = (wxy_rec *)grow(wt->xy, &wt->mxy, wt->nxy+1, sizeof(wxy_rec));
+   pxy = &wt->xy[wt->nxy++];
+   memset(pxy, 0, sizeof(wxy_rec));
+   if ( mxIsInt32(pa) )
+      pxy->pc = (const int32_t *)mxGetData(pa);
+   else
+      pxy->pd = (const double *)mxGetData(pa);
+   pxy->m = mxGetM(pa);
+   pxy->n = mxGetN(pa);
+   pw->nxy += 1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * adds the XY records r0 .. r1-1 of an element store as one matrix
+ */
+static void
+add_store_matrix(write_tables *wt, wel_rec *pw, const store_view *sv, size_t r0, size_t r1)
+{
+   wxy_rec *pxy;
+
+   wt->xy = (wxy_rec *)grow(wt->xy, &wt->mxy, wt->nxy+1, sizeof(wxy_rec));
+   pxy = &wt->xy[wt->nxy++];
+   memset(pxy, 0, sizeof(wxy_rec));
+   pxy->pi = sv->vtx + 2*(size_t)sv->xyoff[r0];
+   pxy->fs = sv->dbu_to_uu;
+   pxy->same = fabs(wt->uu_to_dbu * sv->dbu_to_uu - 1.0) < 1e-12;
+   pxy->m = sv->xyoff[r1] - sv->xyoff[r0];
+   pxy->n = 2;
+   pw->nxy += 1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * appends an element to the element table
+ */
+static void
+collect_element(write_tables *wt, mxArray *data)
+{
+   mxArray *internal, *field, *pa;
+   const element_t *pe;
+   wel_rec *pw;
+   wprop_rec *pp;
+   char txt[TXTLEN];
+   int k, nxy, np;
+
+
+   /* decide what to do */
+   if ( !get_field_ptr(data, "internal", &internal) )
+      mexErrMsgTxt("gds_write_element :  missing internal data field.");
+   pe = (const element_t *)mxGetData(internal);
+
+   wt->el = (wel_rec *)grow(wt->el, &wt->mel, wt->nel+1, sizeof(wel_rec));
+   pw = &wt->el[wt->nel];
+   memset(pw, 0, sizeof(wel_rec));
+   pw->pe = pe;
+   pw->isv = -1;
+   pw->xy = wt->nxy;
+   pw->prop = wt->nprop;
+
+   switch (pe->kind) {
+
+      case GDS_BOUNDARY:
+      case GDS_PATH:
+	 if ( !get_field_ptr(data, "xy", &field) || !mxIsCell(field) ) {
+	    if (pe->kind == GDS_BOUNDARY)
+	       mexErrMsgTxt("gds_write_element (boundary) :  missing or empty xy field.");
+	    else
+	       mexErrMsgTxt("gds_write_element (path) :  missing or empty xy field.");
+	 }
+	 nxy = mxGetNumberOfElements(field);
+	 for (k=0; k<nxy; k++) {
+	    pa = mxGetCell(field, k);
+	    if (pa == NULL)
+	       mexErrMsgTxt("gds_write_element :  missing xy matrix.");
+	    add_matrix(wt, pw, pa);
+	 }
+	 break;
+
+      case GDS_SREF:
+	 if ( !get_field_ptr(data, "xy", &field) )
+	    mexErrMsgTxt("gds_write_element (sref) :  missing or empty xy field.");
+	 add_matrix(wt, pw, field);
+	 break;
+
+      case GDS_AREF:
+	 if ( !get_field_ptr(data, "xy", &field) )
+	    mexErrMsgTxt("gds_write_element (aref) :  missing or empty xy field.");
+	 add_matrix(wt, pw, field);
+	 break;
+
+      case GDS_TEXT:
+	 if ( !get_field_ptr(data, "xy", &field) )
+	    mexErrMsgTxt("gds_write_element (text) :  missing or empty xy field.");
+	 add_matrix(wt, pw, field);
+	 if ( !get_field_ptr(data, "text", &field) )
+	    mexErrMsgTxt("gds_write_element (text) :  missing text field.");
+	 mxGetString(field, txt, TXTLEN);
+	 pw->text = add_string(wt, txt);
+	 break;
+
+      case GDS_NODE:
+	 if ( !get_field_ptr(data, "xy", &field) )
+	    mexErrMsgTxt("gds_write_element (node) :  missing xy field.");
+	 add_matrix(wt, pw, field);
+	 break;
+
+      case GDS_BOX:
+	 if ( !get_field_ptr(data, "xy", &field) )
+	    mexErrMsgTxt("gds_write_element (box) :  missing or empty xy field.");
+	 add_matrix(wt, pw, field);
+	 break;
+
+      default:
+	 mexErrMsgTxt("gds_write_element :  unknown element type.");
+   }
+
+   /* properties */
+   if ( get_field_ptr(data, "prop", &field) && mxIsStruct(field) ) {
+      np = mxGetM(field) * mxGetN(field);
+      for (k=0; k<np; k++) {
+	 wt->prop = (wprop_rec *)grow(wt->prop, &wt->mprop, wt->nprop+1, sizeof(wprop_rec));
+	 pp = &wt->prop[wt->nprop++];
+	 pa = mxGetField(field, k, "attr");
+	 if (pa == NULL || mxIsEmpty(pa))
+	    mexErrMsgTxt("gds_write_element :  missing property attribute.");
+	 pp->attr = (int16_t)((double *)mxGetData(pa))[0];
+	 pa = mxGetField(field, k, "name");
+	 if (pa == NULL)
+	    mexErrMsgTxt("gds_write_element :  missing property value.");
+	 mxGetString(pa, txt, VLEN);
+	 pp->value = add_string(wt, txt);
+	 pw->nprop += 1;
+      }
+   }
+
+   check_element(wt, pw, pe);
+   wt->nel += 1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * appends the elements of an element store to the element table.
+ * The arrays of the store are used without copying.
+ */
+static void
+collect_store(write_tables *wt, const mxArray *store)
+{
+   const mxArray *pa;
+   store_view *sv;
+   wel_rec *pw;
+   wprop_rec *pp;
+   element_t el;
+   size_t k, r0, r1, p;
+   int isv, same;
+   char txt[TXTLEN];
+
+
+   wt->sv = (store_view *)grow(wt->sv, &wt->msv, wt->nsv+1, sizeof(store_view));
+   isv = wt->nsv++;
+   sv = &wt->sv[isv];
+   get_store_view(store, sv);
+   same = fabs(wt->uu_to_dbu * sv->dbu_to_uu - 1.0) < 1e-12;
+
+   for (k=0; k<sv->nel; k++) {
+
+      wt->el = (wel_rec *)grow(wt->el, &wt->mel, wt->nel+1, sizeof(wel_rec));
+      pw = &wt->el[wt->nel];
+      memset(pw, 0, sizeof(wel_rec));
+      pw->isv = isv;
+      pw->sk = k;
+      pw->xy = wt->nxy;
+      pw->prop = wt->nprop;
+
+      /* 
+       * the records of unmodified elements are copied when the
+       * database unit is the same and, unless compound elements
+       * are written, the element has at most one XY record
+       */
+      if (same && (wt->compound || sv->xyrec[k+1] - sv->xyrec[k] <= 1)) {
+	 pw->raw = store_raw(sv, k, &pw->nraw);
+	 if (pw->raw != NULL) {
+	    wt->nel += 1;
+	    continue;
+	 }
+      }
+      store_element(sv, k, &el);
+
+      /* boundaries and paths have one matrix per XY record, other
+	 elements the last record, and srefs all positions */
+      r0 = sv->xyrec[k];
+      r1 = sv->xyrec[k+1];
+      if (el.kind == GDS_BOUNDARY || el.kind == GDS_PATH) {
+	 for (; r0<r1; r0++)
+	    add_store_matrix(wt, pw, sv, r0, r0+1);
+      }
+      else if (r0 == r1)
+	 mexErrMsgTxt("gds_write_element :  missing or empty xy field.");
+      else if (el.kind == GDS_SREF)
+	 add_store_matrix(wt, pw, sv, r0, r1);
+      else
+	 add_store_matrix(wt, pw, sv, r1-1, r1);
+
+      /* text string */
+      if (el.kind == GDS_TEXT) {
+	 pa = sv->ext[k] ? mxGetCell(sv->text, sv->ext[k]-1) : NULL;
+	 if (pa == NULL || !mxIsChar(pa))
+	    mexErrMsgTxt("gds_write_element (text) :  missing text field.");
+	 mxGetString(pa, txt, TXTLEN);
+	 pw->text = add_string(wt, txt);
+      }
+
+      /* properties */
+      for (p=sv->prop[k]; p<sv->prop[k+1]; p++) {
+	 wt->prop = (wprop_rec *)grow(wt->prop, &wt->mprop, wt->nprop+1, sizeof(wprop_rec));
+	 pp = &wt->prop[wt->nprop++];
+	 pp->attr = sv->pattr[p];
+	 txt[0] = '\0';
+	 pa = mxGetCell(sv->pval, p);
+	 if (pa != NULL && mxIsChar(pa))
+	    mxGetString(pa, txt, VLEN);
+	 pp->value = add_string(wt, txt);
+	 pw->nprop += 1;
+      }
+
+      check_element(wt, pw, &el);
+      wt->nel += 1;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * appends a structure and its elements to the tables
+ */
+static void
+collect_structure(write_tables *wt, mxArray *sdata)
+{
+   mxArray *pa, *el;
+   wst_rec *ps;
+   int k, nel;
+
+
+   wt->st = (wst_rec *)grow(wt->st, &wt->mst, wt->nst+1, sizeof(wst_rec));
+   ps = &wt->st[wt->nst];
+   memset(ps, 0, sizeof(wst_rec));
+
+   /* BGNSTR dates */
+   now(ps->cdate);
+   now(ps->mdate);
+
+   /* STRNAME */
+   pa = mxGetField(sdata, 0, "sname");
+   if (pa == NULL)
+      mexErrMsgTxt("write_structure_data :  missing structure name.");
+   mxGetString(pa, ps->sname, SLEN-2);
+   ps->slen = mxGetN(pa);
+   if (ps->slen > 32) {
+      mexPrintf("\nStructure name %s exceeds 32 characters\n\n", ps->sname);
+      mexErrMsgTxt("structure name too long.");
+   }
+   if (ps->slen % 2)
+      ps->slen += 1;
+
+   /* elements from an element store or from element data */
+   ps->el = wt->nel;
+   pa = mxGetField(sdata, 0, "store");
+   el = mxGetField(sdata, 0, "el");
+   if (pa != NULL && !mxIsEmpty(pa))
+      collect_store(wt, pa);
+   else if (el != NULL && mxIsCell(el)) {
+      nel = mxGetNumberOfElements(el);
+      for (k=0; k<nel; k++)
+	 collect_element(wt, mxGetCell(el, k));
+   }
+   wt->st[wt->nst].nel = wt->nel - wt->st[wt->nst].el;
+   wt->nst += 1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * checks the data of an element before it is written
+ */
+static void
+check_element(write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   wxy_rec *pxy = &wt->xy[pw->xy];
+   int k, tlen;
+
+   switch (pe->kind) {
+
+      case GDS_PATH:
+	 for (k=0; k<pw->nxy; k++) {
+	    if (pxy[k].m > MAXVERTEXNUM)
+	       mexErrMsgTxt("gds_write_element (path) :  paths must have <= 8191 vertices.");
+	 }
+	 break;
+
+      case GDS_SREF:
+	 check_sname(pe, "sref");
+	 check_strans(pe, "sref");
+	 break;
+
+      case GDS_AREF:
+	 check_sname(pe, "aref");
+	 check_strans(pe, "aref");
+	 if ( !pe->nrow )
+	    mexErrMsgTxt("gds_write_element (aref) :  number of rows is 0; must be > 0.");
+	 if ( !pe->ncol )
+	    mexErrMsgTxt("gds_write_element (aref) :  number of columns is 0; must be > 0.");
+	 if ( (pxy->m != 3) || (pxy->n != 2) )
+	    mexErrMsgTxt("gds_write_element (aref) :  xy must be 3x2 matrix.");
+	 break;
+
+      case GDS_TEXT:
+	 check_strans(pe, "text");
+	 tlen = strlen(wt->str + pw->text);
+	 if (tlen % 2)
+	    tlen += 1;
+	 if (tlen > 512)
+	    mexErrMsgTxt("gds_write_element (text) :  text must have <= 512 chars.");
+	 break;
+
+      case GDS_NODE:
+	 if (pxy->m > 1024)
+	    mexErrMsgTxt("more than 1024 vertices in node");
+	 break;
+
+      case GDS_BOX:
+	 if (pxy->m < 4 || pxy->m > 5)
+	    mexErrMsgTxt("gds_write_element (box) :  must supply 4 or 5 vertices.");
+	 break;
+
+      default:
+	 break;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+check_sname(const element_t *pe, const char *kind)
+{
+   char msg[128];
+   int nlen;
+
+   nlen = strlen(pe->sname);
+   if ( !nlen ) {
+      sprintf(msg, "gds_write_element (%s) :  name of referenced structure missing.", kind);
+      mexErrMsgTxt(msg);
+   }
+   if (nlen % 2)
+      nlen += 1;
+   if (nlen > 32) {
+      sprintf(msg, "gds_write_element (%s) :  structure name must have <= 32 chars.", kind);
+      mexErrMsgTxt(msg);
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* MAG and ANGLE must be representable as GDS II reals */
+static void
+check_strans(const element_t *pe, const char *kind)
+{
+   char msg[128];
+
+   if ( !(pe->has & HAS_STRANS) )
+      return;
+   if ( (pe->has & HAS_MAG && pe->strans.mag != 1.0 && !real8_ok(pe->strans.mag)) ||
+	(pe->has & HAS_ANGLE && pe->strans.angle != 0.0 && !real8_ok(pe->strans.angle)) ) {
+      sprintf(msg, "gds_write_element (%s) :  floating point number cannot be represented in excess-64 format.", kind);
+      mexErrMsgTxt(msg);
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* same exponent range as in ieee754_to_excess64 */
+static int
+real8_ok(double r)
+{
+   uint64_t bits;
+   int e;
+
+   memcpy(&bits, &r, sizeof(double));
+   e = (int)((bits >> 52) & 0x7ff);
+
+   return (e >= 767) && (e <= 1274);
+}
+
+
+/*-- Writing records ----------------------------------------------*/
+
+/*
+ * writes the records from position (s0,k0) up to, but not including,
+ * position (s1,k1). The BGNSTR and STRNAME records of a structure are
+ * written with its first element, the ENDSTR record after the last.
+ */
+static const char*
+write_range(gdsfile_t *fob, write_tables *wt,
+	    size_t s0, size_t k0, size_t s1, size_t k1)
+{
+   wst_rec *ps;
+   const char *err;
+   size_t s, k, kb, ke;
+
+   for (s=s0; s<=s1 && s<wt->nst; s++) {
+
+      if (s == s1 && k1 == 0)
+	 break;
+      ps = &wt->st[s];
+      kb = (s == s0) ? k0 : 0;
+      ke = (s == s1) ? k1 : ps->nel;
+
+      if (kb == 0) {
+
+	 /* BGNSTR record */
+	 if ( write_record_hdr(fob, BGNSTR, 2*sizeof(date_t)) )
+	    return "failed to write BGNSTR record.";
+	 if ( write_word_n(fob, ps->cdate, 6) )
+	    return "failed to write BGNSTR record (cdate).";
+	 if ( write_word_n(fob, ps->mdate, 6) )
+	    return "failed to write BGNSTR record (mdate).";
+
+	 /* STRNAME record */
+	 if ( write_record_hdr(fob, STRNAME, ps->slen) )
+	    return "failed to write STRNAME record.";
+	 if ( write_string(fob, ps->sname, ps->slen) )
+	    return "failed to write STRNAME record (sname).";
+      }
+
+      /* elements */
+      for (k=kb; k<ke; k++) {
+	 err = write_element(fob, wt, &wt->el[ps->el + k]);
+	 if (err != NULL)
+	    return err;
+      }
+
+      /* ENDSTR record */
+      if (s < s1) {
+	 if ( write_record_hdr(fob, ENDSTR, 0) )
+	    return "failed to write ENDSTR record.";
+      }
+   }
+
+   return NULL;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static const char*
+write_element(gdsfile_t *fob, write_tables *wt, wel_rec *pw)
+{
+   const element_t *pe = pw->pe;
+   element_t el;
+
+   /* unmodified elements of an element store are copied */
+   if (pw->raw != NULL) {
+      if ( write_records(fob, pw->raw, pw->nraw) )
+	 return "gds_write_element :  failed to write element records.";
+      return NULL;
+   }
+
+   /* elements of an element store are unpacked on the stack */
+   if (pe == NULL) {
+      store_element(&wt->sv[pw->isv], pw->sk, &el);
+      pe = &el;
+   }
+
+   switch (pe->kind) {
+
+      case GDS_BOUNDARY:
+	 if ( wt->compound )
+	    return write_compound_boundary(fob, wt, pw, pe);
+	 else
+	    return write_boundary(fob, wt, pw, pe);
+
+      case GDS_PATH:
+	 if ( wt->compound )
+	    return write_compound_path(fob, wt, pw, pe);
+	 else
+	    return write_path(fob, wt, pw, pe);
+
+      case GDS_SREF:
+	 if ( wt->compound )
+	    return write_compound_sref(fob, wt, pw, pe);
+	 else
+	    return write_sref(fob, wt, pw, pe);
+
+      case GDS_AREF:
+	 return write_aref(fob, wt, pw, pe);
+
+      case GDS_TEXT:
+	 return write_text(fob, wt, pw, pe);
+
+      case GDS_NODE:
+	 return write_node(fob, wt, pw, pe);
+
+      case GDS_BOX:
+	 return write_box(fob, wt, pw, pe);
+
+      default:
+	 return "gds_write_element :  unknown element type.";
+   }
+}
+
+
+/*-- Boundary -----------------------------------------------------*/
+
+static const char*
+write_boundary(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *bnd = pe;
+   int32_t *xybuf;
+   int m,kxy,k,npc;
+   poly_pieces pp;
+   size_t off;
+
+
+   /*
+    * now write out the individual boundary elements
+    */
+   for (kxy=0; kxy<pw->nxy; kxy++) {
+
+      /* XY */
+      xybuf = boundary_xy(fob, &wt->xy[pw->xy+kxy], wt->uu_to_dbu, &m);
+      if (xybuf == NULL)
+	 return err_xybuf;
+
+      /* large polygons are written as several boundary elements */
+      init_pieces(&pp);
+      npc = 1;
+      if (m > MAXVERTEXNUM) {
+	 if ( split_boundary(xybuf, m, &pp) )
+	    return "gds_write_element (boundary) :  failed to split boundary with more than 8191 vertices.";
+	 npc = pp.np;
+      }
+
+      for (off=0, k=0; k<npc; k++) {
+
+	 /* BOUNDARY */
+	 write_record_hdr(fob, BOUNDARY, 0);
+
+	 /* ELFLAGS */
+	 if ( bnd->has & HAS_ELFLAGS ) {
+	    write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+	    write_word(fob, bnd->elflags);
+	 }
+
+	 /* PLEX */
+	 if ( bnd->has & HAS_PLEX ) {
+	    write_record_hdr(fob, PLEX, sizeof(int32_t));
+	    write_int(fob, bnd->plex);
+	 }
+
+	 /* LAYER */
+	 write_record_hdr(fob, LAYER, sizeof(uint16_t));
+	 write_word(fob, bnd->layer);
+
+	 /* DATATYPE */
+	 write_record_hdr(fob, DATATYPE, sizeof(uint16_t));
+	 write_word(fob, bnd->dtype);
+
+	 /* XY */
+	 if (m > MAXVERTEXNUM) {
+	    write_record_hdr(fob, XY, 2*pp.len[k]*sizeof(int32_t));
+	    write_int_n(fob, pp.xy + off, 2*pp.len[k]);
+	    off += 2*pp.len[k];
+	 }
+	 else {
+	    write_record_hdr(fob, XY, 2*m*sizeof(int32_t));
+	    write_int_be_n(fob, xybuf, 2*m);
+	 }
+
+	 /* Property */
+	 write_property(fob, wt, pw);
+
+	 /* ENDEL */
+	 write_record_hdr(fob, ENDEL, 0);
+      }
+      free_pieces(&pp);
+   }
+
+   return NULL;
+}
+
+/*-- Compound Boundary --------------------------------------------*/
+
+static const char*
+write_compound_boundary(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *bnd = pe;
+   int32_t *xybuf;
+   int m,kxy,k;
+   poly_pieces pp;
+   size_t off;
+
+
+   /*
+    * write one compound boundary element with multiple XY records
+    */
+   /* BOUNDARY */
+   write_record_hdr(fob, BOUNDARY, 0);
+
+   /* ELFLAGS */
+   if ( bnd->has & HAS_ELFLAGS ) {
+      write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+      write_word(fob, bnd->elflags);
+   }
+
+   /* PLEX */
+   if ( bnd->has & HAS_PLEX ) {
+      write_record_hdr(fob, PLEX, sizeof(int32_t));
+      write_int(fob, bnd->plex);
+   }
+
+   /* LAYER */
+   write_record_hdr(fob, LAYER, sizeof(uint16_t));
+   write_word(fob, bnd->layer);
+
+   /* DATATYPE */
+   write_record_hdr(fob, DATATYPE, sizeof(uint16_t));
+   write_word(fob, bnd->dtype);
+
+   /* XY */
+   for (kxy=0; kxy<pw->nxy; kxy++) {
+      xybuf = boundary_xy(fob, &wt->xy[pw->xy+kxy], wt->uu_to_dbu, &m);
+      if (xybuf == NULL)
+	 return err_xybuf;
+      if (m <= MAXVERTEXNUM) {
+	 write_record_hdr(fob, XY, 2*m*sizeof(int32_t));
+	 write_int_be_n(fob, xybuf, 2*m);
+      }
+      else { /* one XY record per piece of a large polygon */
+	 init_pieces(&pp);
+	 if ( split_boundary(xybuf, m, &pp) )
+	    return "gds_write_element (boundary) :  failed to split boundary with more than 8191 vertices.";
+	 for (off=0, k=0; k<pp.np; k++) {
+	    write_record_hdr(fob, XY, 2*pp.len[k]*sizeof(int32_t));
+	    write_int_n(fob, pp.xy + off, 2*pp.len[k]);
+	    off += 2*pp.len[k];
+	 }
+	 free_pieces(&pp);
+      }
+   }
+
+   /* Property */
+   write_property(fob, wt, pw);
+
+   /* ENDEL */
+   write_record_hdr(fob, ENDEL, 0);
+
+   return NULL;
+}
+
+
+/*-- Path ---------------------------------------------------------*/
+
+static const char*
+write_path(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *path = pe;
+   double uu_to_dbu = wt->uu_to_dbu;
+   wxy_rec *pxy;
+   int32_t *xybuf;
+   int kxy;
+
+
+   /*
+    * write out the individual path elements
+    */
+   for (kxy=0; kxy<pw->nxy; kxy++) {
+
+      /* PATH */
+      write_record_hdr(fob, PATH, 0);
+
+      /* ELFLAGS */
+      if ( path->has & HAS_ELFLAGS ) {
+	 write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+	 write_word(fob, path->elflags);
+      }
+
+      /* PLEX */
+      if ( path->has & HAS_PLEX ) {
+	 write_record_hdr(fob, PLEX, sizeof(int32_t));
+	 write_int(fob, path->plex);
+      }
+
+      /* LAYER */
+      write_record_hdr(fob, LAYER, sizeof(uint16_t));
+      write_word(fob, path->layer);
+
+      /* DATATYPE */
+      write_record_hdr(fob, DATATYPE, sizeof(uint16_t));
+      write_word(fob, path->dtype);
+
+      /* PATHTYPE */
+      if ( path->has & HAS_PTYPE ) {
+	 write_record_hdr(fob, PATHTYPE, sizeof(uint16_t));
+	 write_word(fob, path->ptype);
+      }
+
+      /* WIDTH */
+      if ( path->has & HAS_WIDTH ) {
+	 write_record_hdr(fob, WIDTH, sizeof(int32_t));
+	 write_int(fob, (int32_t)floor(path->width * uu_to_dbu + 0.5));
+      }
+
+      /* Path extensions */
+      if (path->has & HAS_PTYPE && path->ptype == 4) {
+	 if ( path->has & HAS_BGNEXTN ) {
+	    write_record_hdr(fob, BGNEXTN, sizeof(int32_t));
+	    write_int(fob, (int32_t)floor(path->bgnextn * uu_to_dbu + 0.5));
+	 }
+	 if ( path->has & HAS_ENDEXTN ) {
+	    write_record_hdr(fob, ENDEXTN, sizeof(int32_t));
+	    write_int(fob, (int32_t)floor(path->endextn * uu_to_dbu + 0.5));
+	 }
+      }
+
+      /* XY */
+      pxy = &wt->xy[pw->xy+kxy];
+      xybuf = xy_buffer(fob, pxy->m);
+      if (xybuf == NULL)
+	 return err_xybuf;
+      scale_trans(pxy, 0, xybuf, pxy->m, uu_to_dbu);
+      write_record_hdr(fob, XY, pxy->n*pxy->m*sizeof(int32_t));
+      write_int_be_n(fob, xybuf, pxy->n*pxy->m);
+
+      /* Property */
+      write_property(fob, wt, pw);
+
+      /* ENDEL */
+      write_record_hdr(fob, ENDEL, 0);
+   }
+
+   return NULL;
+}
+
+/*-- Compound Path-------------------------------------------------*/
+
+static const char*
+write_compound_path(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *path = pe;
+   double uu_to_dbu = wt->uu_to_dbu;
+   wxy_rec *pxy;
+   int32_t *xybuf;
+   int kxy;
+
+
+   /*
+    * write out one path element with multiple XY records
+    */
+   /* PATH */
+   write_record_hdr(fob, PATH, 0);
+
+   /* ELFLAGS */
+   if ( path->has & HAS_ELFLAGS ) {
+      write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+      write_word(fob, path->elflags);
+   }
+
+   /* PLEX */
+   if ( path->has & HAS_PLEX ) {
+      write_record_hdr(fob, PLEX, sizeof(int32_t));
+      write_int(fob, path->plex);
+   }
+
+   /* LAYER */
+   write_record_hdr(fob, LAYER, sizeof(uint16_t));
+   write_word(fob, path->layer);
+
+   /* DATATYPE */
+   write_record_hdr(fob, DATATYPE, sizeof(uint16_t));
+   write_word(fob, path->dtype);
+
+   /* PATHTYPE */
+   if ( path->has & HAS_PTYPE ) {
+      write_record_hdr(fob, PATHTYPE, sizeof(uint16_t));
+      write_word(fob, path->ptype);
+   }
+
+   /* WIDTH */
+   if ( path->has & HAS_WIDTH ) {
+      write_record_hdr(fob, WIDTH, sizeof(int32_t));
+      write_int(fob, (int32_t)floor(path->width * uu_to_dbu + 0.5));
+   }
+
+      /* Path extensions */
+   if (path->has & HAS_PTYPE && path->ptype == 4) {
+      if ( path->has & HAS_BGNEXTN ) {
+	 write_record_hdr(fob, BGNEXTN, sizeof(int32_t));
+	 write_int(fob, (int32_t)floor(path->bgnextn * uu_to_dbu + 0.5));
+      }
+      if ( path->has & HAS_ENDEXTN ) {
+	 write_record_hdr(fob, ENDEXTN, sizeof(int32_t));
+	 write_int(fob, (int32_t)floor(path->endextn * uu_to_dbu + 0.5));
+      }
+   }
+
+   /* XY */
+   for (kxy=0; kxy<pw->nxy; kxy++) {
+      pxy = &wt->xy[pw->xy+kxy];
+      xybuf = xy_buffer(fob, pxy->m);
+      if (xybuf == NULL)
+	 return err_xybuf;
+      scale_trans(pxy, 0, xybuf, pxy->m, uu_to_dbu);
+      write_record_hdr(fob, XY, pxy->n*pxy->m*sizeof(int32_t));
+      write_int_be_n(fob, xybuf, pxy->n*pxy->m);
+   }
+
+   /* Property */
+   write_property(fob, wt, pw);
+
+   /* ENDEL */
+   write_record_hdr(fob, ENDEL, 0);
+
+   return NULL;
+}
+
+
+/*-- Sref ---------------------------------------------------------*/
+
+static const char*
+write_sref(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *sref = pe;
+   wxy_rec *pxy = &wt->xy[pw->xy];
+   int32_t xy[2];
+   int mxy = pxy->m;
+   int k,nlen;
+
+
+   /*
+    * write out the individual sref elements
+    */
+   for (k=0; k<mxy; k++) {
+
+      /* SREF */
+      write_record_hdr(fob, SREF, 0);
+
+      /* ELFLAGS */
+      if ( sref->has & HAS_ELFLAGS ) {
+	 write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+	 write_word(fob, sref->elflags);
+      }
+
+      /* PLEX */
+      if ( sref->has & HAS_PLEX ) {
+	 write_record_hdr(fob, PLEX, sizeof(int32_t));
+	 write_int(fob, sref->plex);
+      }
+
+      /* SNAME */
+      nlen = strlen(sref->sname);
+      if (nlen % 2)
+	 nlen += 1;
+      write_record_hdr(fob, SNAME, nlen);
+      write_string(fob, (char *)sref->sname, nlen);
+
+      /* STRANS */
+      write_strans(fob, sref);
+
+      /* XY */
+      scale_trans(pxy, k, xy, 1, wt->uu_to_dbu);
+      write_record_hdr(fob, XY, 2*sizeof(int32_t));
+      write_int_be_n(fob, xy, 2);
+
+      /* Property */
+      write_property(fob, wt, pw);
+
+      /* ENDEL */
+      write_record_hdr(fob, ENDEL, 0);
+   }
+
+   return NULL;
+}
+
+
+/*-- Compound Sref ------------------------------------------------*/
+
+static const char*
+write_compound_sref(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *sref = pe;
+   wxy_rec *pxy = &wt->xy[pw->xy];
+   double uu_to_dbu = wt->uu_to_dbu;
+   int32_t *xybuf;
+   int ncxy;      /* number of compound xy records */
+   int mrem;      /* remainder in last record */
+   int mxy = pxy->m;
+   int k,nlen;
+
+
+   /*
+    * write sref elements as non-standard compound element
+    */
+   /* SREF */
+   write_record_hdr(fob, SREF, 0);
+
+   /* ELFLAGS */
+   if ( sref->has & HAS_ELFLAGS ) {
+      write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+      write_word(fob, sref->elflags);
+   }
+
+   /* PLEX */
+   if ( sref->has & HAS_PLEX ) {
+      write_record_hdr(fob, PLEX, sizeof(int32_t));
+      write_int(fob, sref->plex);
+   }
+
+   /* SNAME */
+   nlen = strlen(sref->sname);
+   if (nlen % 2)
+      nlen += 1;
+   write_record_hdr(fob, SNAME, nlen);
+   write_string(fob, (char *)sref->sname, nlen);
+
+   /* STRANS */
+   write_strans(fob, sref);
+
+   /* multiple large XY records */
+   xybuf = xy_buffer(fob, MAXVERTEXNUM);
+   if (xybuf == NULL)
+      return err_xybuf;
+   ncxy = mxy / MAXVERTEXNUM;
+   mrem = mxy % MAXVERTEXNUM;
+   for (k=0; k<ncxy; k++) {
+      sref_block(pxy, k*MAXVERTEXNUM, xybuf, MAXVERTEXNUM, uu_to_dbu);
+      write_record_hdr(fob, XY, (uint16_t)(MAXVERTEXNUM*2*sizeof(int32_t)));
+      write_int_be_n(fob, xybuf, 2*MAXVERTEXNUM);
+   }
+   if (mrem) {
+      sref_block(pxy, ncxy*MAXVERTEXNUM, xybuf, mrem, uu_to_dbu);
+      write_record_hdr(fob, XY, 2*mrem*sizeof(int32_t));
+      write_int_be_n(fob, xybuf, 2*mrem);
+   }
+
+   /* Property */
+   write_property(fob, wt, pw);
+
+   /* ENDEL */
+   write_record_hdr(fob, ENDEL, 0);
+
+   return NULL;
+}
+
+
+/*-- Aref ---------------------------------------------------------*/
+
+static const char*
+write_aref(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *aref = pe;
+   wxy_rec *pxy = &wt->xy[pw->xy];
+   int32_t xy[6];
+   int nlen;
+
+
+   /* AREF */
+   write_record_hdr(fob, AREF, 0);
+
+   /* ELFLAGS */
+   if ( aref->has & HAS_ELFLAGS ) {
+      write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+      write_word(fob, aref->elflags);
+   }
+
+   /* PLEX */
+   if ( aref->has & HAS_PLEX ) {
+      write_record_hdr(fob, PLEX, sizeof(int32_t));
+      write_int(fob, aref->plex);
+   }
+
+   /* SNAME */
+   nlen = strlen(aref->sname);
+   if (nlen % 2)
+      nlen += 1;
+   write_record_hdr(fob, SNAME, nlen);
+   write_string(fob, (char *)aref->sname, nlen);
+
+   /* STRANS */
+   write_strans(fob, aref);
+
+   /* COLROW */
+   write_record_hdr(fob, COLROW, 2*sizeof(uint16_t));
+   write_word(fob, aref->ncol);
+   write_word(fob, aref->nrow);
+
+   /* XY */
+   scale_trans(pxy, 0, xy, pxy->m, wt->uu_to_dbu);
+   write_record_hdr(fob, XY, pxy->m*pxy->n*sizeof(int32_t));
+   write_int_be_n(fob, xy, 6);
+
+   /* Property */
+   write_property(fob, wt, pw);
+
+   /* ENDEL */
+   write_record_hdr(fob, ENDEL, 0);
+
+   return NULL;
+}
+
+
+/*-- Text ---------------------------------------------------------*/
+
+static const char*
+write_text(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *text = pe;
+   char *txt = wt->str + pw->text;
+   int32_t xy[2];
+   int tlen;
+
+
+   /* TEXT */
+   write_record_hdr(fob, TEXT, 0);
+
+   /* ELFLAGS */
+   if ( text->has & HAS_ELFLAGS ) {
+      write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+      write_word(fob, text->elflags);
+   }
+
+   /* PLEX */
+   if ( text->has & HAS_PLEX ) {
+      write_record_hdr(fob, PLEX, sizeof(int32_t));
+      write_int(fob, text->plex);
+   }
+
+   /* LAYER */
+   write_record_hdr(fob, LAYER, sizeof(uint16_t));
+   write_word(fob, text->layer);
+
+   /* TEXTTYPE */
+   write_record_hdr(fob, TEXTTYPE, sizeof(uint16_t));
+   write_word(fob, text->dtype);
+
+   /* PRESENTATION */
+   if ( text->has & HAS_PRESTN ) {
+      write_record_hdr(fob, PRESENTATION, sizeof(uint16_t));
+      write_word(fob, text->present);
+   }
+
+   /* PATHTYPE */
+   if ( text->has & HAS_PTYPE ) {
+      write_record_hdr(fob, PATHTYPE, sizeof(uint16_t));
+      write_word(fob, text->ptype);
+   }
+
+   /* WIDTH */
+   if ( text->has & HAS_WIDTH ) {
+      write_record_hdr(fob, WIDTH, sizeof(int32_t));
+      write_int(fob, text->width);
+   }
+
+   /* STRANS */
+   write_strans(fob, text);
+
+   /* XY */
+   scale_trans(&wt->xy[pw->xy], 0, xy, 1, wt->uu_to_dbu);
+   write_record_hdr(fob, XY, 2*sizeof(int32_t));
+   write_int_be_n(fob, xy, 2);
+
+   /* STRING */
+   tlen = strlen(txt);
+   if (tlen % 2)
+      tlen += 1;
+   write_record_hdr(fob, STRING, tlen);
+   write_string(fob, txt, tlen);
+
+   /* Property */
+   write_property(fob, wt, pw);
+
+   /* ENDEL */
+   write_record_hdr(fob, ENDEL, 0);
+
+   return NULL;
+}
+
+
+/*-- Node ---------------------------------------------------------*/
+
+static const char*
+write_node(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *node = pe;
+   wxy_rec *pxy = &wt->xy[pw->xy];
+   int32_t *xybuf;
+
+   /* NODE */
+   write_record_hdr(fob, NODE, 0);
+
+   /* ELFLAGS */
+   if ( node->has & HAS_ELFLAGS ) {
+      write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+      write_word(fob, node->elflags);
+   }
+
+   /* PLEX */
+   if ( node->has & HAS_PLEX ) {
+      write_record_hdr(fob, ELFLAGS, sizeof(int32_t));
+      write_int(fob, node->plex);
+   }
+
+   /* LAYER */
+   write_record_hdr(fob, LAYER, sizeof(uint16_t));
+   write_word(fob, node->layer);
+
+   /* NODETYPE */
+   write_record_hdr(fob, NODETYPE, sizeof(uint16_t));
+   write_word(fob, node->dtype);
+
+   /* XY */
+   xybuf = xy_buffer(fob, pxy->m);
+   if (xybuf == NULL)
+      return err_xybuf;
+   scale_trans(pxy, 0, xybuf, pxy->m, wt->uu_to_dbu);
+   write_record_hdr(fob, XY, pxy->m*pxy->n*sizeof(int32_t));
+   write_int_be_n(fob, xybuf, pxy->m*pxy->n);
+
+   /* Property */
+   write_property(fob, wt, pw);
+
+   /* ENDEL */
+   write_record_hdr(fob, ENDEL, 0);
+
+   return NULL;
+}
+
+
+/*-- Box ----------------------------------------------------------*/
+
+static const char*
+write_box(gdsfile_t *fob, write_tables *wt, wel_rec *pw, const element_t *pe)
+{
+   const element_t *box = pe;
+   wxy_rec *pxy = &wt->xy[pw->xy];
+   int32_t xy[10];
+
+   /* BOX */
+   write_record_hdr(fob, BOX, 0);
+
+   /* ELFLAGS */
+   if ( box->has & HAS_ELFLAGS ) {
+      write_record_hdr(fob, ELFLAGS, sizeof(uint16_t));
+      write_word(fob, box->elflags);
+   }
+
+   /* PLEX */
+   if ( box->has & HAS_PLEX ) {
+      write_record_hdr(fob, PLEX, sizeof(int32_t));
+      write_int(fob, box->plex);
+   }
+
+   /* LAYER */
+   write_record_hdr(fob, LAYER, sizeof(uint16_t));
+   write_word(fob, box->layer);
+
+   /* BOXTYPE */
+   write_record_hdr(fob, BOXTYPE, sizeof(uint16_t));
+   write_word(fob, box->dtype);
+
+   /* XY */
+   scale_trans(pxy, 0, xy, pxy->m, wt->uu_to_dbu);
+   if (pxy->m == 4) { /* polygon is not closed */
+      xy[8] = xy[0]; xy[9] = xy[1];
+   }
+   write_record_hdr(fob, XY, 10*sizeof(int32_t));
+   write_int_be_n(fob, xy, 10);
+
+   /* Property */
+   write_property(fob, wt, pw);
+
+   /* ENDEL */
+   write_record_hdr(fob, ENDEL, 0);
+
+   return NULL;
+}
+
+
+/*-- Common -------------------------------------------------------*/
+
+static void
+write_property(gdsfile_t *fob, write_tables *wt, wel_rec *pw)
+{
+   wprop_rec *pp;
+   char *value;
+   int k,len;
+
+
+   for (k=0; k<pw->nprop; k++) {
+      pp = &wt->prop[pw->prop + k];
+      write_record_hdr(fob, PROPATTR, sizeof(int16_t));
+      write_word(fob, pp->attr);
+
+      value = wt->str + pp->value;
+      len = strlen(value);
+      if (len%2)
+	 len += 1;
+      write_record_hdr(fob, PROPVALUE, len);
+      write_string(fob, value, len);
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+write_strans(gdsfile_t *fob, const element_t *pe)
+{
+   if ( pe->has & HAS_STRANS ) {
+      write_record_hdr(fob, STRANS, sizeof(uint16_t));
+      write_word(fob, pe->strans.flags);
+      if ( pe->has & HAS_MAG && pe->strans.mag != 1.0) {
+	 write_record_hdr(fob, MAG, 8);
+	 write_real8(fob, pe->strans.mag);
+      }
+      if ( pe->has & HAS_ANGLE && pe->strans.angle != 0.0) {
+	 write_record_hdr(fob, ANGLE, 8);
+	 write_real8(fob, pe->strans.angle);
+      }
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * scales the vertices of a boundary to database units and returns
+ * them in big endian byte order in the coordinate buffer of the
+ * file object. The polygon is closed if necessary; m returns the
+ * number of vertices including the closing vertex.
+ */
+static int32_t *
+boundary_xy(gdsfile_t *fob, wxy_rec *pxy, double uu_to_dbu, int *m)
+{
+   int32_t *xybuf;
+   int n;
+
+   n = pxy->m;
+   xybuf = xy_buffer(fob, n);
+   if (xybuf == NULL)
+      return NULL;
+   scale_trans(pxy, 0, xybuf, n, uu_to_dbu);
+   if ( (xybuf[0]!=xybuf[2*n-2]) || (xybuf[1]!=xybuf[2*n-1]) ) {
+      xybuf[2*n]   = xybuf[0];  /* close polygon */
+      xybuf[2*n+1] = xybuf[1];
+      n+=1;
+   }
+   *m = n;
+
+   return xybuf;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * splits a polygon with more vertices than an XY record can hold
+ * into pieces with at most MAXVERTEXNUM vertices. The coordinates
+ * in xybuf are in big endian byte order and are overwritten.
+ * Returns 0 on success and -1 on failure.
+ */
+static int
+split_boundary(int32_t *xybuf, int m, poly_pieces *pp)
+{
+   byte_reverse32_n(xybuf, 2*m);   /* to host byte order */
+   if ( split_polygon(xybuf, m, MAXVERTEXNUM, pp) ) {
+      free_pieces(pp);
+      return -1;
+   }
+
+   return 0;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * returns the coordinate buffer of the file object with room for
+ * m vertices and a closing vertex, or NULL when the buffer cannot
+ * be allocated. The buffer belongs to the file object, which makes
+ * the element writers reentrant.
+ */
+static int32_t *
+xy_buffer(gdsfile_t *fob, int m)
+{
+   return gdsfile_xybuf(fob, 2*((size_t)m+1));
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * transpose polygon data, starting at vertex k0, and scale to
+ * database units. int32 matrices are already in database units, 
+ * and vertices from an element store are rescaled only when the 
+ * database unit differs. The coordinates are returned in big endian
+ * byte order.
+ */
+static INLINE void
+scale_trans(const wxy_rec *pxy, int k0, int32_t * RESTRICT xy, int m, double sfact)
+{
+   const int32_t *pi;
+   uint8_t *pb = (uint8_t *)xy;
+   int k;
+
+   if (pxy->pd != NULL) {
+      double_xy_to_be32(pxy->pd+k0, pxy->pd+pxy->m+k0, pb, m, sfact);
+      return;
+   }
+   if (pxy->pc != NULL) {
+      int32_xy_to_be32(pxy->pc+k0, pxy->pc+pxy->m+k0, pb, m);
+      return;
+   }
+
+   pi = pxy->pi + 2*k0;
+   if (pxy->same) {
+      for (k=0; k<2*m; k++)
+	 store_be32(pb+4*k, pi[k]);
+   }
+   else {
+      /* rounded like coordinates in user units */
+      for (k=0; k<2*m; k++)
+	 store_be32(pb+4*k, (int32_t)floor(0.5 + (pi[k] * pxy->fs) * sfact));
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * scales the positions k0 .. k0+m-1 of a compound sref. Like the
+ * reader, the MATLAB matrix stores each block of positions with
+ * the x coordinates followed by the y coordinates.
+ */
+static void
+sref_block(const wxy_rec *pxy, int k0, int32_t *xy, int m, double sfact)
+{
+   if (pxy->pd != NULL)
+      double_xy_to_be32(pxy->pd+2*k0, pxy->pd+2*k0+m, (uint8_t *)xy, m, sfact);
+   else if (pxy->pc != NULL)
+      int32_xy_to_be32(pxy->pc+2*k0, pxy->pc+2*k0+m, (uint8_t *)xy, m);
+   else
+      scale_trans(pxy, k0, xy, m, sfact);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * task function for write_library_data: writes chunk k of a batch
+ * into a memory file
+ */
+static void
+write_chunk(void *arg, int k)
+{
+   batch_t *pb = (batch_t *)arg;
+   chunk_t *pc = pb->chunk + k;
+
+   pc->mf = gdsfile_mem();
+   if (pc->mf == NULL) {
+      pc->err = "gds_write_library :  failed to allocate output buffer.";
+      return;
+   }
+   pc->err = write_range(pc->mf, pb->wt, pc->s0, pc->k0, pc->s1, pc->k1);
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,43 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Writes GDS II elements and structures from the mxArray data 
+ * used by the gds_element and gds_structure classes.
+ */
+
+#ifndef _GDSWRITE_H
+#define _GDSWRITE_H
+
+#include "mex.h"
+#include "gdsio.h"
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * write an element from an element data structure as it is
+ * stored in a gds_element object.
+ */
+void write_element_data(gdsfile_t *fob, mxArray *data, double uu_to_dbu, int compound);
+
+/*
+ * write a structure, i.e. the BGNSTR and STRNAME records, all
+ * elements, and the ENDSTR record. sdata is a structure with
+ * fields sname (structure name) and el (cell array with element
+ * data structures).
+ */
+void write_structure_data(gdsfile_t *fob, mxArray *sdata, double uu_to_dbu, int compound);
+
+/*
+ * write all structures in the cell array slist of structure data.
+ * The records are created with up to nthreads threads (all
+ * processors when nthreads <= 0) in batches of ranges and written
+ * in the order of the structures in the list; a batch is written to
+ * the file before the next batch is created. Compressed files are
+ * written by one thread.
+ */
+void write_library_data(gdsfile_t *fob, const mxArray *slist, double uu_to_dbu,
+			int compound, int nthreads);
+
+#endif /* _GDSWRITE_H */
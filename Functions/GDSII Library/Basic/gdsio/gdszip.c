@@ -0,0 +1,686 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Compressed GDS II streams (gzip and Zstandard). See gdszip.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "gdszip.h"
+
+#ifdef HAVE_ZLIB
+   #include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+   #include <zstd.h>
+#endif
+
+#define ZBUF_SIZE   262144     /* decompression buffer */
+
+/* Zstandard seekable format */
+#define SKIPPABLE_MAGIC   0x184D2A5EU
+#define SEEKABLE_MAGIC    0x8F92EAB1U
+#define SEEK_FOOTER       9
+
+
+/*-- Types --------------------------------------------------------*/
+
+struct gds_zstream {
+   zip_codec codec;
+   int wr;               /* opened for writing */
+   uint8_t *ubuf;        /* decompressed data */
+   uint8_t *upos;        /* read position in ubuf */
+   uint8_t *uend;        /* end of data in ubuf */
+   long uoff;            /* uncompressed position of uend, or bytes written */
+#ifdef HAVE_ZLIB
+   gzFile gz;
+#endif
+#ifdef HAVE_ZSTD
+   ZSTD_DCtx *dctx;
+   ZSTD_CCtx *cctx;
+   ZSTD_inBuffer in;     /* compressed input */
+   uint8_t *cbuf;        /* compressed data */
+   size_t mcb;           /* size of cbuf */
+   int eof;              /* end of compressed file reached */
+   long *coff, *doff;    /* compressed and uncompressed frame offsets */
+   size_t nfr, mfr;      /* number of frames, size of offset tables */
+#endif
+};
+
+
+/*-----------------------------------------------------------------*/
+
+zip_codec
+gdszip_codec(const char *fname)
+{
+   size_t n = strlen(fname);
+
+   if (n > 3 && !strcmp(fname + n - 3, ".gz"))
+      return ZIP_GZIP;
+   if (n > 4 && !strcmp(fname + n - 4, ".zst"))
+      return ZIP_ZSTD;
+
+   return ZIP_NONE;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+int
+gdszip_supported(zip_codec codec)
+{
+   switch (codec) {
+
+      case ZIP_NONE:
+	 return 1;
+
+#ifdef HAVE_ZLIB
+      case ZIP_GZIP:
+	 return 1;
+#endif
+
+#ifdef HAVE_ZSTD
+      case ZIP_ZSTD:
+	 return 1;
+#endif
+
+      default:
+	 return 0;
+   }
+}
+
+
+/*-- Zstandard ----------------------------------------------------*/
+
+#ifdef HAVE_ZSTD
+
+static uint32_t
+get_le32(const uint8_t *p)
+{
+   return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+          ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+static void
+put_le32(uint8_t *p, uint32_t u)
+{
+   p[0] = u & 0xff;
+   p[1] = (u >> 8) & 0xff;
+   p[2] = (u >> 16) & 0xff;
+   p[3] = (u >> 24) & 0xff;
+}
+
+
+/*
+ * append a frame to the offset tables. coff[nfr] and doff[nfr]
+ * always hold the end of the last frame.
+ */
+static int
+add_frame(struct gds_zstream *zs, long csize, long dsize)
+{
+   long *p;
+   size_t m;
+
+   if (zs->nfr + 2 > zs->mfr) {
+      m = zs->mfr ? 2*zs->mfr : 64;
+      p = (long *)realloc(zs->coff, m*sizeof(long));
+      if (p == NULL)
+	 return -1;
+      zs->coff = p;
+      p = (long *)realloc(zs->doff, m*sizeof(long));
+      if (p == NULL)
+	 return -1;
+      zs->doff = p;
+      zs->mfr = m;
+   }
+
+   if (zs->nfr == 0)
+      zs->coff[0] = zs->doff[0] = 0;
+   zs->coff[zs->nfr+1] = zs->coff[zs->nfr] + csize;
+   zs->doff[zs->nfr+1] = zs->doff[zs->nfr] + dsize;
+   zs->nfr++;
+
+   return 0;
+}
+
+
+/*
+ * read the seek table at the end of a Zstandard file. Returns the
+ * size of the uncompressed data or -1 when the file has no
+ * (valid) seek table.
+ */
+static long
+read_seek_table(FILE *fp, struct gds_zstream *zs)
+{
+   uint8_t foot[SEEK_FOOTER], hdr[8], ent[12];
+   long fsize, tsize;
+   uint32_t k, nfr;
+   int esz;
+
+   if (fseek(fp, 0L, SEEK_END) || (fsize = ftell(fp)) < 0)
+      return -1;
+   if (fsize < 8 + SEEK_FOOTER)
+      return -1;
+
+   /* footer */
+   if (fseek(fp, fsize - SEEK_FOOTER, SEEK_SET) ||
+       fread(foot, 1, SEEK_FOOTER, fp) != SEEK_FOOTER)
+      return -1;
+   if (get_le32(foot + 5) != SEEKABLE_MAGIC || (foot[4] & 0x7c))
+      return -1;
+   nfr = get_le32(foot);
+   esz = (foot[4] & 0x80) ? 12 : 8;   /* entries with checksum */
+
+   /* skippable frame header */
+   tsize = (long)nfr * esz + SEEK_FOOTER;
+   if (tsize + 8 > fsize)
+      return -1;
+   if (fseek(fp, fsize - tsize - 8, SEEK_SET) ||
+       fread(hdr, 1, 8, fp) != 8)
+      return -1;
+   if (get_le32(hdr) != SKIPPABLE_MAGIC || get_le32(hdr + 4) != tsize)
+      return -1;
+
+   /* entries */
+   for (k=0; k<nfr; k++) {
+      if (fread(ent, 1, esz, fp) != (size_t)esz)
+	 return -1;
+      if ( add_frame(zs, get_le32(ent), get_le32(ent + 4)) )
+	 return -1;
+   }
+
+   /* the frames must cover the file up to the seek table */
+   if (nfr == 0 || zs->coff[nfr] != fsize - tsize - 8) {
+      zs->nfr = 0;
+      return -1;
+   }
+
+   return zs->doff[nfr];
+}
+
+
+/*
+ * append the seek table to a Zstandard file
+ */
+static int
+write_seek_table(FILE *fp, struct gds_zstream *zs)
+{
+   uint8_t buf[12];
+   size_t k;
+
+   put_le32(buf, SKIPPABLE_MAGIC);
+   put_le32(buf + 4, (uint32_t)(8*zs->nfr + SEEK_FOOTER));
+   if (fwrite(buf, 1, 8, fp) != 8)
+      return -1;
+
+   for (k=0; k<zs->nfr; k++) {
+      put_le32(buf, (uint32_t)(zs->coff[k+1] - zs->coff[k]));
+      put_le32(buf + 4, (uint32_t)(zs->doff[k+1] - zs->doff[k]));
+      if (fwrite(buf, 1, 8, fp) != 8)
+	 return -1;
+   }
+
+   put_le32(buf, (uint32_t)zs->nfr);
+   buf[4] = 0;                         /* no checksums */
+   put_le32(buf + 5, SEEKABLE_MAGIC);
+   if (fwrite(buf, 1, SEEK_FOOTER, fp) != SEEK_FOOTER)
+      return -1;
+
+   return 0;
+}
+
+
+/*
+ * continue decompression at frame k. The uncompressed position
+ * becomes the start of the frame.
+ */
+static int
+zstd_restart(gdsfile_t *gf, size_t k)
+{
+   struct gds_zstream *zs = gf->zs;
+   long coff = k ? zs->coff[k] : 0;
+   long doff = k ? zs->doff[k] : 0;
+
+   if ( fseek(gf->fob, coff, SEEK_SET) )
+      return -1;
+   ZSTD_DCtx_reset(zs->dctx, ZSTD_reset_session_only);
+   zs->in.pos = zs->in.size = 0;
+   zs->eof = 0;
+   zs->upos = zs->uend = zs->ubuf;
+   zs->uoff = doff;
+
+   return 0;
+}
+
+
+/*
+ * decompress the next block of data into ubuf
+ */
+static long
+zstd_fill(gdsfile_t *gf)
+{
+   struct gds_zstream *zs = gf->zs;
+   ZSTD_outBuffer out;
+   size_t r;
+
+   out.dst = zs->ubuf;
+   out.size = ZBUF_SIZE;
+   out.pos = 0;
+
+   for (;;) {
+      if (zs->in.pos == zs->in.size && !zs->eof) {
+	 zs->in.size = fread(zs->cbuf, 1, zs->mcb, gf->fob);
+	 zs->in.pos = 0;
+	 if (zs->in.size == 0)
+	    zs->eof = 1;
+      }
+      r = ZSTD_decompressStream(zs->dctx, &out, &zs->in);
+      if ( ZSTD_isError(r) )
+	 return -1;
+      if (out.pos == out.size)
+	 break;
+      if (zs->eof && zs->in.pos == zs->in.size)
+	 break;
+   }
+
+   zs->upos = zs->ubuf;
+   zs->uend = zs->ubuf + out.pos;
+   zs->uoff += out.pos;
+
+   return out.pos;
+}
+
+
+/*
+ * set the read position. With a seek table decompression resumes at
+ * the frame containing the position unless the position lies ahead
+ * in the current frame; without a table a backward seek starts over.
+ */
+static int
+zstd_seek(gdsfile_t *gf, long pos)
+{
+   struct gds_zstream *zs = gf->zs;
+   size_t lo, hi, mid;
+
+   if (zs->nfr > 0) {
+      if (pos > zs->doff[zs->nfr])
+	 return -1;
+      lo = 0;
+      hi = zs->nfr;
+      while (hi - lo > 1) {
+	 mid = (lo + hi) / 2;
+	 if (zs->doff[mid] <= pos)
+	    lo = mid;
+	 else
+	    hi = mid;
+      }
+      if (pos < zs->uoff || zs->doff[lo] > zs->uoff) {
+	 if ( zstd_restart(gf, lo) )
+	    return -1;
+      }
+   }
+   else if (pos < zs->uoff) {
+      if ( zstd_restart(gf, 0) )
+	 return -1;
+   }
+
+   /* decompress up to the new position */
+   while (zs->uoff < pos) {
+      if (zstd_fill(gf) <= 0)
+	 return -1;
+   }
+   zs->upos = zs->uend - (zs->uoff - pos);
+
+   return 0;
+}
+
+
+/*
+ * compress a block of data into an independent frame
+ */
+static int
+zstd_write(gdsfile_t *gf, const void *buf, size_t nb)
+{
+   struct gds_zstream *zs = gf->zs;
+   uint8_t *p;
+   size_t m, r;
+
+   m = ZSTD_compressBound(nb);
+   if (m > zs->mcb) {
+      p = (uint8_t *)realloc(zs->cbuf, m);
+      if (p == NULL)
+	 return -1;
+      zs->cbuf = p;
+      zs->mcb = m;
+   }
+
+   r = ZSTD_compress2(zs->cctx, zs->cbuf, zs->mcb, buf, nb);
+   if ( ZSTD_isError(r) )
+      return -1;
+   if (fwrite(zs->cbuf, 1, r, gf->fob) != r)
+      return -1;
+
+   return add_frame(zs, (long)r, (long)nb);
+}
+
+#endif /* HAVE_ZSTD */
+
+
+/*-- gzip ---------------------------------------------------------*/
+
+#ifdef HAVE_ZLIB
+
+/*
+ * size of the uncompressed data from the gzip trailer, or -1 when it
+ * is unknown. The trailer holds the size modulo 2^32 of the last
+ * member of the file, which is only the size of the data when there
+ * are less than 4 GB of data in one member. Deflate expands data by
+ * at most about 1/7 (see deflateBound in zlib), so a size below 7/8
+ * of the compressed file size is known to be wrong. Larger files can
+ * still report a size that is too small by a multiple of 4 GB.
+ */
+static long
+gzip_size(const char *fname)
+{
+   FILE *fp;
+   uint8_t t[4];
+   long size = -1;
+   long csize;
+
+   fp = fopen(fname, "rb");
+   if (fp == NULL)
+      return -1;
+   if (!fseek(fp, -4L, SEEK_END) && fread(t, 1, 4, fp) == 4 &&
+       (csize = ftell(fp)) >= 0) {
+      size = (long)((uint32_t)t[0] | ((uint32_t)t[1] << 8) |
+		    ((uint32_t)t[2] << 16) | ((uint32_t)t[3] << 24));
+      if (size < (csize - 64) / 8 * 7)
+	 size = -1;
+   }
+   fclose(fp);
+
+   return size;
+}
+
+
+static long
+gzip_fill(gdsfile_t *gf)
+{
+   struct gds_zstream *zs = gf->zs;
+   int n;
+
+   n = gzread(zs->gz, zs->ubuf, ZBUF_SIZE);
+   if (n < 0)
+      return -1;
+
+   zs->upos = zs->ubuf;
+   zs->uend = zs->ubuf + n;
+   zs->uoff += n;
+
+   return n;
+}
+
+#endif /* HAVE_ZLIB */
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * decompress the next block of data
+ */
+static long
+fill(gdsfile_t *gf)
+{
+   switch (gf->zs->codec) {
+
+#ifdef HAVE_ZLIB
+      case ZIP_GZIP:
+	 return gzip_fill(gf);
+#endif
+
+#ifdef HAVE_ZSTD
+      case ZIP_ZSTD:
+	 return zstd_fill(gf);
+#endif
+
+      default:
+	 return -1;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+int
+gdszip_open(gdsfile_t *gf, const char *fname, zip_codec codec, int wr)
+{
+   struct gds_zstream *zs;
+   long size = -1;
+
+   if ( !gdszip_supported(codec) || codec == ZIP_NONE )
+      return -1;
+
+   zs = (struct gds_zstream *)calloc(1, sizeof(struct gds_zstream));
+   if (zs == NULL)
+      return -1;
+   zs->codec = codec;
+   zs->wr = wr;
+
+   if (!wr) {
+      zs->ubuf = (uint8_t *)malloc(ZBUF_SIZE);
+      if (zs->ubuf == NULL)
+	 goto fail;
+      zs->upos = zs->uend = zs->ubuf;
+   }
+
+   switch (codec) {
+
+#ifdef HAVE_ZLIB
+      case ZIP_GZIP:
+	 if (!wr)
+	    size = gzip_size(fname);
+	 zs->gz = gzopen(fname, wr ? "wb" : "rb");
+	 if (zs->gz == NULL)
+	    goto fail;
+	 gzbuffer(zs->gz, ZBUF_SIZE);
+	 break;
+#endif
+
+#ifdef HAVE_ZSTD
+      case ZIP_ZSTD:
+	 gf->fob = fopen(fname, wr ? "wb" : "rb");
+	 if (gf->fob == NULL)
+	    goto fail;
+	 if (wr) {
+	    zs->cctx = ZSTD_createCCtx();
+	    if (zs->cctx == NULL)
+	       goto fail;
+	 }
+	 else {
+	    zs->dctx = ZSTD_createDCtx();
+	    zs->mcb = ZSTD_DStreamInSize();
+	    zs->cbuf = (uint8_t *)malloc(zs->mcb);
+	    if (zs->dctx == NULL || zs->cbuf == NULL)
+	       goto fail;
+	    zs->in.src = zs->cbuf;
+	    size = read_seek_table(gf->fob, zs);
+	    if ( fseek(gf->fob, 0L, SEEK_SET) )
+	       goto fail;
+	 }
+	 break;
+#endif
+
+      default:
+	 goto fail;
+   }
+
+   gf->zs = zs;
+   gf->size = size < 0 ? 0 : size;
+   return 0;
+
+ fail:
+   gf->zs = zs;
+   gdszip_close(gf);
+   if (gf->fob) {
+      fclose(gf->fob);
+      gf->fob = NULL;
+   }
+   return -1;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+err_id
+gdszip_close(gdsfile_t *gf)
+{
+   struct gds_zstream *zs = gf->zs;
+   err_id ret = A_OK;
+
+   if (zs == NULL)
+      return A_OK;
+
+   switch (zs->codec) {
+
+#ifdef HAVE_ZLIB
+      case ZIP_GZIP:
+	 if (zs->gz != NULL && gzclose(zs->gz) != Z_OK)
+	    ret = zs->wr ? WRITE_OPEN_CLOSE : READ_OPEN_CLOSE;
+	 break;
+#endif
+
+#ifdef HAVE_ZSTD
+      case ZIP_ZSTD:
+	 if (zs->wr && gf->fob && zs->nfr > 0) {
+	    if ( write_seek_table(gf->fob, zs) )
+	       ret = WRITE_OPEN_CLOSE;
+	 }
+	 ZSTD_freeCCtx(zs->cctx);
+	 ZSTD_freeDCtx(zs->dctx);
+	 free(zs->cbuf);
+	 free(zs->coff);
+	 free(zs->doff);
+	 break;
+#endif
+
+      default:
+	 break;
+   }
+
+   free(zs->ubuf);
+   free(zs);
+   gf->zs = NULL;
+
+   return ret;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+size_t
+gdszip_read(gdsfile_t *gf, void *buf, size_t nb)
+{
+   struct gds_zstream *zs = gf->zs;
+   uint8_t *pb = (uint8_t *)buf;
+   size_t n, m;
+
+   for (n=0; n<nb; n+=m) {
+      if (zs->upos == zs->uend) {
+	 if (fill(gf) <= 0)
+	    break;
+      }
+      m = zs->uend - zs->upos;
+      if (m > nb - n)
+	 m = nb - n;
+      memcpy(pb + n, zs->upos, m);
+      zs->upos += m;
+   }
+
+   return n;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+int
+gdszip_write(gdsfile_t *gf, const void *buf, size_t nb)
+{
+   struct gds_zstream *zs = gf->zs;
+   int ret = -1;
+
+   switch (zs->codec) {
+
+#ifdef HAVE_ZLIB
+      case ZIP_GZIP:
+	 ret = gzwrite(zs->gz, buf, (unsigned)nb) == (int)nb ? 0 : -1;
+	 break;
+#endif
+
+#ifdef HAVE_ZSTD
+      case ZIP_ZSTD:
+	 ret = zstd_write(gf, buf, nb);
+	 break;
+#endif
+
+      default:
+	 break;
+   }
+
+   if (ret == 0)
+      zs->uoff += nb;
+
+   return ret;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+long
+gdszip_tell(gdsfile_t *gf)
+{
+   struct gds_zstream *zs = gf->zs;
+
+   return zs->uoff - (long)(zs->uend - zs->upos);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+int
+gdszip_seek(gdsfile_t *gf, long pos)
+{
+   struct gds_zstream *zs = gf->zs;
+
+   if (zs->wr || pos < 0)
+      return -1;
+
+   /* inside the decompressed block */
+   if (pos <= zs->uoff && pos >= zs->uoff - (long)(zs->uend - zs->ubuf)) {
+      zs->upos = zs->uend - (zs->uoff - pos);
+      return 0;
+   }
+
+   switch (zs->codec) {
+
+#ifdef HAVE_ZLIB
+      case ZIP_GZIP:
+	 if (gzseek(zs->gz, pos, SEEK_SET) != pos)
+	    return -1;
+	 zs->upos = zs->uend = zs->ubuf;
+	 zs->uoff = pos;
+	 return 0;
+#endif
+
+#ifdef HAVE_ZSTD
+      case ZIP_ZSTD:
+	 return zstd_seek(gf, pos);
+#endif
+
+      default:
+	 return -1;
+   }
+}
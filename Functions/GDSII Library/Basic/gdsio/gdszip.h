@@ -0,0 +1,85 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Compressed GDS II streams. Files with the extension .gz are
+ * compressed with zlib (gzip format), files with the extension .zst
+ * with Zstandard. The codecs are available when the library is
+ * compiled with HAVE_ZLIB and HAVE_ZSTD, respectively. Data are
+ * decompressed and compressed block by block while records are read
+ * or written; the file object always reports positions in the
+ * uncompressed data.
+ *
+ * Zstandard files are written as a sequence of independent frames,
+ * one per output buffer, followed by a seek table in the format of
+ * the Zstandard seekable format (a skippable frame that is ignored by
+ * other decompressors). When the seek table is present, a seek only
+ * decompresses the frame containing the new position. Seeks in gzip
+ * files and in Zstandard files without seek table are emulated by
+ * decompressing from the start of the file.
+ */
+
+#ifndef _GDSZIP_H
+#define _GDSZIP_H
+
+#include "gdsio.h"
+
+
+/* compression formats */
+typedef enum {ZIP_NONE = 0, ZIP_GZIP, ZIP_ZSTD} zip_codec;
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * return the compression format implied by the file name extension
+ */
+zip_codec gdszip_codec(const char *fname);
+
+/*
+ * returns 1 when the compression format of a file can be read and
+ * written by this build of the library, 0 otherwise.
+ */
+int gdszip_supported(zip_codec codec);
+
+/*
+ * open a compressed file for reading (wr == 0) or writing (wr == 1)
+ * and attach the compressed stream to the file object. The size of
+ * the uncompressed data is stored in gf->size when it is known, and
+ * gf->size is 0 otherwise. The size of gzip files is taken from the
+ * trailer, which holds it modulo 2^32; for files with more than 4 GB
+ * of data it is 0 or too small, and must only be used as a hint.
+ * Returns 0 on success and -1 on failure.
+ */
+int gdszip_open(gdsfile_t *gf, const char *fname, zip_codec codec, int wr);
+
+/*
+ * finish and release the compressed stream. The stdio stream in
+ * gf->fob, if any, must be closed by the caller.
+ */
+err_id gdszip_close(gdsfile_t *gf);
+
+/*
+ * decompress up to nb bytes into buf. Returns the number of bytes
+ * copied, which is less than nb at the end of the file or on error.
+ */
+size_t gdszip_read(gdsfile_t *gf, void *buf, size_t nb);
+
+/*
+ * compress nb bytes and write them to the file. Returns 0 on
+ * success and -1 on failure.
+ */
+int gdszip_write(gdsfile_t *gf, const void *buf, size_t nb);
+
+/*
+ * return the position in the uncompressed data
+ */
+long gdszip_tell(gdsfile_t *gf);
+
+/*
+ * set the position in the uncompressed data of a file opened for
+ * reading. Returns 0 on success and -1 on failure.
+ */
+int gdszip_seek(gdsfile_t *gf, long pos);
+
+#endif /* _GDSZIP_H */
@@ -37,14 +37,14 @@ get_field_ptr(mxArray *structure, char *fieldname, mxArray **pfieldp)
 /*-----------------------------------------------------------------*/
 
 /*
- * retrieve a FILE * stored in an mxArray object
+ * retrieve a gds file object pointer stored in an mxArray object
  */
-FILE *
+gdsfile_t *
 get_file_ptr(mxArray *fptr)
 {
-   FILE **pfp;
+   gdsfile_t **pfp;
    
-   pfp = (FILE **)mxGetData(fptr);
+   pfp = (gdsfile_t **)mxGetData(fptr);
    return *pfp;
 }
 
@@ -12,6 +12,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include "mex.h"
+#include "gdsio.h"
 
 
 /*-----------------------------------------------------------------*/
@@ -25,9 +26,9 @@ get_field_ptr(mxArray *structure, char *fieldname, mxArray **pfieldp);
 
 
 /*
- * retrieve a FILE * stored in an mxArray object
+ * retrieve a gds file object pointer stored in an mxArray object
  */
-FILE *
+gdsfile_t *
 get_file_ptr(mxArray *fptr);
 
 
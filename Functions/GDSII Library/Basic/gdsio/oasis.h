@@ -0,0 +1,76 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Record types and constants of the OASIS layout format
+ * (SEMI P39) shared by the OASIS reader and writer.
+ */
+
+#ifndef _OASIS_H
+#define _OASIS_H
+
+
+/*-- OASIS record IDs ---------------------------------------------*/
+
+#define OAS_PAD             0
+#define OAS_START           1
+#define OAS_END             2
+#define OAS_CELLNAME        3   /* implicit reference number */
+#define OAS_CELLNAME_R      4   /* explicit reference number */
+#define OAS_TEXTSTRING      5
+#define OAS_TEXTSTRING_R    6
+#define OAS_PROPNAME        7
+#define OAS_PROPNAME_R      8
+#define OAS_PROPSTRING      9
+#define OAS_PROPSTRING_R   10
+#define OAS_LAYERNAME      11
+#define OAS_LAYERNAME_T    12   /* text layer name */
+#define OAS_CELL_R         13   /* cell by reference number */
+#define OAS_CELL           14   /* cell by name string */
+#define OAS_XYABSOLUTE     15
+#define OAS_XYRELATIVE     16
+#define OAS_PLACEMENT      17
+#define OAS_PLACEMENT_MA   18   /* with magnification and angle */
+#define OAS_TEXT           19
+#define OAS_RECTANGLE      20
+#define OAS_POLYGON        21
+#define OAS_PATH           22
+#define OAS_TRAPEZOID      23
+#define OAS_TRAPEZOID_A    24
+#define OAS_TRAPEZOID_B    25
+#define OAS_CTRAPEZOID     26
+#define OAS_CIRCLE         27
+#define OAS_PROPERTY       28
+#define OAS_PROPERTY_LAST  29   /* repeat last property */
+#define OAS_XNAME          30
+#define OAS_XNAME_R        31
+#define OAS_XELEMENT       32
+#define OAS_XGEOMETRY      33
+#define OAS_CBLOCK         34
+
+
+/*-- Constants ----------------------------------------------------*/
+
+/* file magic */
+#define OAS_MAGIC          "%SEMI-OASIS\r\n"
+#define OAS_MAGIC_LEN      13
+
+/* the END record is padded to this length */
+#define OAS_END_LEN        256
+
+/* CBLOCK compression type: raw DEFLATE (RFC 1951) */
+#define OAS_DEFLATE        0
+
+/* standard property carrying GDS II PROPATTR / PROPVALUE pairs */
+#define OAS_GDS_PROPERTY   "S_GDS_PROPERTY"
+
+/* file properties with the GDS II library name and user unit */
+#define OAS_LIBNAME_PROP   "GDSII_LIBNAME"
+#define OAS_UUNIT_PROP     "GDSII_UUNIT"
+
+/* flags of the GDS II STRANS record */
+#define STRANS_REFLECT     0x8000
+#define STRANS_ABSMAG      0x0004
+#define STRANS_ABSANG      0x0002
+
+#endif /* _OASIS_H */
@@ -0,0 +1,59 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Writes the header of an OASIS library file: the magic string,
+ * the START record, and file properties with the library name and
+ * the user unit, which are not part of the OASIS data model.
+ * 
+ * oasis_beginlib(gf, uunit, dbunit, lname);
+ *
+ * Input
+ * gf :     a file handle returned by gds_open.
+ * uunit :  user unit in m
+ * dbunit:  database unit in m
+ * lname :  string with the library name
+ */
+
+#include <string.h>
+#include "gdsio.h"
+#include "mex.h"
+#include "mexfuncs.h"
+#include "oaswrite.h"
+
+#define NLEN   256
+
+#define UUNIT_ARG    1
+#define DBUNIT_ARG   2
+#define LNAME_ARG    3
+
+
+/*-----------------------------------------------------------------*/
+
+void 
+mexFunction(int nlhs, mxArray *plhs[], 
+	    int nrhs, const mxArray *prhs[])
+{
+   gdsfile_t *fob;        /* file object pointer */
+   double *uunit, *dbunit;
+   char name[NLEN];       /* library name */
+
+   /* check argument number */
+   if (nrhs != 4)
+      mexErrMsgTxt("oasis_beginlib :  4 input arguments expected.");
+   
+   /* get file handle argument */
+   fob = get_file_ptr((mxArray *)prhs[0]);
+
+   /* units and library name */
+   uunit  = mxGetData(prhs[UUNIT_ARG]);
+   dbunit = mxGetData(prhs[DBUNIT_ARG]);
+   if (uunit[0] <= 0.0 || dbunit[0] <= 0.0)
+      mexErrMsgTxt("oasis_beginlib :  units must be > 0.");
+   if ( mxGetString(prhs[LNAME_ARG], name, NLEN) )
+      mexErrMsgTxt("oasis_beginlib :  failed to access library name argument.");
+
+   oas_write_begin(fob, uunit[0], dbunit[0], name);
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,38 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Writes the END record to an OASIS library file.
+ * 
+ * oasis_endlib(gf);
+ *
+ * Input
+ * gf :    a file handle returned by gds_open. 
+ * 
+ */
+
+#include "mex.h"
+#include "mexfuncs.h"
+#include "gdsio.h"
+#include "oaswrite.h"
+
+/*-----------------------------------------------------------------*/
+
+void 
+mexFunction(int nlhs, mxArray *plhs[], 
+	    int nrhs, const mxArray *prhs[])
+{
+   gdsfile_t *fob;                  /* file object pointer */
+
+   /* check argument number */
+   if (nrhs != 1) {
+      mexErrMsgTxt("oasis_endlib :  expected 1 input argument.");
+   }
+   
+   /* get file handle argument */
+   fob = get_file_ptr((mxArray *)prhs[0]);
+
+   oas_write_end(fob);
+}
+
+/*-----------------------------------------------------------------*/
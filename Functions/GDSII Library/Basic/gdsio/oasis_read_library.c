@@ -0,0 +1,85 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Reads an OASIS library file with a single call and returns the
+ * library data and all structures in the form used for GDS II
+ * libraries.
+ *
+ * [ldata, slist] = oasis_read_library(gf, intxy);
+ *
+ * Input
+ * gf :     a file handle returned by gds_open.
+ * intxy :  (Optional) when ~= 0, the xy matrices of the elements
+ *          are int32 matrices in database units. Default is 0.
+ *
+ * Output:
+ * ldata :  a structure with the library data, with the same fields
+ *          as returned by gds_libdata. Only lname, uunit, and
+ *          dbunit are read from the file; the dates are the
+ *          current date.
+ * slist :  (Optional) a 1 x N structure array with one entry per
+ *          structure, as returned by gds_read_library. When slist
+ *          is not requested, only the library header is read.
+ */
+
+#include <stdio.h>
+#include "gdsio.h"
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsread.h"
+#include "oasread.h"
+#include "mexfuncs.h"
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   const char *fields[] = {"lname", "libver", "cdate", "mdate",
+			   "uunit", "dbunit", "reflibs", "fonts", "generations"};
+   gdsfile_t *gf;
+   oas_libinfo info;
+   lib_tables lt;
+   date_t dv;
+   uint16_t word = 7;
+   double *pd;
+
+   /* check argument number */
+   if (nrhs < 1 || nrhs > 2) {
+      mexErrMsgTxt("oasis_read_library :  1 or 2 input arguments expected.");
+   }
+
+   /* get file handle argument */
+   gf = get_file_ptr((mxArray *)prhs[0]);
+
+   /* decode the file */
+   info.lname[0] = '\0';
+   init_tables(&lt, 1.0);
+   oas_read_library(gf, &info, &lt, nlhs < 2);
+   if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+      pd = mxGetData(prhs[1]);
+      lt.intxy = (int)pd[0];
+   }
+
+   /* library data; OASIS files have no library dates */
+   plhs[0] = mxCreateStructMatrix(1, 1, 9, fields); 
+   struct_set_string(plhs[0], 0, info.lname);
+   struct_set_word(plhs[0], 1, &word, 1);
+   now(dv);
+   struct_set_word(plhs[0], 2, dv, 6);
+   struct_set_word(plhs[0], 3, dv, 6);
+   struct_set_float(plhs[0], 4, info.uunit);
+   struct_set_float(plhs[0], 5, info.dbunit);
+
+   /* structures */
+   if (nlhs > 1)
+      plhs[1] = structures_to_mx(&lt, 1);
+
+   free_tables(&lt);
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,57 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Writes a list of structures to an OASIS library file with a
+ * single call. Shapes of equal size and structure references 
+ * without properties are combined into OASIS repetitions, and the
+ * records of each cell are compressed in CBLOCK records when the
+ * function is compiled with zlib.
+ *
+ * oasis_write_library(gf, slist, uu_to_dbu);
+ *
+ * Input
+ * gf :        a file handle returned by gds_open
+ * slist :     a cell array of structures with fields
+ *               sname : structure name
+ *               el    : cell array with element data structures
+ *                       as stored in gds_element objects
+ * uu_to_dbu : conversion factor user units --> database units
+ */
+
+#include <stdio.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsio.h"
+#include "oaswrite.h"
+#include "mexfuncs.h"
+
+
+/*-----------------------------------------------------------------*/
+
+void
+mexFunction(int nlhs, mxArray *plhs[],
+            int nrhs, const mxArray *prhs[])
+{
+   gdsfile_t *fob;
+   double *pd;
+
+   /* check argument number */
+   if (nrhs != 3) {
+      mexErrMsgTxt("oasis_write_library :  3 input arguments expected.");
+   }
+   
+   /* get file handle argument */
+   fob = get_file_ptr((mxArray *)prhs[0]);
+
+   /* write all structures */
+   if ( mxIsEmpty(prhs[1]) )
+      return;
+   if ( !mxIsCell(prhs[1]) )
+      mexErrMsgTxt("oasis_write_library :  structure list must be a cell array.");
+   pd = (double *)mxGetData(prhs[2]);
+   oas_write_structures(fob, prhs[1], pd[0]);
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,1840 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Functions for reading OASIS files. The file is read into memory,
+ * or accessed directly when it is memory mapped, and the records are
+ * decoded into the tables of the GDS II reader. CBLOCK records are
+ * decompressed when the library is compiled with HAVE_ZLIB. Names
+ * of cells, text strings, and properties that are defined by
+ * reference numbers are resolved after the whole file was read,
+ * because the name tables can be anywhere in the file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsio.h"
+#include "gdsread.h"
+#include "oasis.h"
+#include "oasread.h"
+#include "byteswap.h"
+
+#ifdef HAVE_ZLIB
+   #include <zlib.h>
+#endif
+
+#ifndef M_PI
+   #define M_PI  3.14159265358979323846
+#endif
+
+/* number of vertices of polygons approximating circles */
+#define CIRCLE_VERTICES  64
+
+/* maximum number of positions in an expanded repetition */
+#define MAX_POSITIONS    (1<<28)
+
+/* references that are resolved after reading */
+#define FIX_CELL     1     /* structure name */
+#define FIX_SNAME    2     /* name of referenced structure */
+#define FIX_TEXT     3     /* text string */
+
+/* modal variables that are defined */
+#define M_LAYER      1
+#define M_DTYPE      (1<<1)
+#define M_TLAYER     (1<<2)
+#define M_TTYPE      (1<<3)
+#define M_WIDTH      (1<<4)
+#define M_HEIGHT     (1<<5)
+#define M_HWIDTH     (1<<6)
+#define M_EXTN       (1<<7)
+#define M_CELL       (1<<8)
+#define M_TEXT       (1<<9)
+#define M_REP        (1<<10)
+#define M_POLY       (1<<11)
+#define M_PATH       (1<<12)
+#define M_CTRAP      (1<<13)
+#define M_RADIUS     (1<<14)
+
+/* what the next property belongs to */
+#define FOR_NONE     0
+#define FOR_FILE     1
+#define FOR_ELEMENT  2
+
+
+/*-- Local Types --------------------------------------------------*/
+
+/* read position in the file or in a decompressed CBLOCK */
+typedef struct {
+   const uint8_t *p, *end;
+} cursor_t;
+
+/* name table entry */
+typedef struct {
+   uint64_t ref;
+   long str;            /* offset in string pool */
+} name_t;
+
+typedef struct {
+   name_t *e;
+   size_t n, m;
+   uint64_t next;       /* next implicit reference number */
+} names_t;
+
+/* reference number that is resolved after reading */
+typedef struct {
+   int kind;
+   size_t idx;          /* structure or element */
+   uint64_t ref;
+} fixup_t;
+
+/* a name or string value given as string or reference number */
+typedef struct {
+   long str;            /* offset in string pool or -1 */
+   uint64_t ref;        /* reference number when str < 0 */
+} strref_t;
+
+/* property record */
+typedef struct {
+   int owner;           /* FOR_FILE or FOR_ELEMENT */
+   size_t el0, el1;     /* range of elements */
+   strref_t name;
+   int hasnum, hasstr;
+   double num;          /* first numerical value */
+   strref_t str;        /* first string value */
+} oprop_t;
+
+/* repetition */
+typedef struct {
+   int regular;         /* regular array */
+   uint64_t nx, ny;     /* columns and rows of a regular array */
+   int64_t cx, cy;      /* column displacement */
+   int64_t rx, ry;      /* row displacement */
+   int64_t *xy;         /* offsets of other repetitions */
+   size_t n, m;
+} rep_t;
+
+typedef struct {
+   lib_tables *lt;
+   oas_libinfo *info;
+   int hdronly, stop;
+   names_t cellnames, textstrings, propnames, propstrings;
+   fixup_t *fix;
+   size_t nfix, mfix;
+   oprop_t *prop;
+   size_t nprop, mprop;
+   oprop_t lastprop;
+   int haslastprop;
+   int owner;           /* owner of the next property */
+   size_t el0, el1;     /* elements of the last element record */
+   int incell;          /* a cell was begun */
+   size_t cell;         /* current structure */
+   int64_t *pts;        /* point list scratch */
+   size_t mpts;
+   int64_t *pos;        /* expanded repetition */
+   size_t mpos;
+
+   /* modal variables */
+   unsigned int valid;
+   int xyrel;
+   uint64_t layer, dtype, tlayer, ttype;
+   int64_t gx, gy, px, py, tx, ty;
+   uint64_t width, height, hwidth;
+   int sscheme, escheme;      /* path extension schemes */
+   int64_t sextn, eextn;
+   uint64_t ctype, radius;
+   strref_t pcell, tstring;
+   rep_t rep;
+   int64_t *poly, *path;      /* point lists */
+   size_t npoly, mpoly, npath, mpath;
+} oas_reader;
+
+
+/*-- Local Functions ----------------------------------------------*/
+
+static void parse_records(oas_reader *rd, cursor_t *c, int top);
+static void parse_cblock(oas_reader *rd, cursor_t *c);
+static void parse_property(oas_reader *rd, cursor_t *c, int last);
+static void parse_placement(oas_reader *rd, cursor_t *c, int full);
+static void parse_text(oas_reader *rd, cursor_t *c);
+static void parse_rectangle(oas_reader *rd, cursor_t *c);
+static void parse_polygon(oas_reader *rd, cursor_t *c);
+static void parse_path(oas_reader *rd, cursor_t *c);
+static void parse_trapezoid(oas_reader *rd, cursor_t *c, int rid);
+static void parse_ctrapezoid(oas_reader *rd, cursor_t *c);
+static void parse_circle(oas_reader *rd, cursor_t *c);
+static void parse_xgeometry(oas_reader *rd, cursor_t *c);
+static void parse_repetition(oas_reader *rd, cursor_t *c);
+static size_t parse_point_list(oas_reader *rd, cursor_t *c, int polygon);
+static void begin_cell(oas_reader *rd, strref_t name);
+static void add_name(oas_reader *rd, names_t *nt, cursor_t *c, int explicit);
+static long find_name(names_t *nt, uint64_t ref);
+static void add_fixup(oas_reader *rd, int kind, size_t idx, uint64_t ref);
+static void resolve(oas_reader *rd);
+static void add_shape(oas_reader *rd, const int64_t *v, size_t m, int rep);
+static size_t new_element(oas_reader *rd, element_kind kind);
+static void add_xy(oas_reader *rd, size_t iel, const int64_t *v, size_t m,
+                   int64_t x0, int64_t y0, int close);
+static const int64_t* positions(oas_reader *rd, int rep, size_t *n);
+static void read_geometry_xy(oas_reader *rd, cursor_t *c, int info);
+static void* grow(void *p, size_t *mcur, size_t need, size_t esz);
+static void format_error(const char *msg);
+
+
+/*-- Primitives ---------------------------------------------------*/
+
+static void
+format_error(const char *msg)
+{
+   char errmsg[256];
+
+   sprintf(errmsg, "oasis_read_library :  %s", msg);
+   mexErrMsgTxt(errmsg);
+}
+
+static int
+get_byte(cursor_t *c)
+{
+   if (c->p >= c->end)
+      format_error("unexpected end of file.");
+   return *c->p++;
+}
+
+static uint64_t
+get_uint(cursor_t *c)
+{
+   uint64_t u = 0;
+   int b, s = 0;
+
+   do {
+      b = get_byte(c);
+      if (s < 64)
+	 u |= (uint64_t)(b & 0x7f) << s;
+      s += 7;
+   } while (b & 0x80);
+
+   return u;
+}
+
+static int64_t
+get_sint(cursor_t *c)
+{
+   uint64_t u;
+
+   u = get_uint(c);
+   return (u & 1) ? -(int64_t)(u >> 1) : (int64_t)(u >> 1);
+}
+
+/* real number of the given type */
+static double
+real_value(cursor_t *c, uint64_t type)
+{
+   uint64_t u, d;
+   uint32_t f;
+   float r4;
+   double r8;
+   int k;
+
+   switch (type) {
+      case 0:
+	 return (double)get_uint(c);
+      case 1:
+	 return -(double)get_uint(c);
+      case 2:
+	 return 1.0 / (double)get_uint(c);
+      case 3:
+	 return -1.0 / (double)get_uint(c);
+      case 4:
+      case 5:
+	 u = get_uint(c);
+	 d = get_uint(c);
+	 return (type == 4 ? 1.0 : -1.0) * (double)u / (double)d;
+      case 6:
+	 for (f=0, k=0; k<4; k++)    /* little endian */
+	    f |= (uint32_t)get_byte(c) << 8*k;
+	 memcpy(&r4, &f, sizeof(float));
+	 return r4;
+      case 7:
+	 for (u=0, k=0; k<8; k++)
+	    u |= (uint64_t)get_byte(c) << 8*k;
+	 memcpy(&r8, &u, sizeof(double));
+	 return r8;
+      default:
+	 format_error("invalid real number.");
+   }
+   return 0.0;
+}
+
+static double
+get_real(cursor_t *c)
+{
+   return real_value(c, get_uint(c));
+}
+
+/*
+ * displacement encoded as a g-delta
+ */
+static void
+get_gdelta(cursor_t *c, int64_t *dx, int64_t *dy)
+{
+   static const int ox[] = {1, 0, -1, 0, 1, -1, -1, 1};
+   static const int oy[] = {0, 1, 0, -1, 1, 1, -1, -1};
+   uint64_t u;
+   int64_t m;
+   int dir;
+
+   u = get_uint(c);
+   if (u & 1) {
+      *dx = (u & 2) ? -(int64_t)(u >> 2) : (int64_t)(u >> 2);
+      *dy = get_sint(c);
+   }
+   else {
+      dir = (u >> 1) & 7;
+      m = u >> 4;
+      *dx = ox[dir] * m;
+      *dy = oy[dir] * m;
+   }
+}
+
+/*
+ * reads a string into the string pool and returns its offset
+ */
+static long
+get_string(oas_reader *rd, cursor_t *c)
+{
+   lib_tables *lt = rd->lt;
+   uint64_t n;
+   long off;
+
+   n = get_uint(c);
+   if (n > (uint64_t)(c->end - c->p))
+      format_error("unexpected end of file.");
+   lt->str = grow(lt->str, &lt->mstr, lt->nstr+n+1, sizeof(char));
+   off = lt->nstr;
+   memcpy(lt->str + off, c->p, n);
+   lt->str[off + n] = '\0';
+   lt->nstr += n+1;
+   c->p += n;
+
+   return off;
+}
+
+static void
+skip_string(cursor_t *c)
+{
+   uint64_t n;
+
+   n = get_uint(c);
+   if (n > (uint64_t)(c->end - c->p))
+      format_error("unexpected end of file.");
+   c->p += n;
+}
+
+/* name given as string or, when isref is set, as reference number */
+static strref_t
+get_strref(oas_reader *rd, cursor_t *c, int isref)
+{
+   strref_t sr;
+
+   if (isref) {
+      sr.str = -1;
+      sr.ref = get_uint(c);
+   }
+   else {
+      sr.str = get_string(rd, c);
+      sr.ref = 0;
+   }
+   return sr;
+}
+
+
+/*-- Library ------------------------------------------------------*/
+
+void
+oas_read_library(gdsfile_t *gf, oas_libinfo *info, lib_tables *lt, int hdronly)
+{
+   oas_reader rd;
+   cursor_t c;
+   uint8_t *buf = NULL;
+   size_t nb, mb, k;
+   double unit;
+   long off;
+
+   /* file contents */
+   if (gf->map) {
+      c.p = gf->map;
+      c.end = gf->end;
+   }
+   else {
+      if ( gdsfile_seek(gf, 0) )
+	 format_error("failed to rewind file.");
+      mb = gf->size ? gf->size + 1 : 1048576;
+      buf = (uint8_t *)mxMalloc(mb);
+      nb = 0;
+      while ( (k = gdsfile_read(gf, buf+nb, mb-nb)) > 0 ) {
+	 nb += k;
+	 if (nb == mb) {
+	    mb *= 2;
+	    buf = (uint8_t *)mxRealloc(buf, mb);
+	 }
+      }
+      c.p = buf;
+      c.end = buf + nb;
+   }
+
+   memset(&rd, '\0', sizeof(oas_reader));
+   rd.lt = lt;
+   rd.info = info;
+   rd.hdronly = hdronly;
+   info->uunit = 1.0e-6;
+   info->dbunit = 1.0e-9;
+
+   /* magic string */
+   if (c.end - c.p < OAS_MAGIC_LEN || memcmp(c.p, OAS_MAGIC, OAS_MAGIC_LEN))
+      format_error("not an OASIS file.");
+   c.p += OAS_MAGIC_LEN;
+
+   /* START record */
+   if (get_uint(&c) != OAS_START)
+      format_error("missing START record.");
+   off = get_string(&rd, &c);
+   if ( strcmp(lt->str + off, "1.0") )
+      format_error("unsupported OASIS version.");
+   unit = get_real(&c);
+   if (unit <= 0.0)
+      format_error("invalid database unit.");
+   info->dbunit = 1.0e-6 / unit;
+   if ( !get_uint(&c) ) {        /* table offsets */
+      for (k=0; k<12; k++)
+	 get_uint(&c);
+   }
+   rd.owner = FOR_FILE;
+
+   parse_records(&rd, &c, 1);
+   if ( !rd.stop )
+      format_error("missing END record.");
+
+   resolve(&rd);
+   lt->dbu_to_uu = info->dbunit / info->uunit;
+
+   mxFree(buf);
+   mxFree(rd.cellnames.e);
+   mxFree(rd.textstrings.e);
+   mxFree(rd.propnames.e);
+   mxFree(rd.propstrings.e);
+   mxFree(rd.fix);
+   mxFree(rd.prop);
+   mxFree(rd.pts);
+   mxFree(rd.pos);
+   mxFree(rd.rep.xy);
+   mxFree(rd.poly);
+   mxFree(rd.path);
+}
+
+
+/*-- Records ------------------------------------------------------*/
+
+static void
+parse_records(oas_reader *rd, cursor_t *c, int top)
+{
+   uint64_t rid;
+   int k;
+
+   while (c->p < c->end) {
+
+      rid = get_uint(c);
+      switch (rid) {
+
+         case OAS_PAD:
+	    break;
+
+         case OAS_END:
+	    if ( !top )
+	       format_error("END record in CBLOCK.");
+	    rd->stop = 1;
+	    return;
+
+         case OAS_CELLNAME:
+         case OAS_CELLNAME_R:
+	    add_name(rd, &rd->cellnames, c, rid == OAS_CELLNAME_R);
+	    rd->owner = FOR_NONE;
+	    break;
+
+         case OAS_TEXTSTRING:
+         case OAS_TEXTSTRING_R:
+	    add_name(rd, &rd->textstrings, c, rid == OAS_TEXTSTRING_R);
+	    rd->owner = FOR_NONE;
+	    break;
+
+         case OAS_PROPNAME:
+         case OAS_PROPNAME_R:
+	    add_name(rd, &rd->propnames, c, rid == OAS_PROPNAME_R);
+	    rd->owner = FOR_NONE;
+	    break;
+
+         case OAS_PROPSTRING:
+         case OAS_PROPSTRING_R:
+	    add_name(rd, &rd->propstrings, c, rid == OAS_PROPSTRING_R);
+	    rd->owner = FOR_NONE;
+	    break;
+
+         case OAS_LAYERNAME:
+         case OAS_LAYERNAME_T:
+	    skip_string(c);
+	    for (k=0; k<2; k++) {    /* layer and type intervals */
+	       switch (get_uint(c)) {
+	          case 0:
+		     break;
+	          case 1:
+	          case 2:
+	          case 3:
+		     get_uint(c);
+		     break;
+	          case 4:
+		     get_uint(c);
+		     get_uint(c);
+		     break;
+	          default:
+		     format_error("invalid interval in LAYERNAME record.");
+	       }
+	    }
+	    rd->owner = FOR_NONE;
+	    break;
+
+         case OAS_CELL_R:
+         case OAS_CELL:
+	    if (rd->hdronly) {
+	       rd->stop = 1;
+	       return;
+	    }
+	    begin_cell(rd, get_strref(rd, c, rid == OAS_CELL_R));
+	    break;
+
+         case OAS_XYABSOLUTE:
+	    rd->xyrel = 0;
+	    break;
+
+         case OAS_XYRELATIVE:
+	    rd->xyrel = 1;
+	    break;
+
+         case OAS_PLACEMENT:
+         case OAS_PLACEMENT_MA:
+	    parse_placement(rd, c, rid == OAS_PLACEMENT_MA);
+	    break;
+
+         case OAS_TEXT:
+	    parse_text(rd, c);
+	    break;
+
+         case OAS_RECTANGLE:
+	    parse_rectangle(rd, c);
+	    break;
+
+         case OAS_POLYGON:
+	    parse_polygon(rd, c);
+	    break;
+
+         case OAS_PATH:
+	    parse_path(rd, c);
+	    break;
+
+         case OAS_TRAPEZOID:
+         case OAS_TRAPEZOID_A:
+         case OAS_TRAPEZOID_B:
+	    parse_trapezoid(rd, c, rid);
+	    break;
+
+         case OAS_CTRAPEZOID:
+	    parse_ctrapezoid(rd, c);
+	    break;
+
+         case OAS_CIRCLE:
+	    parse_circle(rd, c);
+	    break;
+
+         case OAS_PROPERTY:
+         case OAS_PROPERTY_LAST:
+	    parse_property(rd, c, rid == OAS_PROPERTY_LAST);
+	    break;
+
+         case OAS_XNAME:
+         case OAS_XNAME_R:
+	    get_uint(c);
+	    skip_string(c);
+	    if (rid == OAS_XNAME_R)
+	       get_uint(c);
+	    rd->owner = FOR_NONE;
+	    break;
+
+         case OAS_XELEMENT:
+	    get_uint(c);
+	    skip_string(c);
+	    rd->owner = FOR_NONE;
+	    break;
+
+         case OAS_XGEOMETRY:
+	    parse_xgeometry(rd, c);
+	    break;
+
+         case OAS_CBLOCK:
+	    if ( !top )
+	       format_error("nested CBLOCK record.");
+	    parse_cblock(rd, c);
+	    if (rd->stop)
+	       return;
+	    break;
+
+         case OAS_START:
+	    format_error("unexpected START record.");
+	    break;
+
+         default:
+	    format_error("unknown record type.");
+      }
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+parse_cblock(oas_reader *rd, cursor_t *c)
+{
+   cursor_t sub;
+   uint64_t nu, nc;
+   uint8_t *ubuf;
+#ifdef HAVE_ZLIB
+   z_stream zs;
+   int ret;
+#endif
+
+   if (get_uint(c) != OAS_DEFLATE)
+      format_error("unknown CBLOCK compression type.");
+   nu = get_uint(c);
+   nc = get_uint(c);
+   if (nc > (uint64_t)(c->end - c->p))
+      format_error("unexpected end of file.");
+
+#ifdef HAVE_ZLIB
+   ubuf = (uint8_t *)mxMalloc(nu ? nu : 1);
+   memset(&zs, '\0', sizeof(z_stream));
+   if (inflateInit2(&zs, -15) != Z_OK)
+      format_error("failed to initialize decompression.");
+   zs.next_in = (Bytef *)c->p;
+   zs.avail_in = nc;
+   zs.next_out = ubuf;
+   zs.avail_out = nu;
+   ret = inflate(&zs, Z_FINISH);
+   inflateEnd(&zs);
+   if (ret != Z_STREAM_END || zs.total_out != nu)
+      format_error("corrupt CBLOCK record.");
+   c->p += nc;
+
+   sub.p = ubuf;
+   sub.end = ubuf + nu;
+   parse_records(rd, &sub, 0);
+   mxFree(ubuf);
+#else
+   ubuf = NULL;
+   sub.p = sub.end = ubuf;
+   format_error("compressed CBLOCK records are not supported by this build.");
+#endif
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+begin_cell(oas_reader *rd, strref_t name)
+{
+   lib_tables *lt = rd->lt;
+   st_rec *ps;
+
+   lt->st = grow(lt->st, &lt->mst, lt->nst+1, sizeof(st_rec));
+   ps = &lt->st[lt->nst];
+   memset(ps, '\0', sizeof(st_rec));
+   now(ps->cdate);
+   now(ps->mdate);
+   ps->el = lt->nel;
+   if (name.str >= 0) {
+      strncpy(ps->sname, lt->str + name.str, sizeof(ps->sname)-1);
+      ps->sname[sizeof(ps->sname)-1] = '\0';
+   }
+   else
+      add_fixup(rd, FIX_CELL, lt->nst, name.ref);
+
+   rd->cell = lt->nst;
+   rd->incell = 1;
+   lt->nst += 1;
+
+   /* modal variables are reset at the beginning of a cell */
+   rd->valid = 0;
+   rd->xyrel = 0;
+   rd->gx = rd->gy = rd->px = rd->py = rd->tx = rd->ty = 0;
+   rd->haslastprop = 0;
+   rd->owner = FOR_NONE;
+}
+
+
+/*-- Properties ---------------------------------------------------*/
+
+static void
+parse_property(oas_reader *rd, cursor_t *c, int last)
+{
+   oprop_t pr;
+   uint64_t k, n, type;
+   double num;
+   strref_t sr;
+   int info;
+
+   if (last) {
+      if ( !rd->haslastprop )
+	 format_error("PROPERTY record without previous property.");
+      pr = rd->lastprop;
+   }
+   else {
+      info = get_byte(c);
+
+      /* name */
+      if (info & 0x04)
+	 pr.name = get_strref(rd, c, info & 0x02);
+      else {
+	 if ( !rd->haslastprop )
+	    format_error("PROPERTY record without property name.");
+	 pr.name = rd->lastprop.name;
+      }
+
+      /* values */
+      if (info & 0x08) {
+	 if ( !rd->haslastprop )
+	    format_error("PROPERTY record without previous value list.");
+	 pr.hasnum = rd->lastprop.hasnum;
+	 pr.num = rd->lastprop.num;
+	 pr.hasstr = rd->lastprop.hasstr;
+	 pr.str = rd->lastprop.str;
+      }
+      else {
+	 pr.hasnum = pr.hasstr = 0;
+	 n = info >> 4;
+	 if (n == 15)
+	    n = get_uint(c);
+	 for (k=0; k<n; k++) {
+	    type = get_uint(c);
+	    sr.str = -1;
+	    sr.ref = 0;
+	    num = 0.0;
+	    switch (type) {
+	       case 0: case 1: case 2: case 3:
+	       case 4: case 5: case 6: case 7:
+		  num = real_value(c, type);
+		  break;
+	       case 8:
+		  num = (double)get_uint(c);
+		  break;
+	       case 9:
+		  num = (double)get_sint(c);
+		  break;
+	       case 10: case 11: case 12:
+		  sr = get_strref(rd, c, 0);
+		  break;
+	       case 13: case 14: case 15:
+		  sr = get_strref(rd, c, 1);
+		  break;
+	       default:
+		  format_error("invalid property value.");
+	    }
+	    if (type <= 9 && !pr.hasnum) {
+	       pr.num = num;
+	       pr.hasnum = 1;
+	    }
+	    if (type >= 10 && !pr.hasstr) {
+	       pr.str = sr;
+	       pr.hasstr = 1;
+	    }
+	 }
+      }
+   }
+   rd->lastprop = pr;
+   rd->haslastprop = 1;
+
+   /* properties of names and cells are ignored */
+   if (rd->owner == FOR_NONE || (rd->hdronly && rd->owner != FOR_FILE))
+      return;
+   pr.owner = rd->owner;
+   pr.el0 = rd->el0;
+   pr.el1 = rd->el1;
+   rd->prop = grow(rd->prop, &rd->mprop, rd->nprop+1, sizeof(oprop_t));
+   rd->prop[rd->nprop++] = pr;
+}
+
+
+/*-- Elements -----------------------------------------------------*/
+
+/* layer and datatype of geometry records */
+static void
+read_layer_dtype(oas_reader *rd, cursor_t *c, int info)
+{
+   if (info & 0x01) {
+      rd->layer = get_uint(c);
+      rd->valid |= M_LAYER;
+   }
+   if (info & 0x02) {
+      rd->dtype = get_uint(c);
+      rd->valid |= M_DTYPE;
+   }
+   if ( (rd->valid & (M_LAYER | M_DTYPE)) != (M_LAYER | M_DTYPE) )
+      format_error("layer or datatype undefined.");
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* position of geometry records */
+static void
+read_geometry_xy(oas_reader *rd, cursor_t *c, int info)
+{
+   int64_t v;
+
+   if (info & 0x10) {
+      v = get_sint(c);
+      rd->gx = rd->xyrel ? rd->gx + v : v;
+   }
+   if (info & 0x08) {
+      v = get_sint(c);
+      rd->gy = rd->xyrel ? rd->gy + v : v;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+parse_placement(oas_reader *rd, cursor_t *c, int full)
+{
+   lib_tables *lt = rd->lt;
+   element_t *pi;
+   const int64_t *pos;
+   int64_t v, xy[6];
+   double mag, angle;
+   size_t iel, n;
+   int info, rep;
+
+   info = get_byte(c);
+   if (info & 0x80) {
+      rd->pcell = get_strref(rd, c, info & 0x40);
+      rd->valid |= M_CELL;
+   }
+   else if ( !(rd->valid & M_CELL) )
+      format_error("placement cell undefined.");
+
+   mag = 1.0;
+   angle = 0.0;
+   if (full) {
+      if (info & 0x04)
+	 mag = get_real(c);
+      if (info & 0x02)
+	 angle = get_real(c);
+   }
+   else
+      angle = 90.0 * ((info >> 1) & 3);
+
+   if (info & 0x20) {
+      v = get_sint(c);
+      rd->px = rd->xyrel ? rd->px + v : v;
+   }
+   if (info & 0x10) {
+      v = get_sint(c);
+      rd->py = rd->xyrel ? rd->py + v : v;
+   }
+   rep = info & 0x08;
+   if (rep)
+      parse_repetition(rd, c);
+
+   /* regular arrays are array references */
+   if (rep && rd->rep.regular && rd->rep.nx <= 65535 && rd->rep.ny <= 65535) {
+      iel = new_element(rd, GDS_AREF);
+      pi = &lt->el[iel].internal;
+      pi->ncol = rd->rep.nx;
+      pi->nrow = rd->rep.ny;
+      xy[0] = rd->px;
+      xy[1] = rd->py;
+      xy[2] = rd->px + (int64_t)rd->rep.nx * rd->rep.cx;
+      xy[3] = rd->py + (int64_t)rd->rep.nx * rd->rep.cy;
+      xy[4] = rd->px + (int64_t)rd->rep.ny * rd->rep.rx;
+      xy[5] = rd->py + (int64_t)rd->rep.ny * rd->rep.ry;
+      add_xy(rd, iel, xy, 3, 0, 0, 0);
+   }
+   else {
+      iel = new_element(rd, GDS_SREF);
+      pos = positions(rd, rep, &n);
+      add_xy(rd, iel, pos, n, rd->px, rd->py, 0);
+   }
+
+   /* transformation */
+   pi = &lt->el[iel].internal;
+   if ((info & 0x01) || mag != 1.0 || angle != 0.0) {
+      pi->has |= HAS_STRANS;
+      if (info & 0x01)
+	 pi->strans.flags = STRANS_REFLECT;
+      if (mag != 1.0) {
+	 pi->has |= HAS_MAG;
+	 pi->strans.mag = mag;
+      }
+      if (angle != 0.0) {
+	 pi->has |= HAS_ANGLE;
+	 pi->strans.angle = angle;
+      }
+   }
+
+   /* referenced structure */
+   if (rd->pcell.str >= 0) {
+      strncpy(pi->sname, lt->str + rd->pcell.str, sizeof(pi->sname)-1);
+      pi->sname[sizeof(pi->sname)-1] = '\0';
+   }
+   else
+      add_fixup(rd, FIX_SNAME, iel, rd->pcell.ref);
+
+   rd->el0 = iel;
+   rd->el1 = iel + 1;
+   rd->owner = FOR_ELEMENT;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+parse_text(oas_reader *rd, cursor_t *c)
+{
+   lib_tables *lt = rd->lt;
+   element_t *pi;
+   const int64_t *pos;
+   int64_t v;
+   size_t iel, n, k;
+   int info, rep;
+
+   info = get_byte(c);
+   if (info & 0x40) {
+      rd->tstring = get_strref(rd, c, info & 0x20);
+      rd->valid |= M_TEXT;
+   }
+   if (info & 0x01) {
+      rd->tlayer = get_uint(c);
+      rd->valid |= M_TLAYER;
+   }
+   if (info & 0x02) {
+      rd->ttype = get_uint(c);
+      rd->valid |= M_TTYPE;
+   }
+   if ( (rd->valid & (M_TEXT | M_TLAYER | M_TTYPE)) != (M_TEXT | M_TLAYER | M_TTYPE) )
+      format_error("text string, layer, or type undefined.");
+
+   if (info & 0x10) {
+      v = get_sint(c);
+      rd->tx = rd->xyrel ? rd->tx + v : v;
+   }
+   if (info & 0x08) {
+      v = get_sint(c);
+      rd->ty = rd->xyrel ? rd->ty + v : v;
+   }
+   rep = info & 0x04;
+   if (rep)
+      parse_repetition(rd, c);
+
+   /* one text element per position */
+   pos = positions(rd, rep, &n);
+   rd->el0 = lt->nel;
+   for (k=0; k<n; k++) {
+      iel = new_element(rd, GDS_TEXT);
+      pi = &lt->el[iel].internal;
+      pi->layer = rd->tlayer;
+      pi->dtype = rd->ttype;
+      add_xy(rd, iel, pos + 2*k, 1, rd->tx, rd->ty, 0);
+      if (rd->tstring.str >= 0)
+	 lt->el[iel].text = rd->tstring.str;
+      else
+	 add_fixup(rd, FIX_TEXT, iel, rd->tstring.ref);
+   }
+   rd->el1 = lt->nel;
+   rd->owner = FOR_ELEMENT;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+parse_rectangle(oas_reader *rd, cursor_t *c)
+{
+   int64_t v[8];
+   int info;
+
+   info = get_byte(c);
+   read_layer_dtype(rd, c, info);
+   if (info & 0x40) {
+      rd->width = get_uint(c);
+      rd->valid |= M_WIDTH;
+   }
+   if (info & 0x80) {              /* square */
+      rd->height = rd->width;
+      rd->valid |= (rd->valid & M_WIDTH) ? M_HEIGHT : 0;
+   }
+   else if (info & 0x20) {
+      rd->height = get_uint(c);
+      rd->valid |= M_HEIGHT;
+   }
+   if ( (rd->valid & (M_WIDTH | M_HEIGHT)) != (M_WIDTH | M_HEIGHT) )
+      format_error("rectangle size undefined.");
+   read_geometry_xy(rd, c, info);
+   if (info & 0x04)
+      parse_repetition(rd, c);
+
+   v[0] = 0;          v[1] = 0;
+   v[2] = rd->width;  v[3] = 0;
+   v[4] = rd->width;  v[5] = rd->height;
+   v[6] = 0;          v[7] = rd->height;
+   add_shape(rd, v, 4, info & 0x04);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+parse_polygon(oas_reader *rd, cursor_t *c)
+{
+   size_t m;
+   int info;
+
+   info = get_byte(c);
+   read_layer_dtype(rd, c, info);
+   if (info & 0x20) {
+      m = parse_point_list(rd, c, 1);
+      rd->poly = grow(rd->poly, &rd->mpoly, 2*m, sizeof(int64_t));
+      memcpy(rd->poly, rd->pts, 2*m*sizeof(int64_t));
+      rd->npoly = m;
+      rd->valid |= M_POLY;
+   }
+   else if ( !(rd->valid & M_POLY) )
+      format_error("polygon point list undefined.");
+   read_geometry_xy(rd, c, info);
+   if (info & 0x04)
+      parse_repetition(rd, c);
+
+   add_shape(rd, rd->poly, rd->npoly, info & 0x04);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* path extension value of an extension scheme */
+static int64_t
+extension(int scheme, int64_t value, uint64_t hwidth)
+{
+   switch (scheme) {
+      case 2:
+	 return hwidth;
+      case 3:
+	 return value;
+      default:
+	 return 0;
+   }
+}
+
+static void
+parse_path(oas_reader *rd, cursor_t *c)
+{
+   lib_tables *lt = rd->lt;
+   element_t *pi;
+   const int64_t *pos;
+   int64_t bgn, end;
+   size_t iel, m, n, k;
+   int info, scheme;
+
+   info = get_byte(c);
+   read_layer_dtype(rd, c, info);
+   if (info & 0x40) {
+      rd->hwidth = get_uint(c);
+      rd->valid |= M_HWIDTH;
+   }
+   else if ( !(rd->valid & M_HWIDTH) )
+      format_error("path half width undefined.");
+   if (info & 0x80) {
+      scheme = get_uint(c);
+      if (scheme >> 2 & 3) {
+	 rd->sscheme = scheme >> 2 & 3;
+	 if (rd->sscheme == 3)
+	    rd->sextn = get_sint(c);
+      }
+      if (scheme & 3) {
+	 rd->escheme = scheme & 3;
+	 if (rd->escheme == 3)
+	    rd->eextn = get_sint(c);
+      }
+   }
+   if (info & 0x20) {
+      m = parse_point_list(rd, c, 0);
+      rd->path = grow(rd->path, &rd->mpath, 2*m, sizeof(int64_t));
+      memcpy(rd->path, rd->pts, 2*m*sizeof(int64_t));
+      rd->npath = m;
+      rd->valid |= M_PATH;
+   }
+   else if ( !(rd->valid & M_PATH) )
+      format_error("path point list undefined.");
+   read_geometry_xy(rd, c, info);
+   if (info & 0x04)
+      parse_repetition(rd, c);
+
+   iel = new_element(rd, GDS_PATH);
+   pi = &lt->el[iel].internal;
+   pi->layer = rd->layer;
+   pi->dtype = rd->dtype;
+
+   /* widths remain in database units until the units are known */
+   pi->has |= HAS_PTYPE | HAS_WIDTH;
+   pi->width = 2.0 * rd->hwidth;
+   bgn = extension(rd->sscheme, rd->sextn, rd->hwidth);
+   end = extension(rd->escheme, rd->eextn, rd->hwidth);
+   if (bgn == 0 && end == 0)
+      pi->ptype = 0;
+   else if (bgn == (int64_t)rd->hwidth && end == (int64_t)rd->hwidth)
+      pi->ptype = 2;
+   else {
+      pi->ptype = 4;
+      pi->has |= HAS_BGNEXTN | HAS_ENDEXTN;
+      pi->bgnextn = bgn;
+      pi->endextn = end;
+   }
+
+   pos = positions(rd, info & 0x04, &n);
+   for (k=0; k<n; k++)
+      add_xy(rd, iel, rd->path, rd->npath, rd->gx + pos[2*k], rd->gy + pos[2*k+1], 0);
+
+   rd->el0 = iel;
+   rd->el1 = iel + 1;
+   rd->owner = FOR_ELEMENT;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+parse_trapezoid(oas_reader *rd, cursor_t *c, int rid)
+{
+   int64_t v[8], w, h, a, b;
+   int info;
+
+   info = get_byte(c);
+   read_layer_dtype(rd, c, info);
+   if (info & 0x40) {
+      rd->width = get_uint(c);
+      rd->valid |= M_WIDTH;
+   }
+   if (info & 0x20) {
+      rd->height = get_uint(c);
+      rd->valid |= M_HEIGHT;
+   }
+   if ( (rd->valid & (M_WIDTH | M_HEIGHT)) != (M_WIDTH | M_HEIGHT) )
+      format_error("trapezoid size undefined.");
+   a = rid == OAS_TRAPEZOID_B ? 0 : get_sint(c);
+   b = rid == OAS_TRAPEZOID_A ? 0 : get_sint(c);
+   read_geometry_xy(rd, c, info);
+   if (info & 0x04)
+      parse_repetition(rd, c);
+
+   w = rd->width;
+   h = rd->height;
+   if (info & 0x80) {              /* vertical */
+      v[0] = 0;  v[1] = a > 0 ? a : 0;
+      v[2] = 0;  v[3] = h + (b < 0 ? b : 0);
+      v[4] = w;  v[5] = h - (b > 0 ? b : 0);
+      v[6] = w;  v[7] = a < 0 ? -a : 0;
+   }
+   else {                          /* horizontal */
+      v[0] = a > 0 ? a : 0;           v[1] = h;
+      v[2] = w + (b < 0 ? b : 0);     v[3] = h;
+      v[4] = w - (b > 0 ? b : 0);     v[5] = 0;
+      v[6] = a < 0 ? -a : 0;          v[7] = 0;
+   }
+   add_shape(rd, v, 4, info & 0x04);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * vertices of the 26 constrained trapezoid types. Each coordinate
+ * is a linear combination of width and height: x = a*w + b*h and
+ * y = c*w + d*h with {a,b,c,d} in the table.
+ */
+static const signed char ctrap[26][4][4] = {
+   {{0,0,0,0}, {0,0,0,1}, {1,-1,0,1}, {1,0,0,0}},
+   {{0,0,0,0}, {0,0,0,1}, {1,0,0,1},  {1,-1,0,0}},
+   {{0,0,0,0}, {0,1,0,1}, {1,0,0,1},  {1,0,0,0}},
+   {{0,1,0,0}, {0,0,0,1}, {1,0,0,1},  {1,0,0,0}},
+   {{0,0,0,0}, {0,1,0,1}, {1,-1,0,1}, {1,0,0,0}},
+   {{0,1,0,0}, {0,0,0,1}, {1,0,0,1},  {1,-1,0,0}},
+   {{0,0,0,0}, {0,1,0,1}, {1,0,0,1},  {1,-1,0,0}},
+   {{0,1,0,0}, {0,0,0,1}, {1,-1,0,1}, {1,0,0,0}},
+   {{0,0,0,0}, {0,0,0,1}, {1,0,-1,1}, {1,0,0,0}},
+   {{0,0,0,0}, {0,0,-1,1},{1,0,0,1},  {1,0,0,0}},
+   {{0,0,0,0}, {0,0,0,1}, {1,0,0,1},  {1,0,1,0}},
+   {{0,0,1,0}, {0,0,0,1}, {1,0,0,1},  {1,0,0,0}},
+   {{0,0,0,0}, {0,0,0,1}, {1,0,-1,1}, {1,0,1,0}},
+   {{0,0,1,0}, {0,0,-1,1},{1,0,0,1},  {1,0,0,0}},
+   {{0,0,0,0}, {0,0,-1,1},{1,0,0,1},  {1,0,1,0}},
+   {{0,0,1,0}, {0,0,0,1}, {1,0,-1,1}, {1,0,0,0}},
+   {{0,0,0,0}, {0,0,1,0}, {1,0,0,0}},
+   {{0,0,0,0}, {0,0,1,0}, {1,0,1,0}},
+   {{0,0,0,0}, {1,0,1,0}, {1,0,0,0}},
+   {{0,0,1,0}, {1,0,1,0}, {1,0,0,0}},
+   {{0,0,0,0}, {0,1,0,1}, {0,2,0,0}},
+   {{0,0,0,1}, {0,2,0,1}, {0,1,0,0}},
+   {{0,0,0,0}, {0,0,2,0}, {1,0,1,0}},
+   {{1,0,0,0}, {0,0,1,0}, {1,0,2,0}},
+   {{0,0,0,0}, {0,0,0,1}, {1,0,0,1},  {1,0,0,0}},
+   {{0,0,0,0}, {0,0,1,0}, {1,0,1,0},  {1,0,0,0}}
+};
+
+static void
+parse_ctrapezoid(oas_reader *rd, cursor_t *c)
+{
+   int64_t v[8], w, h;
+   int k, m, info, type;
+
+   info = get_byte(c);
+   read_layer_dtype(rd, c, info);
+   if (info & 0x80) {
+      rd->ctype = get_uint(c);
+      rd->valid |= M_CTRAP;
+   }
+   else if ( !(rd->valid & M_CTRAP) )
+      format_error("ctrapezoid type undefined.");
+   if (info & 0x40) {
+      rd->width = get_uint(c);
+      rd->valid |= M_WIDTH;
+   }
+   if (info & 0x20) {
+      rd->height = get_uint(c);
+      rd->valid |= M_HEIGHT;
+   }
+   read_geometry_xy(rd, c, info);
+   if (info & 0x04)
+      parse_repetition(rd, c);
+
+   type = rd->ctype;
+   if (type > 25)
+      format_error("invalid ctrapezoid type.");
+   w = rd->width;
+   h = rd->height;
+   if (type == 20 || type == 21) {  /* width is twice the height */
+      if ( !(rd->valid & M_HEIGHT) )
+	 format_error("ctrapezoid size undefined.");
+      w = 2*h;
+   }
+   else {
+      if ( !(rd->valid & M_WIDTH) )
+	 format_error("ctrapezoid size undefined.");
+      if ((type >= 16 && type <= 19) || type == 25)
+	 h = w;
+      else if (type == 22 || type == 23)
+	 h = 2*w;
+      else if ( !(rd->valid & M_HEIGHT) )
+	 format_error("ctrapezoid size undefined.");
+   }
+
+   m = (type >= 16 && type <= 23) ? 3 : 4;
+   for (k=0; k<m; k++) {
+      v[2*k]   = ctrap[type][k][0] * w + ctrap[type][k][1] * h;
+      v[2*k+1] = ctrap[type][k][2] * w + ctrap[type][k][3] * h;
+   }
+   add_shape(rd, v, m, info & 0x04);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* circles are approximated by polygons */
+static void
+parse_circle(oas_reader *rd, cursor_t *c)
+{
+   int64_t v[2*CIRCLE_VERTICES];
+   double phi;
+   int k, info;
+
+   info = get_byte(c);
+   read_layer_dtype(rd, c, info);
+   if (info & 0x20) {
+      rd->radius = get_uint(c);
+      rd->valid |= M_RADIUS;
+   }
+   else if ( !(rd->valid & M_RADIUS) )
+      format_error("circle radius undefined.");
+   read_geometry_xy(rd, c, info);
+   if (info & 0x04)
+      parse_repetition(rd, c);
+
+   for (k=0; k<CIRCLE_VERTICES; k++) {
+      phi = 2.0 * M_PI * k / CIRCLE_VERTICES;
+      v[2*k]   = (int64_t)floor(0.5 + rd->radius * cos(phi));
+      v[2*k+1] = (int64_t)floor(0.5 + rd->radius * sin(phi));
+   }
+   add_shape(rd, v, CIRCLE_VERTICES, info & 0x04);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* user defined geometry is skipped; the modal variables are kept */
+static void
+parse_xgeometry(oas_reader *rd, cursor_t *c)
+{
+   int info;
+
+   info = get_byte(c);
+   get_uint(c);                    /* attribute */
+   read_layer_dtype(rd, c, info);
+   skip_string(c);
+   read_geometry_xy(rd, c, info);
+   if (info & 0x04)
+      parse_repetition(rd, c);
+   rd->owner = FOR_NONE;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * adds a boundary with the polygon v at the geometry position and,
+ * when rep is set, at all positions of the repetition.
+ */
+static void
+add_shape(oas_reader *rd, const int64_t *v, size_t m, int rep)
+{
+   lib_tables *lt = rd->lt;
+   element_t *pi;
+   const int64_t *pos;
+   size_t iel, n, k;
+
+   iel = new_element(rd, GDS_BOUNDARY);
+   pi = &lt->el[iel].internal;
+   pi->layer = rd->layer;
+   pi->dtype = rd->dtype;
+
+   pos = positions(rd, rep, &n);
+   for (k=0; k<n; k++)
+      add_xy(rd, iel, v, m, rd->gx + pos[2*k], rd->gy + pos[2*k+1], 1);
+
+   rd->el0 = iel;
+   rd->el1 = iel + 1;
+   rd->owner = FOR_ELEMENT;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static size_t
+new_element(oas_reader *rd, element_kind kind)
+{
+   lib_tables *lt = rd->lt;
+   el_rec *pe;
+
+   if ( !rd->incell )
+      format_error("element outside of a cell.");
+
+   lt->el = grow(lt->el, &lt->mel, lt->nel+1, sizeof(el_rec));
+   pe = &lt->el[lt->nel];
+   memset(pe, '\0', sizeof(el_rec));
+   pe->internal.kind = kind;
+   pe->xy = lt->nxy;
+   pe->prop = lt->nprop;
+   pe->text = -1;
+   lt->st[rd->cell].nel += 1;
+
+   return lt->nel++;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * appends an XY record with m vertices of v, displaced by (x0,y0),
+ * to element iel. When close is set, the first vertex is repeated
+ * at the end, as in GDS II boundaries.
+ */
+static void
+add_xy(oas_reader *rd, size_t iel, const int64_t *v, size_t m,
+       int64_t x0, int64_t y0, int close)
+{
+   lib_tables *lt = rd->lt;
+   xy_rec *pxy;
+   uint8_t *pb;
+   int64_t x, y;
+   size_t k, n;
+
+   if (close && m > 1 && v[0] == v[2*m-2] && v[1] == v[2*m-1])
+      close = 0;
+   n = m + (close ? 1 : 0);
+   if (n > 2147483647)
+      format_error("too many vertices.");
+
+   lt->vtx = grow(lt->vtx, &lt->mvtx, lt->nvtx + 2*n, sizeof(int32_t));
+   pb = (uint8_t *)(lt->vtx + lt->nvtx);
+   for (k=0; k<n; k++) {
+      x = v[2*(k % m)]   + x0;
+      y = v[2*(k % m)+1] + y0;
+      if (x < INT32_MIN || x > INT32_MAX || y < INT32_MIN || y > INT32_MAX)
+	 format_error("coordinate exceeds the range of GDS II.");
+      store_be32(pb + 8*k,     (int32_t)x);
+      store_be32(pb + 8*k + 4, (int32_t)y);
+   }
+
+   lt->xy = grow(lt->xy, &lt->mxy, lt->nxy+1, sizeof(xy_rec));
+   pxy = &lt->xy[lt->nxy++];
+   pxy->off = lt->nvtx;
+   pxy->m = n;
+   lt->nvtx += 2*n;
+   lt->el[iel].nxy += 1;
+}
+
+
+/*-- Repetitions and point lists ----------------------------------*/
+
+static void
+push_offset(rep_t *r, int64_t x, int64_t y)
+{
+   r->xy = grow(r->xy, &r->m, 2*r->n+2, sizeof(int64_t));
+   r->xy[2*r->n]   = x;
+   r->xy[2*r->n+1] = y;
+   r->n += 1;
+}
+
+static void
+parse_repetition(oas_reader *rd, cursor_t *c)
+{
+   rep_t *r = &rd->rep;
+   uint64_t type, n, k, g;
+   int64_t x, y, dx, dy;
+
+   type = get_uint(c);
+   if (type == 0) {                /* previous repetition */
+      if ( !(rd->valid & M_REP) )
+	 format_error("repetition undefined.");
+      return;
+   }
+
+   r->regular = 0;
+   r->n = 0;
+   r->cx = r->cy = r->rx = r->ry = 0;
+
+   switch (type) {
+
+      case 1:                      /* array */
+	 r->nx = get_uint(c) + 2;
+	 r->ny = get_uint(c) + 2;
+	 r->cx = get_uint(c);
+	 r->ry = get_uint(c);
+	 r->regular = 1;
+	 break;
+
+      case 2:                      /* row */
+	 r->nx = get_uint(c) + 2;
+	 r->ny = 1;
+	 r->cx = get_uint(c);
+	 r->regular = 1;
+	 break;
+
+      case 3:                      /* column */
+	 r->nx = 1;
+	 r->ny = get_uint(c) + 2;
+	 r->ry = get_uint(c);
+	 r->regular = 1;
+	 break;
+
+      case 4:                      /* row, arbitrary spacing */
+      case 5:
+      case 6:                      /* column, arbitrary spacing */
+      case 7:
+	 n = get_uint(c) + 2;
+	 if (n-1 > (uint64_t)(c->end - c->p))
+	    format_error("unexpected end of file.");
+	 g = (type == 5 || type == 7) ? get_uint(c) : 1;
+	 push_offset(r, 0, 0);
+	 for (x=0, k=1; k<n; k++) {
+	    x += get_uint(c) * g;
+	    if (type < 6)
+	       push_offset(r, x, 0);
+	    else
+	       push_offset(r, 0, x);
+	 }
+	 break;
+
+      case 8:                      /* lattice */
+	 r->nx = get_uint(c) + 2;
+	 r->ny = get_uint(c) + 2;
+	 get_gdelta(c, &r->cx, &r->cy);
+	 get_gdelta(c, &r->rx, &r->ry);
+	 r->regular = 1;
+	 break;
+
+      case 9:                      /* displacement vector */
+	 r->nx = get_uint(c) + 2;
+	 r->ny = 1;
+	 get_gdelta(c, &r->cx, &r->cy);
+	 r->regular = 1;
+	 break;
+
+      case 10:                     /* arbitrary positions */
+      case 11:
+	 n = get_uint(c) + 2;
+	 if (n-1 > (uint64_t)(c->end - c->p))
+	    format_error("unexpected end of file.");
+	 g = type == 11 ? get_uint(c) : 1;
+	 push_offset(r, 0, 0);
+	 for (x=y=0, k=1; k<n; k++) {
+	    get_gdelta(c, &dx, &dy);
+	    x += dx * (int64_t)g;
+	    y += dy * (int64_t)g;
+	    push_offset(r, x, y);
+	 }
+	 break;
+
+      default:
+	 format_error("invalid repetition type.");
+   }
+
+   rd->valid |= M_REP;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * returns the offsets of all positions of the current repetition,
+ * or a single zero offset when rep is not set.
+ */
+static const int64_t*
+positions(oas_reader *rd, int rep, size_t *n)
+{
+   rep_t *r = &rd->rep;
+   uint64_t i, j;
+   size_t k;
+
+   if ( !rep ) {
+      rd->pos = grow(rd->pos, &rd->mpos, 2, sizeof(int64_t));
+      rd->pos[0] = rd->pos[1] = 0;
+      *n = 1;
+      return rd->pos;
+   }
+
+   if ( !r->regular ) {
+      *n = r->n;
+      return r->xy;
+   }
+
+   if (r->nx > MAX_POSITIONS || r->ny > MAX_POSITIONS || r->nx * r->ny > MAX_POSITIONS)
+      format_error("repetition is too large.");
+   rd->pos = grow(rd->pos, &rd->mpos, 2*r->nx*r->ny, sizeof(int64_t));
+   for (k=0, j=0; j<r->ny; j++) {
+      for (i=0; i<r->nx; i++, k++) {
+	 rd->pos[2*k]   = (int64_t)i * r->cx + (int64_t)j * r->rx;
+	 rd->pos[2*k+1] = (int64_t)i * r->cy + (int64_t)j * r->ry;
+      }
+   }
+   *n = k;
+
+   return rd->pos;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * reads a point list into the point list scratch buffer. The first
+ * vertex is (0,0); the number of vertices is returned. The implied
+ * last vertex of Manhattan polygons (types 0 and 1) is added.
+ */
+static size_t
+parse_point_list(oas_reader *rd, cursor_t *c, int polygon)
+{
+   static const int ox[] = {1, 0, -1, 0, 1, -1, -1, 1};
+   static const int oy[] = {0, 1, 0, -1, 1, 1, -1, -1};
+   uint64_t type, n, k, u;
+   int64_t x, y, dx, dy, ddx, ddy, d;
+   size_t m;
+   int h;
+
+   type = get_uint(c);
+   n = get_uint(c);
+   if (n > (uint64_t)(c->end - c->p))
+      format_error("unexpected end of file.");
+   rd->pts = grow(rd->pts, &rd->mpts, 2*(n+2), sizeof(int64_t));
+   rd->pts[0] = rd->pts[1] = 0;
+   m = 1;
+   x = y = 0;
+   ddx = ddy = 0;
+
+   switch (type) {
+
+      case 0:                      /* alternating 1-deltas */
+      case 1:
+	 h = type == 0;
+	 for (k=0; k<n; k++) {
+	    d = get_sint(c);
+	    if (h)
+	       x += d;
+	    else
+	       y += d;
+	    rd->pts[2*m] = x;
+	    rd->pts[2*m+1] = y;
+	    m++;
+	    h = !h;
+	 }
+	 if (polygon) {
+	    rd->pts[2*m]   = h ? 0 : x;
+	    rd->pts[2*m+1] = h ? y : 0;
+	    m++;
+	 }
+	 return m;
+
+      case 2:                      /* 2-deltas */
+      case 3:                      /* 3-deltas */
+	 for (k=0; k<n; k++) {
+	    u = get_uint(c);
+	    if (type == 2) {
+	       d = u >> 2;
+	       x += ox[u & 3] * d;
+	       y += oy[u & 3] * d;
+	    }
+	    else {
+	       d = u >> 3;
+	       x += ox[u & 7] * d;
+	       y += oy[u & 7] * d;
+	    }
+	    rd->pts[2*m] = x;
+	    rd->pts[2*m+1] = y;
+	    m++;
+	 }
+	 return m;
+
+      case 4:                      /* g-deltas */
+      case 5:                      /* double g-deltas */
+	 for (k=0; k<n; k++) {
+	    get_gdelta(c, &dx, &dy);
+	    if (type == 5) {
+	       ddx += dx;
+	       ddy += dy;
+	       dx = ddx;
+	       dy = ddy;
+	    }
+	    x += dx;
+	    y += dy;
+	    rd->pts[2*m] = x;
+	    rd->pts[2*m+1] = y;
+	    m++;
+	 }
+	 return m;
+
+      default:
+	 format_error("invalid point list type.");
+   }
+
+   return 0;
+}
+
+
+/*-- Names --------------------------------------------------------*/
+
+static void
+add_name(oas_reader *rd, names_t *nt, cursor_t *c, int explicit)
+{
+   name_t *pn;
+
+   nt->e = grow(nt->e, &nt->m, nt->n+1, sizeof(name_t));
+   pn = &nt->e[nt->n++];
+   pn->str = get_string(rd, c);
+   pn->ref = explicit ? get_uint(c) : nt->next++;
+}
+
+
+static int
+compare_names(const void *a, const void *b)
+{
+   const name_t *pa = (const name_t *)a;
+   const name_t *pb = (const name_t *)b;
+
+   if (pa->ref != pb->ref)
+      return pa->ref < pb->ref ? -1 : 1;
+   return 0;
+}
+
+
+/* returns the string offset of a name, or -1 when it is undefined */
+static long
+find_name(names_t *nt, uint64_t ref)
+{
+   name_t key, *pn;
+
+   key.ref = ref;
+   pn = (name_t *)bsearch(&key, nt->e, nt->n, sizeof(name_t), compare_names);
+   return pn == NULL ? -1 : pn->str;
+}
+
+
+static void
+add_fixup(oas_reader *rd, int kind, size_t idx, uint64_t ref)
+{
+   fixup_t *pf;
+
+   rd->fix = grow(rd->fix, &rd->mfix, rd->nfix+1, sizeof(fixup_t));
+   pf = &rd->fix[rd->nfix++];
+   pf->kind = kind;
+   pf->idx = idx;
+   pf->ref = ref;
+}
+
+
+/* string of a name or value, NULL when it is undefined */
+static const char*
+strref_string(oas_reader *rd, names_t *nt, strref_t *sr)
+{
+   long off;
+
+   off = sr->str >= 0 ? sr->str : find_name(nt, sr->ref);
+   return off < 0 ? NULL : rd->lt->str + off;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * resolves reference numbers, evaluates the file properties, and
+ * converts S_GDS_PROPERTY properties into element properties.
+ */
+static void
+resolve(oas_reader *rd)
+{
+   lib_tables *lt = rd->lt;
+   oprop_t *pp;
+   el_rec *pe;
+   prop_rec *pr;
+   fixup_t *pf;
+   element_t *pi;
+   const char *name, *value;
+   double dbu_to_uu;
+   names_t *nt;
+   size_t i, j, k, e;
+   long off;
+
+   qsort(rd->cellnames.e, rd->cellnames.n, sizeof(name_t), compare_names);
+   qsort(rd->textstrings.e, rd->textstrings.n, sizeof(name_t), compare_names);
+   qsort(rd->propnames.e, rd->propnames.n, sizeof(name_t), compare_names);
+   qsort(rd->propstrings.e, rd->propstrings.n, sizeof(name_t), compare_names);
+
+   /* library name and user unit */
+   for (k=0; k<rd->nprop; k++) {
+      pp = &rd->prop[k];
+      if (pp->owner != FOR_FILE)
+	 continue;
+      name = strref_string(rd, &rd->propnames, &pp->name);
+      if (name == NULL)
+	 continue;
+      if (!strcmp(name, OAS_LIBNAME_PROP) && pp->hasstr) {
+	 value = strref_string(rd, &rd->propstrings, &pp->str);
+	 if (value != NULL) {
+	    strncpy(rd->info->lname, value, sizeof(rd->info->lname)-1);
+	    rd->info->lname[sizeof(rd->info->lname)-1] = '\0';
+	 }
+      }
+      if (!strcmp(name, OAS_UUNIT_PROP) && pp->hasnum && pp->num > 0.0)
+	 rd->info->uunit = pp->num;
+   }
+   if (rd->hdronly)
+      return;
+
+   /* names defined by reference numbers */
+   for (k=0; k<rd->nfix; k++) {
+      pf = &rd->fix[k];
+      nt = pf->kind == FIX_TEXT ? &rd->textstrings : &rd->cellnames;
+      off = find_name(nt, pf->ref);
+      if (off < 0)
+	 format_error(pf->kind == FIX_TEXT ? "undefined text string reference." :
+		                             "undefined cell name reference.");
+      switch (pf->kind) {
+         case FIX_CELL:
+	    strncpy(lt->st[pf->idx].sname, lt->str + off, sizeof(lt->st[0].sname)-1);
+	    break;
+         case FIX_SNAME:
+	    strncpy(lt->el[pf->idx].internal.sname, lt->str + off,
+		    sizeof(lt->el[0].internal.sname)-1);
+	    break;
+         case FIX_TEXT:
+	    lt->el[pf->idx].text = off;
+	    break;
+      }
+   }
+
+   /* GDS II properties of the elements of one element record */
+   for (i=0; i<rd->nprop; i=j) {
+      pp = &rd->prop[i];
+      for (j=i+1; j<rd->nprop && rd->prop[j].owner == pp->owner &&
+	     rd->prop[j].el0 == pp->el0 && rd->prop[j].el1 == pp->el1; j++)
+	 ;
+      if (pp->owner != FOR_ELEMENT)
+	 continue;
+
+      for (e=pp->el0; e<pp->el1; e++) {
+	 pe = &lt->el[e];
+	 pe->prop = lt->nprop;
+	 for (k=i; k<j; k++) {
+	    name = strref_string(rd, &rd->propnames, &rd->prop[k].name);
+	    if (name == NULL || strcmp(name, OAS_GDS_PROPERTY) ||
+		!rd->prop[k].hasnum || !rd->prop[k].hasstr)
+	       continue;
+	    value = strref_string(rd, &rd->propstrings, &rd->prop[k].str);
+	    if (value == NULL)
+	       continue;
+	    lt->prop = grow(lt->prop, &lt->mprop, lt->nprop+1, sizeof(prop_rec));
+	    pr = &lt->prop[lt->nprop++];
+	    pr->attr = (int16_t)rd->prop[k].num;
+	    pr->name = value - lt->str;
+	    pe->nslot += 1;
+	    pe->nval += 1;
+	 }
+      }
+   }
+
+   /* path widths and extensions in user units */
+   dbu_to_uu = rd->info->dbunit / rd->info->uunit;
+   for (e=0; e<lt->nel; e++) {
+      pi = &lt->el[e].internal;
+      if (pi->kind == GDS_PATH) {
+	 pi->width *= dbu_to_uu;
+	 pi->bgnextn *= dbu_to_uu;
+	 pi->endextn *= dbu_to_uu;
+      }
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void*
+grow(void *p, size_t *mcur, size_t need, size_t esz)
+{
+   size_t m;
+
+   if (need <= *mcur)
+      return p;
+
+   m = *mcur < 64 ? 64 : *mcur;
+   while (m < need)
+      m *= 2;
+   *mcur = m;
+
+   return mxRealloc(p, m*esz);
+}
+
+/*-----------------------------------------------------------------*/
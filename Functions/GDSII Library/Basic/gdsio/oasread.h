@@ -0,0 +1,44 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Reads OASIS files (SEMI P39) into the decoding tables of the
+ * GDS II library reader (gdsread.h). The tables are converted into
+ * the element data of the gds_element class with structures_to_mx.
+ * Shapes with a repetition become compound boundaries and paths,
+ * placements with a regular repetition become AREF elements, and
+ * placements with other repetitions become compound SREF elements.
+ * Properties named S_GDS_PROPERTY are converted into GDS II element
+ * properties; all other element properties are ignored.
+ */
+
+#ifndef _OASREAD_H
+#define _OASREAD_H
+
+#include "gdsio.h"
+#include "gdsread.h"
+
+
+/*-- Types --------------------------------------------------------*/
+
+/*
+ * library data of an OASIS file
+ */
+typedef struct {
+   char lname[256];     /* library name */
+   double uunit;        /* user unit in m */
+   double dbunit;       /* database unit in m */
+} oas_libinfo;
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * read an OASIS file from the beginning. The library name and
+ * units are returned in info. When hdronly is set, reading stops
+ * at the first cell; otherwise all cells and their elements are
+ * decoded into the tables lt, which must be initialized.
+ */
+void oas_read_library(gdsfile_t *gf, oas_libinfo *info, lib_tables *lt, int hdronly);
+
+#endif /* _OASREAD_H */
@@ -0,0 +1,1610 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Functions for writing OASIS files. The records of a cell are
+ * collected in a buffer and written as CBLOCK records compressed
+ * with DEFLATE when the library is compiled with HAVE_ZLIB. Values
+ * that are equal to the modal variables of the format, e.g. the
+ * layer of the previous element, are omitted. Rectangles, polygons,
+ * and structure references without properties that differ only in
+ * their position are collected while a cell is written and are
+ * stored as a single record with a repetition.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mex.h"
+
+#include "gdstypes.h"
+#include "gdsio.h"
+#include "mexfuncs.h"
+#include "oasis.h"
+#include "oaswrite.h"
+
+#ifdef HAVE_ZLIB
+   #include <zlib.h>
+#endif
+
+#define VLEN         128
+#define SLEN         256
+#define TXTLEN       512
+#define CBLOCK_SIZE  1048576     /* uncompressed bytes per CBLOCK */
+
+/* shapes that can be repeated */
+#define ITEM_RECT    1
+#define ITEM_POLY    2
+#define ITEM_PLACE   3
+
+/* modal variables that are defined */
+#define M_LAYER      1
+#define M_DTYPE      (1<<1)
+#define M_TLAYER     (1<<2)
+#define M_TTYPE      (1<<3)
+#define M_WIDTH      (1<<4)
+#define M_HEIGHT     (1<<5)
+#define M_HWIDTH     (1<<6)
+#define M_EXTN       (1<<7)
+#define M_CELL       (1<<8)
+#define M_TEXT       (1<<9)
+#define M_PROPNAME   (1<<10)
+#define M_REP        (1<<11)
+#define M_POLY       (1<<12)
+#define M_PATH       (1<<13)
+
+
+/*-- Local Types --------------------------------------------------*/
+
+/* growing byte buffer */
+typedef struct {
+   uint8_t *b;
+   size_t n, m;
+} bytes_t;
+
+/*
+ * a rectangle, polygon, or placement without properties that
+ * can be combined with identical shapes at other positions.
+ */
+typedef struct {
+   int kind;
+   uint16_t layer, dtype;
+   int32_t w, h;            /* size of rectangles */
+   size_t off;              /* first polygon vertex in vertex pool */
+   int m;                   /* number of polygon vertices */
+   const int32_t *v;        /* polygon vertices relative to the first */
+   const element_t *pe;     /* reference data of placements */
+   int32_t x, y;            /* position */
+} item_t;
+
+typedef struct {
+   int64_t x, y;
+} pos_t;
+
+typedef struct {
+   gdsfile_t *gf;
+   double uu_to_dbu;
+   bytes_t rec;             /* records of the current cell */
+   bytes_t tmp;             /* point list scratch */
+   bytes_t rep, lastrep;    /* repetition, modal repetition */
+   bytes_t lastpoly;        /* modal polygon point list */
+   bytes_t lastpath;        /* modal path point list */
+   int32_t *xy;             /* coordinate scratch buffer */
+   size_t mxy;
+   item_t *it;              /* repeatable shapes of the cell */
+   size_t nit, mit;
+   int32_t *pool;           /* polygon vertices of items */
+   size_t npool, mpool;
+   pos_t *pos;              /* positions of a group of items */
+   size_t mpos;
+   int nodes;               /* number of skipped NODE elements */
+   int oddpaths;            /* number of widened paths */
+   int abspaths;            /* paths with absolute width */
+   int roundpaths;          /* paths with round ends */
+   int texts;               /* texts with unstored attributes */
+   int absrefs;             /* references with absolute mag or angle */
+   int elflags;             /* elements with ELFLAGS or PLEX */
+   int arefs;               /* arrays with inexact corners */
+
+   /* modal variables */
+   unsigned int valid;
+   uint16_t layer, dtype, tlayer, ttype;
+   int64_t gx, gy, px, py, tx, ty;
+   int64_t width, height, hwidth;
+   int extn;
+   int64_t bgnextn, endextn;
+   char cell[34];
+   char text[TXTLEN];
+
+#ifdef HAVE_ZLIB
+   z_stream zs;
+   int zinit;
+   bytes_t zbuf;
+#endif
+} oas_writer;
+
+
+/*-- Local Functions ----------------------------------------------*/
+
+static void write_cell(oas_writer *w, mxArray *sdata);
+static void write_element(oas_writer *w, mxArray *data);
+static void write_boundary(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop);
+static void write_path(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop);
+static void write_sref(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop);
+static void write_aref(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop);
+static void write_text(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop);
+static void add_polygon(oas_writer *w, element_t *pe, int32_t *xy, int m, mxArray *prop);
+static void write_properties(oas_writer *w, mxArray *prop);
+static void write_items(oas_writer *w);
+static void rectangle_record(oas_writer *w, uint16_t layer, uint16_t dtype,
+                             int64_t x, int64_t y, int64_t wd, int64_t ht);
+static void polygon_record(oas_writer *w, uint16_t layer, uint16_t dtype,
+                           const int32_t *xy, int m, int64_t x, int64_t y);
+static void placement_record(oas_writer *w, const element_t *pe, int64_t x, int64_t y);
+static void put_repetition(oas_writer *w);
+static void item_repetition(oas_writer *w, const pos_t *p, size_t n);
+static void aref_repetition(oas_writer *w, int64_t *xy, int ncol, int nrow);
+static void put_point_list(bytes_t *pb, const int32_t *xy, int m, int polygon);
+static void flush_records(oas_writer *w, int compress);
+static void put_file(gdsfile_t *gf, const uint8_t *p, size_t nb);
+static int32_t* scale_xy(oas_writer *w, mxArray *pa, int *pm);
+static int64_t xy_dbu(oas_writer *w, const mxArray *pa, size_t k);
+static int compare_items(const void *a, const void *b);
+static int compare_shapes(const item_t *pa, const item_t *pb);
+static void placement_trans(const element_t *pe, int *flip, double *mag, double *angle);
+
+
+/*-- Byte buffers -------------------------------------------------*/
+
+static void
+reserve(bytes_t *pb, size_t nb)
+{
+   size_t m;
+
+   if (pb->n + nb <= pb->m)
+      return;
+   m = pb->m ? pb->m : 256;
+   while (m < pb->n + nb)
+      m *= 2;
+   pb->b = (uint8_t *)mxRealloc(pb->b, m);
+   pb->m = m;
+}
+
+static void
+put_byte(bytes_t *pb, int c)
+{
+   reserve(pb, 1);
+   pb->b[pb->n++] = (uint8_t)c;
+}
+
+static void
+put_raw(bytes_t *pb, const void *p, size_t nb)
+{
+   reserve(pb, nb);
+   memcpy(pb->b + pb->n, p, nb);
+   pb->n += nb;
+}
+
+static void
+put_uint(bytes_t *pb, uint64_t u)
+{
+   reserve(pb, 10);
+   while (u >= 0x80) {
+      pb->b[pb->n++] = (uint8_t)(u | 0x80);
+      u >>= 7;
+   }
+   pb->b[pb->n++] = (uint8_t)u;
+}
+
+static void
+put_sint(bytes_t *pb, int64_t s)
+{
+   if (s < 0)
+      put_uint(pb, ((uint64_t)(-s) << 1) | 1);
+   else
+      put_uint(pb, (uint64_t)s << 1);
+}
+
+static void
+put_string(bytes_t *pb, const char *str, size_t nb)
+{
+   put_uint(pb, nb);
+   put_raw(pb, str, nb);
+}
+
+/* integers are stored as such, all other numbers as IEEE doubles */
+static void
+put_real(bytes_t *pb, double r)
+{
+   uint64_t u;
+   int k;
+
+   if (r == floor(r) && fabs(r) < 1.0e18) {
+      put_uint(pb, r < 0 ? 1 : 0);
+      put_uint(pb, (uint64_t)fabs(r));
+   }
+   else {
+      put_uint(pb, 7);
+      memcpy(&u, &r, sizeof(double));
+      for (k=0; k<8; k++, u >>= 8)  /* little endian */
+	 put_byte(pb, (int)(u & 0xff));
+   }
+}
+
+static int
+same_bytes(const bytes_t *pa, const bytes_t *pb)
+{
+   return pa->n == pb->n && !memcmp(pa->b, pb->b, pa->n);
+}
+
+static void
+copy_bytes(bytes_t *dst, const bytes_t *src)
+{
+   dst->n = 0;
+   put_raw(dst, src->b, src->n);
+}
+
+
+/*-- Deltas -------------------------------------------------------*/
+
+/*
+ * direction of an octangular displacement (0 = east, 1 = north,
+ * ..., 4 = northeast, ... 7 = southeast) or -1
+ */
+static int
+direction(int64_t dx, int64_t dy)
+{
+   if (dy == 0)
+      return dx >= 0 ? 0 : 2;
+   if (dx == 0)
+      return dy > 0 ? 1 : 3;
+   if (dx == dy)
+      return dx > 0 ? 4 : 6;
+   if (dx == -dy)
+      return dx < 0 ? 5 : 7;
+   return -1;
+}
+
+static uint64_t
+magnitude(int64_t dx, int64_t dy)
+{
+   if (dx)
+      return dx < 0 ? -dx : dx;
+   return dy < 0 ? -dy : dy;
+}
+
+static void
+put_gdelta(bytes_t *pb, int64_t dx, int64_t dy)
+{
+   int dir;
+
+   dir = direction(dx, dy);
+   if (dir >= 0)
+      put_uint(pb, (magnitude(dx, dy) << 4) | (dir << 1));
+   else {
+      put_uint(pb, ((uint64_t)(dx < 0 ? -dx : dx) << 2) | (dx < 0 ? 2 : 0) | 1);
+      put_sint(pb, dy);
+   }
+}
+
+static uint64_t
+gcd(uint64_t a, uint64_t b)
+{
+   uint64_t t;
+
+   while (b) {
+      t = a % b;
+      a = b;
+      b = t;
+   }
+   return a;
+}
+
+
+/*-- Library ------------------------------------------------------*/
+
+void
+oas_write_begin(gdsfile_t *gf, double uunit, double dbunit, const char *lname)
+{
+   bytes_t hb;
+   double unit;
+   int k;
+
+   memset(&hb, '\0', sizeof(bytes_t));
+   put_raw(&hb, OAS_MAGIC, OAS_MAGIC_LEN);
+
+   /* START record with the number of database units per micron */
+   put_byte(&hb, OAS_START);
+   put_string(&hb, "1.0", 3);
+   unit = 1.0e-6 / dbunit;
+   if ( fabs(unit - floor(unit+0.5)) < 1e-9*unit )
+      unit = floor(unit+0.5);
+   put_real(&hb, unit);
+   put_uint(&hb, 0);             /* table offsets are in START */
+   for (k=0; k<12; k++)          /* there are no name tables */
+      put_uint(&hb, 0);
+
+   /* library name and user unit as file properties */
+   put_byte(&hb, OAS_PROPERTY);
+   put_byte(&hb, (1<<4) | 0x04);
+   put_string(&hb, OAS_LIBNAME_PROP, strlen(OAS_LIBNAME_PROP));
+   put_uint(&hb, 10);            /* a-string */
+   put_string(&hb, lname, strlen(lname));
+
+   put_byte(&hb, OAS_PROPERTY);
+   put_byte(&hb, (1<<4) | 0x04);
+   put_string(&hb, OAS_UUNIT_PROP, strlen(OAS_UUNIT_PROP));
+   put_real(&hb, uunit);
+
+   put_file(gf, hb.b, hb.n);
+   mxFree(hb.b);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+oas_write_end(gdsfile_t *gf)
+{
+   uint8_t end[OAS_END_LEN];
+
+   /* END record padded to 256 bytes, no validation */
+   memset(end, '\0', OAS_END_LEN);
+   end[0] = OAS_END;
+   end[1] = (OAS_END_LEN - 4) | 0x80;   /* padding b-string length */
+   end[2] = (OAS_END_LEN - 4) >> 7;
+   put_file(gf, end, OAS_END_LEN);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+oas_write_structures(gdsfile_t *gf, const mxArray *slist, double uu_to_dbu)
+{
+   oas_writer w;
+   int k, nst;
+
+   if ( mxIsEmpty(slist) )
+      return;
+   if ( !mxIsCell(slist) )
+      mexErrMsgTxt("oasis_write_library :  structure list must be a cell array.");
+
+   memset(&w, '\0', sizeof(oas_writer));
+   w.gf = gf;
+   w.uu_to_dbu = uu_to_dbu;
+
+#ifdef HAVE_ZLIB
+   w.zs.zalloc = Z_NULL;
+   w.zs.zfree = Z_NULL;
+   w.zs.opaque = Z_NULL;
+   if (deflateInit2(&w.zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8,
+		    Z_DEFAULT_STRATEGY) != Z_OK)
+      mexErrMsgTxt("oasis_write_library :  failed to initialize compression.");
+   w.zinit = 1;
+#endif
+
+   nst = mxGetNumberOfElements(slist);
+   for (k=0; k<nst; k++)
+      write_cell(&w, mxGetCell(slist, k));
+
+#ifdef HAVE_ZLIB
+   deflateEnd(&w.zs);
+   mxFree(w.zbuf.b);
+#endif
+   mxFree(w.rec.b);
+   mxFree(w.tmp.b);
+   mxFree(w.rep.b);
+   mxFree(w.lastrep.b);
+   mxFree(w.lastpoly.b);
+   mxFree(w.lastpath.b);
+   mxFree(w.xy);
+   mxFree(w.it);
+   mxFree(w.pool);
+   mxFree(w.pos);
+
+   if (w.nodes)
+      mexWarnMsgTxt("oasis_write_library :  NODE elements cannot be stored in OASIS files and were skipped.");
+   if (w.oddpaths)
+      mexWarnMsgTxt("oasis_write_library :  paths with an odd width in database units were widened by one unit.");
+   if (w.abspaths)
+      mexWarnMsgTxt("oasis_write_library :  paths with absolute (negative) width were stored with a relative width.");
+   if (w.roundpaths)
+      mexWarnMsgTxt("oasis_write_library :  round path ends were replaced by square ends extended by half the width.");
+   if (w.texts)
+      mexWarnMsgTxt("oasis_write_library :  presentation, path type, width, and strans of text elements were not stored.");
+   if (w.absrefs)
+      mexWarnMsgTxt("oasis_write_library :  absolute magnification and angle flags of references were not stored.");
+   if (w.elflags)
+      mexWarnMsgTxt("oasis_write_library :  ELFLAGS and PLEX records of elements were not stored.");
+   if (w.arefs)
+      mexWarnMsgTxt("oasis_write_library :  array references with a pitch that is not a whole number of database units were moved to the nearest grid.");
+}
+
+
+/*-- Cells --------------------------------------------------------*/
+
+static void
+write_cell(oas_writer *w, mxArray *sdata)
+{
+   mxArray *pa, *el;
+   char sname[SLEN];
+   int k, nel;
+
+   pa = mxGetField(sdata, 0, "sname");
+   if (pa == NULL)
+      mexErrMsgTxt("oasis_write_library :  missing structure name.");
+   mxGetString(pa, sname, SLEN);
+   if ( !strlen(sname) )
+      mexErrMsgTxt("oasis_write_library :  empty structure name.");
+
+   /* modal variables are reset at the beginning of a cell */
+   w->valid = 0;
+   w->gx = w->gy = w->px = w->py = w->tx = w->ty = 0;
+
+   /* CELL record and relative coordinates are not compressed */
+   put_byte(&w->rec, OAS_CELL);
+   put_string(&w->rec, sname, strlen(sname));
+   put_byte(&w->rec, OAS_XYRELATIVE);
+   flush_records(w, 0);
+
+   /* elements */
+   el = mxGetField(sdata, 0, "el");
+   if (el != NULL && mxIsCell(el)) {
+      nel = mxGetNumberOfElements(el);
+      for (k=0; k<nel; k++) {
+	 write_element(w, mxGetCell(el, k));
+	 if (w->rec.n >= CBLOCK_SIZE)
+	    flush_records(w, 1);
+      }
+   }
+
+   /* repeated shapes */
+   write_items(w);
+   flush_records(w, 1);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+write_element(oas_writer *w, mxArray *data)
+{
+   mxArray *internal, *prop;
+   element_t *pe;
+
+   if ( !get_field_ptr(data, "internal", &internal) )
+      mexErrMsgTxt("oasis_write_library :  missing internal data field.");
+   pe = (element_t *)mxGetData(internal);
+   if ( !get_field_ptr(data, "prop", &prop) )
+      prop = NULL;
+
+   /* records that have no equivalent in OASIS */
+   if ( pe->has & (HAS_ELFLAGS | HAS_PLEX) )
+      w->elflags++;
+   if ( (pe->kind == GDS_SREF || pe->kind == GDS_AREF) && (pe->has & HAS_STRANS) &&
+	(pe->strans.flags & (STRANS_ABSMAG | STRANS_ABSANG)) )
+      w->absrefs++;
+
+   switch (pe->kind) {
+
+      case GDS_BOUNDARY:
+      case GDS_BOX:
+	 write_boundary(w, data, pe, prop);
+	 break;
+
+      case GDS_PATH:
+	 write_path(w, data, pe, prop);
+	 break;
+
+      case GDS_SREF:
+	 write_sref(w, data, pe, prop);
+	 break;
+
+      case GDS_AREF:
+	 write_aref(w, data, pe, prop);
+	 break;
+
+      case GDS_TEXT:
+	 write_text(w, data, pe, prop);
+	 break;
+
+      case GDS_NODE:
+	 w->nodes++;
+	 break;
+
+      default:
+	 mexErrMsgTxt("oasis_write_library :  unknown element type.");
+   }
+}
+
+
+/*-- Boundary and box ---------------------------------------------*/
+
+static void
+write_boundary(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop)
+{
+   mxArray *pxy;
+   int32_t *xy;
+   int k, m, nxy;
+
+   if ( !get_field_ptr(data, "xy", &pxy) )
+      mexErrMsgTxt("oasis_write_library (boundary) :  missing or empty xy field.");
+
+   /* boxes have a single matrix of vertices */
+   if (pe->kind == GDS_BOX) {
+      xy = scale_xy(w, pxy, &m);
+      add_polygon(w, pe, xy, m, prop);
+      return;
+   }
+
+   nxy = mxGetNumberOfElements(pxy);
+   for (k=0; k<nxy; k++) {
+      xy = scale_xy(w, mxGetCell(pxy, k), &m);
+      add_polygon(w, pe, xy, m, prop);
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * write a polygon, or store it for combination with identical
+ * polygons when it has no properties.
+ */
+static void
+add_polygon(oas_writer *w, element_t *pe, int32_t *xy, int m, mxArray *prop)
+{
+   item_t *pi;
+   int32_t x0, y0, xmin, ymin, wd, ht;
+   int k, rect;
+
+   /* the closing vertex is implied */
+   if (m > 1 && xy[0] == xy[2*m-2] && xy[1] == xy[2*m-1])
+      m--;
+   if (m < 3)
+      return;
+
+   /* axis parallel rectangle ? */
+   rect = 0;
+   if (m == 4) {
+      if (xy[0] == xy[2] && xy[3] == xy[5] && xy[4] == xy[6] && xy[7] == xy[1])
+	 rect = 1;
+      if (xy[1] == xy[3] && xy[2] == xy[4] && xy[5] == xy[7] && xy[6] == xy[0])
+	 rect = 1;
+   }
+   xmin = ymin = wd = ht = 0;
+   if (rect) {
+      xmin = xy[0] < xy[4] ? xy[0] : xy[4];
+      ymin = xy[1] < xy[5] ? xy[1] : xy[5];
+      wd = abs(xy[4] - xy[0]);
+      ht = abs(xy[5] - xy[1]);
+      rect = wd > 0 && ht > 0;
+   }
+
+   if (prop != NULL) {
+      w->rep.n = 0;
+      if (rect)
+	 rectangle_record(w, pe->layer, pe->dtype, xmin, ymin, wd, ht);
+      else
+	 polygon_record(w, pe->layer, pe->dtype, xy, m, xy[0], xy[1]);
+      write_properties(w, prop);
+      return;
+   }
+
+   /* store the shape */
+   if (w->nit == w->mit) {
+      w->mit = w->mit ? 2*w->mit : 1024;
+      w->it = (item_t *)mxRealloc(w->it, w->mit*sizeof(item_t));
+   }
+   pi = &w->it[w->nit++];
+   memset(pi, '\0', sizeof(item_t));
+   pi->layer = pe->layer;
+   pi->dtype = pe->dtype;
+   if (rect) {
+      pi->kind = ITEM_RECT;
+      pi->w = wd;
+      pi->h = ht;
+      pi->x = xmin;
+      pi->y = ymin;
+   }
+   else {
+      pi->kind = ITEM_POLY;
+      pi->m = m;
+      pi->x = x0 = xy[0];
+      pi->y = y0 = xy[1];
+      if (w->npool + 2*m > w->mpool) {
+	 w->mpool = w->mpool ? 2*w->mpool : 65536;
+	 while (w->npool + 2*m > w->mpool)
+	    w->mpool *= 2;
+	 w->pool = (int32_t *)mxRealloc(w->pool, w->mpool*sizeof(int32_t));
+      }
+      pi->off = w->npool;
+      for (k=0; k<m; k++) {
+	 w->pool[w->npool++] = xy[2*k]   - x0;
+	 w->pool[w->npool++] = xy[2*k+1] - y0;
+      }
+   }
+}
+
+
+/*-- Path ---------------------------------------------------------*/
+
+static void
+write_path(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop)
+{
+   mxArray *pxy;
+   bytes_t *rec = &w->rec;
+   int32_t *xy;
+   int64_t wd, hw, bgn, end;
+   int k, m, nxy, scheme, info;
+
+   if ( !get_field_ptr(data, "xy", &pxy) )
+      mexErrMsgTxt("oasis_write_library (path) :  missing or empty xy field.");
+
+   /* half width */
+   wd = 0;
+   if (pe->has & HAS_WIDTH) {
+      wd = (int64_t)floor(fabs(pe->width) * w->uu_to_dbu + 0.5);
+      if (pe->width < 0)
+	 w->abspaths++;
+   }
+   if (wd % 2) {                       /* OASIS stores half widths */
+      wd += 1;
+      w->oddpaths += 1;
+   }
+   hw = wd / 2;
+
+   /* path extensions; round ends are approximated by square ends */
+   bgn = end = 0;
+   scheme = (1<<2) | 1;                /* flush */
+   if (pe->has & HAS_PTYPE) {
+      if (pe->ptype == 1 || pe->ptype == 2) {
+	 scheme = (2<<2) | 2;          /* half width */
+	 if (pe->ptype == 1)
+	    w->roundpaths++;
+      }
+      else if (pe->ptype == 4) {
+	 if (pe->has & HAS_BGNEXTN)
+	    bgn = (int64_t)floor(pe->bgnextn * w->uu_to_dbu + 0.5);
+	 if (pe->has & HAS_ENDEXTN)
+	    end = (int64_t)floor(pe->endextn * w->uu_to_dbu + 0.5);
+	 scheme = (3<<2) | 3;          /* explicit */
+      }
+   }
+
+   nxy = mxGetNumberOfElements(pxy);
+   for (k=0; k<nxy; k++) {
+
+      xy = scale_xy(w, mxGetCell(pxy, k), &m);
+      if (m < 2)
+	 continue;
+      w->tmp.n = 0;
+      put_point_list(&w->tmp, xy, m, 0);
+
+      info = 0;
+      if ( !(w->valid & M_EXTN) || w->extn != scheme ||
+	   w->bgnextn != bgn || w->endextn != end )
+	 info |= 0x80;
+      if ( !(w->valid & M_HWIDTH) || w->hwidth != hw )
+	 info |= 0x40;
+      if ( !(w->valid & M_PATH) || !same_bytes(&w->tmp, &w->lastpath) )
+	 info |= 0x20;
+      if (xy[0] != w->gx)
+	 info |= 0x10;
+      if (xy[1] != w->gy)
+	 info |= 0x08;
+      if ( !(w->valid & M_DTYPE) || w->dtype != pe->dtype )
+	 info |= 0x02;
+      if ( !(w->valid & M_LAYER) || w->layer != pe->layer )
+	 info |= 0x01;
+
+      put_byte(rec, OAS_PATH);
+      put_byte(rec, info);
+      if (info & 0x01)
+	 put_uint(rec, pe->layer);
+      if (info & 0x02)
+	 put_uint(rec, pe->dtype);
+      if (info & 0x40)
+	 put_uint(rec, hw);
+      if (info & 0x80) {
+	 put_uint(rec, scheme);
+	 if (scheme >> 2 == 3)
+	    put_sint(rec, bgn);
+	 if ((scheme & 3) == 3)
+	    put_sint(rec, end);
+      }
+      if (info & 0x20) {
+	 put_raw(rec, w->tmp.b, w->tmp.n);
+	 copy_bytes(&w->lastpath, &w->tmp);
+      }
+      if (info & 0x10)
+	 put_sint(rec, xy[0] - w->gx);
+      if (info & 0x08)
+	 put_sint(rec, xy[1] - w->gy);
+
+      w->layer = pe->layer;
+      w->dtype = pe->dtype;
+      w->hwidth = hw;
+      w->extn = scheme;
+      w->bgnextn = bgn;
+      w->endextn = end;
+      w->gx = xy[0];
+      w->gy = xy[1];
+      w->valid |= M_LAYER | M_DTYPE | M_HWIDTH | M_EXTN | M_PATH;
+
+      if (prop != NULL)
+	 write_properties(w, prop);
+   }
+}
+
+
+/*-- Sref ---------------------------------------------------------*/
+
+static void
+write_sref(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop)
+{
+   mxArray *pxy;
+   item_t *pi;
+   int k, mxy;
+
+   if ( !strlen(pe->sname) )
+      mexErrMsgTxt("oasis_write_library (sref) :  name of referenced structure missing.");
+   if ( !get_field_ptr(data, "xy", &pxy) )
+      mexErrMsgTxt("oasis_write_library (sref) :  missing or empty xy field.");
+   mxy = mxGetM(pxy);
+
+   for (k=0; k<mxy; k++) {
+
+      if (prop != NULL) {
+	 w->rep.n = 0;
+	 placement_record(w, pe, xy_dbu(w, pxy, k), xy_dbu(w, pxy, k+mxy));
+	 write_properties(w, prop);
+	 continue;
+      }
+
+      if (w->nit == w->mit) {
+	 w->mit = w->mit ? 2*w->mit : 1024;
+	 w->it = (item_t *)mxRealloc(w->it, w->mit*sizeof(item_t));
+      }
+      pi = &w->it[w->nit++];
+      memset(pi, '\0', sizeof(item_t));
+      pi->kind = ITEM_PLACE;
+      pi->pe = pe;
+      pi->x = (int32_t)xy_dbu(w, pxy, k);
+      pi->y = (int32_t)xy_dbu(w, pxy, k+mxy);
+   }
+}
+
+
+/*-- Aref ---------------------------------------------------------*/
+
+static void
+write_aref(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop)
+{
+   mxArray *pxy;
+   int64_t xy[6];
+   int k;
+
+   if ( !strlen(pe->sname) )
+      mexErrMsgTxt("oasis_write_library (aref) :  name of referenced structure missing.");
+   if ( !pe->nrow || !pe->ncol )
+      mexErrMsgTxt("oasis_write_library (aref) :  number of rows and columns must be > 0.");
+   if ( !get_field_ptr(data, "xy", &pxy) )
+      mexErrMsgTxt("oasis_write_library (aref) :  missing or empty xy field.");
+   if (mxGetM(pxy) != 3 || mxGetN(pxy) != 2)
+      mexErrMsgTxt("oasis_write_library (aref) :  xy must be 3x2 matrix.");
+
+   for (k=0; k<3; k++) {
+      xy[2*k]   = xy_dbu(w, pxy, k);
+      xy[2*k+1] = xy_dbu(w, pxy, k+3);
+   }
+
+   aref_repetition(w, xy, pe->ncol, pe->nrow);
+   placement_record(w, pe, xy[0], xy[1]);
+   if (prop != NULL)
+      write_properties(w, prop);
+}
+
+
+/*-- Text ---------------------------------------------------------*/
+
+static void
+write_text(oas_writer *w, mxArray *data, element_t *pe, mxArray *prop)
+{
+   mxArray *field;
+   bytes_t *rec = &w->rec;
+   int64_t x, y;
+   char txt[TXTLEN];
+   int info;
+
+   if ( !get_field_ptr(data, "xy", &field) )
+      mexErrMsgTxt("oasis_write_library (text) :  missing or empty xy field.");
+   x = xy_dbu(w, field, 0);
+   y = xy_dbu(w, field, mxGetM(field));
+
+   if ( !get_field_ptr(data, "text", &field) )
+      mexErrMsgTxt("oasis_write_library (text) :  missing text field.");
+   mxGetString(field, txt, TXTLEN);
+
+   /* OASIS texts have no presentation, width, or transformation */
+   if ( pe->has & (HAS_PRESTN | HAS_PTYPE | HAS_WIDTH | HAS_STRANS) )
+      w->texts++;
+
+   info = 0;
+   if ( !(w->valid & M_TEXT) || strcmp(w->text, txt) )
+      info |= 0x40;
+   if (x != w->tx)
+      info |= 0x10;
+   if (y != w->ty)
+      info |= 0x08;
+   if ( !(w->valid & M_TTYPE) || w->ttype != pe->dtype )
+      info |= 0x02;
+   if ( !(w->valid & M_TLAYER) || w->tlayer != pe->layer )
+      info |= 0x01;
+
+   put_byte(rec, OAS_TEXT);
+   put_byte(rec, info);
+   if (info & 0x40)
+      put_string(rec, txt, strlen(txt));
+   if (info & 0x01)
+      put_uint(rec, pe->layer);
+   if (info & 0x02)
+      put_uint(rec, pe->dtype);
+   if (info & 0x10)
+      put_sint(rec, x - w->tx);
+   if (info & 0x08)
+      put_sint(rec, y - w->ty);
+
+   strcpy(w->text, txt);
+   w->tlayer = pe->layer;
+   w->ttype = pe->dtype;
+   w->tx = x;
+   w->ty = y;
+   w->valid |= M_TEXT | M_TLAYER | M_TTYPE;
+
+   if (prop != NULL)
+      write_properties(w, prop);
+}
+
+
+/*-- Properties ---------------------------------------------------*/
+
+/*
+ * GDS II properties are stored as S_GDS_PROPERTY properties with
+ * the attribute number and the value string.
+ */
+static void
+write_properties(oas_writer *w, mxArray *prop)
+{
+   mxArray *pa;
+   bytes_t *rec = &w->rec;
+   double *pd;
+   int k, np, info;
+   int16_t attr;
+   char value[VLEN];
+
+   np = mxGetM(prop) * mxGetN(prop);
+
+   for (k=0; k<np; k++) {
+      pa = mxGetField(prop, k, "attr");
+      pd = (double *)mxGetData(pa);
+      attr = (int16_t)pd[0];
+      pa = mxGetField(prop, k, "name");
+      value[0] = '\0';
+      if (pa != NULL)
+	 mxGetString(pa, value, VLEN);
+
+      info = (2<<4) | 0x01;            /* two values, standard property */
+      if ( !(w->valid & M_PROPNAME) )
+	 info |= 0x04;
+      put_byte(rec, OAS_PROPERTY);
+      put_byte(rec, info);
+      if (info & 0x04)
+	 put_string(rec, OAS_GDS_PROPERTY, strlen(OAS_GDS_PROPERTY));
+      put_uint(rec, 8);                /* unsigned integer */
+      put_uint(rec, (uint16_t)attr);
+      put_uint(rec, 11);               /* b-string */
+      put_string(rec, value, strlen(value));
+      w->valid |= M_PROPNAME;
+   }
+}
+
+
+/*-- Repeated shapes ----------------------------------------------*/
+
+/*
+ * sorts the stored shapes and writes each group of identical
+ * shapes as one record with a repetition.
+ */
+static void
+write_items(oas_writer *w)
+{
+   item_t *pi;
+   size_t i, j, k;
+
+   if ( !w->nit )
+      return;
+
+   for (k=0; k<w->nit; k++) {
+      if (w->it[k].kind == ITEM_POLY)
+	 w->it[k].v = w->pool + w->it[k].off;
+   }
+   qsort(w->it, w->nit, sizeof(item_t), compare_items);
+
+   for (i=0; i<w->nit; i=j) {
+
+      for (j=i+1; j<w->nit && !compare_shapes(&w->it[i], &w->it[j]); j++)
+	 ;
+
+      if (j-i > w->mpos) {
+	 w->mpos = j-i;
+	 w->pos = (pos_t *)mxRealloc(w->pos, w->mpos*sizeof(pos_t));
+      }
+      for (k=i; k<j; k++) {
+	 w->pos[k-i].x = w->it[k].x;
+	 w->pos[k-i].y = w->it[k].y;
+      }
+      item_repetition(w, w->pos, j-i);
+
+      pi = &w->it[i];
+      switch (pi->kind) {
+
+         case ITEM_RECT:
+	    rectangle_record(w, pi->layer, pi->dtype, pi->x, pi->y, pi->w, pi->h);
+	    break;
+
+         case ITEM_POLY:
+	    polygon_record(w, pi->layer, pi->dtype, pi->v, pi->m, pi->x, pi->y);
+	    break;
+
+         case ITEM_PLACE:
+	    placement_record(w, pi->pe, pi->x, pi->y);
+	    break;
+      }
+
+      if (w->rec.n >= CBLOCK_SIZE)
+	 flush_records(w, 1);
+   }
+
+   w->nit = 0;
+   w->npool = 0;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* order of shapes, excluding the position */
+static int
+compare_shapes(const item_t *pa, const item_t *pb)
+{
+   int fa, fb, c;
+   double ma, mb, aa, ab;
+
+   if (pa->kind != pb->kind)
+      return pa->kind - pb->kind;
+
+   if (pa->kind == ITEM_PLACE) {
+      c = strcmp(pa->pe->sname, pb->pe->sname);
+      if (c)
+	 return c;
+      placement_trans(pa->pe, &fa, &ma, &aa);
+      placement_trans(pb->pe, &fb, &mb, &ab);
+      if (fa != fb)
+	 return fa - fb;
+      if (ma != mb)
+	 return ma < mb ? -1 : 1;
+      if (aa != ab)
+	 return aa < ab ? -1 : 1;
+      return 0;
+   }
+
+   if (pa->layer != pb->layer)
+      return pa->layer - pb->layer;
+   if (pa->dtype != pb->dtype)
+      return pa->dtype - pb->dtype;
+
+   if (pa->kind == ITEM_RECT) {
+      if (pa->w != pb->w)
+	 return pa->w < pb->w ? -1 : 1;
+      if (pa->h != pb->h)
+	 return pa->h < pb->h ? -1 : 1;
+      return 0;
+   }
+
+   if (pa->m != pb->m)
+      return pa->m - pb->m;
+   return memcmp(pa->v, pb->v, 2*pa->m*sizeof(int32_t));
+}
+
+
+/* order of shapes and positions (y first) */
+static int
+compare_items(const void *a, const void *b)
+{
+   const item_t *pa = (const item_t *)a;
+   const item_t *pb = (const item_t *)b;
+   int c;
+
+   c = compare_shapes(pa, pb);
+   if (c)
+      return c;
+   if (pa->y != pb->y)
+      return pa->y < pb->y ? -1 : 1;
+   if (pa->x != pb->x)
+      return pa->x < pb->x ? -1 : 1;
+   return 0;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * creates the repetition for n positions, which are sorted by
+ * y and then by x. Regular arrays are stored with their dimensions
+ * and spacing, other sets of positions as lists of displacements.
+ */
+static void
+item_repetition(oas_writer *w, const pos_t *p, size_t n)
+{
+   bytes_t *rep = &w->rep;
+   int64_t dx, dy;
+   uint64_t g;
+   size_t i, j, k, nx, ny;
+   int grid, samex;
+
+   rep->n = 0;
+   if (n < 2)
+      return;
+
+   /* regular array ? */
+   for (nx=1; nx<n && p[nx].y == p[0].y; nx++)
+      ;
+   if (n % nx == 0) {
+      ny = n / nx;
+      dx = nx > 1 ? p[1].x - p[0].x : 0;
+      dy = ny > 1 ? p[nx].y - p[0].y : 0;
+      grid = (nx == 1 || dx > 0) && (ny == 1 || dy > 0);
+      for (j=0; j<ny && grid; j++) {
+	 for (i=0; i<nx && grid; i++) {
+	    k = j*nx + i;
+	    grid = p[k].x == p[0].x + (int64_t)i*dx && p[k].y == p[0].y + (int64_t)j*dy;
+	 }
+      }
+      if (grid) {
+	 if (nx > 1 && ny > 1) {
+	    put_uint(rep, 1);
+	    put_uint(rep, nx-2);
+	    put_uint(rep, ny-2);
+	    put_uint(rep, dx);
+	    put_uint(rep, dy);
+	 }
+	 else if (nx > 1) {
+	    put_uint(rep, 2);
+	    put_uint(rep, nx-2);
+	    put_uint(rep, dx);
+	 }
+	 else {
+	    put_uint(rep, 3);
+	    put_uint(rep, ny-2);
+	    put_uint(rep, dy);
+	 }
+	 return;
+      }
+   }
+
+   /* positions in a row */
+   if (nx == n) {
+      for (g=0, k=1; k<n; k++)
+	 g = gcd(g, p[k].x - p[k-1].x);
+      put_uint(rep, g > 1 ? 5 : 4);
+      put_uint(rep, n-2);
+      if (g > 1)
+	 put_uint(rep, g);
+      else
+	 g = 1;
+      for (k=1; k<n; k++)
+	 put_uint(rep, (p[k].x - p[k-1].x) / g);
+      return;
+   }
+
+   /* positions in a column */
+   for (samex=1, k=1; k<n && samex; k++)
+      samex = p[k].x == p[0].x;
+   if (samex) {
+      for (g=0, k=1; k<n; k++)
+	 g = gcd(g, p[k].y - p[k-1].y);
+      put_uint(rep, g > 1 ? 7 : 6);
+      put_uint(rep, n-2);
+      if (g > 1)
+	 put_uint(rep, g);
+      else
+	 g = 1;
+      for (k=1; k<n; k++)
+	 put_uint(rep, (p[k].y - p[k-1].y) / g);
+      return;
+   }
+
+   /* arbitrary positions */
+   for (g=0, k=1; k<n; k++) {
+      g = gcd(g, magnitude(p[k].x - p[k-1].x, 0));
+      g = gcd(g, magnitude(p[k].y - p[k-1].y, 0));
+   }
+   put_uint(rep, g > 1 ? 11 : 10);
+   put_uint(rep, n-2);
+   if (g > 1)
+      put_uint(rep, g);
+   else
+      g = 1;
+   for (k=1; k<n; k++)
+      put_gdelta(rep, (p[k].x - p[k-1].x) / (int64_t)g,
+		      (p[k].y - p[k-1].y) / (int64_t)g);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * creates the repetition of an array reference from the three
+ * points in the XY record of an AREF element
+ */
+static void
+aref_repetition(oas_writer *w, int64_t *xy, int ncol, int nrow)
+{
+   bytes_t *rep = &w->rep;
+   int64_t cx, cy, rx, ry;
+
+   /* column and row displacements */
+   cx = (int64_t)floor(0.5 + (double)(xy[2] - xy[0]) / ncol);
+   cy = (int64_t)floor(0.5 + (double)(xy[3] - xy[1]) / ncol);
+   rx = (int64_t)floor(0.5 + (double)(xy[4] - xy[0]) / nrow);
+   ry = (int64_t)floor(0.5 + (double)(xy[5] - xy[1]) / nrow);
+
+   /* the corners are only kept when they are on the array grid */
+   if ( cx*ncol != xy[2] - xy[0] || cy*ncol != xy[3] - xy[1] ||
+	rx*nrow != xy[4] - xy[0] || ry*nrow != xy[5] - xy[1] )
+      w->arefs++;
+
+   rep->n = 0;
+   if (ncol == 1 && nrow == 1)
+      return;
+
+   if (nrow == 1) {
+      if (cy == 0 && cx > 0) {
+	 put_uint(rep, 2);
+	 put_uint(rep, ncol-2);
+	 put_uint(rep, cx);
+      }
+      else {
+	 put_uint(rep, 9);
+	 put_uint(rep, ncol-2);
+	 put_gdelta(rep, cx, cy);
+      }
+   }
+   else if (ncol == 1) {
+      if (rx == 0 && ry > 0) {
+	 put_uint(rep, 3);
+	 put_uint(rep, nrow-2);
+	 put_uint(rep, ry);
+      }
+      else {
+	 put_uint(rep, 9);
+	 put_uint(rep, nrow-2);
+	 put_gdelta(rep, rx, ry);
+      }
+   }
+   else {
+      if (cy == 0 && rx == 0 && cx > 0 && ry > 0) {
+	 put_uint(rep, 1);
+	 put_uint(rep, ncol-2);
+	 put_uint(rep, nrow-2);
+	 put_uint(rep, cx);
+	 put_uint(rep, ry);
+      }
+      else {
+	 put_uint(rep, 8);
+	 put_uint(rep, ncol-2);
+	 put_uint(rep, nrow-2);
+	 put_gdelta(rep, cx, cy);
+	 put_gdelta(rep, rx, ry);
+      }
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* writes the repetition in w->rep, or reuses the modal repetition */
+static void
+put_repetition(oas_writer *w)
+{
+   if ( (w->valid & M_REP) && same_bytes(&w->rep, &w->lastrep) )
+      put_uint(&w->rec, 0);
+   else {
+      put_raw(&w->rec, w->rep.b, w->rep.n);
+      copy_bytes(&w->lastrep, &w->rep);
+      w->valid |= M_REP;
+   }
+}
+
+
+/*-- Records ------------------------------------------------------*/
+
+static void
+rectangle_record(oas_writer *w, uint16_t layer, uint16_t dtype,
+                 int64_t x, int64_t y, int64_t wd, int64_t ht)
+{
+   bytes_t *rec = &w->rec;
+   int info;
+
+   info = 0;
+   if (wd == ht) {
+      info |= 0x80;                    /* square */
+      if ( !(w->valid & M_WIDTH) || w->width != wd )
+	 info |= 0x40;
+   }
+   else {
+      if ( !(w->valid & M_WIDTH) || w->width != wd )
+	 info |= 0x40;
+      if ( !(w->valid & M_HEIGHT) || w->height != ht )
+	 info |= 0x20;
+   }
+   if (x != w->gx)
+      info |= 0x10;
+   if (y != w->gy)
+      info |= 0x08;
+   if (w->rep.n)
+      info |= 0x04;
+   if ( !(w->valid & M_DTYPE) || w->dtype != dtype )
+      info |= 0x02;
+   if ( !(w->valid & M_LAYER) || w->layer != layer )
+      info |= 0x01;
+
+   put_byte(rec, OAS_RECTANGLE);
+   put_byte(rec, info);
+   if (info & 0x01)
+      put_uint(rec, layer);
+   if (info & 0x02)
+      put_uint(rec, dtype);
+   if (info & 0x40)
+      put_uint(rec, wd);
+   if (info & 0x20)
+      put_uint(rec, ht);
+   if (info & 0x10)
+      put_sint(rec, x - w->gx);
+   if (info & 0x08)
+      put_sint(rec, y - w->gy);
+   if (info & 0x04)
+      put_repetition(w);
+
+   w->layer = layer;
+   w->dtype = dtype;
+   w->width = wd;
+   w->height = ht;
+   w->gx = x;
+   w->gy = y;
+   w->valid |= M_LAYER | M_DTYPE | M_WIDTH | M_HEIGHT;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+polygon_record(oas_writer *w, uint16_t layer, uint16_t dtype,
+               const int32_t *xy, int m, int64_t x, int64_t y)
+{
+   bytes_t *rec = &w->rec;
+   int info;
+
+   w->tmp.n = 0;
+   put_point_list(&w->tmp, xy, m, 1);
+
+   info = 0;
+   if ( !(w->valid & M_POLY) || !same_bytes(&w->tmp, &w->lastpoly) )
+      info |= 0x20;
+   if (x != w->gx)
+      info |= 0x10;
+   if (y != w->gy)
+      info |= 0x08;
+   if (w->rep.n)
+      info |= 0x04;
+   if ( !(w->valid & M_DTYPE) || w->dtype != dtype )
+      info |= 0x02;
+   if ( !(w->valid & M_LAYER) || w->layer != layer )
+      info |= 0x01;
+
+   put_byte(rec, OAS_POLYGON);
+   put_byte(rec, info);
+   if (info & 0x01)
+      put_uint(rec, layer);
+   if (info & 0x02)
+      put_uint(rec, dtype);
+   if (info & 0x20) {
+      put_raw(rec, w->tmp.b, w->tmp.n);
+      copy_bytes(&w->lastpoly, &w->tmp);
+   }
+   if (info & 0x10)
+      put_sint(rec, x - w->gx);
+   if (info & 0x08)
+      put_sint(rec, y - w->gy);
+   if (info & 0x04)
+      put_repetition(w);
+
+   w->layer = layer;
+   w->dtype = dtype;
+   w->gx = x;
+   w->gy = y;
+   w->valid |= M_LAYER | M_DTYPE | M_POLY;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * writes a PLACEMENT record. Placements with magnification or
+ * with angles that are not multiples of 90 degrees are written
+ * with the second form of the record.
+ */
+static void
+placement_record(oas_writer *w, const element_t *pe, int64_t x, int64_t y)
+{
+   bytes_t *rec = &w->rec;
+   double mag, angle;
+   int flip, info, full;
+
+   placement_trans(pe, &flip, &mag, &angle);
+   full = mag != 1.0 || fmod(angle, 90.0) != 0.0;
+
+   info = 0;
+   if ( !(w->valid & M_CELL) || strcmp(w->cell, pe->sname) )
+      info |= 0x80;
+   if (x != w->px)
+      info |= 0x20;
+   if (y != w->py)
+      info |= 0x10;
+   if (w->rep.n)
+      info |= 0x08;
+   if (full) {
+      if (mag != 1.0)
+	 info |= 0x04;
+      if (angle != 0.0)
+	 info |= 0x02;
+   }
+   else
+      info |= ((int)(angle / 90.0) & 3) << 1;
+   if (flip)
+      info |= 0x01;
+
+   put_byte(rec, full ? OAS_PLACEMENT_MA : OAS_PLACEMENT);
+   put_byte(rec, info);
+   if (info & 0x80)
+      put_string(rec, pe->sname, strlen(pe->sname));
+   if (full) {
+      if (info & 0x04)
+	 put_real(rec, mag);
+      if (info & 0x02)
+	 put_real(rec, angle);
+   }
+   if (info & 0x20)
+      put_sint(rec, x - w->px);
+   if (info & 0x10)
+      put_sint(rec, y - w->py);
+   if (info & 0x08)
+      put_repetition(w);
+
+   strcpy(w->cell, pe->sname);
+   w->px = x;
+   w->py = y;
+   w->valid |= M_CELL;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/* strans data of a reference; the angle is in [0,360) degrees */
+static void
+placement_trans(const element_t *pe, int *flip, double *mag, double *angle)
+{
+   *flip = 0;
+   *mag = 1.0;
+   *angle = 0.0;
+   if ( !(pe->has & HAS_STRANS) )
+      return;
+
+   *flip = (pe->strans.flags & STRANS_REFLECT) != 0;
+   if (pe->has & HAS_MAG)
+      *mag = pe->strans.mag;
+   if (pe->has & HAS_ANGLE) {
+      *angle = fmod(pe->strans.angle, 360.0);
+      if (*angle < 0.0)
+	 *angle += 360.0;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * writes the point list of a polygon or path with m vertices
+ * in host byte order. The first vertex is the position of the
+ * element and is not part of the list. Manhattan polygons with
+ * alternating horizontal and vertical edges have the shortest
+ * encoding, in which the last vertex is implied.
+ */
+static void
+put_point_list(bytes_t *pb, const int32_t *xy, int m, int polygon)
+{
+   int64_t dx, dy;
+   int k, ne, n, man, oct, alt0, alt1, hor;
+
+   /* a polygon is closed by an edge to the first vertex */
+   ne = polygon ? m : m-1;
+
+   man = oct = 1;
+   alt0 = alt1 = polygon ? (m % 2 == 0 && m >= 4) : 1;
+   for (k=0; k<ne; k++) {
+      dx = (int64_t)xy[2*((k+1)%m)]   - xy[2*k];
+      dy = (int64_t)xy[2*((k+1)%m)+1] - xy[2*k+1];
+      hor = dy == 0 && dx != 0;
+      if (k % 2) {
+	 alt0 = alt0 && dx == 0 && dy != 0;
+	 alt1 = alt1 && hor;
+      }
+      else {
+	 alt0 = alt0 && hor;
+	 alt1 = alt1 && dx == 0 && dy != 0;
+      }
+      man = man && (dx == 0 || dy == 0);
+      oct = oct && direction(dx, dy) >= 0;
+   }
+
+   /* alternating horizontal and vertical deltas */
+   if (alt0 || alt1) {
+      n = polygon ? m-2 : m-1;
+      put_uint(pb, alt0 ? 0 : 1);
+      put_uint(pb, n);
+      for (k=0; k<n; k++) {
+	 if ( (k % 2 == 0) == (alt0 != 0) )
+	    put_sint(pb, (int64_t)xy[2*k+2] - xy[2*k]);
+	 else
+	    put_sint(pb, (int64_t)xy[2*k+3] - xy[2*k+1]);
+      }
+      return;
+   }
+
+   put_uint(pb, man ? 2 : oct ? 3 : 4);
+   put_uint(pb, m-1);
+   for (k=0; k<m-1; k++) {
+      dx = (int64_t)xy[2*k+2] - xy[2*k];
+      dy = (int64_t)xy[2*k+3] - xy[2*k+1];
+      if (man)
+	 put_uint(pb, (magnitude(dx, dy) << 2) | direction(dx, dy));
+      else if (oct)
+	 put_uint(pb, (magnitude(dx, dy) << 3) | direction(dx, dy));
+      else
+	 put_gdelta(pb, dx, dy);
+   }
+}
+
+
+/*-- Output -------------------------------------------------------*/
+
+/*
+ * writes the collected records to the file, as a CBLOCK record
+ * when compress is set and compression reduces the size.
+ */
+static void
+flush_records(oas_writer *w, int compress)
+{
+#ifdef HAVE_ZLIB
+   bytes_t hdr;
+   size_t nz;
+#endif
+
+   if ( !w->rec.n )
+      return;
+
+#ifdef HAVE_ZLIB
+   if (compress) {
+      w->zbuf.n = 0;
+      reserve(&w->zbuf, deflateBound(&w->zs, w->rec.n));
+      deflateReset(&w->zs);
+      w->zs.next_in = w->rec.b;
+      w->zs.avail_in = w->rec.n;
+      w->zs.next_out = w->zbuf.b;
+      w->zs.avail_out = w->zbuf.m;
+      if (deflate(&w->zs, Z_FINISH) != Z_STREAM_END)
+	 mexErrMsgTxt("oasis_write_library :  failed to compress CBLOCK.");
+      nz = w->zbuf.m - w->zs.avail_out;
+
+      if (nz + 16 < w->rec.n) {
+	 memset(&hdr, '\0', sizeof(bytes_t));
+	 put_byte(&hdr, OAS_CBLOCK);
+	 put_uint(&hdr, OAS_DEFLATE);
+	 put_uint(&hdr, w->rec.n);
+	 put_uint(&hdr, nz);
+	 put_file(w->gf, hdr.b, hdr.n);
+	 put_file(w->gf, w->zbuf.b, nz);
+	 mxFree(hdr.b);
+	 w->rec.n = 0;
+	 return;
+      }
+   }
+#endif
+
+   put_file(w->gf, w->rec.b, w->rec.n);
+   w->rec.n = 0;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+put_file(gdsfile_t *gf, const uint8_t *p, size_t nb)
+{
+   size_t n;
+
+   while (nb) {
+      n = nb > 1073741824 ? 1073741824 : nb;
+      if ( write_string(gf, (char *)p, (int)n) )
+	 mexErrMsgTxt("oasis_write_library :  failed to write to file.");
+      p += n;
+      nb -= n;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * scales an m x 2 matrix of vertices to database units and
+ * returns them as (x,y) pairs in the coordinate scratch buffer
+ */
+static int32_t*
+scale_xy(oas_writer *w, mxArray *pa, int *pm)
+{
+   const int32_t *pi;
+   double *pd;
+   int k, m;
+
+   m = mxGetM(pa);
+   if (2*(size_t)m > w->mxy) {
+      w->mxy = 2*(size_t)m;
+      w->xy = (int32_t *)mxRealloc(w->xy, w->mxy*sizeof(int32_t));
+   }
+   if ( mxIsInt32(pa) ) {   /* already in database units */
+      pi = (const int32_t *)mxGetData(pa);
+      for (k=0; k<m; k++) {
+	 w->xy[2*k]   = pi[k];
+	 w->xy[2*k+1] = pi[k+m];
+      }
+   }
+   else {
+      pd = (double *)mxGetData(pa);
+      for (k=0; k<m; k++) {
+	 w->xy[2*k]   = (int32_t)floor(0.5 + pd[k]   * w->uu_to_dbu);
+	 w->xy[2*k+1] = (int32_t)floor(0.5 + pd[k+m] * w->uu_to_dbu);
+      }
+   }
+   *pm = m;
+
+   return w->xy;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * returns coordinate k of an xy matrix in database units
+ */
+static int64_t
+xy_dbu(oas_writer *w, const mxArray *pa, size_t k)
+{
+   if ( mxIsInt32(pa) )
+      return ((const int32_t *)mxGetData(pa))[k];
+   else
+      return (int64_t)floor(0.5 + ((const double *)mxGetData(pa))[k] * w->uu_to_dbu);
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,37 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Writes libraries in the OASIS format (SEMI P39) from the
+ * mxArray data used by the gds_element and gds_structure classes.
+ * Records are collected in the output buffer of the gds file object.
+ */
+
+#ifndef _OASWRITE_H
+#define _OASWRITE_H
+
+#include "mex.h"
+#include "gdsio.h"
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * write the OASIS magic string, the START record, and file
+ * properties with the library name and the user unit.
+ */
+void oas_write_begin(gdsfile_t *gf, double uunit, double dbunit, const char *lname);
+
+/*
+ * write a list of structures. slist is a cell array of structures
+ * with fields sname (structure name) and el (cell array with
+ * element data structures), as for write_structure_data.
+ */
+void oas_write_structures(gdsfile_t *gf, const mxArray *slist, double uu_to_dbu);
+
+/*
+ * write the END record
+ */
+void oas_write_end(gdsfile_t *gf);
+
+#endif /* _OASWRITE_H */
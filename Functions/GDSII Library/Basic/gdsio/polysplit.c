@@ -0,0 +1,835 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Splits polygons with too many vertices for one XY record. A
+ * polygon is cut at a line u = c + 1/2, where u is the x or the y
+ * coordinate. Because vertices have integer coordinates, no vertex
+ * lies on the cut line. The points at which edges cross the line
+ * are rounded to the nearest database unit on the line u = c and
+ * are shared by the pieces on both sides. The crossings, sorted
+ * along the cut line, bound the intervals of the line inside the
+ * polygon; the pieces are assembled by following the polygon between
+ * crossings and the intervals along the cut line. Pieces that are
+ * still too large are cut again.
+ *
+ * A cut of a polygon that is not convex can leave many small pieces,
+ * e.g. the tips of spikes beyond the cut line. When all cuts are 
+ * done, pieces that share an edge on a cut line are merged again as
+ * long as the merged piece is small enough, smallest pieces first.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "polysplit.h"
+
+#define MAXDEPTH   64   /* maximum recursion depth */
+#define CROSS_COST 4    /* cost of a crossing relative to a vertex */
+#define NFRAC      5    /* cut lines per axis and method */
+#define SLIVER     64   /* pieces narrower than 1/SLIVER of the ring */
+#define MAXPASS    16   /* maximum number of merge passes */
+
+
+/*-- Local Types --------------------------------------------------*/
+
+/*
+ * an edge crossing the cut line
+ */
+typedef struct {
+   size_t node;         /* index of the crossing point in the ring */
+   double v;            /* position on the cut line */
+   int dir;             /* +1: crosses towards u > c, -1: reverse */
+} cross_t;
+
+/*
+ * an axis parallel edge of a piece
+ */
+typedef struct {
+   int32_t x0, y0;      /* start point */
+   int32_t x1, y1;      /* end point */
+   int piece;           /* piece */
+   int idx;             /* index of the start point in the piece */
+} edge_t;
+
+/*
+ * a piece and its number of vertices
+ */
+typedef struct {
+   int n;
+   int piece;
+} psize_t;
+
+
+/*-- Local Functions ----------------------------------------------*/
+
+static int split_ring(int32_t *xy, int n, int mmax, poly_pieces *pp, int depth);
+static int best_cut(int32_t *xy, int n, poly_pieces *pc);
+static int cut_ring(int32_t *xy, int n, int axis, int32_t c, poly_pieces *pc);
+static int count_crossings(const int32_t *xy, int n, int axis, int32_t c);
+static int count_slivers(const poly_pieces *pc, int axis, int32_t lo, int32_t hi);
+static int merge_pieces(poly_pieces *pp, int np0, int mmax);
+static int merge_pass(int32_t **ring, int *len, int np, int mmax, 
+                      edge_t *et, psize_t *ps, char *mod);
+static int add_piece(poly_pieces *pp, const int32_t *xy, int n);
+static int simplify_ring(int32_t *xy, int n);
+static int collinear(const int32_t *a, const int32_t *b, const int32_t *c);
+static double ring_area(const int32_t *xy, int n);
+static void reverse_ring(int32_t *xy, int n);
+static int cmp_cross(const void *a, const void *b);
+static int cmp_int32(const void *a, const void *b);
+static int cmp_edge(const void *a, const void *b);
+static int cmp_psize(const void *a, const void *b);
+
+
+/*-----------------------------------------------------------------*/
+
+void
+init_pieces(poly_pieces *pp)
+{
+   memset(pp, '\0', sizeof(poly_pieces));
+}
+
+
+/*-----------------------------------------------------------------*/
+
+void
+free_pieces(poly_pieces *pp)
+{
+   free(pp->xy);
+   free(pp->len);
+   init_pieces(pp);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+int
+split_polygon(const int32_t *xy, int m, int mmax, poly_pieces *pp)
+{
+   int32_t *ring;
+   int n, ret, np0;
+
+   if (m < 4 || mmax < 5)
+      return -1;
+   np0 = pp->np;
+
+   /* work on an open ring without the closing vertex */
+   ring = (int32_t *)malloc(2*m*sizeof(int32_t));
+   if (ring == NULL)
+      return -1;
+   memcpy(ring, xy, 2*m*sizeof(int32_t));
+   n = simplify_ring(ring, m);
+
+   ret = split_ring(ring, n, mmax, pp, 0);
+   free(ring);
+
+   if (!ret && pp->np - np0 > 1)
+      ret = merge_pieces(pp, np0, mmax);
+
+   return ret;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * split an open ring of n vertices. The ring is modified.
+ */
+static int
+split_ring(int32_t *xy, int n, int mmax, poly_pieces *pp, int depth)
+{
+   poly_pieces pc;
+   size_t off;
+   int k, ret;
+
+   n = simplify_ring(xy, n);
+   if (n+1 <= mmax)
+      return add_piece(pp, xy, n);
+   if (depth >= MAXDEPTH)
+      return -1;
+
+   init_pieces(&pc);
+   ret = best_cut(xy, n, &pc);
+   for (off=0, k=0; k<pc.np && !ret; k++) {
+      ret = split_ring(pc.xy + off, pc.len[k]-1, mmax, pp, depth+1);
+      off += 2*pc.len[k];
+   }
+   free_pieces(&pc);
+
+   return ret;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * cut a ring at the best of several lines. Lines through quantiles
+ * of the vertex coordinates and through fractions of the bounding
+ * box are tried on both axes. Every crossing adds a vertex on both
+ * sides of the line, so the cut that minimizes the size of the
+ * largest piece plus a multiple of the number of crossings is used;
+ * a cut must make the largest piece smaller than the ring. Cuts 
+ * that leave slivers, pieces that are very narrow across the cut 
+ * line, are penalized by the number of ring vertices per sliver;
+ * they are normally used only when all cuts leave slivers, but a
+ * cut with many crossings can cost more. The pieces of the best
+ * cut are returned in pc.
+ */
+static int
+best_cut(int32_t *xy, int n, poly_pieces *pc)
+{
+   static const int frac[NFRAC] = {4, 3, 5, 2, 6};  /* in units of 1/8 */
+   poly_pieces tp, t;
+   int32_t *tmp;
+   int32_t lo, hi, c;
+   double cost, cbest = -1.0;
+   int a, b, q, k, m;
+
+   tmp = (int32_t *)malloc(n*sizeof(int32_t));
+   if (tmp == NULL)
+      return -1;
+   init_pieces(&tp);
+
+   for (a=0; a<2; a++) {
+      for (k=0; k<n; k++)
+	 tmp[k] = xy[2*k+a];
+      qsort(tmp, n, sizeof(int32_t), cmp_int32);
+      lo = tmp[0];
+      hi = tmp[n-1];
+      if ((double)hi - lo < 2)
+	 continue;
+      for (b=0; b<2; b++) {
+	 for (q=0; q<NFRAC; q++) {
+	    if (b == 0)
+	       c = tmp[(size_t)n*frac[q]/8];
+	    else
+	       c = (int32_t)floor(lo + ((double)hi - lo)*frac[q]/8);
+	    if (c < lo+1)      /* never cut at the bounding box */
+	       c = lo+1;
+	    if (c > hi-1)
+	       c = hi-1;
+
+	    tp.nxy = tp.np = 0;
+	    if ( cut_ring(xy, n, a, c, &tp) )
+	       continue;
+	    for (m=0, k=0; k<tp.np; k++) {
+	       if (tp.len[k]-1 > m)
+		  m = tp.len[k]-1;
+	    }
+	    if (m >= n)
+	       continue;   /* no progress */
+	    cost = m + CROSS_COST*(double)count_crossings(xy, n, a, c) +
+	           (double)n*count_slivers(&tp, a, lo, hi);
+	    if (cbest < 0 || cost < cbest) {
+	       cbest = cost;
+	       t = *pc; *pc = tp; tp = t;
+	    }
+	 }
+      }
+   }
+   free(tmp);
+   free_pieces(&tp);
+
+   return cbest < 0 ? -1 : 0;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static int
+count_crossings(const int32_t *xy, int n, int axis, int32_t c)
+{
+   int k, j, nc;
+
+   for (nc=0, k=0; k<n; k++) {
+      j = (k+1) % n;
+      if ((xy[2*k+axis] <= c) != (xy[2*j+axis] <= c))
+	 nc++;
+   }
+
+   return nc;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * count the pieces in pc that extend less than 1/SLIVER of the 
+ * extent lo .. hi of the cut ring along the axis, but at least 2
+ * database units.
+ */
+static int
+count_slivers(const poly_pieces *pc, int axis, int32_t lo, int32_t hi)
+{
+   const int32_t *xy;
+   int32_t pmin, pmax;
+   double minw;
+   int k, j, ns;
+
+   minw = ((double)hi - lo) / SLIVER;
+   if (minw < 2)
+      minw = 2;
+
+   for (xy=pc->xy, ns=0, k=0; k<pc->np; xy+=2*pc->len[k], k++) {
+      pmin = pmax = xy[axis];
+      for (j=1; j<pc->len[k]; j++) {
+	 if (xy[2*j+axis] < pmin)
+	    pmin = xy[2*j+axis];
+	 if (xy[2*j+axis] > pmax)
+	    pmax = xy[2*j+axis];
+      }
+      if ((double)pmax - pmin < minw)
+	 ns++;
+   }
+
+   return ns;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * cut an open ring at the line u = c + 1/2 and append the pieces
+ * on both sides of the line to pc. u is the coordinate with index
+ * axis, v the other coordinate.
+ */
+static int
+cut_ring(int32_t *xy, int n, int axis, int32_t c, poly_pieces *pc)
+{
+   int32_t *nd = NULL;  /* ring with crossing points */
+   int *ncx = NULL;     /* crossing index of ring nodes or -1 */
+   cross_t *cr = NULL;  /* crossings */
+   char *used = NULL;
+   int32_t *pr = NULL;  /* piece */
+   int32_t u0, v0, u1, v1;
+   double area, v;
+   int nc, nn, np;
+   int k, j, e, s, i, steps;
+   int ret = -1;
+
+   /* make the ring counterclockwise in (u,v) coordinates */
+   area = ring_area(xy, n);
+   if (area == 0)
+      return 0;      /* nothing left */
+   if ((area < 0) == (axis == 0))
+      reverse_ring(xy, n);
+
+   nc = count_crossings(xy, n, axis, c);
+   if (nc < 2 || nc % 2)
+      return -1;
+
+   nd   = (int32_t *)malloc(2*(n+nc)*sizeof(int32_t));
+   ncx  = (int *)malloc((n+nc)*sizeof(int));
+   cr   = (cross_t *)malloc(nc*sizeof(cross_t));
+   used = (char *)calloc(nc, sizeof(char));
+   pr   = (int32_t *)malloc(2*(n+nc)*sizeof(int32_t));
+   if (nd == NULL || ncx == NULL || cr == NULL || used == NULL || pr == NULL)
+      goto done;
+
+   /* insert the crossing points */
+   for (nn=0, nc=0, k=0; k<n; k++) {
+      nd[2*nn] = xy[2*k];
+      nd[2*nn+1] = xy[2*k+1];
+      ncx[nn++] = -1;
+      j = (k+1) % n;
+      u0 = xy[2*k+axis];
+      v0 = xy[2*k+1-axis];
+      u1 = xy[2*j+axis];
+      v1 = xy[2*j+1-axis];
+      if ((u0 <= c) != (u1 <= c)) {
+	 cr[nc].node = nn;
+	 cr[nc].v = v0 + (c + 0.5 - u0) * ((double)v1 - v0) / ((double)u1 - u0);
+	 cr[nc].dir = (u0 <= c) ? 1 : -1;
+	 v = v0 + ((double)c - u0) * ((double)v1 - v0) / ((double)u1 - u0);
+	 nd[2*nn+axis] = c;
+	 nd[2*nn+1-axis] = (int32_t)floor(v + 0.5);
+	 ncx[nn++] = nc++;
+      }
+   }
+
+   /*
+    * sort the crossings along the cut line. In a counterclockwise
+    * polygon, crossings in +u direction begin an interval inside
+    * the polygon and crossings in -u direction end it.
+    */
+   qsort(cr, nc, sizeof(cross_t), cmp_cross);
+   for (k=0; k<nc; k++) {
+      if (cr[k].dir != ((k % 2) ? -1 : 1))
+	 goto done;  /* polygon intersects itself */
+      ncx[cr[k].node] = k;
+   }
+
+   /*
+    * assemble the pieces: s = -1 for u <= c, s = 1 for u > c. A piece
+    * enters its side at a crossing in direction s, follows the ring
+    * to the next crossing, and continues along the cut line at the
+    * other end of the interval.
+    */
+   for (s=-1; s<=1; s+=2) {
+      memset(used, '\0', nc);
+      for (k=0; k<nc; k++) {
+	 if (cr[k].dir != s || used[k])
+	    continue;
+	 np = 0;
+	 steps = 0;
+	 j = k;
+	 do {
+	    if (used[j] || steps++ > nc)
+	       goto done;
+	    used[j] = 1;
+	    i = cr[j].node;
+	    do {
+	       pr[2*np] = nd[2*i];
+	       pr[2*np+1] = nd[2*i+1];
+	       np++;
+	       i = (i+1) % nn;
+	    } while (ncx[i] < 0);
+	    e = ncx[i];
+	    if (cr[e].dir != -s)
+	       goto done;
+	    pr[2*np] = nd[2*i];
+	    pr[2*np+1] = nd[2*i+1];
+	    np++;
+	    j = e ^ 1;   /* other end of the interval */
+	 } while (j != k);
+
+	 np = simplify_ring(pr, np);
+	 if ( add_piece(pc, pr, np) )
+	    goto done;
+      }
+   }
+   ret = 0;
+
+ done:
+   free(nd);
+   free(ncx);
+   free(cr);
+   free(used);
+   free(pr);
+
+   return ret;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * merge the pieces np0 .. np-1 in pp that share an edge as long as
+ * the merged pieces have at most mmax vertices. The pieces are
+ * replaced by the merged pieces.
+ */
+static int
+merge_pieces(poly_pieces *pp, int np0, int mmax)
+{
+   int32_t **ring = NULL;  /* open rings of the pieces */
+   int *len = NULL;        /* their vertices, 0 when merged */
+   edge_t *et = NULL;      /* edge table */
+   psize_t *ps = NULL;     /* pieces by size */
+   char *mod = NULL;       /* pieces modified in a pass */
+   size_t off, off0, nv;
+   int np, k, pass;
+   int ret = -1;
+
+   np = pp->np - np0;
+   for (nv=0, k=np0; k<pp->np; k++)
+      nv += pp->len[k];
+   ring = (int32_t **)calloc(np, sizeof(int32_t *));
+   len  = (int *)malloc(np*sizeof(int));
+   et   = (edge_t *)malloc(nv*sizeof(edge_t));
+   ps   = (psize_t *)malloc(np*sizeof(psize_t));
+   mod  = (char *)malloc(np*sizeof(char));
+   if (ring == NULL || len == NULL || et == NULL || ps == NULL || mod == NULL)
+      goto done;
+
+   /* copy the pieces and give them positive orientation */
+   for (off=0, k=0; k<np0; k++)
+      off += 2*pp->len[k];
+   off0 = off;
+   for (k=0; k<np; k++) {
+      len[k] = pp->len[np0+k] - 1;
+      ring[k] = (int32_t *)malloc(2*len[k]*sizeof(int32_t));
+      if (ring[k] == NULL)
+	 goto done;
+      memcpy(ring[k], pp->xy + off, 2*len[k]*sizeof(int32_t));
+      if (ring_area(ring[k], len[k]) < 0)
+	 reverse_ring(ring[k], len[k]);
+      off += 2*pp->len[np0+k];
+   }
+
+   for (pass=0; pass<MAXPASS; pass++) {
+      k = merge_pass(ring, len, np, mmax, et, ps, mod);
+      if (k < 0)
+	 goto done;
+      if (k == 0)
+	 break;
+   }
+
+   /* replace the pieces */
+   pp->nxy = off0;
+   pp->np = np0;
+   for (k=0; k<np; k++) {
+      if (len[k] && add_piece(pp, ring[k], len[k]))
+	 goto done;
+   }
+   ret = 0;
+
+ done:
+   if (ring != NULL) {
+      for (k=0; k<np; k++)
+	 free(ring[k]);
+   }
+   free(ring);
+   free(len);
+   free(et);
+   free(ps);
+   free(mod);
+
+   return ret;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * one pass over the pieces, smallest first: a piece is merged with
+ * the smallest piece that shares an axis parallel edge with it, 
+ * i.e. an edge on a cut line, while the merged piece is small 
+ * enough. Returns the number of merges, or -1 when memory is 
+ * exhausted.
+ */
+static int
+merge_pass(int32_t **ring, int *len, int np, int mmax, 
+	   edge_t *et, psize_t *ps, char *mod)
+{
+   edge_t key, *pe;
+   int32_t *a, *b, *mr;
+   int ne, nps, nm, k, i, j, na, nb, ia, ib, best, m = 0;
+
+   /* table of the axis parallel edges */
+   for (ne=0, nps=0, k=0; k<np; k++) {
+      if (!len[k])
+	 continue;
+      a = ring[k];
+      for (i=0; i<len[k]; i++) {
+	 j = (i+1) % len[k];
+	 if (a[2*i] != a[2*j] && a[2*i+1] != a[2*j+1])
+	    continue;
+	 et[ne].x0 = a[2*i];
+	 et[ne].y0 = a[2*i+1];
+	 et[ne].x1 = a[2*j];
+	 et[ne].y1 = a[2*j+1];
+	 et[ne].piece = k;
+	 et[ne].idx = i;
+	 ne++;
+      }
+      ps[nps].n = len[k];
+      ps[nps].piece = k;
+      nps++;
+   }
+   qsort(et, ne, sizeof(edge_t), cmp_edge);
+   qsort(ps, nps, sizeof(psize_t), cmp_psize);
+   memset(mod, '\0', np);
+
+   for (nm=0, k=0; k<nps; k++) {
+      ia = ps[k].piece;
+      if (mod[ia])
+	 continue;
+
+      /* 
+       * the piece absorbs neighbours until none fits. Its entries
+       * in the edge table are not valid after the first merge, so
+       * other pieces cannot merge with it in this pass.
+       */
+      for (;;) {
+
+	 /* the smallest neighbour that can be merged */
+	 a = ring[ia];
+	 na = len[ia];
+	 best = -1;
+	 ib = 0;
+	 for (i=0; i<na; i++) {
+	    j = (i+1) % na;
+	    key.x0 = a[2*j];
+	    key.y0 = a[2*j+1];
+	    key.x1 = a[2*i];
+	    key.y1 = a[2*i+1];
+	    pe = (edge_t *)bsearch(&key, et, ne, sizeof(edge_t), cmp_edge);
+	    if (pe == NULL)
+	       continue;
+	    while (pe > et && !cmp_edge(pe-1, &key))
+	       pe--;
+	    for (; pe < et+ne && !cmp_edge(pe, &key); pe++) {
+	       if (pe->piece == ia || mod[pe->piece])
+		  continue;
+	       if (na + len[pe->piece] - 1 > mmax)
+		  continue;
+	       if (best < 0 || len[pe->piece] < len[best]) {
+		  best = pe->piece;
+		  ib = pe->idx;
+		  m = i;
+	       }
+	    }
+	 }
+	 if (best < 0)
+	    break;
+
+	 /*
+	  * the edge a[m] -> a[m+1] is the edge b[ib+1] -> b[ib]. The
+	  * merged ring follows a from a[m+1] to a[m] and continues in
+	  * b after b[ib+1].
+	  */
+	 b = ring[best];
+	 nb = len[best];
+	 mr = (int32_t *)malloc(2*(na+nb-2)*sizeof(int32_t));
+	 if (mr == NULL)
+	    return -1;
+	 for (i=0; i<na; i++) {
+	    j = (m+1+i) % na;
+	    mr[2*i] = a[2*j];
+	    mr[2*i+1] = a[2*j+1];
+	 }
+	 for (i=0; i<nb-2; i++) {
+	    j = (ib+2+i) % nb;
+	    mr[2*(na+i)] = b[2*j];
+	    mr[2*(na+i)+1] = b[2*j+1];
+	 }
+	 free(a);
+	 free(b);
+	 ring[ia] = mr;
+	 len[ia] = simplify_ring(mr, na+nb-2);
+	 ring[best] = NULL;
+	 len[best] = 0;
+	 mod[ia] = mod[best] = 1;
+	 nm++;
+	 if (len[ia] == 0)
+	    break;
+      }
+   }
+
+   return nm;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * append an open ring as closed polygon; degenerate rings are
+ * dropped.
+ */
+static int
+add_piece(poly_pieces *pp, const int32_t *xy, int n)
+{
+   int32_t *pxy;
+   int *plen;
+   size_t m;
+
+   if (n < 3 || ring_area(xy, n) == 0)
+      return 0;
+
+   if (pp->nxy + 2*(n+1) > pp->mxy) {
+      m = pp->mxy < 4096 ? 4096 : pp->mxy;
+      while (m < pp->nxy + 2*(n+1))
+	 m *= 2;
+      pxy = (int32_t *)realloc(pp->xy, m*sizeof(int32_t));
+      if (pxy == NULL)
+	 return -1;
+      pp->xy = pxy;
+      pp->mxy = m;
+   }
+   if (pp->np == pp->mp) {
+      m = pp->mp < 16 ? 16 : 2*pp->mp;
+      plen = (int *)realloc(pp->len, m*sizeof(int));
+      if (plen == NULL)
+	 return -1;
+      pp->len = plen;
+      pp->mp = m;
+   }
+
+   memcpy(pp->xy + pp->nxy, xy, 2*n*sizeof(int32_t));
+   pp->xy[pp->nxy + 2*n]   = xy[0];  /* close polygon */
+   pp->xy[pp->nxy + 2*n+1] = xy[1];
+   pp->nxy += 2*(n+1);
+   pp->len[pp->np++] = n+1;
+
+   return 0;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * remove repeated vertices, including the closing vertex, and
+ * vertices on a straight line between their neighbours from a ring
+ * and return the new number of vertices. This also removes the zero
+ * width spikes that remain when a cut line runs along an edge.
+ */
+static int
+simplify_ring(int32_t *xy, int n)
+{
+   int k, m, f;
+
+   /* single pass with a stack */
+   for (m=0, k=0; k<n; k++) {
+      if (m > 0 && xy[2*k] == xy[2*m-2] && xy[2*k+1] == xy[2*m-1])
+	 continue;
+      xy[2*m] = xy[2*k];
+      xy[2*m+1] = xy[2*k+1];
+      m++;
+      while (m >= 3 && collinear(xy+2*m-6, xy+2*m-4, xy+2*m-2)) {
+	 xy[2*m-4] = xy[2*m-2];
+	 xy[2*m-3] = xy[2*m-1];
+	 m--;
+      }
+   }
+
+   /* where the ring closes */
+   f = 0;
+   while (m - f >= 3) {
+      if (xy[2*m-2] == xy[2*f] && xy[2*m-1] == xy[2*f+1])
+	 m--;
+      else if (collinear(xy+2*m-4, xy+2*m-2, xy+2*f))
+	 m--;
+      else if (collinear(xy+2*m-2, xy+2*f, xy+2*f+2))
+	 f++;
+      else
+	 break;
+   }
+   if (m - f < 3)
+      return 0;
+   if (f > 0)
+      memmove(xy, xy+2*f, 2*(m-f)*sizeof(int32_t));
+
+   return m - f;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * returns 1 when vertex b lies on the line through a and c
+ */
+static int
+collinear(const int32_t *a, const int32_t *b, const int32_t *c)
+{
+   int64_t ux, uy, vx, vy;
+
+   ux = (int64_t)b[0] - a[0];
+   uy = (int64_t)b[1] - a[1];
+   vx = (int64_t)c[0] - b[0];
+   vy = (int64_t)c[1] - b[1];
+
+   /* products of differences below 2^31 are exact */
+   if (ux > -2147483647 && ux < 2147483647 && uy > -2147483647 && uy < 2147483647 &&
+       vx > -2147483647 && vx < 2147483647 && vy > -2147483647 && vy < 2147483647)
+      return ux*vy == uy*vx;
+
+   return (double)ux*vy == (double)uy*vx;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * twice the signed area of a ring
+ */
+static double
+ring_area(const int32_t *xy, int n)
+{
+   double a = 0.0;
+   int k, j;
+
+   for (k=0; k<n; k++) {
+      j = (k+1) % n;
+      a += ((double)xy[2*k] - xy[0]) * ((double)xy[2*j+1] - xy[1]) -
+	   ((double)xy[2*j] - xy[0]) * ((double)xy[2*k+1] - xy[1]);
+   }
+
+   return a;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static void
+reverse_ring(int32_t *xy, int n)
+{
+   int32_t t;
+   int k, j;
+
+   for (k=0, j=n-1; k<j; k++, j--) {
+      t = xy[2*k];   xy[2*k] = xy[2*j];     xy[2*j] = t;
+      t = xy[2*k+1]; xy[2*k+1] = xy[2*j+1]; xy[2*j+1] = t;
+   }
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * crossings that coincide, as at keyhole cuts, separate two
+ * intervals inside the polygon: the end of the lower interval
+ * comes first.
+ */
+static int
+cmp_cross(const void *a, const void *b)
+{
+   const cross_t *pa = (const cross_t *)a;
+   const cross_t *pb = (const cross_t *)b;
+
+   if (pa->v < pb->v)
+      return -1;
+   if (pa->v > pb->v)
+      return 1;
+   return pa->dir - pb->dir;
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static int
+cmp_int32(const void *a, const void *b)
+{
+   int32_t ia = *(const int32_t *)a;
+   int32_t ib = *(const int32_t *)b;
+
+   return (ia > ib) - (ia < ib);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+static int
+cmp_edge(const void *a, const void *b)
+{
+   const edge_t *pa = (const edge_t *)a;
+   const edge_t *pb = (const edge_t *)b;
+
+   if (pa->x0 != pb->x0)
+      return (pa->x0 > pb->x0) - (pa->x0 < pb->x0);
+   if (pa->y0 != pb->y0)
+      return (pa->y0 > pb->y0) - (pa->y0 < pb->y0);
+   if (pa->x1 != pb->x1)
+      return (pa->x1 > pb->x1) - (pa->x1 < pb->x1);
+   return (pa->y1 > pb->y1) - (pa->y1 < pb->y1);
+}
+
+
+/*-----------------------------------------------------------------*/
+
+/*
+ * by size, then by piece number, which makes the order reproducible
+ */
+static int
+cmp_psize(const void *a, const void *b)
+{
+   const psize_t *pa = (const psize_t *)a;
+   const psize_t *pb = (const psize_t *)b;
+
+   if (pa->n != pb->n)
+      return pa->n - pb->n;
+   return pa->piece - pb->piece;
+}
+
+/*-----------------------------------------------------------------*/
@@ -0,0 +1,58 @@
+/*
+ * Part of the GDS II toolbox for Octave & MATLAB
+ *
+ * Description:
+ * Splits polygons with more vertices than a GDS II XY record can
+ * hold into smaller polygons that cover the same area. Polygons are
+ * cut recursively at axis parallel lines until all pieces are small
+ * enough. Each cut uses the best of several candidate lines on both
+ * axes, through quantiles of the vertex coordinates and through
+ * fractions of the bounding box: the line with the smallest largest
+ * piece and the fewest edge crossings. Cuts that leave very narrow
+ * pieces are penalized, but are still used when no better line is
+ * found, so narrow pieces are possible. Pieces share the vertices on
+ * the cut lines exactly, so the pieces neither overlap nor leave
+ * gaps. Small pieces that share an edge on a cut line are merged.
+ */
+
+#ifndef _POLYSPLIT_H
+#define _POLYSPLIT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/*-- Types --------------------------------------------------------*/
+
+/*
+ * polygons resulting from a split; the vertices of all pieces are
+ * stored consecutively as (x,y) pairs in host byte order. Each piece
+ * is closed, i.e. its last vertex is equal to the first.
+ */
+typedef struct {
+   int32_t *xy;         /* vertices of all pieces */
+   size_t nxy, mxy;     /* number of coordinates, buffer size */
+   int *len;            /* number of vertices of each piece */
+   int np, mp;          /* number of pieces, buffer size */
+} poly_pieces;
+
+
+/*-- Function prototypes ------------------------------------------*/
+
+/*
+ * initialize and release a piece list
+ */
+void init_pieces(poly_pieces *pp);
+void free_pieces(poly_pieces *pp);
+
+/*
+ * split the closed polygon xy with m vertices (host byte order)
+ * into pieces with at most mmax vertices, including the closing
+ * vertex, and append them to pp. The polygon must not intersect
+ * itself; touching edges, as in polygons with keyhole cuts, are
+ * permitted. Returns 0 on success and -1 when the polygon cannot
+ * be split or when memory is exhausted.
+ */
+int split_polygon(const int32_t *xy, int m, int mmax, poly_pieces *pp);
+
+#endif /* _POLYSPLIT_H */
@@ -0,0 +1,54 @@
+function [glib] = read_gds_cache(cname, maxres);
+%function [glib] = read_gds_cache(cname, maxres);
+%
+% read_gds_cache :
+%        returns the library stored in a layout cache file written
+%        with write_gds_cache. Only the structure table of the cache
+%        is read; the library is a lazy library (see read_gds_library)
+%        whose structures are loaded from the memory mapped cache
+%        file when they are first indexed or iterated.
+%
+% cname :    name of a layout cache file
+% maxres :   (Optional) maximum number of structures that are kept in
+%            memory. Default is Inf.
+% glib :     a gds_library object
+%
+
+% Initial version, layout cache
+
+% check arguments
+if nargin < 2, maxres = []; end
+if nargin < 1
+   error('missing file name');
+end
+if isempty(maxres), maxres = Inf; end
+
+% the absolute file name is needed to read structures later
+if ~any(cname(1) == '/\') && isempty(strfind(cname, ':'))
+   cname = fullfile(pwd, cname);
+end
+finfo = dir(cname);
+if isempty(finfo)
+   error('read_gds_cache :  file %s does not exist.', cname);
+end
+
+[ldata, cidx] = gds_cache_read(cname);
+
+glib = gds_library(ldata.lname, 'uunit',ldata.uunit, 'dbunit',ldata.dbunit);
+
+lz.fname = cname;
+lz.fsize = finfo.bytes;
+lz.mtime = finfo.datenum;
+lz.uunit = ldata.uunit;
+lz.dbunit = ldata.dbunit;
+lz.names = {cidx.sname};
+lz.refs = {cidx.refs};
+lz.offset = [cidx.offset];
+lz.numel = [cidx.numel];
+lz.maxres = maxres;
+lz.cache = 1;
+
+nstr = length(cidx);
+glib = set(glib, 'lazy',lz, 'st',num2cell(1:nstr), 'numst',nstr);
+
+return
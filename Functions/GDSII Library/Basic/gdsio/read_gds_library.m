@@ -1,5 +1,5 @@
-function [glib] = read_gds_library(gdsname, verbose, hdronly);
-%function [glib] = read_gds_library(gdsname, verbose, hdronly);
+function [glib] = read_gds_library(gdsname, varargin);
+%function [glib] = read_gds_library(gdsname, varargin);
 %
 % read_gds_library :
 %        Reads a GDS II file and returns its structures
@@ -8,30 +8,125 @@ function [glib] = read_gds_library(gdsname, verbose, hdronly);
 %        GDS II file.
 %
 % gdsname :  name of a GDS II file to read (with or without .gds extension).
-% verbose :  when > 0, print out information about the file and
-%            structure names during reading. Default is 0 (quiet).
-% hdronly :  when > 0, only the header information will be displayed and
-%            the header structure will be returned. Implies verbose = 1.
-%            Default is 0.
+%            Files with the extension .gz or .zst are decompressed
+%            while they are read. Files with the extension .oas are
+%            read as OASIS files.
+% varargin : optional argument/value pairs. For compatibility, the
+%            values of verbose and hdronly can also be passed as the
+%            second and third argument, e.g. read_gds_library(fname, 1).
+%
+%            verbose : when > 0, print out information about the file
+%                and structure names during reading. Default is 0 (quiet).
+%
+%            hdronly : when > 0, only the header information will be
+%                displayed and the header structure will be returned.
+%                Implies verbose = 1. Default is 0.
+%
+%            lazy : when > 0, only the structure index of the file is
+%                read (see gds_index) and a lazy library is returned.
+%                Structure names and the structure hierarchy are available
+%                immediately, the elements of a structure are read from
+%                the file when the structure is first indexed or iterated.
+%                Default is 0. OASIS files are always read completely.
+%
+%            maxres : maximum number of structures of a lazy library that
+%                are kept in memory. When more structures were read, the
+%                least recently used structures are released and read
+%                again from the file when they are needed. Default is Inf.
+%
+%            prefetch : when > 0, the file is not mapped into memory but
+%                read in large blocks by a background thread while the
+%                records are decoded. This can be faster for files on
+%                network storage. With verbose > 0, the read throughput
+%                and the fraction of the reading time that overlapped with
+%                decoding are displayed (see gds_io_stats). Default is 0.
+%
+%            store : when > 0, the elements of each structure are kept in
+%                an element store (see elstore) instead of one gds_element
+%                object per element. Element objects are created only
+%                when elements of a structure are accessed or modified,
+%                and unmodified structures are written from the store.
+%                Uses much less memory for large layouts. When store > 1,
+%                the stores also keep the records of the elements as they
+%                were read, and elements that were not modified are copied
+%                to the output file without encoding them again (requires
+%                prefetch = 0). Default is 0.
+%
+%            dbu : when > 0, the xy coordinates of the elements are int32
+%                matrices in database units instead of double matrices
+%                in user units. They take half the memory and are written
+%                without conversion, and poly_bool works on them directly,
+%                which avoids rounding to the database grid on every
+%                write. Path widths and extensions remain in user units.
+%                Default is 0.
+%
 % glib :     library object with GDS elements and structures
 %
+% Example:
+%            glib = read_gds_library('chip.gds', 'store',1, 'dbu',1);
+%
 
 % Initial version, Ulf Griesmann, NIST, November 2011
 
 % check arguments
-if nargin < 3, hdronly = []; end
-if nargin < 2, verbose = []; end
 if nargin < 1
   error('missing file name');
 end
-if ~nargout & ~hdronly
-  error('missing output argument');
+
+% defaults
+verbose = [];
+hdronly = [];
+lazy = 0;
+maxres = Inf;
+prefetch = 0;
+store = 0;
+dbu = 0;
+
+% verbose and hdronly can be passed by position
+na = 1;
+if na <= length(varargin) && ~ischar(varargin{na})
+  verbose = varargin{na};
+  na = na + 1;
+  if na <= length(varargin) && ~ischar(varargin{na})
+    hdronly = varargin{na};
+    na = na + 1;
+  end
+end
+
+% process argument/value pairs
+for idx = na:2:length(varargin)
+  prop = varargin{idx};
+  if idx == length(varargin) || ~ischar(prop)
+    error('read_gds_library :  options must be argument/value pairs.');
+  end
+  valu = varargin{idx+1};
+  switch prop
+    case 'verbose'
+      verbose = valu;
+    case 'hdronly'
+      hdronly = valu;
+    case 'lazy'
+      lazy = valu;
+    case 'maxres'
+      maxres = valu;
+    case 'prefetch'
+      prefetch = valu;
+    case 'store'
+      store = valu;
+    case 'dbu'
+      dbu = valu;
+    otherwise
+      error(sprintf('unknown property --> %s\n', prop));
+  end
 end
 
-% set defaults
 if isempty(hdronly), hdronly = 0; end
 if hdronly, verbose = 1; end
 if isempty(verbose), verbose = 0; end
+if isempty(maxres), maxres = Inf; end
+if ~nargout & ~hdronly
+  error('missing output argument');
+end
 
 % open file for reading
 if ~gds_file_exists(gdsname)
@@ -39,18 +134,40 @@ if ~gds_file_exists(gdsname)
     gdsname = [gdsname, '.gds'];
   elseif gds_file_exists([gdsname,'.cgds'])
     gdsname = [gdsname, '.cgds'];
+  elseif gds_file_exists([gdsname,'.gds.gz'])
+    gdsname = [gdsname, '.gds.gz'];
+  elseif gds_file_exists([gdsname,'.gds.zst'])
+    gdsname = [gdsname, '.gds.zst'];
+  elseif gds_file_exists([gdsname,'.oas'])
+    gdsname = [gdsname, '.oas'];
   else
     error('input file does not exist.');
   end
 end
 
-[gf,fsize] = gds_open(gdsname, 'rb'); % use 'b' for Windows
+if prefetch
+  [gf,fsize] = gds_open(gdsname, 'rba'); % 'a' reads ahead
+else
+  [gf,fsize] = gds_open(gdsname, 'rbm'); % 'b' for Windows, 'm' maps the file
+end
 
 % start time
 t_start = now();
 
-% read the library information records
-ldata = gds_libdata(gf);
+% read the library information records; OASIS files are
+% decoded completely with a single call
+oasis = ~isempty(regexp(gdsname, '\.oas(\.gz|\.zst)?$', 'once'));
+if oasis
+  lazy = 0;
+  if hdronly
+    ldata = oasis_read_library(gf);
+  else
+    [ldata, slist] = oasis_read_library(gf, dbu);
+    epos = [];  % OASIS cells have no file positions
+  end
+else
+  ldata = gds_libdata(gf);
+end
 if verbose
   fprintf('\nLibrary name  : %s\n', ldata.lname);
   fprintf('Creation date : %d-%d-%d, %02d:%02d:%02d\n', ldata.cdate);
@@ -60,6 +177,7 @@ end
 
 % return if only header display
 if hdronly
+  gds_close(gf);
   return
 end
 
@@ -79,36 +197,67 @@ if verbose
   fprintf('Structures    :\n');
 end
 
+% a lazy library only needs the structure index
+if lazy
+  gds_close(gf);
+  glib = lazy_library(glib, gdsname, maxres, dbu, verbose);
+  t_el = now() - t_start;
+  if verbose
+    fprintf('\nIndex time : %s\n', datestr(t_el, 'HH:MM:SS.FFF'));
+    fprintf('Structures : %d\n\n', numst(glib));
+  end
+  return
+end
+
+% read all structures and elements with a single call
+if oasis
+  store = 0;
+else
+  [slist, epos] = gds_read_library(gf, ldata.dbunit/ldata.uunit, 0, 0, store, dbu);
+end
+
 % element and structure counters
 tnel = 0;
-nstr = 0;
+nstr = length(slist);
 
-while 1
+% create structure objects
+S = cell(1, nstr);
+for k = 1:nstr
   
-  rtype = gds_record_info(gf);
+  if store
+    elist = slist(k).store;
+    slist(k).store = [];
+  else
+    elist = cellfun(@(x)gds_element([],x), slist(k).el, 'UniformOutput',0);
+    if isempty(elist)
+      elist = {};
+    end
+    slist(k).el = []; % release element data
+  end
   
-  switch rtype
-    
-    case 1024 % ENDLIB
-      break
-      
-    case 1282 % BGNSTR - beginning of structure
-      nstr = nstr + 1;
-      S = gds_read_struct(gf, ldata.uunit, ldata.dbunit);
-      glib(nstr) = S;
-      tnel = tnel + numel(S);
-      if verbose  % print structure information and progress info
-        fpos = gds_ftell(gf);
-        fprintf('%d ... %3.1f%% ... %s (%d)\n', ...
-          nstr, 100*fpos/fsize, sname(S), numel(S));
-      end
-      
-    otherwise
-      fclose(gf); % something is wrong - get out
-      error('invalid GDS file - ENDLIB or BGNSTR expected.');
+  S{k} = gds_structure(slist(k).sname, elist);
+  S{k} = set(S{k}, 'cdate',slist(k).cdate, 'mdate',slist(k).mdate);
+  tnel = tnel + numel(S{k});
+  if verbose  % print structure information and progress info
+    if isempty(epos) || fsize <= 0  % size of compressed files can be unknown
+      fprintf('%d of %d ... %s (%d)\n', ...
+        k, nstr, sname(S{k}), numel(S{k}));
+    else
+      fprintf('%d ... %3.1f%% ... %s (%d)\n', ...
+        k, 100*epos(k)/fsize, sname(S{k}), numel(S{k}));
+    end
   end
   
 end
+if nstr
+  glib(1:nstr) = S;
+end
+
+% read-ahead statistics
+iost = [];
+if prefetch
+  iost = gds_io_stats(gf);
+end
 
 % close the GDS file
 gds_close(gf);
@@ -120,7 +269,50 @@ t_el = now() - t_start;  % elapsed time in days
 if verbose
   fprintf('\nRead time  : %s\n', datestr(t_el, 'HH:MM:SS.FFF'));
   fprintf('Structures : %d\n', numst(glib));
-  fprintf('Elements   : %d\n\n', tnel);
+  fprintf('Elements   : %d\n', tnel);
+  if ~isempty(iost)
+    fprintf('Throughput : %.1f MB/s\n', iost.throughput);
+    fprintf('Overlap    : %.0f%%\n', 100*iost.overlap);
+  end
+  fprintf('\n');
+end
+
+return
+
+
+function glib = lazy_library(glib, gdsname, maxres, dbu, verbose)
+%
+% returns a library with the structures of a lazy library,
+% which are indices into the structure index of the file
+%
+
+% the absolute file name is needed to read structures later
+if ~any(gdsname(1) == '/\') && isempty(strfind(gdsname, ':'))
+  gdsname = fullfile(pwd, gdsname);
+end
+
+gidx = gds_index(gdsname);
+
+lz.fname = gdsname;
+lz.fsize = gidx.fsize;
+lz.mtime = gidx.mtime;
+lz.uunit = gidx.uunit;
+lz.dbunit = gidx.dbunit;
+lz.names = {gidx.st.sname};
+lz.refs = {gidx.st.refs};
+lz.offset = [gidx.st.offset];
+lz.numel = [gidx.st.numel];
+lz.maxres = maxres;
+lz.cache = 0;
+lz.dbu = dbu;
+
+nstr = length(gidx.st);
+glib = set(glib, 'lazy',lz, 'st',num2cell(1:nstr), 'numst',nstr);
+
+if verbose
+  for k = 1:nstr
+    fprintf('%d ... %s (%d)\n', k, lz.names{k}, lz.numel(k));
+  end
 end
 
 return
@@ -0,0 +1,59 @@
+function [slist] = read_gds_structures(gdsname, snames, subtree)
+%function [slist] = read_gds_structures(gdsname, snames, subtree)
+%
+% read_gds_structures :
+%        reads selected structures from a GDS II file without
+%        reading the entire library. The structures are located 
+%        with a structure index (see gds_index).
+%
+% gdsname :  name of a GDS II file
+% snames :   a structure name or a cell array of structure names
+% subtree :  (Optional) when > 0, all structures referenced 
+%            directly or indirectly by the named structures are
+%            also read. Default is 0.
+% slist :    cell array of gds_structure objects
+%
+
+% Initial version, structure index
+
+% check arguments
+if nargin < 3, subtree = []; end
+if nargin < 2
+   error('read_gds_structures :  missing argument(s).');
+end
+if isempty(subtree), subtree = 0; end
+if ischar(snames), snames = {snames}; end
+
+% structure index
+gidx = gds_index(gdsname);
+N = {gidx.st.sname};
+
+% indices of requested structures
+[found, sidx] = ismember(snames, N);
+if ~all(found)
+   error('read_gds_structures :  structure >> %s << not found.', ...
+         snames{find(~found,1)});
+end
+
+% add referenced structures
+if subtree
+   k = 1;
+   while k <= length(sidx)
+      [found, ridx] = ismember(gidx.st(sidx(k)).refs, N);
+      ridx = ridx(found);
+      sidx = [sidx, ridx(~ismember(ridx, sidx))];
+      k = k + 1;
+   end
+end
+
+% read the structures in file order
+sidx = sort(sidx);
+gf = gds_open(gdsname, 'rbm');
+slist = cell(1, length(sidx));
+for k = 1:length(sidx)
+   slist{k} = gds_read_struct(gf, gidx.uunit, gidx.dbunit, ...
+                              gidx.st(sidx(k)).offset);
+end
+gds_close(gf);
+
+return
@@ -1,4 +1,6 @@
 %
 % script to make .mex files
 %
-mex -O poly_boolmex.cpp clipper.cpp
+mex -O -I../Basic/gdsio poly_boolmex.cpp clipper.cpp polyio.cpp polyhole.cpp polytile.cpp ../Basic/gdsio/gdsthreads.c
+mex -O -I../Basic/gdsio poly_offsetmex.cpp clipper.cpp polyio.cpp polyhole.cpp polytile.cpp ../Basic/gdsio/gdsthreads.c
+mex -O -I../Basic/gdsio poly_clipmex.cpp clipper.cpp polyio.cpp polyhole.cpp polytile.cpp ../Basic/gdsio/gdsthreads.c
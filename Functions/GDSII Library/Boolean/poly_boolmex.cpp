@@ -1,18 +1,33 @@
 // A mex interface to the Clipper library
 // for the GDS II toolbox
 // 
-// [pc, hf] =  = poly_boolmex(pa, pb, op, ud);
+// [pc, hf] =  = poly_boolmex(pa, pb, op, ud, nt, nthreads, hm);
 //
 // pa :  cell array with polygons (nx2 matrices)
 // pb :  polygon b, an nx2 matrix
 // op :  polygon operation
 // ud :  conversion factor for conversion from user
 //       coordinates to database coordinates
+// nt :  (Optional) when nt > 1, the bounding box of the polygons is
+//       divided into a grid of nt x nt tiles, which are clipped 
+//       independently by several threads (see polytile.hpp). The
+//       results are merged at the tile borders. Default is 1, the
+//       largest value is 256 (MAX_TILES in polytile.hpp).
+// nthreads : (Optional) number of threads for tiled operations.
+//       Default is 0, which uses all processors.
+// hm :  (Optional) hole mode. When hm is 'keyhole' or 'cutline', 
+//       holes are connected to the polygons that contain them, so 
+//       that the result contains no holes (see polyhole.hpp). By 
+//       default, holes are returned as separate polygons.
 // pc :  a cell array containing one or more polygons that result
 //       from applying the polygon operation to each (pair pa{k}, pb).
 // hf :  hole flag array; when hf(k)==1, pc{k} is the interior boundary
 //       of a hole.
 //
+// Polygons can also be int32 matrices in database units, which are
+// used without conversion. The result polygons are int32 matrices
+// when the first polygon in pa is an int32 matrix.
+//
 // polygon operations are:
 //   'and' :  polygon intersection
 //   'or' :   polygon union
@@ -24,13 +39,21 @@
 // NOTE:
 // C++ memory management in mex functions is a nightmare. In C,
 // calls to malloc can simply be redirected to mxMalloc etc., but in C++, 
-// memory management is baked into the language. I am not sure that 
-// all memory allocated by the Clipper library is freed, and memory 
-// leaks are possible. Need to keep an eye on this ... 
+// memory management is baked into the language. All Clipper objects
+// are local to clip_polygons and are destroyed before the function 
+// returns. Errors are raised with mexErrMsgTxt only after that, because
+// mexErrMsgTxt does not return and would skip the destructors. There 
+// is no state that persists between calls, so the function is 
+// reentrant.
 
 #include <math.h>
+#include <string.h>
+#include <stdint.h>
 #include "mex.h"
 #include "clipper.hpp"
+#include "polyio.hpp"
+#include "polyhole.hpp"
+#include "polytile.hpp"
 
 #define STR_LEN    8
 
@@ -39,51 +62,36 @@
 
 using namespace ClipperLib;
 
-// declare static to avoid memory leaks when the mex function exits
-static Paths pa, pb, pc;
-static Clipper C;
+static const char* clip_polygons(mxArray *plhs[], const mxArray *prhs[],
+				 ClipType pop, double ud, int nt, int nthreads,
+				 HoleMode hm);
+
+
+//-----------------------------------------------------------------
 
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
-	mxArray *par;         // ptr to mxArray structure 
-	double *pda;          // ptr to polynomial data
 	double *pud;          // pointer to unit conversion factor
-	mxLogical *ph;        // pointer to hole flags
-	double ud, iud;
-	unsigned int Na, Nb, vnu;
-	unsigned int k, m;
+	double ud;
+	int nt = 1;           // tiles per side
+	int nthreads = 0;
 	ClipType pop;
+	HoleMode hm = hmNone;
 	char ostr[STR_LEN];   //string with polygon operation
-	unsigned int maxVerticles = 8000;
-
-	C.StrictlySimple(true);
+	const char *emsg;
 
 	//////////////////
 	// check arguments
 	//
 
 	// argument number
-	if (nrhs != 4) {
-		mexErrMsgTxt("polyboolmex :  expected 4 input arguments.");
+	if (nrhs < 4 || nrhs > 7) {
+		mexErrMsgTxt("polyboolmex :  expected 4 to 7 input arguments.");
 	}
 
-	// argument pa
-	if (!mxIsCell(prhs[0])) {
-		mexErrMsgTxt("polyboolmex :  argument pa must be a cell array.");
-	}
-	Na = mxGetM(prhs[0])*mxGetN(prhs[0]);
-	if (!Na) {
-		mexErrMsgTxt("polyboolmex :  no input polygons pa.");
-	}
-
-	// argument pb
-	if (!mxIsCell(prhs[1])) {
-		mexErrMsgTxt("polyboolmex :  argument pb must be a cell array.");
-	}
-	Nb = mxGetM(prhs[1])*mxGetN(prhs[1]);
-	if (!Nb) {
-		mexErrMsgTxt("polyboolmex :  no input polygons pb.");
-	}
+	// arguments pa and pb
+	check_polygons(prhs[0], "polyboolmex", "pa");
+	check_polygons(prhs[1], "polyboolmex", "pb");
 
 	// get operation argument
 	mxGetString(prhs[2], ostr, STR_LEN);
@@ -102,110 +110,95 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 	// conversion factor argument
 	pud = (double*)mxGetData(prhs[3]);
 	ud = *pud;
-	iud = 1.0 / ud;
-
-
-	////////////////////////
-	// copy and prepare data
-	//
-
-	// pa
-	pa.resize(Na);
-	for (k = 0; k < Na; k++) {
 
-		// get the next polygon from the cell array 
-		par = mxGetCell(prhs[0], k);   // ptr to mxArray
-		if (mxIsEmpty(par)) {
-			mexErrMsgTxt("poly_boolmex :  empty polygon in pa.");
-		}
-		pda = (double*)mxGetData(par); // ptr to a data     
-		vnu = mxGetM(par);             // rows = vertex number
-
-		// copy polygon and transpose, scale
-		pa[k].resize(vnu);
-		for (m = 0; m < vnu; m++) {
-			pa[k][m].X = (cInt)floor(ud * pda[m] + 0.5);
-			pa[k][m].Y = (cInt)floor(ud * pda[m + vnu] + 0.5);
+	// tiles and threads
+	if (nrhs > 4 && !mxIsEmpty(prhs[4]))
+		nt = (int)mxGetScalar(prhs[4]);
+	if (nt > MAX_TILES)
+		mexErrMsgTxt("polyboolmex :  at most 256 tiles per side (MAX_TILES).");
+	if (nrhs > 5 && !mxIsEmpty(prhs[5]))
+		nthreads = (int)mxGetScalar(prhs[5]);
+
+	// hole mode
+	if (nrhs > 6 && !mxIsEmpty(prhs[6])) {
+		mxGetString(prhs[6], ostr, STR_LEN);
+		if (!strncmp(ostr, "keyhole", 7))
+			hm = hmKeyhole;
+		else if (!strncmp(ostr, "cutline", 7))
+			hm = hmCutline;
+		else {
+			mexErrMsgTxt("polyboolmex :  unknown hole mode.");
 		}
-
-		// make sure polygons have positive orientation
-		if (!Orientation(pa[k]))
-			ReversePath(pa[k]);
 	}
 
-	// pb
-	pb.resize(Nb);
-	for (k = 0; k < Nb; k++) {
-
-		// get the next polygon 
-		par = mxGetCell(prhs[1], k);   // ptr to mxArray
-		if (mxIsEmpty(par)) {
-			mexErrMsgTxt("poly_boolmex :  empty polygon in pb.");
-		}
-		pda = (double*)mxGetData(par); // ptr to a data     
-		vnu = mxGetM(par);             // rows = vertex number
-
-		// copy polygon and transpose, scale
-		pb[k].resize(vnu);
-		for (m = 0; m < vnu; m++) {
-			pb[k][m].X = (cInt)floor(ud * pda[m] + 0.5);
-			pb[k][m].Y = (cInt)floor(ud * pda[m + vnu] + 0.5);
-		}
-
-		// make sure polygons have positive orientation
-		if (!Orientation(pb[k]))
-			ReversePath(pb[k]);
-	}
-
-
-	////////////////////
-	// clip the polygons
+	/////////////////////////////////
+	// clip, then report any failure
 	//
-	C.AddPaths(pa, ptSubject, true);
-	C.AddPaths(pb, ptClip, true);
+	emsg = clip_polygons(plhs, prhs, pop, ud, nt, nthreads, hm);
+	if (emsg)
+		mexErrMsgTxt(emsg);
+}
 
-	if (!C.Execute(pop, pc, pftNonZero, pftNonZero))
-		mexErrMsgTxt("polyboolmex :  Clipper library error.");
 
-	//////////////////////////////////////////
-	// create a cell array for output argument
-	//
-	plhs[0] = mxCreateCellMatrix(1, pc.size());
+//-----------------------------------------------------------------
 
-	//////////////////////////
-	// return clipping results
-	//
-	for (k = 0; k < pc.size(); k++) {
+// performs the polygon operation and creates the output arguments.
+// Returns NULL on success or an error message. All C++ objects 
+// have been destroyed when the function returns.
+static const char* 
+clip_polygons(mxArray *plhs[], const mxArray *prhs[], ClipType pop, double ud,
+	      int nt, int nthreads, HoleMode hm)
+{
+	Paths pa, pb, pc;
+	PolyTree pt;
+	Clipper C;
+	bool intxy = mxIsInt32(mxGetCell(prhs[0], 0));
 
-		// allocate matrix for boundary
-		vnu = pc[k].size();
-		par = mxCreateDoubleMatrix(vnu, 2, mxREAL);
-		pda = (double*)mxGetData(par);
+	C.StrictlySimple(true);
 
-		// copy vertex array, transpose, and scale back to user units
-		for (m = 0; m < vnu; m++) {
-			pda[m] = iud * pc[k][m].X;
-			pda[vnu + m] = iud * pc[k][m].Y;
+	////////////////////////
+	// copy and prepare data
+	//
+	try {
+		copy_polygons(pa, prhs[0], ud);
+		copy_polygons(pb, prhs[1], ud);
+
+		////////////////////
+		// clip the polygons
+		//
+		if (nt > 1) {
+			if (!tiled_clip(pa, pb, pop, nt, nthreads, pc))
+				return "polyboolmex :  Clipper library error.";
+		}
+		else {
+			C.AddPaths(pa, ptSubject, true);
+			C.AddPaths(pb, ptClip, true);
+
+			if (hm == hmNone) {
+				if (!C.Execute(pop, pc, pftNonZero, pftNonZero))
+					return "polyboolmex :  Clipper library error.";
+			}
+			else {
+				// holes must follow their polygons
+				if (!C.Execute(pop, pt, pftNonZero, pftNonZero))
+					return "polyboolmex :  Clipper library error.";
+				tree_polygons(&pt, pc);
+				pt.Clear();
+			}
 		}
 
-		// store in cell array
-		mxSetCell(plhs[0], k, par);
+		// connect the holes to their polygons
+		resolve_holes(pc, hm);
+	}
+	catch (...) {
+		return "polyboolmex :  Clipper library error.";
 	}
 
-	///////////////////
-	// return hole flags
+	//////////////////////////////
+	// return the clipping results
 	//
-	plhs[1] = mxCreateLogicalMatrix(1, pc.size());
-	ph = (mxLogical*)mxGetData(plhs[1]);
-	for (k = 0; k < pc.size(); k++)
-		ph[k] = !Orientation(pc[k]); // same as input == no hole
-
-	 ///////////////////
-	 // clean up
-	 //
-	C.Clear();
-	pa.resize(0);
-	pb.resize(0);
-	pc.resize(0);
-}
+	plhs[0] = polygons_to_cell(pc, ud, intxy);
+	plhs[1] = hole_flags(pc);
 
+	return NULL;
+}
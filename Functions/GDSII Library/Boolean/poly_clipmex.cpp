@@ -0,0 +1,361 @@
+// A mex interface to persistent Clipper objects
+// for the GDS II toolbox; see gds_element/poly_boolops.m
+//
+// A clipper context holds subject and clip polygons that were 
+// converted to database units once, and a Clipper object with their
+// edge lists. Several operations can be executed on the same 
+// polygons without converting them again or rebuilding the edge 
+// lists.
+//
+// h = poly_clipmex('create', ud);
+//     poly_clipmex('add', h, pa, pt);
+//     poly_clipmex('clear', h, pt);
+// [pc, hf] = poly_clipmex('execute', h, op, hm);
+//     poly_clipmex('destroy', h);
+//
+// ud :  conversion factor for conversion from user
+//       coordinates to database coordinates
+// h :   handle of a clipper context
+// pa :  cell array with polygons (nx2 matrices)
+// pt :  polygon type, 'subject' or 'clip'. When pt is omitted in
+//       'clear', all polygons are removed.
+// op :  polygon operation, 'and', 'or', 'notb', or 'xor' (see 
+//       poly_boolmex.cpp); the subject polygons are the polygons a,
+//       the clip polygons are the polygons b.
+// hm :  (Optional) hole mode, 'keyhole' or 'cutline' (see
+//       poly_boolmex.cpp)
+// pc :  a cell array containing the resulting polygons
+// hf :  hole flag array; when hf(k)==1, pc{k} is the interior boundary
+//       of a hole.
+//
+// Polygons can also be int32 matrices in database units, which are
+// used without conversion. The result polygons are int32 matrices
+// when the first polygons added to the context are int32 matrices.
+//
+// Polygons added to a context are appended to the edge lists of the
+// Clipper object. The Clipper library cannot remove polygons from
+// its edge lists; after 'clear', the edge lists are rebuilt from the
+// remaining converted polygons at the next 'execute'. 
+//
+// A context is only released by 'destroy'. Functions that create a
+// context should destroy it with an onCleanup object, which also
+// releases the context when an error is raised:
+//
+//     h = poly_clipmex('create', ud);
+//     guard = onCleanup(@() poly_clipmex('destroy', h));
+//     ...
+//     clear guard;   % or return from the function
+
+// NOTE:
+// The contexts persist between calls and are kept in a table that
+// is local to this function; the function is locked in memory while
+// contexts exist. All other C++ objects are local to the functions
+// that implement the commands, and errors are raised only after they
+// returned (see poly_boolmex.cpp).
+
+#include <string.h>
+#include <vector>
+#include "mex.h"
+#include "clipper.hpp"
+#include "polyio.hpp"
+#include "polyhole.hpp"
+#include "polytile.hpp"
+
+#define STR_LEN    8
+
+
+//-----------------------------------------------------------------
+
+using namespace ClipperLib;
+
+// a clipper context
+struct clip_ctx {
+	double ud;            // user units --> database units
+	bool intxy;           // results are int32 matrices
+	bool empty;           // no polygons were added yet
+	Paths ps, pc;         // subject and clip polygons
+	Clipper C;            // holds the edges of ps and pc unless dirty
+	bool dirty;
+};
+
+// table of contexts; handle h is context[h-1]
+static std::vector<clip_ctx*> context;
+static int ncontext = 0;
+
+static clip_ctx* get_context(const mxArray *ph);
+static PolyType get_polytype(const mxArray *ps);
+static void destroy_all(void);
+static const char* create_context(double ud, unsigned int *ph);
+static const char* add_polygons(clip_ctx *pc, const mxArray *ca, PolyType pt);
+static const char* execute_op(mxArray *plhs[], clip_ctx *pc, ClipType pop, 
+			      HoleMode hm);
+
+
+//-----------------------------------------------------------------
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	char cstr[STR_LEN];   // string with command
+	char ostr[STR_LEN];   // string with polygon operation
+	clip_ctx *pc;
+	ClipType pop;
+	HoleMode hm = hmNone;
+	unsigned int h;
+	const char *emsg = NULL;
+
+	// argument number
+	if (nrhs < 2) {
+		mexErrMsgTxt("polyclipmex :  expected at least 2 input arguments.");
+	}
+
+	// command
+	if (!mxIsChar(prhs[0])) {
+		mexErrMsgTxt("polyclipmex :  first argument must be a command string.");
+	}
+	mxGetString(prhs[0], cstr, STR_LEN);
+
+	if (!strcmp(cstr, "create")) {
+		if (mxIsEmpty(prhs[1])) {
+			mexErrMsgTxt("polyclipmex :  argument ud must not be empty.");
+		}
+		emsg = create_context(mxGetScalar(prhs[1]), &h);
+		if (!emsg) {
+			plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT32_CLASS, mxREAL);
+			*(uint32_t*)mxGetData(plhs[0]) = h;
+		}
+	}
+	else if (!strcmp(cstr, "add")) {
+		if (nrhs != 4) {
+			mexErrMsgTxt("polyclipmex :  'add' expects 4 arguments.");
+		}
+		pc = get_context(prhs[1]);
+		check_polygons(prhs[2], "polyclipmex", "pa");
+		emsg = add_polygons(pc, prhs[2], get_polytype(prhs[3]));
+	}
+	else if (!strcmp(cstr, "clear")) {
+		pc = get_context(prhs[1]);
+		if (nrhs < 3 || get_polytype(prhs[2]) == ptSubject)
+			Paths().swap(pc->ps);
+		if (nrhs < 3 || get_polytype(prhs[2]) == ptClip)
+			Paths().swap(pc->pc);
+		pc->dirty = true;
+	}
+	else if (!strcmp(cstr, "execute")) {
+		if (nrhs < 3) {
+			mexErrMsgTxt("polyclipmex :  'execute' expects 3 or 4 arguments.");
+		}
+		pc = get_context(prhs[1]);
+
+		mxGetString(prhs[2], ostr, STR_LEN);
+		if (!strncmp(ostr, "or", 2))
+			pop = ctUnion;
+		else if (!strncmp(ostr, "and", 3))
+			pop = ctIntersection;
+		else if (!strncmp(ostr, "notb", 4))
+			pop = ctDifference;
+		else if (!strncmp(ostr, "xor", 3))
+			pop = ctXor;
+		else {
+			mexErrMsgTxt("polyclipmex :  unknown boolean set algebra operation.");
+		}
+
+		if (nrhs > 3 && !mxIsEmpty(prhs[3])) {
+			mxGetString(prhs[3], ostr, STR_LEN);
+			if (!strncmp(ostr, "keyhole", 7))
+				hm = hmKeyhole;
+			else if (!strncmp(ostr, "cutline", 7))
+				hm = hmCutline;
+			else {
+				mexErrMsgTxt("polyclipmex :  unknown hole mode.");
+			}
+		}
+
+		emsg = execute_op(plhs, pc, pop, hm);
+	}
+	else if (!strcmp(cstr, "destroy")) {
+		pc = get_context(prhs[1]);
+		h = (unsigned int)mxGetScalar(prhs[1]);
+		delete pc;
+		context[h-1] = NULL;
+		if (--ncontext == 0)
+			mexUnlock();
+	}
+	else {
+		mexErrMsgTxt("polyclipmex :  unknown command.");
+	}
+
+	if (emsg)
+		mexErrMsgTxt(emsg);
+}
+
+
+//-----------------------------------------------------------------
+
+// returns the context for a handle or raises an error
+static clip_ctx*
+get_context(const mxArray *ph)
+{
+	double h;
+
+	if (!mxIsNumeric(ph) || mxIsEmpty(ph)) {
+		mexErrMsgTxt("polyclipmex :  argument h must be a handle.");
+	}
+	h = mxGetScalar(ph);
+	if (h < 1 || h > context.size() || context[(size_t)h-1] == NULL) {
+		mexErrMsgTxt("polyclipmex :  invalid clipper handle.");
+	}
+
+	return context[(size_t)h-1];
+}
+
+
+//-----------------------------------------------------------------
+
+static PolyType
+get_polytype(const mxArray *ps)
+{
+	char tstr[STR_LEN];
+
+	mxGetString(ps, tstr, STR_LEN);
+	if (!strncmp(tstr, "subject", 7))
+		return ptSubject;
+	else if (!strncmp(tstr, "clip", 4))
+		return ptClip;
+	else {
+		mexErrMsgTxt("polyclipmex :  polygon type must be 'subject' or 'clip'.");
+	}
+
+	return ptSubject;
+}
+
+
+//-----------------------------------------------------------------
+
+// deletes all contexts when the function is cleared
+static void
+destroy_all(void)
+{
+	size_t k;
+
+	for (k = 0; k < context.size(); k++)
+		delete context[k];
+	std::vector<clip_ctx*>().swap(context);
+	ncontext = 0;
+}
+
+
+//-----------------------------------------------------------------
+
+static const char*
+create_context(double ud, unsigned int *ph)
+{
+	clip_ctx *pc;
+	size_t k;
+
+	try {
+		pc = new clip_ctx;
+		pc->ud = ud;
+		pc->intxy = false;
+		pc->empty = true;
+		pc->dirty = false;
+		pc->C.StrictlySimple(true);
+
+		// first free table entry
+		for (k = 0; k < context.size() && context[k] != NULL; k++)
+			;
+		if (k == context.size()) {
+			try {
+				context.push_back(pc);
+			}
+			catch (...) {
+				delete pc;
+				throw;
+			}
+		}
+		else
+			context[k] = pc;
+	}
+	catch (...) {
+		return "polyclipmex :  failed to create clipper context.";
+	}
+
+	if (ncontext++ == 0) {
+		mexAtExit(destroy_all);
+		mexLock();
+	}
+	*ph = (unsigned int)(k + 1);
+
+	return NULL;
+}
+
+
+//-----------------------------------------------------------------
+
+static const char*
+add_polygons(clip_ctx *pc, const mxArray *ca, PolyType pt)
+{
+	Paths &pp = (pt == ptSubject) ? pc->ps : pc->pc;
+	size_t np = pp.size();
+
+	if (pc->empty) {
+		pc->intxy = mxIsInt32(mxGetCell(ca, 0));
+		pc->empty = false;
+	}
+
+	try {
+		Paths pa;
+		copy_polygons(pa, ca, pc->ud);
+		pp.insert(pp.end(), pa.begin(), pa.end());
+		if (!pc->dirty)
+			pc->C.AddPaths(pa, pt, true);
+	}
+	catch (...) {
+		pp.resize(np);
+		pc->dirty = true;
+		return "polyclipmex :  failed to add polygons.";
+	}
+
+	return NULL;
+}
+
+
+//-----------------------------------------------------------------
+
+static const char*
+execute_op(mxArray *plhs[], clip_ctx *pc, ClipType pop, HoleMode hm)
+{
+	Paths pr;
+	PolyTree pt;
+
+	try {
+		// rebuild the edge lists
+		if (pc->dirty) {
+			pc->C.Clear();
+			pc->C.AddPaths(pc->ps, ptSubject, true);
+			pc->C.AddPaths(pc->pc, ptClip, true);
+			pc->dirty = false;
+		}
+
+		if (hm == hmNone) {
+			if (!pc->C.Execute(pop, pr, pftNonZero, pftNonZero))
+				return "polyclipmex :  Clipper library error.";
+		}
+		else {
+			// holes must follow their polygons
+			if (!pc->C.Execute(pop, pt, pftNonZero, pftNonZero))
+				return "polyclipmex :  Clipper library error.";
+			tree_polygons(&pt, pr);
+			pt.Clear();
+			resolve_holes(pr, hm);
+		}
+	}
+	catch (...) {
+		pc->dirty = true;
+		return "polyclipmex :  Clipper library error.";
+	}
+
+	plhs[0] = polygons_to_cell(pr, pc->ud, pc->intxy);
+	plhs[1] = hole_flags(pr);
+
+	return NULL;
+}
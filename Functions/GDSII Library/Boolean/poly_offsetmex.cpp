@@ -0,0 +1,181 @@
+// A mex interface to the polygon offset function of the Clipper
+// library for the GDS II toolbox
+// 
+// [pc, hf] = poly_offsetmex(pa, d, ud, jt, at, ml, hm);
+//
+// pa :  cell array with polygons (nx2 matrices)
+// d :   offset distance in user units. Polygons grow when d > 0 and
+//       shrink when d < 0. 
+// ud :  conversion factor for conversion from user
+//       coordinates to database coordinates
+// jt :  (Optional) join type at convex corners: 'miter', 'square',
+//       or 'round'. Default is 'miter'.
+// at :  (Optional) arc tolerance for round joins in database units;
+//       the maximum distance of the arcs from the true arcs.
+//       Default is 0.25.
+// ml :  (Optional) miter limit for miter joins in multiples of d.
+//       Corners that would extend further are squared off. Default
+//       is 2.
+// hm :  (Optional) hole mode 'keyhole' or 'cutline' (see 
+//       poly_boolmex.cpp). By default, holes are returned as separate
+//       polygons.
+// pc :  a cell array containing the offset polygons. Polygons that
+//       overlap after the offset are merged.
+// hf :  hole flag array; when hf(k)==1, pc{k} is the interior boundary
+//       of a hole.
+//
+// Polygons can also be int32 matrices in database units, which are
+// used without conversion; d is then multiplied by ud as well. The 
+// result polygons are int32 matrices when the first polygon in pa 
+// is an int32 matrix.
+
+// NOTE:
+// See the note on memory management in poly_boolmex.cpp. The
+// ClipperOffset object is local to offset_polygons.
+
+#include <string.h>
+#include "mex.h"
+#include "clipper.hpp"
+#include "polyio.hpp"
+#include "polyhole.hpp"
+#include "polytile.hpp"
+
+#define STR_LEN    8
+
+
+//-----------------------------------------------------------------
+
+using namespace ClipperLib;
+
+static const char* offset_polygons(mxArray *plhs[], const mxArray *prhs[],
+				   double d, double ud, JoinType jt, 
+				   double at, double ml, HoleMode hm);
+
+
+//-----------------------------------------------------------------
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	double d, ud;
+	double at = 0.25;     // arc tolerance
+	double ml = 2.0;      // miter limit
+	JoinType jt = jtMiter;
+	HoleMode hm = hmNone;
+	char jstr[STR_LEN];   // string with join type
+	const char *emsg;
+
+	//////////////////
+	// check arguments
+	//
+
+	// argument number
+	if (nrhs < 3 || nrhs > 7) {
+		mexErrMsgTxt("polyoffsetmex :  expected 3 to 7 input arguments.");
+	}
+
+	// argument pa
+	check_polygons(prhs[0], "polyoffsetmex", "pa");
+
+	// offset and conversion factor
+	if (mxIsEmpty(prhs[1]) || mxIsEmpty(prhs[2])) {
+		mexErrMsgTxt("polyoffsetmex :  arguments d and ud must not be empty.");
+	}
+	d = mxGetScalar(prhs[1]);
+	ud = mxGetScalar(prhs[2]);
+
+	// join type
+	if (nrhs > 3 && !mxIsEmpty(prhs[3])) {
+		mxGetString(prhs[3], jstr, STR_LEN);
+		if (!strncmp(jstr, "miter", 5))
+			jt = jtMiter;
+		else if (!strncmp(jstr, "square", 6))
+			jt = jtSquare;
+		else if (!strncmp(jstr, "round", 5))
+			jt = jtRound;
+		else {
+			mexErrMsgTxt("polyoffsetmex :  unknown join type.");
+		}
+	}
+
+	// arc tolerance and miter limit
+	if (nrhs > 4 && !mxIsEmpty(prhs[4])) {
+		at = mxGetScalar(prhs[4]);
+		if (at <= 0) {
+			mexErrMsgTxt("polyoffsetmex :  arc tolerance must be > 0.");
+		}
+	}
+	if (nrhs > 5 && !mxIsEmpty(prhs[5])) {
+		ml = mxGetScalar(prhs[5]);
+		if (ml < 1) {
+			mexErrMsgTxt("polyoffsetmex :  miter limit must be >= 1.");
+		}
+	}
+
+	// hole mode
+	if (nrhs > 6 && !mxIsEmpty(prhs[6])) {
+		mxGetString(prhs[6], jstr, STR_LEN);
+		if (!strncmp(jstr, "keyhole", 7))
+			hm = hmKeyhole;
+		else if (!strncmp(jstr, "cutline", 7))
+			hm = hmCutline;
+		else {
+			mexErrMsgTxt("polyoffsetmex :  unknown hole mode.");
+		}
+	}
+
+	/////////////////////////////////
+	// offset, then report any failure
+	//
+	emsg = offset_polygons(plhs, prhs, d, ud, jt, at, ml, hm);
+	if (emsg)
+		mexErrMsgTxt(emsg);
+}
+
+
+//-----------------------------------------------------------------
+
+// offsets the polygons and creates the output arguments.
+// Returns NULL on success or an error message. All C++ objects 
+// have been destroyed when the function returns.
+static const char* 
+offset_polygons(mxArray *plhs[], const mxArray *prhs[], double d, double ud,
+		JoinType jt, double at, double ml, HoleMode hm)
+{
+	Paths pa, pc;
+	PolyTree pt;
+	bool intxy = mxIsInt32(mxGetCell(prhs[0], 0));
+
+	////////////////////////
+	// copy and prepare data
+	//
+	try {
+		ClipperOffset O(ml, at);
+
+		copy_polygons(pa, prhs[0], ud);
+
+		//////////////////////
+		// offset the polygons
+		//
+		O.AddPaths(pa, jt, etClosedPolygon);
+		if (hm == hmNone)
+			O.Execute(pc, ud * d);
+		else {
+			// holes must follow their polygons
+			O.Execute(pt, ud * d);
+			tree_polygons(&pt, pc);
+			pt.Clear();
+			resolve_holes(pc, hm);
+		}
+	}
+	catch (...) {
+		return "polyoffsetmex :  Clipper library error.";
+	}
+
+	/////////////////////////////
+	// return the offset polygons
+	//
+	plhs[0] = polygons_to_cell(pc, ud, intxy);
+	plhs[1] = hole_flags(pc);
+
+	return NULL;
+}
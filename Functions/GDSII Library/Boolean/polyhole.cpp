@@ -0,0 +1,240 @@
+// Conversion of polygons with holes into simple boundaries
+// for the GDS II toolbox (see polyhole.hpp)
+
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "polyhole.hpp"
+
+using namespace ClipperLib;
+
+
+//-----------------------------------------------------------------
+
+// > 0 when b is to the left of the line from o to a
+static inline double
+cross(const IntPoint &o, const IntPoint &a, const IntPoint &b)
+{
+	return (double)(a.X - o.X) * (double)(b.Y - o.Y) - 
+	       (double)(a.Y - o.Y) * (double)(b.X - o.X);
+}
+
+
+//-----------------------------------------------------------------
+
+// returns true when the direction from vertex i of the ring (positive
+// orientation) to point m points into the interior of the ring
+static bool
+locally_inside(const Path &ring, size_t i, const IntPoint &m)
+{
+	size_t n = ring.size();
+	const IntPoint &a = ring[i];
+	const IntPoint &p = ring[(i + n - 1) % n];
+	const IntPoint &q = ring[(i + 1) % n];
+
+	if (cross(p, a, q) > 0)    // convex vertex
+		return cross(a, q, m) >= 0 && cross(a, m, p) >= 0;
+	else
+		return cross(a, q, m) >= 0 || cross(a, m, p) >= 0;
+}
+
+
+//-----------------------------------------------------------------
+
+// returns true when (x,y) is inside the triangle (ax,ay), (bx,by),
+// (cx,cy) or on its boundary
+static bool
+in_triangle(double ax, double ay, double bx, double by, double cx, double cy,
+	    double x, double y)
+{
+	double d1, d2, d3;
+
+	d1 = (bx - ax) * (y - ay) - (by - ay) * (x - ax);
+	d2 = (cx - bx) * (y - by) - (cy - by) * (x - bx);
+	d3 = (ax - cx) * (y - cy) - (ay - cy) * (x - cx);
+
+	return (d1 >= 0 && d2 >= 0 && d3 >= 0) || (d1 <= 0 && d2 <= 0 && d3 <= 0);
+}
+
+
+//-----------------------------------------------------------------
+
+// connects the hole h (negative orientation) to the ring (positive
+// orientation). Returns false when no connecting line was found.
+static bool
+connect_hole(Path &ring, const Path &h, HoleMode hm)
+{
+	std::vector<IntPoint> ins;
+	IntPoint M, I;
+	size_t n = ring.size();
+	size_t i, im, ie, ip, nh;
+	double qx, x, t, tmin;
+	bool cut = false;
+
+	// rightmost vertex of the hole
+	nh = h.size();
+	im = 0;
+	for (i = 1; i < nh; i++) {
+		if (h[i].X > h[im].X)
+			im = i;
+	}
+	M = h[im];
+
+	// the hole touches the ring at M (e.g. a hole that touches
+	// a connected hole); it is inserted there without a line
+	for (i = 0; i < n; i++) {
+		if (ring[i] == M && locally_inside(ring, i, h[(im + 1) % nh])) {
+			for (ip = 1; ip <= nh; ip++)
+				ins.push_back(h[(im + ip) % nh]);
+			ring.insert(ring.begin() + i + 1, ins.begin(), ins.end());
+			return true;
+		}
+	}
+
+	// nearest edge of the ring to the right of M that is seen
+	// from the interior of the ring
+	qx = HUGE_VAL;
+	ie = n;
+	for (i = 0; i < n; i++) {
+		const IntPoint &a = ring[i];
+		const IntPoint &b = ring[(i + 1) % n];
+		if (a.Y == b.Y)
+			continue;
+		if (M.Y < std::min(a.Y, b.Y) || M.Y > std::max(a.Y, b.Y))
+			continue;
+		if (cross(a, b, M) <= 0)
+			continue;
+		x = a.X + (double)(M.Y - a.Y) * (double)(b.X - a.X) / (double)(b.Y - a.Y);
+		if (x >= M.X && x < qx) {
+			qx = x;
+			ie = i;
+		}
+	}
+	if (ie == n)
+		return false;
+
+	const IntPoint &a = ring[ie];
+	const IntPoint &b = ring[(ie + 1) % n];
+
+	if (a.Y == M.Y)
+		ip = ie;
+	else if (b.Y == M.Y)
+		ip = (ie + 1) % n;
+	else {
+
+		// cut line to a grid point on the edge
+		if (hm == hmCutline) {
+			if (a.X == b.X) {
+				I = IntPoint(a.X, M.Y);
+				cut = true;
+			}
+			else if (fabs((double)(M.Y - a.Y)) < 2147483648.0 &&
+				 fabs((double)(b.X - a.X)) < 2147483648.0 &&
+				 ((M.Y - a.Y) * (b.X - a.X)) % (b.Y - a.Y) == 0) {
+				I = IntPoint(a.X + (M.Y - a.Y) * (b.X - a.X) / (b.Y - a.Y), M.Y);
+				cut = true;
+			}
+		}
+
+		// keyhole: the endpoint of the edge further to the right,
+		// unless a vertex in the triangle between M, the edge, and
+		// that endpoint obstructs the view. The vertex with the
+		// smallest angle to the horizontal is seen from M.
+		ip = a.X > b.X ? ie : (ie + 1) % n;
+		if (!cut) {
+			const IntPoint P = ring[ip];
+			tmin = HUGE_VAL;
+			for (i = 0; i < n; i++) {
+				const IntPoint &v = ring[i];
+				if (v.X <= M.X || v.X > P.X)
+					continue;
+				if (!in_triangle(M.X, M.Y, qx, M.Y, P.X, P.Y, v.X, v.Y))
+					continue;
+				t = fabs((double)(M.Y - v.Y)) / (double)(v.X - M.X);
+				if (locally_inside(ring, i, M) &&
+				    (t < tmin || (t == tmin && v.X < ring[ip].X))) {
+					ip = i;
+					tmin = t;
+				}
+			}
+		}
+	}
+
+	// the vertices inserted after ring[ie] (cut line) or ring[ip]
+	if (cut)
+		ins.push_back(I);
+	for (i = 0; i < nh; i++)
+		ins.push_back(h[(im + i) % nh]);
+	ins.push_back(M);
+	if (cut) {
+		ins.push_back(I);
+		ip = ie;
+	}
+	else
+		ins.push_back(ring[ip]);
+	ring.insert(ring.begin() + ip + 1, ins.begin(), ins.end());
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------
+
+// orders holes by decreasing x coordinate of their rightmost vertex
+struct hole_t {
+	cInt xmax;
+	size_t k;
+	bool operator<(const hole_t &o) const { return xmax > o.xmax; }
+};
+
+
+//-----------------------------------------------------------------
+
+void
+resolve_holes(Paths &pc, HoleMode hm)
+{
+	Paths out, left;
+	std::vector<hole_t> hole;
+	size_t k, j, i, m;
+
+	if (hm == hmNone)
+		return;
+
+	k = 0;
+	while (k < pc.size()) {
+
+		// a polygon and its holes pc[k+1] .. pc[j-1]
+		for (j = k + 1; j < pc.size() && !Orientation(pc[j]); j++)
+			;
+		if (!Orientation(pc[k]) || j == k + 1) {
+			for (i = k; i < j; i++)
+				out.push_back(pc[i]);
+			k = j;
+			continue;
+		}
+
+		hole.resize(j - k - 1);
+		for (i = k + 1; i < j; i++) {
+			hole_t &ht = hole[i - k - 1];
+			ht.k = i;
+			ht.xmax = pc[i][0].X;
+			for (m = 1; m < pc[i].size(); m++) {
+				if (pc[i][m].X > ht.xmax)
+					ht.xmax = pc[i][m].X;
+			}
+		}
+		std::stable_sort(hole.begin(), hole.end());
+
+		out.push_back(pc[k]);
+		for (i = 0; i < hole.size(); i++) {
+			if (!connect_hole(out.back(), pc[hole[i].k], hm))
+				left.push_back(pc[hole[i].k]);
+		}
+		out.insert(out.end(), left.begin(), left.end());
+		left.clear();
+
+		k = j;
+	}
+
+	pc.swap(out);
+}
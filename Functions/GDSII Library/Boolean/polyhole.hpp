@@ -0,0 +1,36 @@
+// Conversion of polygons with holes into simple boundaries
+// for the GDS II toolbox
+//
+// GDS II boundaries cannot have holes. A hole can be connected to the
+// polygon that contains it by a pair of coincident edges; the result
+// is a single boundary that traces the outer contour, runs to the hole
+// along the connecting line, traces the hole, and returns along the
+// same line. Two kinds of connecting lines are supported:
+//
+//   keyhole :  the line runs from the rightmost vertex of the hole to
+//              a vertex of the enclosing boundary. Adds two vertices
+//              per hole.
+//   cutline :  the line runs horizontally from the rightmost vertex
+//              of the hole to the nearest edge of the enclosing
+//              boundary, which keeps Manhattan polygons Manhattan.
+//              Adds three vertices per hole. A keyhole is used when 
+//              the edge has no grid point on the line.
+//
+// The holes are connected in the order of decreasing x coordinate of
+// their rightmost vertices, so a connecting line never crosses a hole
+// that is not yet connected.
+
+#ifndef _POLYHOLE_HPP
+#define _POLYHOLE_HPP
+
+#include "clipper.hpp"
+
+enum HoleMode { hmNone, hmKeyhole, hmCutline };
+
+// connects the holes in pc to the polygons that contain them. Each
+// polygon with positive orientation in pc must be followed by its
+// holes, which have negative orientation (see tree_polygons). Holes
+// that could not be connected remain in pc.
+void resolve_holes(ClipperLib::Paths &pc, HoleMode hm);
+
+#endif // _POLYHOLE_HPP
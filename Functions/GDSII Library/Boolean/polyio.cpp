@@ -0,0 +1,144 @@
+// Conversion of polygons between MATLAB arrays and the
+// Clipper library for the GDS II toolbox (see polyio.hpp)
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "polyio.hpp"
+
+using namespace ClipperLib;
+
+
+//-----------------------------------------------------------------
+
+void
+check_polygons(const mxArray *ca, const char *fname, const char *name)
+{
+	char msg[128];
+	unsigned int N, k;
+
+	if (!mxIsCell(ca)) {
+		sprintf(msg, "%s :  argument %s must be a cell array.", fname, name);
+		mexErrMsgTxt(msg);
+	}
+	N = mxGetM(ca)*mxGetN(ca);
+	if (!N) {
+		sprintf(msg, "%s :  no input polygons %s.", fname, name);
+		mexErrMsgTxt(msg);
+	}
+	for (k = 0; k < N; k++) {
+		if (mxIsEmpty(mxGetCell(ca, k))) {
+			sprintf(msg, "%s :  empty polygon in %s.", fname, name);
+			mexErrMsgTxt(msg);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------
+
+void
+copy_polygons(Paths &pp, const mxArray *ca, double ud)
+{
+	mxArray *par;         // ptr to mxArray structure 
+	double *pda;          // ptr to polynomial data
+	int32_t *pia;         // ptr to polygon data in database units
+	unsigned int N, vnu;
+	unsigned int k, m;
+
+	N = mxGetM(ca)*mxGetN(ca);
+	pp.resize(N);
+	for (k = 0; k < N; k++) {
+
+		// get the next polygon from the cell array 
+		par = mxGetCell(ca, k);        // ptr to mxArray
+		vnu = mxGetM(par);             // rows = vertex number
+		pp[k].resize(vnu);
+
+		if (mxIsInt32(par)) {
+			// copy polygon and transpose
+			pia = (int32_t*)mxGetData(par);
+			for (m = 0; m < vnu; m++) {
+				pp[k][m].X = pia[m];
+				pp[k][m].Y = pia[m + vnu];
+			}
+		}
+		else {
+			// copy polygon and transpose, scale
+			pda = (double*)mxGetData(par); // ptr to a data     
+			for (m = 0; m < vnu; m++) {
+				pp[k][m].X = (cInt)floor(ud * pda[m] + 0.5);
+				pp[k][m].Y = (cInt)floor(ud * pda[m + vnu] + 0.5);
+			}
+		}
+
+		// make sure polygons have positive orientation
+		if (!Orientation(pp[k]))
+			ReversePath(pp[k]);
+	}
+}
+
+
+//-----------------------------------------------------------------
+
+mxArray*
+polygons_to_cell(const Paths &pc, double ud, bool intxy)
+{
+	mxArray *ca;          // output cell array
+	mxArray *par;         // ptr to mxArray structure 
+	double *pda;          // ptr to polynomial data
+	int32_t *pia;         // ptr to polygon data in database units
+	double iud = 1.0 / ud;
+	unsigned int vnu;
+	unsigned int k, m;
+
+	ca = mxCreateCellMatrix(1, pc.size());
+
+	for (k = 0; k < pc.size(); k++) {
+
+		// allocate matrix for boundary
+		vnu = pc[k].size();
+		if (intxy) {
+			// copy vertex array and transpose
+			par = mxCreateNumericMatrix(vnu, 2, mxINT32_CLASS, mxREAL);
+			pia = (int32_t*)mxGetData(par);
+			for (m = 0; m < vnu; m++) {
+				pia[m] = (int32_t)pc[k][m].X;
+				pia[vnu + m] = (int32_t)pc[k][m].Y;
+			}
+		}
+		else {
+			par = mxCreateDoubleMatrix(vnu, 2, mxREAL);
+			pda = (double*)mxGetData(par);
+
+			// copy vertex array, transpose, and scale back to user units
+			for (m = 0; m < vnu; m++) {
+				pda[m] = iud * pc[k][m].X;
+				pda[vnu + m] = iud * pc[k][m].Y;
+			}
+		}
+
+		// store in cell array
+		mxSetCell(ca, k, par);
+	}
+
+	return ca;
+}
+
+
+//-----------------------------------------------------------------
+
+mxArray*
+hole_flags(const Paths &pc)
+{
+	mxArray *hf;
+	mxLogical *ph;        // pointer to hole flags
+	unsigned int k;
+
+	hf = mxCreateLogicalMatrix(1, pc.size());
+	ph = (mxLogical*)mxGetData(hf);
+	for (k = 0; k < pc.size(); k++)
+		ph[k] = !Orientation(pc[k]); // same as input == no hole
+
+	return hf;
+}
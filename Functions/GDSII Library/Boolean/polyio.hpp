@@ -0,0 +1,32 @@
+// Conversion of polygons between MATLAB arrays and the
+// Clipper library for the GDS II toolbox
+//
+// Polygons are nx2 matrices of double in user units or of int32 in
+// database units. Polygons with int32 vertices are used without
+// conversion.
+
+#ifndef _POLYIO_HPP
+#define _POLYIO_HPP
+
+#include "mex.h"
+#include "clipper.hpp"
+
+// checks that ca is a non-empty cell array of non-empty polygons and
+// raises an error with message prefix fname otherwise. name is the
+// name of the argument.
+void check_polygons(const mxArray *ca, const char *fname, const char *name);
+
+// copies the polygons in a cell array into a Paths vector and
+// scales them to database units with the factor ud. The polygons
+// are given positive orientation.
+void copy_polygons(ClipperLib::Paths &pp, const mxArray *ca, double ud);
+
+// returns a 1 x N cell array with the polygons in pc, scaled back
+// to user units, or as int32 matrices when intxy is true.
+mxArray* polygons_to_cell(const ClipperLib::Paths &pc, double ud, bool intxy);
+
+// returns a 1 x N logical array that is true for the polygons in pc
+// with negative orientation (holes).
+mxArray* hole_flags(const ClipperLib::Paths &pc);
+
+#endif // _POLYIO_HPP
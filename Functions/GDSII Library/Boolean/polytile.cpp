@@ -0,0 +1,335 @@
+// Tiled boolean set operations with the Clipper library
+// for the GDS II toolbox (see polytile.hpp)
+
+#include <vector>
+#include "polytile.hpp"
+#include "gdsthreads.h"
+
+using namespace ClipperLib;
+
+
+//-----------------------------------------------------------------
+
+// a tile and the polygons that overlap it
+struct tile_t {
+	IntRect r;                  // tile boundaries
+	bool bl, br, bb, bt;        // left, right, bottom, top are inner borders
+	std::vector<size_t> ia;     // polygons of pa
+	std::vector<size_t> ib;     // polygons of pb
+	Paths direct;               // polygons away from inner borders
+	Paths border;               // polygons at inner borders
+	bool failed;
+};
+
+// task argument: the polygons and the tiles they are sorted into
+struct clip_job_t {
+	const Paths *pa;
+	const Paths *pb;
+	const std::vector<IntRect> *ba;   // bounds of the polygons
+	const std::vector<IntRect> *bb;
+	ClipType pop;
+	tile_t *tile;
+};
+
+
+//-----------------------------------------------------------------
+
+static IntRect
+path_bounds(const Path &p)
+{
+	IntRect b;
+	size_t k;
+
+	b.left = b.right = p[0].X;
+	b.top = b.bottom = p[0].Y;
+	for (k = 1; k < p.size(); k++) {
+		if (p[k].X < b.left)   b.left = p[k].X;
+		if (p[k].X > b.right)  b.right = p[k].X;
+		if (p[k].Y < b.bottom) b.bottom = p[k].Y;
+		if (p[k].Y > b.top)    b.top = p[k].Y;
+	}
+	return b;
+}
+
+
+//-----------------------------------------------------------------
+
+// returns true when a vertex of path p is on an inner border of tile t
+static bool
+at_border(const Path &p, const tile_t &t)
+{
+	size_t k;
+
+	for (k = 0; k < p.size(); k++) {
+		if ((t.bl && p[k].X == t.r.left) || (t.br && p[k].X == t.r.right) ||
+		    (t.bb && p[k].Y == t.r.bottom) || (t.bt && p[k].Y == t.r.top))
+			return true;
+	}
+	return false;
+}
+
+
+//-----------------------------------------------------------------
+
+// appends the polygons below node to pc, each followed by its holes.
+// When t is not NULL, polygons that touch an inner border of tile t,
+// and their holes, are appended to pb instead.
+static void
+collect_polygons(const PolyNode *node, Paths &pc, Paths *pb, const tile_t *t)
+{
+	const PolyNode *outer;
+	Paths *pd;
+	size_t k, j;
+	bool border;
+
+	for (k = 0; k < node->Childs.size(); k++) {
+
+		outer = node->Childs[k];
+		border = false;
+		if (t != NULL) {
+			border = at_border(outer->Contour, *t);
+			for (j = 0; j < outer->Childs.size() && !border; j++)
+				border = at_border(outer->Childs[j]->Contour, *t);
+		}
+
+		pd = border ? pb : &pc;
+		pd->push_back(outer->Contour);
+		for (j = 0; j < outer->Childs.size(); j++)
+			pd->push_back(outer->Childs[j]->Contour);
+
+		// polygons inside the holes
+		for (j = 0; j < outer->Childs.size(); j++)
+			collect_polygons(outer->Childs[j], pc, pb, t);
+	}
+}
+
+
+//-----------------------------------------------------------------
+
+void
+tree_polygons(const PolyNode *node, Paths &pc)
+{
+	collect_polygons(node, pc, NULL, NULL);
+}
+
+
+//-----------------------------------------------------------------
+
+// adds the polygons ind of pp to the Clipper C. Polygons that are
+// not inside the tile are cut at the tile first.
+static bool
+add_tile_paths(Clipper &C, const Paths &pp, const std::vector<size_t> &ind,
+	       const std::vector<IntRect> &bnd, const tile_t &t, PolyType ptype)
+{
+	Clipper R;
+	Paths pr;
+	Path rect;
+	size_t k;
+	bool cut = false;
+
+	for (k = 0; k < ind.size(); k++) {
+		const IntRect &b = bnd[ind[k]];
+		if (b.left >= t.r.left && b.right <= t.r.right &&
+		    b.bottom >= t.r.bottom && b.top <= t.r.top)
+			C.AddPath(pp[ind[k]], ptype, true);
+		else {
+			R.AddPath(pp[ind[k]], ptSubject, true);
+			cut = true;
+		}
+	}
+	if (!cut)
+		return true;
+
+	rect << IntPoint(t.r.left, t.r.bottom) << IntPoint(t.r.right, t.r.bottom)
+	     << IntPoint(t.r.right, t.r.top) << IntPoint(t.r.left, t.r.top);
+	R.AddPath(rect, ptClip, true);
+	if (!R.Execute(ctIntersection, pr, pftNonZero, pftNonZero))
+		return false;
+	C.AddPaths(pr, ptype, true);
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------
+
+// clips the parts of the polygons inside of one tile
+static void
+clip_tile(const clip_job_t *pw, tile_t &t)
+{
+	PolyTree pt;
+
+	try {
+		Clipper C;
+
+		C.StrictlySimple(true);
+		if (!add_tile_paths(C, *pw->pa, t.ia, *pw->ba, t, ptSubject) ||
+		    !add_tile_paths(C, *pw->pb, t.ib, *pw->bb, t, ptClip) ||
+		    !C.Execute(pw->pop, pt, pftNonZero, pftNonZero)) {
+			t.failed = true;
+			return;
+		}
+		collect_polygons(&pt, t.direct, &t.border, &t);
+	}
+	catch (...) {
+		t.failed = true;
+	}
+}
+
+
+//-----------------------------------------------------------------
+
+// task function for tiled_clip: clips tile k
+static void
+clip_task(void *arg, int k)
+{
+	const clip_job_t *pw = (const clip_job_t *)arg;
+
+	clip_tile(pw, pw->tile[k]);
+}
+
+
+//-----------------------------------------------------------------
+
+// adds polygon k with bounds b to all tiles it overlaps
+static void
+bin_polygon(std::vector<tile_t> &tile, int ntile, const IntRect &all,
+	    cInt w, cInt h, const IntRect &b, size_t k, bool subject)
+{
+	int i0, i1, j0, j1, i, j;
+	tile_t *pt;
+
+	i0 = (int)((b.left - all.left) / w);
+	i1 = (int)((b.right - all.left) / w);
+	j0 = (int)((b.bottom - all.bottom) / h);
+	j1 = (int)((b.top - all.bottom) / h);
+	if (i0 >= ntile) i0 = ntile - 1;
+	if (i1 >= ntile) i1 = ntile - 1;
+	if (j0 >= ntile) j0 = ntile - 1;
+	if (j1 >= ntile) j1 = ntile - 1;
+
+	for (j = j0; j <= j1; j++) {
+		for (i = i0; i <= i1; i++) {
+			pt = &tile[j*ntile + i];
+			if (subject)
+				pt->ia.push_back(k);
+			else
+				pt->ib.push_back(k);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------
+
+bool
+tiled_clip(const Paths &pa, const Paths &pb, ClipType pop,
+	   int ntile, int nthreads, Paths &pc)
+{
+	std::vector<tile_t> tile;
+	std::vector<IntRect> ba, bb;
+	IntRect all;
+	Paths border;
+	PolyTree pt;
+	cInt w, h;
+	size_t k;
+	clip_job_t job;
+	int nt, i, j, t;
+	bool failed = false;
+
+	pc.clear();
+	if (pa.empty() && pb.empty())
+		return true;
+	if (ntile < 1)
+		ntile = 1;
+	if (ntile > MAX_TILES)
+		ntile = MAX_TILES;
+
+	// bounds of all polygons
+	ba.resize(pa.size());
+	for (k = 0; k < pa.size(); k++)
+		ba[k] = path_bounds(pa[k]);
+	bb.resize(pb.size());
+	for (k = 0; k < pb.size(); k++)
+		bb[k] = path_bounds(pb[k]);
+	all = pa.empty() ? bb[0] : ba[0];
+	for (k = 0; k < ba.size() + bb.size(); k++) {
+		const IntRect &b = k < ba.size() ? ba[k] : bb[k - ba.size()];
+		if (b.left < all.left)     all.left = b.left;
+		if (b.right > all.right)   all.right = b.right;
+		if (b.bottom < all.bottom) all.bottom = b.bottom;
+		if (b.top > all.top)       all.top = b.top;
+	}
+
+	// the tile grid
+	w = (all.right - all.left + ntile - 1) / ntile;
+	h = (all.top - all.bottom + ntile - 1) / ntile;
+	if (w < 1) w = 1;
+	if (h < 1) h = 1;
+	nt = ntile * ntile;
+	tile.resize(nt);
+	for (j = 0; j < ntile; j++) {
+		for (i = 0; i < ntile; i++) {
+			tile_t &tt = tile[j*ntile + i];
+			tt.r.left = all.left + i*w;
+			tt.r.right = (i == ntile-1) ? all.right : all.left + (i+1)*w;
+			tt.r.bottom = all.bottom + j*h;
+			tt.r.top = (j == ntile-1) ? all.top : all.bottom + (j+1)*h;
+			tt.bl = i > 0;
+			tt.br = i < ntile-1;
+			tt.bb = j > 0;
+			tt.bt = j < ntile-1;
+			tt.failed = false;
+		}
+	}
+
+	// sort the polygons into the tiles
+	for (k = 0; k < pa.size(); k++)
+		bin_polygon(tile, ntile, all, w, h, ba[k], k, true);
+	for (k = 0; k < pb.size(); k++)
+		bin_polygon(tile, ntile, all, w, h, bb[k], k, false);
+
+	// clip the tiles
+	job.pa = &pa;
+	job.pb = &pb;
+	job.ba = &ba;
+	job.bb = &bb;
+	job.pop = pop;
+	job.tile = &tile[0];
+	run_tasks(clip_task, &job, nt, nthreads);
+
+	// collect the results in tile order
+	for (t = 0; t < nt; t++) {
+		failed = failed || tile[t].failed;
+		pc.insert(pc.end(), tile[t].direct.begin(), tile[t].direct.end());
+		border.insert(border.end(), tile[t].border.begin(), tile[t].border.end());
+		Paths().swap(tile[t].direct);
+		Paths().swap(tile[t].border);
+	}
+	if (failed)
+		return false;
+
+	// merge the polygons at the tile borders. Clipper is very slow
+	// when strictly simple polygons are created from polygons that
+	// share long edges; the polygons are merged first and then made
+	// strictly simple.
+	if (!border.empty()) {
+		try {
+			Clipper U, S;
+			Paths pu;
+			U.AddPaths(border, ptSubject, true);
+			if (!U.Execute(ctUnion, pu, pftNonZero, pftNonZero))
+				return false;
+			S.StrictlySimple(true);
+			S.AddPaths(pu, ptSubject, true);
+			if (!S.Execute(ctUnion, pt, pftNonZero, pftNonZero))
+				return false;
+		}
+		catch (...) {
+			return false;
+		}
+		collect_polygons(&pt, pc, NULL, NULL);
+	}
+
+	return true;
+}
@@ -0,0 +1,39 @@
+// Tiled boolean set operations with the Clipper library
+// for the GDS II toolbox
+//
+// The bounding box of the input polygons is divided into a grid of
+// tiles. The polygons whose bounding boxes overlap a tile are cut at
+// the tile, and each tile is clipped with its own Clipper object;
+// op(A,B) restricted to a tile equals op(A restricted to the tile,
+// B restricted to the tile). The tiles are clipped by the worker pool
+// of the gdsio functions (gdsthreads.h).
+// Result polygons that touch a border between tiles are merged with
+// a final union; all other polygons are returned as they were computed
+// in their tile. The result covers the same area as an untiled
+// operation, except that edges which cross tile borders can move by
+// up to one database unit where they were cut.
+//
+// The functions do not call the MEX API and can be used in any thread.
+
+#ifndef _POLYTILE_HPP
+#define _POLYTILE_HPP
+
+#include "clipper.hpp"
+
+// largest number of tiles per side of the grid
+#define MAX_TILES  256
+
+// applies the operation pop to the polygons pa and pb with a grid of
+// ntile x ntile tiles (at most MAX_TILES per side) and nthreads
+// threads (all processors when nthreads <= 0). The polygons must have positive orientation. Holes
+// in the result have negative orientation and follow the polygons
+// that contain them. Returns false when the Clipper library failed.
+bool tiled_clip(const ClipperLib::Paths &pa, const ClipperLib::Paths &pb,
+		ClipperLib::ClipType pop, int ntile, int nthreads,
+		ClipperLib::Paths &pc);
+
+// appends the polygons in the tree below node to pc, each polygon
+// followed by its holes.
+void tree_polygons(const ClipperLib::PolyNode *node, ClipperLib::Paths &pc);
+
+#endif // _POLYTILE_HPP
@@ -7,22 +7,40 @@ fprintf('\n\n>>>>>\n');
 fprintf('>>>>>  Compiling mex functions for low-level i/o on MATLAB ...\n');
 fprintf('>>>>>\n');
 
+% compressed GDS II files (.gz, .zst) need zlib and zstd; on Linux
+% and macOS add e.g. -DHAVE_ZLIB -lz -DHAVE_ZSTD -lzstd to the
+% commands that compile gdszip.c
 cd Basic/gdsio
-mex -O gds_open.c mexfuncs.c
-mex -O gds_close.c mexfuncs.c
-mex -O gds_ftell.c mexfuncs.c
-mex -O gds_structdata.c gdsio.c mexfuncs.c 
-mex -O gds_libdata.c gdsio.c mexfuncs.c
-mex -O gds_beginstruct.c gdsio.c mexfuncs.c
-mex -O gds_endstruct.c gdsio.c mexfuncs.c
-mex -O gds_beginlib.c gdsio.c mexfuncs.c
-mex -O gds_endlib.c gdsio.c mexfuncs.c
-mex -O gds_write_element.c gdsio.c mexfuncs.c
-mex -O gds_read_element.c gdsio.c mexfuncs.c mxlist.c
-mex -O gds_record_info.c gdsio.c mexfuncs.c
+mex -O gds_open.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_close.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_ftell.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_fseek.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_structdata.c gdsio.c gdszip.c gdsahead.c mexfuncs.c 
+mex -O gds_libdata.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_beginstruct.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_endstruct.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_beginlib.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_endlib.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_write_element.c gdsio.c gdszip.c gdsahead.c gdswrite.c gdsstore.c polysplit.c gdsthreads.c mexfuncs.c
+mex -O gds_write_library.c gdsio.c gdszip.c gdsahead.c gdswrite.c gdsstore.c polysplit.c gdsthreads.c mexfuncs.c
+mex -O gds_read_element.c gdsio.c gdszip.c gdsahead.c gdsread.c gdsthreads.c mexfuncs.c
+mex -O gds_read_library.c gdsio.c gdszip.c gdsahead.c gdsread.c gdsstore.c gdsthreads.c mexfuncs.c
+mex -O gds_struct_index.c gdsio.c gdszip.c gdsahead.c gdsread.c gdsthreads.c mexfuncs.c
+mex -O gds_layer_stats.c gdsio.c gdszip.c gdsahead.c gdsstats.c gdsthreads.c mexfuncs.c
+mex -O gds_io_stats.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O gds_record_info.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex -O oasis_beginlib.c gdsio.c gdszip.c gdsahead.c oaswrite.c mexfuncs.c
+mex -O oasis_endlib.c gdsio.c gdszip.c gdsahead.c oaswrite.c mexfuncs.c
+mex -O oasis_write_library.c gdsio.c gdszip.c gdsahead.c oaswrite.c mexfuncs.c
+mex -O oasis_read_library.c gdsio.c gdszip.c gdsahead.c oasread.c gdsread.c gdsthreads.c mexfuncs.c
+mex -O gds_cache_write.c gdsio.c gdszip.c gdsahead.c gdscache.c gdsread.c gdsthreads.c mexfuncs.c
+mex -O gds_store_pack.c gdsio.c gdszip.c gdsahead.c gdscache.c gdsread.c gdsstore.c gdsthreads.c mexfuncs.c
+mex -O gds_store_unpack.c gdsio.c gdszip.c gdsahead.c gdsread.c gdsstore.c gdsthreads.c mexfuncs.c
+mex -O gds_cache_read.c gdsio.c gdszip.c gdsahead.c gdscache.c gdsread.c gdsthreads.c mexfuncs.c
 
 cd ../@gds_element/private
 mex -O poly_iscwmex.c
+mex -O -I../../gdsio poly_splitmex.c ../../gdsio/polysplit.c
 mex -O -I../../gdsio isref.c
 mex -O -I../../gdsio get_etype.c
 mex -O -I../../gdsio is_not_internal.c
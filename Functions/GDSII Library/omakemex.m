@@ -11,22 +11,37 @@ setenv('CFLAGS', '-O3 -fomit-frame-pointer -march=native -mtune=native');
 setenv('CXXFLAGS', '-O3 -fomit-frame-pointer -march=native -mtune=native');
 
 cd Basic/gdsio
-mex gds_open.c mexfuncs.c
-mex gds_close.c mexfuncs.c
-mex gds_ftell.c mexfuncs.c
-mex gds_structdata.c gdsio.c mexfuncs.c 
-mex gds_libdata.c gdsio.c mexfuncs.c
-mex gds_beginstruct.c gdsio.c mexfuncs.c
-mex gds_endstruct.c gdsio.c mexfuncs.c
-mex gds_beginlib.c gdsio.c mexfuncs.c
-mex gds_endlib.c gdsio.c mexfuncs.c
-mex gds_write_element.c gdsio.c mexfuncs.c
-mex gds_read_element.c gdsio.c mexfuncs.c mxlist.c
-mex gds_record_info.c gdsio.c mexfuncs.c
+mex gds_open.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_close.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_ftell.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_fseek.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_structdata.c gdsio.c gdszip.c gdsahead.c mexfuncs.c 
+mex gds_libdata.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_beginstruct.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_endstruct.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_beginlib.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_endlib.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_write_element.c gdsio.c gdszip.c gdsahead.c gdswrite.c gdsstore.c polysplit.c gdsthreads.c mexfuncs.c
+mex gds_write_library.c gdsio.c gdszip.c gdsahead.c gdswrite.c gdsstore.c polysplit.c gdsthreads.c mexfuncs.c
+mex gds_read_element.c gdsio.c gdszip.c gdsahead.c gdsread.c gdsthreads.c mexfuncs.c
+mex gds_read_library.c gdsio.c gdszip.c gdsahead.c gdsread.c gdsstore.c gdsthreads.c mexfuncs.c
+mex gds_struct_index.c gdsio.c gdszip.c gdsahead.c gdsread.c gdsthreads.c mexfuncs.c
+mex gds_layer_stats.c gdsio.c gdszip.c gdsahead.c gdsstats.c gdsthreads.c mexfuncs.c
+mex gds_io_stats.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex gds_record_info.c gdsio.c gdszip.c gdsahead.c mexfuncs.c
+mex oasis_beginlib.c gdsio.c gdszip.c gdsahead.c oaswrite.c mexfuncs.c
+mex oasis_endlib.c gdsio.c gdszip.c gdsahead.c oaswrite.c mexfuncs.c
+mex oasis_write_library.c gdsio.c gdszip.c gdsahead.c oaswrite.c mexfuncs.c
+mex oasis_read_library.c gdsio.c gdszip.c gdsahead.c oasread.c gdsread.c gdsthreads.c mexfuncs.c
+mex gds_cache_write.c gdsio.c gdszip.c gdsahead.c gdscache.c gdsread.c gdsthreads.c mexfuncs.c
+mex gds_store_pack.c gdsio.c gdszip.c gdsahead.c gdscache.c gdsread.c gdsstore.c gdsthreads.c mexfuncs.c
+mex gds_store_unpack.c gdsio.c gdszip.c gdsahead.c gdsread.c gdsstore.c gdsthreads.c mexfuncs.c
+mex gds_cache_read.c gdsio.c gdszip.c gdsahead.c gdscache.c gdsread.c gdsthreads.c mexfuncs.c
 system('del *.o');
 
 cd ../@gds_element/private
 mex poly_iscwmex.c
+mex -I../../gdsio poly_splitmex.c ../../gdsio/polysplit.c
 mex -I../../gdsio isref.c
 mex -I../../gdsio get_etype.c
 mex -I../../gdsio is_not_internal.c
@@ -47,7 +62,9 @@ fprintf('>>>>>\n\n');
 
 % for Clipper library
 cd ../../Boolean
-mex poly_boolmex.cpp clipper.cpp
+mex -I../Basic/gdsio poly_boolmex.cpp clipper.cpp polyio.cpp polyhole.cpp polytile.cpp ../Basic/gdsio/gdsthreads.c
+mex -I../Basic/gdsio poly_offsetmex.cpp clipper.cpp polyio.cpp polyhole.cpp polytile.cpp ../Basic/gdsio/gdsthreads.c
+mex -I../Basic/gdsio poly_clipmex.cpp clipper.cpp polyio.cpp polyhole.cpp polytile.cpp ../Basic/gdsio/gdsthreads.c
 system('del *.o');
 
 % back up
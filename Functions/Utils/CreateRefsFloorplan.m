@@ -3,7 +3,8 @@ function CreateRefsFloorplan(filename, forceUpdate)
 % containing all the floorplan information for each structure.
 %
 %     This function receives the filename of a .gds and creates an information
-%     structure .mat file
+%     structure .mat file and a structure index (.sidx) used to read
+%     individual reference cells (see GDS_INDEX and READ_GDS_STRUCTURES)
 %
 %     See also GETREFSFLOORPLAN
 
@@ -23,8 +24,8 @@ if(forceUpdate || ~exist([filename(1:end-4) '.mat'], 'file'))
   end
   
   save(filename(1:end-4), 'cells');
-  save([filename(1:end-4) '_gds'], 'gdslib');
 end
+gds_index(filename, forceUpdate);
 
 end
 
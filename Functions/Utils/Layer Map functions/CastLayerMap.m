@@ -22,7 +22,7 @@ end
 
 %% Reading the input GDS library
 log.write('\t\tReading gds: %s\n', filename);
-load(['Cells/' filename(1:end-4) '_gds']);
+gdslib = read_gds_cache(['Cells/' filename(1:end-4) '_gds.gdc']);
 gdsii_units(get(gdslib, 'uunit'), get(gdslib, 'dbunit'));
 
 
@@ -59,5 +59,5 @@ outlib = set(outlib, 'st', structs);
 %% New Library output
 log.write('\t\tWriting gds: %s\n', outfile);
 gdslib = outlib;
-save(['Cells/' outfile(1:end-4) '_gds'], 'gdslib');
+write_gds_cache(gdslib, ['Cells/' outfile(1:end-4) '_gds.gdc']);
 write_gds_library(outlib, ['!Cells/' outfile], 'verbose', 0);
\ No newline at end of file
@@ -79,7 +79,6 @@ end
 function st = AndLayer(st, sourceLayer, andLayer, targetLayer, varargin)
 
 options.discardRemains = false;
-options.maxVertices = 8190;
 options = ReadOptions(options, varargin{:});
 
 refEls = find(st, @(el) is_etype(el, 'sref') || is_etype(el, 'aref'));
@@ -97,12 +96,12 @@ if(all([~isempty(sourceEls), ~isempty(andEls)]))
   sourceEl = MergeElements(sourceEls);
   andEl = MergeElements(andEls);
   
-  targetEl = {poly_bool(sourceEl, andEl, 'and', 'layer', targetLayer(1), 'dtype', targetLayer(2))};
-  partialEl = {poly_bool(sourceEl, andEl, 'notb', 'layer', sourceLayer(1), 'dtype', sourceLayer(2))};
+  % both operations use the same polygons, which are added once
+  outEl = poly_boolops(sourceEl, andEl, {'and', 'notb'});
+  targetEl = {set(outEl{1}, 'layer', targetLayer(1), 'dtype', targetLayer(2))};
+  partialEl = {set(outEl{2}, 'layer', sourceLayer(1), 'dtype', sourceLayer(2))};
   
-  targetEl = {CheckForLargePolygons(targetEl{1}, 'maxVertices', options.maxVertices)};
-  partialEl = {CheckForLargePolygons(partialEl{1}, 'maxVertices', options.maxVertices)};
-
+  % polygons with more than 8191 vertices are split when they are written
   
   targetMask = true(1, length(targetEl));
   for ii = 1 : length(targetEl)
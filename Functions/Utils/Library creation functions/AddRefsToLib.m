@@ -9,61 +9,28 @@ function gdslib = AddRefsToLib(gdslib, refs, log)
 
 log.write('\n\t%s  -  %s\n\n', log.title(), log.time());
 
-for ii = 1 : length(refs)      % Loop on GDS files
+for ii = 1 : length(refs)      % Loop on references
   
-  if(ii > 1)
-    if(~strcmpi(refs(ii).filename, refs(ii - 1).filename))
+  if((ii == 1) || ~strcmpi(refs(ii).filename, refs(ii - 1).filename))
+    if(ii > 1)
       log.write('\n');
-      data = load([refs(ii).filename(1:end-4) '_gds']);
-      lib = data.gdslib;
-      log.write('\t\tRead gds: %s\n', refs(ii).filename);
     end
-  else
-    data = load([refs(ii).filename(1:end-4) '_gds']);
-    lib = data.gdslib;
     log.write('\t\tRead gds: %s\n', refs(ii).filename);
   end
   
+  % Read only the referenced cell and the cells it depends on
+  slist = read_gds_structures(refs(ii).filename, refs(ii).cellname, 1);
+  names = snames(gdslib);
   
-  
-  for jj = 1 : numst(lib)    % Loop on new structures
-    exis = false;
-    stname = sname(lib(jj));
-    if(strcmp(stname, refs(ii).cellname))
-      for kk = 1 : numst(gdslib)   % Loop on existing structures
-        if(strcmp(stname, sname(gdslib(kk))))
-          exis = true;
-        end
-      end
-      subrefs = find_ref(lib(jj));
-      
-      % If no reference with the same name was found, import it.
-      if(exis)
-        log.write('\t\t\tDuplicate cellname: %s\n', stname);
-      else
-        gdslib = add_struct(gdslib, lib(jj));
-        log.write('\t\t\tAdding cell: %s\n', stname);
-      end
-    end
-  end
-  
-  for jj = 1 : numst(lib)    % Loop on new structures
-    exis = false;
-    stname = sname(lib(jj));
-    if(strcmp(stname, subrefs))
-      for kk = 1 : numst(gdslib)   % Loop on existing structures
-        if(strcmp(stname, sname(gdslib(kk))))
-          exis = true;
-        end
-      end
-      
-      % If no reference with the same name was found, import it.
-      if(exis)
-        log.write('\t\t\tDuplicate cellname: %s\n', stname);
-      else
-        gdslib = add_struct(gdslib, lib(jj));
-        log.write('\t\t\tAdding cell: %s\n', stname);
-      end
+  for jj = 1 : length(slist)    % Loop on new structures
+    stname = sname(slist{jj});
+    
+    % If no reference with the same name was found, import it.
+    if(any(strcmp(stname, names)))
+      log.write('\t\t\tDuplicate cellname: %s\n', stname);
+    else
+      gdslib = add_struct(gdslib, slist{jj});
+      log.write('\t\t\tAdding cell: %s\n', stname);
     end
   end
   log.write('\n');
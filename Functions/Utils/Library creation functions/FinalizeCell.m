@@ -26,7 +26,7 @@ CheckForDirectory(filename);
 gdslib = gds_library([cellname '.DB'], 'uunit', cad.uunit, 'dbunit', cad.dbunit);   % GDS library object
 gdslib = AddRefsToLib(gdslib, refs, log);
 gdslib = add_struct(gdslib, cells);
-save(['Cells\' cellname '_gds'], 'gdslib');
+write_gds_cache(gdslib, ['Cells\' cellname '_gds.gdc']);
 write_gds_library(gdslib, ['!Cells\' cellname '.gds'], 'verbose', 0);
 
 
@@ -20,7 +20,13 @@ files = dir(['Cells/*' cad.v '_put.mat']);
 for inputFile = 1 : length(files)
    putData = load(['Cells/' files(inputFile).name(1:end-4)]);
    cellname = [cad.author '_' putData.cellname '_' cad.v];
-   load([putData.filename '_gds']);
+   % element stores of cells read from their GDS files keep the element
+   % records, which are copied to the merged file without encoding
+   if(exist([putData.filename '.gds'], 'file'))
+      gdslib = read_gds_library([putData.filename '.gds'], 'store',2);
+   else
+      gdslib = read_gds_cache([putData.filename '_gds.gdc']);
+   end
    log.write('\t\tRead gds: %s\n', putData.filename);
    
    for inputStructure = 1 : length(gdslib)
@@ -57,7 +63,7 @@ MergeGDSRoutingMat(cad.outfil(1:end-4));
 mergedLibrary = add_struct(mergedLibrary, topCell);
 gdslib = mergedLibrary;
 
-save(['Cells/' cad.outfil(1:end-4) '_gds'], 'gdslib');
+write_gds_cache(gdslib, ['Cells/' cad.outfil(1:end-4) '_gds.gdc']);
 write_gds_library(mergedLibrary, ['!Cells/' cad.outfil], 'verbose', 0);
 
 end